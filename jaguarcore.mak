@@ -68,12 +68,16 @@ OBJS := \
 	obj/jagdasm.o      \
 	obj/jaguar.o       \
 	obj/jerry.o        \
+	obj/jit.o          \
 	obj/joystick.o     \
+	obj/lockstep.o     \
 	obj/log.o          \
+	obj/machine.o      \
 	obj/memory.o       \
 	obj/memtrack.o     \
 	obj/mmu.o          \
 	obj/op.o           \
+	obj/risc.o         \
 	obj/settings.o     \
 	obj/state.o        \
 	obj/tom.o          \
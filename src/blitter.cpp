@@ -24,13 +24,26 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
 #include "jaguar.h"
+#include "lockstep.h"
 #include "log.h"
 //#include "memory.h"
+#include "mmu.h"
 #include "settings.h"
 
 // Various conditional compilation goodies...
 
+// The shaded row kernels do a phrase at a time with SSE2, which every x86-64
+// has; anywhere else, shaded blits all go thru blitter_generic()
+#if defined(JAGMEM_NATIVE_WORDS) && (defined(__SSE2__) || defined(_M_X64))
+#define BLITTER_SSE2
+#include <emmintrin.h>
+#endif
+
 //#define LOG_BLITS
 
 #define USE_ORIGINAL_BLITTER
@@ -50,22 +63,28 @@ extern int jaguar_active_memory_dumps;
 
 // Local global variables
 
-int start_logging = 0;
-uint8_t blitter_working = 0;
-bool startConciseBlitLogging = false;
-bool logBlit = false;
+PER_MACHINE int start_logging = 0;
+PER_MACHINE uint8_t blitter_working = 0;
+PER_MACHINE bool startConciseBlitLogging = false;
+PER_MACHINE bool logBlit = false;
 
 // Blitter register RAM (most of it is hidden from the user)
 
-static uint8_t blitter_ram[0x100];
+static PER_MACHINE uint8_t blitter_ram[0x100];
 
 // Other crapola
 
-bool specialLog = false;
-extern int effect_start;
-extern int blit_start_log;
+PER_MACHINE bool specialLog = false;
+static PER_MACHINE uint32_t blitterLockstepBlits = 0;			// See BlitterLockstep()
+static PER_MACHINE uint32_t blitterLockstepMemory = 0;
+static PER_MACHINE uint32_t blitterLockstepRegisters = 0;
+extern PER_MACHINE int effect_start;
+extern PER_MACHINE int blit_start_log;
 void BlitterMidsummer(uint32_t cmd);
 void BlitterMidsummer2(void);
+static void BlitterLockstep(void);
+static void BlitterExecute(void);
+static bool BlitterQueue(void);
 
 #define REG(A)	(((uint32_t)blitter_ram[(A)] << 24) | ((uint32_t)blitter_ram[(A)+1] << 16) \
 				| ((uint32_t)blitter_ram[(A)+2] << 8) | (uint32_t)blitter_ram[(A)+3])
@@ -221,155 +240,1111 @@ void BlitterMidsummer2(void);
 #define WRITE_ZDATA_16(a,d)     {  JaguarWriteWord(a##_addr+(ZDATA_OFFSET_16(a)<<1), d, BLITTER); }
 //#define WRITE_ZDATA_16(a,d)     {  JaguarWriteWord(a##_addr+(ZDATA_OFFSET_16(a)<<1), d); }
 
-// z data write
-#define WRITE_ZDATA(a,f,d) WRITE_ZDATA_16(a,d);
+// z data write
+#define WRITE_ZDATA(a,f,d) WRITE_ZDATA_16(a,d);
+
+// 1 bpp r data read
+#define READ_RDATA_1(r,a,p)  ((p) ?  ((REG(r+(((uint32_t)a##_x >> 19) & 0x04))) >> (((uint32_t)a##_x >> 16) & 0x1F)) & 0x0001 : (REG(r) & 0x0001))
+
+// 2 bpp r data read
+#define READ_RDATA_2(r,a,p)  ((p) ?  ((REG(r+(((uint32_t)a##_x >> 18) & 0x04))) >> (((uint32_t)a##_x >> 15) & 0x3E)) & 0x0003 : (REG(r) & 0x0003))
+
+// 4 bpp r data read
+#define READ_RDATA_4(r,a,p)  ((p) ?  ((REG(r+(((uint32_t)a##_x >> 17) & 0x04))) >> (((uint32_t)a##_x >> 14) & 0x28)) & 0x000F : (REG(r) & 0x000F))
+
+// 8 bpp r data read
+#define READ_RDATA_8(r,a,p)  ((p) ?  ((REG(r+(((uint32_t)a##_x >> 16) & 0x04))) >> (((uint32_t)a##_x >> 13) & 0x18)) & 0x00FF : (REG(r) & 0x00FF))
+
+// 16 bpp r data read
+#define READ_RDATA_16(r,a,p)  ((p) ? ((REG(r+(((uint32_t)a##_x >> 15) & 0x04))) >> (((uint32_t)a##_x >> 12) & 0x10)) & 0xFFFF : (REG(r) & 0xFFFF))
+
+// 32 bpp r data read
+#define READ_RDATA_32(r,a,p)  ((p) ? REG(r+(((uint32_t)a##_x >> 14) & 0x04)) : REG(r))
+
+// register data read
+#define READ_RDATA(r,a,f,p) (\
+	 (((f>>3)&0x07) == 0) ? (READ_RDATA_1(r,a,p)) : \
+	 (((f>>3)&0x07) == 1) ? (READ_RDATA_2(r,a,p)) : \
+	 (((f>>3)&0x07) == 2) ? (READ_RDATA_4(r,a,p)) : \
+	 (((f>>3)&0x07) == 3) ? (READ_RDATA_8(r,a,p)) : \
+	 (((f>>3)&0x07) == 4) ? (READ_RDATA_16(r,a,p)) : \
+	 (((f>>3)&0x07) == 5) ? (READ_RDATA_32(r,a,p)) : 0)
+
+// 1 bpp pixel write
+#define WRITE_PIXEL_1(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_1(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_1(a), BLITTER)&(~(0x01 << PIXEL_SHIFT_1(a))))|(d<<PIXEL_SHIFT_1(a)), BLITTER); }
+//#define WRITE_PIXEL_1(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_1(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_1(a))&(~(0x01 << PIXEL_SHIFT_1(a))))|(d<<PIXEL_SHIFT_1(a))); }
+
+// 2 bpp pixel write
+#define WRITE_PIXEL_2(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_2(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_2(a), BLITTER)&(~(0x03 << PIXEL_SHIFT_2(a))))|(d<<PIXEL_SHIFT_2(a)), BLITTER); }
+//#define WRITE_PIXEL_2(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_2(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_2(a))&(~(0x03 << PIXEL_SHIFT_2(a))))|(d<<PIXEL_SHIFT_2(a))); }
+
+// 4 bpp pixel write
+#define WRITE_PIXEL_4(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_4(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_4(a), BLITTER)&(~(0x0f << PIXEL_SHIFT_4(a))))|(d<<PIXEL_SHIFT_4(a)), BLITTER); }
+//#define WRITE_PIXEL_4(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_4(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_4(a))&(~(0x0f << PIXEL_SHIFT_4(a))))|(d<<PIXEL_SHIFT_4(a))); }
+
+// 8 bpp pixel write
+#define WRITE_PIXEL_8(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_8(a), d, BLITTER); }
+//#define WRITE_PIXEL_8(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_8(a), d); }
+
+// 16 bpp pixel write
+//#define WRITE_PIXEL_16(a,d)     {  JaguarWriteWord(a##_addr+(PIXEL_OFFSET_16(a)<<1),d); }
+#define WRITE_PIXEL_16(a,d)     {  JaguarWriteWord(a##_addr+(PIXEL_OFFSET_16(a)<<1), d, BLITTER); if (specialLog) WriteLog("Pixel write address: %08X\n", a##_addr+(PIXEL_OFFSET_16(a)<<1)); }
+//#define WRITE_PIXEL_16(a,d)     {  JaguarWriteWord(a##_addr+(PIXEL_OFFSET_16(a)<<1), d); if (specialLog) WriteLog("Pixel write address: %08X\n", a##_addr+(PIXEL_OFFSET_16(a)<<1)); }
+
+// 32 bpp pixel write
+#define WRITE_PIXEL_32(a,d)		{ JaguarWriteLong(a##_addr+(PIXEL_OFFSET_32(a)<<2), d, BLITTER); }
+//#define WRITE_PIXEL_32(a,d)		{ JaguarWriteLong(a##_addr+(PIXEL_OFFSET_32(a)<<2), d); }
+
+// pixel write
+#define WRITE_PIXEL(a,f,d) {\
+	switch ((f>>3)&0x07) { \
+	case 0: WRITE_PIXEL_1(a,d);  break;  \
+	case 1: WRITE_PIXEL_2(a,d);  break;  \
+	case 2: WRITE_PIXEL_4(a,d);  break;  \
+	case 3: WRITE_PIXEL_8(a,d);  break;  \
+	case 4: WRITE_PIXEL_16(a,d); break;  \
+	case 5: WRITE_PIXEL_32(a,d); break;  \
+	}}
+
+// Width in Pixels of a Scanline
+// This is a pretranslation of the value found in the A1 & A2 flags: It's really a floating point value
+// of the form EEEEMM where MM is the mantissa with an implied "1." in front of it and the EEEE value is
+// the exponent. Valid values for the exponent range from 0 to 11 (decimal). It's easiest to think of it
+// as a floating point bit pattern being followed by a number of zeroes. So, e.g., 001101 translates to
+// 1.01 (the "1." being implied) x (2 ^ 3) or 1010 -> 10 in base 10 (i.e., 1.01 with the decimal place
+// being shifted to the right 3 places).
+/*static uint32_t blitter_scanline_width[48] =
+{
+     0,    0,    0,    0,					// Note: This would really translate to 1, 1, 1, 1
+     2,    0,    0,    0,
+     4,    0,    6,    0,
+     8,   10,   12,   14,
+    16,   20,   24,   28,
+    32,   40,   48,   56,
+    64,   80,   96,  112,
+   128,  160,  192,  224,
+   256,  320,  384,  448,
+   512,  640,  768,  896,
+  1024, 1280, 1536, 1792,
+  2048, 2560, 3072, 3584
+};//*/
+
+//static uint8_t * tom_ram_8;
+//static uint8_t * paletteRam;
+static PER_MACHINE uint8_t src;
+static PER_MACHINE uint8_t dst;
+static PER_MACHINE uint8_t misc;
+static PER_MACHINE uint8_t a1ctl;
+static PER_MACHINE uint8_t mode;
+static PER_MACHINE uint8_t ity;
+static PER_MACHINE uint8_t zop;
+static PER_MACHINE uint8_t op;
+static PER_MACHINE uint8_t ctrl;
+static PER_MACHINE uint32_t a1_addr;
+static PER_MACHINE uint32_t a2_addr;
+static PER_MACHINE int32_t a1_zoffs;
+static PER_MACHINE int32_t a2_zoffs;
+static PER_MACHINE uint32_t xadd_a1_control;
+static PER_MACHINE uint32_t xadd_a2_control;
+static PER_MACHINE int32_t a1_pitch;
+static PER_MACHINE int32_t a2_pitch;
+static PER_MACHINE uint32_t n_pixels;
+static PER_MACHINE uint32_t n_lines;
+static PER_MACHINE int32_t a1_x;
+static PER_MACHINE int32_t a1_y;
+static PER_MACHINE int32_t a1_width;
+static PER_MACHINE int32_t a2_x;
+static PER_MACHINE int32_t a2_y;
+static PER_MACHINE int32_t a2_width;
+static PER_MACHINE int32_t a2_mask_x;
+static PER_MACHINE int32_t a2_mask_y;
+static PER_MACHINE int32_t a1_xadd;
+static PER_MACHINE int32_t a1_yadd;
+static PER_MACHINE int32_t a2_xadd;
+static PER_MACHINE int32_t a2_yadd;
+static PER_MACHINE uint8_t a1_phrase_mode;
+static PER_MACHINE uint8_t a2_phrase_mode;
+static PER_MACHINE int32_t a1_step_x = 0;
+static PER_MACHINE int32_t a1_step_y = 0;
+static PER_MACHINE int32_t a2_step_x = 0;
+static PER_MACHINE int32_t a2_step_y = 0;
+static PER_MACHINE uint32_t outer_loop;
+static PER_MACHINE uint32_t inner_loop;
+static PER_MACHINE uint32_t a2_psize;
+static PER_MACHINE uint32_t a1_psize;
+static PER_MACHINE uint32_t gouraud_add;
+//static uint32_t gouraud_data;
+//static uint16_t gint[4];
+//static uint16_t gfrac[4];
+//static uint8_t  gcolour[4];
+static PER_MACHINE int gd_i[4];
+static PER_MACHINE int gd_c[4];
+static PER_MACHINE int gd_ia, gd_ca;
+static PER_MACHINE int colour_index = 0;
+static PER_MACHINE int32_t zadd;
+static PER_MACHINE uint32_t z_i[4];
+
+static PER_MACHINE int32_t a1_clip_x, a1_clip_y;
+
+// In the spirit of "get it right first, *then* optimize" I've taken the liberty
+// of removing all the unnecessary code caching. If it turns out to be a good way
+// to optimize the blitter, then we may revisit it in the future...
+
+//
+// Row kernels
+//
+// blitter_generic() works out what to do from the command bits for every single
+// pixel, and every read & write goes thru the MMU. Most of what games actually
+// throw at it is a lot more boring than that: filling a rectangle with the
+// pattern, or copying a sprite over (maybe with colour 0 as see-thru), A1 <- A2
+// at 8, 16 or 32 bpp. BlitterSelectRowKernel() picks one of the kernels below
+// for those, & blitter_generic() hands it each line before doing it the slow
+// way. A kernel finds the line in host memory once, then walks along it a pixel
+// at a time (or does it with memset()/memcpy(), if it's a plain fill or copy
+// along the line; see the spans below); if the line isn't all in plain memory,
+// or X wraps around partway thru, the kernel says no & it's done the slow way
+// after all.
+//
+
+enum { BLIT_KERNEL_FILL, BLIT_KERNEL_COPY, BLIT_KERNEL_COPY_TRANSPARENT };
+
+struct BlitterRow
+{
+	uint8_t * mem;								// Host memory of the page the line starts in
+	uint32_t offset;							// First pixel, from mem
+	int32_t step;								// Bytes from one pixel to the next
+};
+
+// Everything a kernel needs to do one line, once it's been found
+struct BlitterRowJob
+{
+	BlitterRow dst, src;
+	uint32_t x;									// A1's X, for the pattern
+};
+
+// A kernel, in the two halves BlitterParallelRows() needs
+struct BlitterRowSplit
+{
+	bool (* find)(BlitterRowJob & job);
+	void (* run)(BlitterRowJob job);
+};
+
+static PER_MACHINE bool (* blitterRowKernel)(void) = NULL;
+static PER_MACHINE const BlitterRowSplit * blitterRowSplit = NULL;
+static PER_MACHINE uint32_t blitterKernelPattern[8];	// PATTERNDATA, by X within the phrase
+
+
+//
+// Where the bytes from lo to hi are in host memory (counting from the start of
+// lo's page), or NULL if they're not all in one run of plain memory. When the
+// bus is hooked (see MMUHookBus()), nothing's writable, so it all goes the slow way.
+// Fences (see BlitterQueue()) are there to keep everybody *else* out, so they
+// don't count.
+//
+static uint8_t * BlitterHostMemory(uint32_t lo, uint32_t hi, bool write)
+{
+	uint32_t first = lo >> MMU_PAGE_SHIFT;
+	uint8_t * mem = MMUBusMemory(first, write);
+
+	if (mem == NULL)
+		return NULL;
+
+	for(uint32_t i=first+1; i<=(hi >> MMU_PAGE_SHIFT); i++)
+	{
+		uint8_t * next = MMUBusMemory(i, write);
+
+		if (next != mem + ((i - first) << MMU_PAGE_SHIFT))
+			return NULL;
+	}
+
+	return mem;
+}
+
+
+//
+// Find where the current line of an A1/A2 channel (with a pitch of one phrase)
+// lives; its address only has to be worked out for the first pixel.
+//
+template <uint32_t depth>
+static bool BlitterHostRow(BlitterRow & row, uint32_t addr, int32_t x, int32_t y, int32_t width,
+	int32_t xadd, bool write)
+{
+	const int64_t size = 1 << (depth - 3);
+	int64_t dx = xadd >> 16;					// -1, 0 or 1
+	int64_t firstX = (uint32_t)x >> 16;
+	int64_t lastX = firstX + (dx * (n_pixels - 1));
+
+	if (lastX < 0 || lastX > 0xFFFF)
+		return false;
+
+	uint32_t address = (addr + (((((uint32_t)y >> 16) * width) + (uint32_t)firstX) << (depth - 3))) & 0xFFFFFF;
+	int64_t last = (int64_t)address + (dx * (n_pixels - 1) * size);
+	int64_t lo = (dx < 0 ? last : address), hi = (dx < 0 ? address : last) + size - 1;
+
+	if (lo < 0 || hi > 0xFFFFFF)
+		return false;
+
+	row.mem = BlitterHostMemory((uint32_t)lo, (uint32_t)hi, write);
+	row.offset = address - ((uint32_t)lo & ~MMU_PAGE_MASK);
+	row.step = (int32_t)(dx * size);
+
+	return (row.mem != NULL);
+}
+
+
+template <uint32_t depth>
+static inline uint32_t BlitterHostRead(const uint8_t * mem, uint32_t offset)
+{
+	if (depth == 3)
+		return JagMemRead8(mem, offset);
+	else if (depth == 4)
+		return JagMemRead16(mem, offset);
+
+	return JagMemRead32(mem, offset);
+}
+
+
+template <uint32_t depth>
+static inline void BlitterHostWrite(uint8_t * mem, uint32_t offset, uint32_t data)
+{
+	if (depth == 3)
+		JagMemWrite8(mem, offset, data);
+	else if (depth == 4)
+		JagMemWrite16(mem, offset, data);
+	else
+		JagMemWrite32(mem, offset, data);
+}
+
+
+//
+// Spans: when a line runs straight along memory (X going up or down by one
+// pixel at a time), fills & copies don't have to be done a pixel at a time.
+// The row's first pixel is at the top end of the span if X is going down.
+//
+
+//
+// The pattern only depends on where X is within the phrase, so once a whole
+// phrase has been laid down the slow way, the rest of the line is just copies
+// of it
+//
+template <uint32_t depth>
+static void BlitterHostFillSpan(BlitterRow & dst, uint32_t x)
+{
+	const uint32_t size = 1 << (depth - 3), phrasePixels = 8 >> (depth - 3);
+	uint32_t offset = dst.offset;
+
+	// Work up from the bottom end of the span
+	if (dst.step < 0)
+		offset -= (n_pixels - 1) * size, x -= n_pixels - 1;
+
+	uint32_t i = 0;
+
+	for(; i<n_pixels && ((offset + (i * size)) & 0x07); i++)
+		BlitterHostWrite<depth>(dst.mem, offset + (i * size), blitterKernelPattern[(x + i) & (phrasePixels - 1)]);
+
+	uint32_t phrases = (n_pixels - i) / phrasePixels;
+
+	if (phrases)
+	{
+		uint8_t * phrase = dst.mem + offset + (i * size);
+
+		for(uint32_t j=0; j<phrasePixels; j++, i++)
+			BlitterHostWrite<depth>(dst.mem, offset + (i * size), blitterKernelPattern[(x + i) & (phrasePixels - 1)]);
+
+		bool same = true;
+
+		for(int j=1; j<8; j++)
+			same = same && (phrase[j] == phrase[0]);
+
+		uint32_t done = 8, length = phrases * 8;
+
+		if (same)
+			memset(phrase + done, phrase[0], length - done);
+		else
+		{
+			while (done < length)
+			{
+				uint32_t chunk = (done < length - done ? done : length - done);
+				memcpy(phrase + done, phrase, chunk);
+				done += chunk;
+			}
+		}
+
+		i += (phrases - 1) * phrasePixels;
+	}
+
+	for(; i<n_pixels; i++)
+		BlitterHostWrite<depth>(dst.mem, offset + (i * size), blitterKernelPattern[(x + i) & (phrasePixels - 1)]);
+}
+
+
+//
+// Straight copy of a span that doesn't overlap itself (if it does, the pixel
+// at a time copy smears it, & that has to be done the slow way). Main RAM &
+// ROM are kept a word at a time (see memory.h), so it can only be done as one
+// memcpy() if both ends are the same way around; any odd byte at either end
+// is done on its own. Says no if it can't do it.
+//
+static bool BlitterHostCopySpan(BlitterRow & dst, BlitterRow & src, uint32_t length)
+{
+	uint32_t size = (dst.step < 0 ? -dst.step : dst.step);
+	uint32_t dstOffset = dst.offset, srcOffset = src.offset;
+
+	if (dst.step < 0)
+		dstOffset -= length - size, srcOffset -= length - size;
+
+	uintptr_t to = (uintptr_t)(dst.mem + dstOffset), from = (uintptr_t)(src.mem + srcOffset);
+
+	if (((dstOffset ^ srcOffset) & 0x01) || (to < from + length && from < to + length))
+		return false;
+
+	if (dstOffset & 0x01)
+	{
+		JagMemWrite8(dst.mem, dstOffset, JagMemRead8(src.mem, srcOffset));
+		dstOffset++, srcOffset++, length--;
+	}
+
+	if (length & 0x01)
+	{
+		length--;
+		JagMemWrite8(dst.mem, dstOffset + length, JagMemRead8(src.mem, srcOffset + length));
+	}
+
+	memcpy(dst.mem + dstOffset, src.mem + srcOffset, length);
+
+	return true;
+}
+
+//
+// Leave A1 & A2 where blitter_generic() would have at the end of the line
+//
+static void BlitterKernelAdvance(void)
+{
+	a1_x = (int32_t)((uint32_t)a1_x + ((uint32_t)a1_xadd * n_pixels));
+
+	if (a2_mask_x == -1)
+		a2_x = (int32_t)((uint32_t)a2_x + ((uint32_t)a2_xadd * n_pixels));
+	else
+		for(uint32_t i=0; i<n_pixels; i++)
+			a2_x = (int32_t)((uint32_t)a2_x + (uint32_t)a2_xadd) & a2_mask_x;
+
+	a2_y &= a2_mask_y;
+}
+
+
+//
+// Find the line A1 & A2 are on now, if the kernel can do it
+//
+template <uint32_t depth, int kind>
+static bool BlitterRowFind(BlitterRowJob & job)
+{
+	if (!BlitterHostRow<depth>(job.dst, a1_addr, a1_x, a1_y, a1_width, a1_xadd, true))
+		return false;
+
+	if (kind != BLIT_KERNEL_FILL
+		&& !BlitterHostRow<depth>(job.src, a2_addr, a2_x, a2_y, a2_width, a2_xadd, false))
+		return false;
+
+	job.x = (uint32_t)a1_x >> 16;
+
+	return true;
+}
+
+
+//
+// Do a line that's been found. This doesn't touch A1 or A2, so it doesn't care
+// which line it is (or which thread it's on; see BlitterParallelRows()).
+//
+template <uint32_t depth, int kind>
+static void BlitterRowRun(BlitterRowJob job)
+{
+	BlitterRow & dst = job.dst, & src = job.src;
+
+	if (kind == BLIT_KERNEL_FILL && dst.step != 0)
+		BlitterHostFillSpan<depth>(dst, job.x);
+	else if (kind == BLIT_KERNEL_FILL)
+	{
+		const uint32_t phraseMask = (8 >> (depth - 3)) - 1;
+
+		for(uint32_t i=0; i<n_pixels; i++)
+			BlitterHostWrite<depth>(dst.mem, dst.offset, blitterKernelPattern[job.x & phraseMask]);
+	}
+	else if (kind == BLIT_KERNEL_COPY && dst.step != 0 && src.step == dst.step
+		&& BlitterHostCopySpan(dst, src, n_pixels << (depth - 3)))
+	{
+		// Done in one go
+	}
+	else
+	{
+		// One pixel at a time, so overlapping lines come out the same as well
+		for(uint32_t i=0; i<n_pixels; i++, src.offset+=src.step, dst.offset+=dst.step)
+		{
+			uint32_t data = BlitterHostRead<depth>(src.mem, src.offset);
+
+			if (kind == BLIT_KERNEL_COPY || data != 0)
+				BlitterHostWrite<depth>(dst.mem, dst.offset, data);
+		}
+	}
+}
+
+
+template <uint32_t depth, int kind>
+static bool BlitterRowKernel(void)
+{
+	BlitterRowJob job;
+
+	if (n_pixels == 0)
+		return true;
+
+	if (!BlitterRowFind<depth, kind>(job))
+		return false;
+
+	BlitterRowRun<depth, kind>(job);
+	BlitterKernelAdvance();
+
+	return true;
+}
+
+
+static bool (* const blitterRowKernels[3][3])(void) = {
+	{ BlitterRowKernel<3, BLIT_KERNEL_FILL>, BlitterRowKernel<3, BLIT_KERNEL_COPY>, BlitterRowKernel<3, BLIT_KERNEL_COPY_TRANSPARENT> },
+	{ BlitterRowKernel<4, BLIT_KERNEL_FILL>, BlitterRowKernel<4, BLIT_KERNEL_COPY>, BlitterRowKernel<4, BLIT_KERNEL_COPY_TRANSPARENT> },
+	{ BlitterRowKernel<5, BLIT_KERNEL_FILL>, BlitterRowKernel<5, BLIT_KERNEL_COPY>, BlitterRowKernel<5, BLIT_KERNEL_COPY_TRANSPARENT> }
+};
+
+#define BLIT_ROW_SPLIT(depth, kind)		{ BlitterRowFind<depth, kind>, BlitterRowRun<depth, kind> }
+
+static const BlitterRowSplit blitterRowSplits[3][3] = {
+	{ BLIT_ROW_SPLIT(3, BLIT_KERNEL_FILL), BLIT_ROW_SPLIT(3, BLIT_KERNEL_COPY), BLIT_ROW_SPLIT(3, BLIT_KERNEL_COPY_TRANSPARENT) },
+	{ BLIT_ROW_SPLIT(4, BLIT_KERNEL_FILL), BLIT_ROW_SPLIT(4, BLIT_KERNEL_COPY), BLIT_ROW_SPLIT(4, BLIT_KERNEL_COPY_TRANSPARENT) },
+	{ BLIT_ROW_SPLIT(5, BLIT_KERNEL_FILL), BLIT_ROW_SPLIT(5, BLIT_KERNEL_COPY), BLIT_ROW_SPLIT(5, BLIT_KERNEL_COPY_TRANSPARENT) }
+};
+
+
+#ifdef BLITTER_SSE2
+//
+// Shaded kernel: Gouraud shading (GOURD) and/or Z (GOURZ, with or without a Z
+// compare & DSTWRZ), A1 <- nothing, 16 bpp, in phrase mode. In phrase mode each
+// of the four pixels in a phrase has its own intensity, colour & Z (gd_i[],
+// gd_c[] & z_i[], picked by colour_index), and each one gets the increment once
+// per phrase, so a whole phrase can be done at once with one lane for each.
+// Any pixels before the first phrase boundary & after the last are done one at
+// a time by BlitterShadePixel(), which is what blitter_generic() does, minus
+// the command bits that can't be set here.
+//
+
+static PER_MACHINE uint32_t blitterKernelZMode;			// Z_OP_INF/EQU/SUP, shifted down
+static PER_MACHINE bool blitterKernelZWrite;			// DSTWRZ
+static PER_MACHINE bool blitterKernelZRead;				// Destination Z comes from memory
+static PER_MACHINE uint32_t blitterKernelDstZ[4];		// ...or from DSTZ, by X within the phrase
+
+template <bool gourd, bool gourz>
+static inline void BlitterShadePixel(uint8_t * mem, uint32_t offset, uint32_t zOffset, uint32_t x)
+{
+	uint32_t writedata = (gourd ? ((gd_c[colour_index] << 8) | (gd_i[colour_index] >> 16))
+		: blitterKernelPattern[x & 0x03]);
+	bool inhibit = false;
+
+	if (gourz && blitterKernelZMode)
+	{
+		uint32_t srcz = z_i[colour_index] >> 16;
+		uint32_t dstz = (blitterKernelZRead ? JagMemRead16(mem, zOffset) : blitterKernelDstZ[x & 0x03]);
+
+		inhibit = ((blitterKernelZMode & 0x01) && srcz < dstz) || ((blitterKernelZMode & 0x02) && srcz == dstz)
+			|| ((blitterKernelZMode & 0x04) && srcz > dstz);
+	}
+
+	if (!inhibit)
+	{
+		JagMemWrite16(mem, offset, writedata);
+
+		if (gourz && blitterKernelZWrite)
+			JagMemWrite16(mem, zOffset, z_i[colour_index] >> 16);
+	}
+
+	if (gourz)
+		z_i[colour_index] += zadd;
+
+	if (gourd)
+	{
+		gd_i[colour_index] += gd_ia;
+
+		if ((int32_t)gd_i[colour_index] < 0)
+			gd_i[colour_index] = 0;
+
+		if (gd_i[colour_index] > 0x00FFFFFF)
+			gd_i[colour_index] = 0x00FFFFFF;
+
+		gd_c[colour_index] += gd_ca;
+
+		if ((int32_t)gd_c[colour_index] < 0)
+			gd_c[colour_index] = 0;
+
+		if (gd_c[colour_index] > 0x000000FF)
+			gd_c[colour_index] = 0x000000FF;
+	}
+
+	colour_index = (colour_index + 1) & 0x03;
+}
+
+
+// Lane n of the result is lane (n + r) & 3 of v
+static inline __m128i BlitterRotateLanes(__m128i v, uint32_t r)
+{
+	switch (r & 0x03)
+	{
+	case 1: return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 3, 2, 1));
+	case 2: return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+	case 3: return _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 1, 0, 3));
+	}
+
+	return v;
+}
+
+
+// Four 32-bit lanes that are known to fit in 16 bits, down to 16 bits each
+static inline __m128i BlitterPack16(__m128i v)
+{
+	const __m128i bias32 = _mm_set1_epi32(0x8000), bias16 = _mm_set1_epi16((short)0x8000);
+	return _mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(v, bias32), _mm_setzero_si128()), bias16);
+}
+
+
+// Signed 32-bit lanes clamped to 0..max
+static inline __m128i BlitterClamp(__m128i v, __m128i max)
+{
+	v = _mm_andnot_si128(_mm_cmplt_epi32(v, _mm_setzero_si128()), v);
+	__m128i over = _mm_cmpgt_epi32(v, max);
+	return _mm_or_si128(_mm_andnot_si128(over, v), _mm_and_si128(over, max));
+}
+
+
+template <bool gourd, bool gourz>
+static bool BlitterShadeKernel(void)
+{
+	if (n_pixels == 0)
+		return true;
+
+	// Where the line (and its Z, which is zoffs phrases past each pixel) is
+	uint32_t firstX = (uint32_t)a1_x >> 16;
+	int64_t lastX = (int64_t)firstX + n_pixels - 1;
+
+	if (lastX > 0xFFFF)
+		return false;
+
+	uint32_t address = (a1_addr + (PIXEL_OFFSET_16(a1) << 1)) & 0xFFFFFF;
+	int64_t span = ((((lastX & ~3) - (firstX & ~3)) * (1 + a1_pitch)) + (lastX & 3) - (firstX & 3)) * 2;
+	int64_t hi = (int64_t)address + span + (a1_zoffs * 8) + 1;
+
+	if (hi > 0xFFFFFF)
+		return false;
+
+	uint8_t * mem = BlitterHostMemory(address, (uint32_t)hi, true);
+
+	if (mem == NULL)
+		return false;
+
+	// From here on, offsets are from mem, & the Z is always zoffs phrases on
+	uint32_t offset = address & MMU_PAGE_MASK, zDistance = a1_zoffs * 8;
+	uint32_t x = firstX, i = 0;
+
+	for(; i<n_pixels && (x & 0x03); i++, x++, offset+=2)
+		BlitterShadePixel<gourd, gourz>(mem, offset, offset + zDistance, x);
+
+	// Crossing a phrase boundary skips over the pitch
+	if (i != 0)
+		offset += (uint32_t)(a1_pitch * 8);
+
+	uint32_t phrases = (n_pixels - i) / 4;
+
+	if (phrases)
+	{
+		// Turn the lanes around so pixel n of each phrase is in lane n
+		uint32_t r = colour_index;
+		__m128i intensity = BlitterRotateLanes(_mm_loadu_si128((__m128i *)gd_i), r);
+		__m128i colour = BlitterRotateLanes(_mm_loadu_si128((__m128i *)gd_c), r);
+		__m128i z = BlitterRotateLanes(_mm_loadu_si128((__m128i *)z_i), r);
+		const __m128i intensityAdd = _mm_set1_epi32(gd_ia), colourAdd = _mm_set1_epi32(gd_ca);
+		const __m128i intensityMax = _mm_set1_epi32(0x00FFFFFF), colourMax = _mm_set1_epi32(0x000000FF);
+		const __m128i zAdd = _mm_set1_epi32(zadd), sign = _mm_set1_epi16((short)0x8000);
+		const __m128i pattern = BlitterPack16(_mm_loadu_si128((__m128i *)blitterKernelPattern));
+		const __m128i dstZ = BlitterPack16(_mm_loadu_si128((__m128i *)blitterKernelDstZ));
+		const uint32_t phraseStep = 8 * (1 + a1_pitch);
+
+		for(uint32_t p=0; p<phrases; p++, offset+=phraseStep)
+		{
+			__m128i pixels = (gourd ? BlitterPack16(_mm_or_si128(_mm_slli_epi32(colour, 8), _mm_srli_epi32(intensity, 16)))
+				: pattern);
+			__m128i write = _mm_set1_epi32(-1);
+			__m128i srcZ = _mm_setzero_si128();
+
+			if (gourz)
+			{
+				srcZ = BlitterPack16(_mm_srli_epi32(z, 16));
+
+				if (blitterKernelZMode)
+				{
+					__m128i s = _mm_xor_si128(srcZ, sign);
+					__m128i d = _mm_xor_si128((blitterKernelZRead ? _mm_loadl_epi64((__m128i *)(mem + offset + zDistance)) : dstZ), sign);
+					__m128i inhibit = _mm_setzero_si128();
+
+					if (blitterKernelZMode & 0x01)
+						inhibit = _mm_or_si128(inhibit, _mm_cmplt_epi16(s, d));
+
+					if (blitterKernelZMode & 0x02)
+						inhibit = _mm_or_si128(inhibit, _mm_cmpeq_epi16(s, d));
+
+					if (blitterKernelZMode & 0x04)
+						inhibit = _mm_or_si128(inhibit, _mm_cmpgt_epi16(s, d));
+
+					write = _mm_andnot_si128(inhibit, write);
+				}
+			}
+
+			__m128i old = _mm_loadl_epi64((__m128i *)(mem + offset));
+			_mm_storel_epi64((__m128i *)(mem + offset), _mm_or_si128(_mm_and_si128(write, pixels), _mm_andnot_si128(write, old)));
+
+			if (gourz && blitterKernelZWrite)
+			{
+				old = _mm_loadl_epi64((__m128i *)(mem + offset + zDistance));
+				_mm_storel_epi64((__m128i *)(mem + offset + zDistance), _mm_or_si128(_mm_and_si128(write, srcZ), _mm_andnot_si128(write, old)));
+			}
+
+			if (gourz)
+				z = _mm_add_epi32(z, zAdd);
+
+			if (gourd)
+			{
+				intensity = BlitterClamp(_mm_add_epi32(intensity, intensityAdd), intensityMax);
+				colour = BlitterClamp(_mm_add_epi32(colour, colourAdd), colourMax);
+			}
+		}
+
+		_mm_storeu_si128((__m128i *)gd_i, BlitterRotateLanes(intensity, 4 - r));
+		_mm_storeu_si128((__m128i *)gd_c, BlitterRotateLanes(colour, 4 - r));
+		_mm_storeu_si128((__m128i *)z_i, BlitterRotateLanes(z, 4 - r));
+		i += phrases * 4, x += phrases * 4;
+	}
+
+	for(; i<n_pixels; i++, x++, offset+=2)
+		BlitterShadePixel<gourd, gourz>(mem, offset, offset + zDistance, x);
+
+	BlitterKernelAdvance();
+
+	return true;
+}
+
+
+static bool (* const blitterShadeKernels[3])(void) = {
+	BlitterShadeKernel<true, false>, BlitterShadeKernel<false, true>, BlitterShadeKernel<true, true>
+};
+
+
+//
+// Pick the shaded kernel, if there's one for this blit
+//
+static void BlitterSelectShadeKernel(uint32_t cmd)
+{
+	if (DSTA2 || SRCEN || SRCENX || SRCENZ || CLIPA1 || SRCSHADE || BCOMPEN || DCOMPEN || BKGWREN)
+		return;
+
+	if (((REG(A1_FLAGS) >> 3) & 0x07) != 4 || xadd_a1_control != XADDPHR || XSIGNSUB_A1 || YADD1_A1
+		|| xadd_a2_control == XADDINC)
+		return;
+
+	// Without GOURD, what gets written has to be the pattern; without GOURZ,
+	// there's no Z to compare or write
+	if ((!GOURD && (!PATDSEL || ADDDSEL)) || (!GOURZ && (Z_OP_INF || Z_OP_EQU || Z_OP_SUP || DSTWRZ)))
+		return;
+
+	blitterKernelZMode = (cmd >> 18) & 0x07;
+	blitterKernelZWrite = (DSTWRZ != 0);
+	blitterKernelZRead = (DSTEN && DSTENZ);
+
+	for(uint32_t i=0; i<4; i++)
+	{
+		int32_t pattern_x = i << 16;
+		blitterKernelPattern[i] = READ_RDATA_16(PATTERNDATA, pattern, 1);
+		blitterKernelDstZ[i] = (DSTEN || DSTENZ ? READ_RDATA_16(DSTZ, pattern, 1) : 0);
+	}
+
+	blitterRowKernel = blitterShadeKernels[(GOURD ? 1 : 0) + (GOURZ ? 2 : 0) - 1];
+}
+#endif
+
+//
+// Pick a row kernel for the blit blitter_blit() has just set up, if there's one
+// that does exactly what blitter_generic() would
+//
+static void BlitterSelectRowKernel(uint32_t cmd)
+{
+	uint32_t depth = (REG(A1_FLAGS) >> 3) & 0x07;
+	int kind;
+	blitterRowKernel = NULL;
+	blitterRowSplit = NULL;
+
+#ifdef BLITTER_SSE2
+	if (GOURD || GOURZ)
+	{
+		BlitterSelectShadeKernel(cmd);
+		return;
+	}
+#endif
+
+	// Straight data movement, A1 <- A2, with nothing to step but X
+	if (DSTA2 || SRCENZ || DSTENZ || DSTWRZ || CLIPA1 || GOURD || GOURZ || ADDDSEL
+		|| Z_OP_INF || Z_OP_EQU || Z_OP_SUP || BCOMPEN || SRCSHADE)
+		return;
+
+	if (depth < 3 || depth > 5 || a1_pitch != 0 || YADD1_A1
+		|| xadd_a1_control == XADDINC || xadd_a2_control == XADDINC)
+		return;
+
+	uint32_t lfu = (cmd >> 21) & 0x0F;
+
+	// Filling with the pattern, or with all zeroes or all ones (LFU_CLEAR &
+	// LFU_ONE don't care what the source & destination are)
+	if (PATDSEL || lfu == 0x00 || lfu == 0x0F)
+	{
+		if (SRCEN || SRCENX || DCOMPEN)
+			return;
+
+		kind = BLIT_KERNEL_FILL;
+
+		for(uint32_t i=0; i<8; i++)
+		{
+			int32_t pattern_x = i << 16;
+			blitterKernelPattern[i] = (PATDSEL ? READ_RDATA(PATTERNDATA, pattern, REG(A1_FLAGS), a1_phrase_mode)
+				: (lfu == 0x0F ? 0xFFFFFFFF : 0));
+		}
+	}
+	else
+	{
+		// LFU_REPLACE, from memory in the same depth, with no A2 mask
+		if (!(SRCEN || SRCENX) || lfu != 0x0C
+			|| ((REG(A2_FLAGS) >> 3) & 0x07) != depth || a2_pitch != 0 || a2_mask_x != -1)
+			return;
+
+		if (DCOMPEN && (CMPDST || BKGWREN))
+			return;
+
+		kind = (DCOMPEN ? BLIT_KERNEL_COPY_TRANSPARENT : BLIT_KERNEL_COPY);
+	}
+
+	blitterRowKernel = blitterRowKernels[depth - 3][kind];
+	blitterRowSplit = &blitterRowSplits[depth - 3][kind];
+}
+
+//
+// Move A1 & A2 on to where the next line starts
+//
+static void BlitterEndLine(uint32_t cmd, uint32_t a1_start, uint32_t a2_start)
+{
+//NOTE: The way to fix the CD BIOS is to uncomment below and comment the stuff after
+//      the phrase mode mucking around. But it fucks up everything else...
+//#define SCREWY_CD_DEPENDENT
+#ifdef SCREWY_CD_DEPENDENT
+	a1_x += a1_step_x;
+	a1_y += a1_step_y;
+	a2_x += a2_step_x;
+	a2_y += a2_step_y;//*/
+#endif
+
+	//New: Phrase mode taken into account! :-p
+/*	if (a1_phrase_mode)			// v1
+	{
+		// Bump the pointer to the next phrase boundary
+		// Even though it works, this is crappy... Clean it up!
+		uint32_t size = 64 / a1_psize;
+
+		// Crappy kludge... ('aligning' source to destination)
+		if (a2_phrase_mode && DSTA2)
+		{
+			uint32_t extra = (a2_start >> 16) % size;
+			a1_x += extra << 16;
+		}
+
+		uint32_t newx = (a1_x >> 16) / size;
+		uint32_t newxrem = (a1_x >> 16) % size;
+		a1_x &= 0x0000FFFF;
+		a1_x |= (((newx + (newxrem == 0 ? 0 : 1)) * size) & 0xFFFF) << 16;
+	}//*/
+	if (a1_phrase_mode)			// v2
+	{
+		// Bump the pointer to the next phrase boundary
+		// Even though it works, this is crappy... Clean it up!
+		uint32_t size = 64 / a1_psize;
+
+		// Crappy kludge... ('aligning' source to destination)
+		if (a2_phrase_mode && DSTA2)
+		{
+			uint32_t extra = (a2_start >> 16) % size;
+			a1_x += extra << 16;
+		}
+
+		uint32_t pixelSize = (size - 1) << 16;
+		a1_x = (a1_x + pixelSize) & ~pixelSize;
+	}
+
+/*	if (a2_phrase_mode)			// v1
+	{
+		// Bump the pointer to the next phrase boundary
+		// Even though it works, this is crappy... Clean it up!
+		uint32_t size = 64 / a2_psize;
+
+		// Crappy kludge... ('aligning' source to destination)
+		// Prolly should do this for A1 channel as well... [DONE]
+		if (a1_phrase_mode && !DSTA2)
+		{
+			uint32_t extra = (a1_start >> 16) % size;
+			a2_x += extra << 16;
+		}
+
+		uint32_t newx = (a2_x >> 16) / size;
+		uint32_t newxrem = (a2_x >> 16) % size;
+		a2_x &= 0x0000FFFF;
+		a2_x |= (((newx + (newxrem == 0 ? 0 : 1)) * size) & 0xFFFF) << 16;
+	}//*/
+	if (a2_phrase_mode)			// v1
+	{
+		// Bump the pointer to the next phrase boundary
+		// Even though it works, this is crappy... Clean it up!
+		uint32_t size = 64 / a2_psize;
+
+		// Crappy kludge... ('aligning' source to destination)
+		// Prolly should do this for A1 channel as well... [DONE]
+		if (a1_phrase_mode && !DSTA2)
+		{
+			uint32_t extra = (a1_start >> 16) % size;
+			a2_x += extra << 16;
+		}
+
+		uint32_t pixelSize = (size - 1) << 16;
+		a2_x = (a2_x + pixelSize) & ~pixelSize;
+	}
+
+	//Not entirely: This still mucks things up... !!! FIX !!!
+	//Should this go before or after the phrase mode mucking around?
+#ifndef SCREWY_CD_DEPENDENT
+	a1_x += a1_step_x;
+	a1_y += a1_step_y;
+	a2_x += a2_step_x;
+	a2_y += a2_step_y;//*/
+#endif
+}
+
+
+//
+// Row-parallel blits (vjs.parallelBlitter). Where a line starts only depends
+// on where the one before it started (see BlitterEndLine()), never on what it
+// read or wrote, so for a big blit with a kernel, the pointers can be walked
+// down every line first without doing any of them. If they're all in plain
+// memory & none of the lines it writes land on anything another line reads or
+// writes, the lines can be done in any order, so they're shared out between
+// the threads in the pool. A1 & A2 end up wherever the walk left them, which
+// is right where doing it a line at a time would have.
+//
+#define BLIT_PARALLEL_LINES		100			// Fewer lines than this aren't worth it
+#define BLIT_PARALLEL_CHUNK		8			// Lines a thread takes at a time
+#define BLIT_MAX_WORKERS		7
+#define BLIT_IDLE_SPINS			0x10000		// Before a thread with nothing to do starts sleeping
+
+struct BlitterSpan
+{
+	uintptr_t lo, hi;							// Host memory, inclusive
+	bool write;
+};
+
+static std::thread * blitterWorkers[BLIT_MAX_WORKERS];
+static int blitterNumWorkers = -1;				// -1 until the pool's been started
+static std::atomic<uint32_t> blitterPoolGeneration(0);	// Bumped for every blit handed out
+static std::atomic<uint32_t> blitterPoolNext(0), blitterPoolDone(0);
+static std::atomic<bool> blitterPoolQuit(false);
+static const BlitterRowJob * blitterPoolJobs;
+static uint32_t blitterPoolLines;
+static void (* blitterPoolRun)(BlitterRowJob job);
+
+
+//
+// Do lines from the current blit until there aren't any left
+//
+static void BlitterRunLines(void)
+{
+	uint32_t first;
+
+	while ((first = blitterPoolNext.fetch_add(BLIT_PARALLEL_CHUNK, std::memory_order_relaxed)) < blitterPoolLines)
+	{
+		uint32_t last = std::min(first + BLIT_PARALLEL_CHUNK, blitterPoolLines);
+
+		for(uint32_t i=first; i<last; i++)
+			blitterPoolRun(blitterPoolJobs[i]);
+	}
+}
+
+
+static void BlitterWorkerLoop(uint32_t generation)
+{
+	uint32_t idleSpins = 0;
+
+	while (!blitterPoolQuit.load(std::memory_order_acquire))
+	{
+		uint32_t current = blitterPoolGeneration.load(std::memory_order_acquire);
+
+		if (current == generation)
+		{
+			// Back off if nothing's come in for a while
+			if (++idleSpins > BLIT_IDLE_SPINS)
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			else
+				std::this_thread::yield();
+
+			continue;
+		}
+
+		generation = current;
+		idleSpins = 0;
+		BlitterRunLines();
+		blitterPoolDone.fetch_add(1, std::memory_order_release);
+	}
+}
+
+
+static void BlitterStopWorkers(void)
+{
+	if (blitterNumWorkers <= 0)
+		return;
+
+	blitterPoolQuit.store(true, std::memory_order_release);
+
+	for(int i=0; i<blitterNumWorkers; i++)
+	{
+		blitterWorkers[i]->join();
+		delete blitterWorkers[i];
+		blitterWorkers[i] = NULL;
+	}
+
+	blitterPoolQuit.store(false, std::memory_order_relaxed);
+	blitterNumWorkers = -1;
+}
+
+
+static bool ByLo(const BlitterSpan & a, const BlitterSpan & b)
+{
+	return a.lo < b.lo;
+}
+
+
+//
+// Whether any line writes where another one reads or writes. Main RAM & ROM
+// are kept a word at a time (see memory.h), so everything's rounded out to
+// whole words.
+//
+static bool BlitterLinesOverlap(std::vector<BlitterSpan> & spans)
+{
+	std::sort(spans.begin(), spans.end(), ByLo);
+	uintptr_t lastWrite = 0, lastRead = 0;		// One past the highest byte so far
+	bool anyWrite = false, anyRead = false;
+
+	for(size_t i=0; i<spans.size(); i++)
+	{
+		uintptr_t lo = spans[i].lo & ~(uintptr_t)0x01, hi = spans[i].hi | 0x01;
+
+		if ((anyWrite && lo < lastWrite) || (spans[i].write && anyRead && lo < lastRead))
+			return true;
+
+		if (spans[i].write)
+			lastWrite = std::max(lastWrite, hi + 1), anyWrite = true;
+		else
+			lastRead = std::max(lastRead, hi + 1), anyRead = true;
+	}
+
+	return false;
+}
+
 
-// 1 bpp r data read
-#define READ_RDATA_1(r,a,p)  ((p) ?  ((REG(r+(((uint32_t)a##_x >> 19) & 0x04))) >> (((uint32_t)a##_x >> 16) & 0x1F)) & 0x0001 : (REG(r) & 0x0001))
+static void BlitterAddSpan(std::vector<BlitterSpan> & spans, const BlitterRow & row, uint32_t size, bool write)
+{
+	uintptr_t first = (uintptr_t)(row.mem + row.offset);
+	uintptr_t last = first + ((intptr_t)row.step * (intptr_t)(n_pixels - 1));
+	BlitterSpan span = { std::min(first, last), std::max(first, last) + size - 1, write };
+	spans.push_back(span);
+}
 
-// 2 bpp r data read
-#define READ_RDATA_2(r,a,p)  ((p) ?  ((REG(r+(((uint32_t)a##_x >> 18) & 0x04))) >> (((uint32_t)a##_x >> 15) & 0x3E)) & 0x0003 : (REG(r) & 0x0003))
 
-// 4 bpp r data read
-#define READ_RDATA_4(r,a,p)  ((p) ?  ((REG(r+(((uint32_t)a##_x >> 17) & 0x04))) >> (((uint32_t)a##_x >> 14) & 0x28)) & 0x000F : (REG(r) & 0x000F))
+//
+// Do the whole blit a bunch of lines at a time, if we can; if not, A1 & A2 are
+// left alone & it's up to the caller to do it
+//
+static bool BlitterParallelRows(uint32_t cmd)
+{
+#ifdef JAGUAR_MULTI_INSTANCE
+	return false;								// The pool can't see our state
+#else
+	if (!vjs.parallelBlitter || !blitterRowSplit || outer_loop < BLIT_PARALLEL_LINES || n_pixels == 0)
+		return false;
 
-// 8 bpp r data read
-#define READ_RDATA_8(r,a,p)  ((p) ?  ((REG(r+(((uint32_t)a##_x >> 16) & 0x04))) >> (((uint32_t)a##_x >> 13) & 0x18)) & 0x00FF : (REG(r) & 0x00FF))
+	if (blitterNumWorkers < 0)
+	{
+		// Whoever's doing the blit does its share too
+		int threads = (int)std::thread::hardware_concurrency() - 1;
+		blitterNumWorkers = std::max(0, std::min(threads, BLIT_MAX_WORKERS));
 
-// 16 bpp r data read
-#define READ_RDATA_16(r,a,p)  ((p) ? ((REG(r+(((uint32_t)a##_x >> 15) & 0x04))) >> (((uint32_t)a##_x >> 12) & 0x10)) & 0xFFFF : (REG(r) & 0xFFFF))
+		for(int i=0; i<blitterNumWorkers; i++)
+			blitterWorkers[i] = new std::thread(BlitterWorkerLoop, blitterPoolGeneration.load());
+	}
 
-// 32 bpp r data read
-#define READ_RDATA_32(r,a,p)  ((p) ? REG(r+(((uint32_t)a##_x >> 14) & 0x04)) : REG(r))
+	if (blitterNumWorkers == 0)
+		return false;
 
-// register data read
-#define READ_RDATA(r,a,f,p) (\
-	 (((f>>3)&0x07) == 0) ? (READ_RDATA_1(r,a,p)) : \
-	 (((f>>3)&0x07) == 1) ? (READ_RDATA_2(r,a,p)) : \
-	 (((f>>3)&0x07) == 2) ? (READ_RDATA_4(r,a,p)) : \
-	 (((f>>3)&0x07) == 3) ? (READ_RDATA_8(r,a,p)) : \
-	 (((f>>3)&0x07) == 4) ? (READ_RDATA_16(r,a,p)) : \
-	 (((f>>3)&0x07) == 5) ? (READ_RDATA_32(r,a,p)) : 0)
+	static std::vector<BlitterRowJob> jobs;
+	static std::vector<BlitterSpan> spans;
+	int32_t a1x = a1_x, a1y = a1_y, a2x = a2_x, a2y = a2_y;
+	uint32_t size = 1 << (((REG(A1_FLAGS) >> 3) & 0x07) - 3);
+	bool copy = (cmd & 0x00000005);			// SRCEN or SRCENX
+	jobs.resize(outer_loop);
+	spans.clear();
 
-// 1 bpp pixel write
-#define WRITE_PIXEL_1(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_1(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_1(a), BLITTER)&(~(0x01 << PIXEL_SHIFT_1(a))))|(d<<PIXEL_SHIFT_1(a)), BLITTER); }
-//#define WRITE_PIXEL_1(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_1(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_1(a))&(~(0x01 << PIXEL_SHIFT_1(a))))|(d<<PIXEL_SHIFT_1(a))); }
+	for(uint32_t i=0; i<outer_loop; i++)
+	{
+		uint32_t a1_start = a1_x, a2_start = a2_x;
 
-// 2 bpp pixel write
-#define WRITE_PIXEL_2(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_2(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_2(a), BLITTER)&(~(0x03 << PIXEL_SHIFT_2(a))))|(d<<PIXEL_SHIFT_2(a)), BLITTER); }
-//#define WRITE_PIXEL_2(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_2(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_2(a))&(~(0x03 << PIXEL_SHIFT_2(a))))|(d<<PIXEL_SHIFT_2(a))); }
+		if (!blitterRowSplit->find(jobs[i]))
+		{
+			a1_x = a1x, a1_y = a1y, a2_x = a2x, a2_y = a2y;
+			return false;
+		}
 
-// 4 bpp pixel write
-#define WRITE_PIXEL_4(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_4(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_4(a), BLITTER)&(~(0x0f << PIXEL_SHIFT_4(a))))|(d<<PIXEL_SHIFT_4(a)), BLITTER); }
-//#define WRITE_PIXEL_4(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_4(a), (JaguarReadByte(a##_addr+PIXEL_OFFSET_4(a))&(~(0x0f << PIXEL_SHIFT_4(a))))|(d<<PIXEL_SHIFT_4(a))); }
+		BlitterAddSpan(spans, jobs[i].dst, size, true);
 
-// 8 bpp pixel write
-#define WRITE_PIXEL_8(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_8(a), d, BLITTER); }
-//#define WRITE_PIXEL_8(a,d)       { JaguarWriteByte(a##_addr+PIXEL_OFFSET_8(a), d); }
+		if (copy)
+			BlitterAddSpan(spans, jobs[i].src, size, false);
 
-// 16 bpp pixel write
-//#define WRITE_PIXEL_16(a,d)     {  JaguarWriteWord(a##_addr+(PIXEL_OFFSET_16(a)<<1),d); }
-#define WRITE_PIXEL_16(a,d)     {  JaguarWriteWord(a##_addr+(PIXEL_OFFSET_16(a)<<1), d, BLITTER); if (specialLog) WriteLog("Pixel write address: %08X\n", a##_addr+(PIXEL_OFFSET_16(a)<<1)); }
-//#define WRITE_PIXEL_16(a,d)     {  JaguarWriteWord(a##_addr+(PIXEL_OFFSET_16(a)<<1), d); if (specialLog) WriteLog("Pixel write address: %08X\n", a##_addr+(PIXEL_OFFSET_16(a)<<1)); }
+		BlitterKernelAdvance();
+		BlitterEndLine(cmd, a1_start, a2_start);
+	}
 
-// 32 bpp pixel write
-#define WRITE_PIXEL_32(a,d)		{ JaguarWriteLong(a##_addr+(PIXEL_OFFSET_32(a)<<2), d, BLITTER); }
-//#define WRITE_PIXEL_32(a,d)		{ JaguarWriteLong(a##_addr+(PIXEL_OFFSET_32(a)<<2), d); }
+	if (BlitterLinesOverlap(spans))
+	{
+		a1_x = a1x, a1_y = a1y, a2_x = a2x, a2_y = a2y;
+		return false;
+	}
 
-// pixel write
-#define WRITE_PIXEL(a,f,d) {\
-	switch ((f>>3)&0x07) { \
-	case 0: WRITE_PIXEL_1(a,d);  break;  \
-	case 1: WRITE_PIXEL_2(a,d);  break;  \
-	case 2: WRITE_PIXEL_4(a,d);  break;  \
-	case 3: WRITE_PIXEL_8(a,d);  break;  \
-	case 4: WRITE_PIXEL_16(a,d); break;  \
-	case 5: WRITE_PIXEL_32(a,d); break;  \
-	}}
+	blitterPoolJobs = &jobs[0];
+	blitterPoolLines = outer_loop;
+	blitterPoolRun = blitterRowSplit->run;
+	blitterPoolNext.store(0, std::memory_order_relaxed);
+	blitterPoolDone.store(0, std::memory_order_relaxed);
+	blitterPoolGeneration.fetch_add(1, std::memory_order_release);
 
-// Width in Pixels of a Scanline
-// This is a pretranslation of the value found in the A1 & A2 flags: It's really a floating point value
-// of the form EEEEMM where MM is the mantissa with an implied "1." in front of it and the EEEE value is
-// the exponent. Valid values for the exponent range from 0 to 11 (decimal). It's easiest to think of it
-// as a floating point bit pattern being followed by a number of zeroes. So, e.g., 001101 translates to
-// 1.01 (the "1." being implied) x (2 ^ 3) or 1010 -> 10 in base 10 (i.e., 1.01 with the decimal place
-// being shifted to the right 3 places).
-/*static uint32_t blitter_scanline_width[48] =
-{
-     0,    0,    0,    0,					// Note: This would really translate to 1, 1, 1, 1
-     2,    0,    0,    0,
-     4,    0,    6,    0,
-     8,   10,   12,   14,
-    16,   20,   24,   28,
-    32,   40,   48,   56,
-    64,   80,   96,  112,
-   128,  160,  192,  224,
-   256,  320,  384,  448,
-   512,  640,  768,  896,
-  1024, 1280, 1536, 1792,
-  2048, 2560, 3072, 3584
-};//*/
+	BlitterRunLines();
 
-//static uint8_t * tom_ram_8;
-//static uint8_t * paletteRam;
-static uint8_t src;
-static uint8_t dst;
-static uint8_t misc;
-static uint8_t a1ctl;
-static uint8_t mode;
-static uint8_t ity;
-static uint8_t zop;
-static uint8_t op;
-static uint8_t ctrl;
-static uint32_t a1_addr;
-static uint32_t a2_addr;
-static int32_t a1_zoffs;
-static int32_t a2_zoffs;
-static uint32_t xadd_a1_control;
-static uint32_t xadd_a2_control;
-static int32_t a1_pitch;
-static int32_t a2_pitch;
-static uint32_t n_pixels;
-static uint32_t n_lines;
-static int32_t a1_x;
-static int32_t a1_y;
-static int32_t a1_width;
-static int32_t a2_x;
-static int32_t a2_y;
-static int32_t a2_width;
-static int32_t a2_mask_x;
-static int32_t a2_mask_y;
-static int32_t a1_xadd;
-static int32_t a1_yadd;
-static int32_t a2_xadd;
-static int32_t a2_yadd;
-static uint8_t a1_phrase_mode;
-static uint8_t a2_phrase_mode;
-static int32_t a1_step_x = 0;
-static int32_t a1_step_y = 0;
-static int32_t a2_step_x = 0;
-static int32_t a2_step_y = 0;
-static uint32_t outer_loop;
-static uint32_t inner_loop;
-static uint32_t a2_psize;
-static uint32_t a1_psize;
-static uint32_t gouraud_add;
-//static uint32_t gouraud_data;
-//static uint16_t gint[4];
-//static uint16_t gfrac[4];
-//static uint8_t  gcolour[4];
-static int gd_i[4];
-static int gd_c[4];
-static int gd_ia, gd_ca;
-static int colour_index = 0;
-static int32_t zadd;
-static uint32_t z_i[4];
+	while (blitterPoolDone.load(std::memory_order_acquire) != (uint32_t)blitterNumWorkers)
+		std::this_thread::yield();
 
-static int32_t a1_clip_x, a1_clip_y;
+	return true;
+#endif
+}
 
-// In the spirit of "get it right first, *then* optimize" I've taken the liberty
-// of removing all the unnecessary code caching. If it turns out to be a good way
-// to optimize the blitter, then we may revisit it in the future...
 
 //
 // Generic blit handler
@@ -407,6 +1382,10 @@ if (specialLog)
 			a2_xadd = 0;
 	}//*/
 
+	// Big fills & copies can be done a bunch of lines at a time
+	if (BlitterParallelRows(cmd))
+		outer_loop = 0;
+
 	while (outer_loop--)
 	{
 if (specialLog)
@@ -425,6 +1404,11 @@ if (specialLog)
 		}
 
 		inner_loop = n_pixels;
+
+		// The common cases have their own kernels (see BlitterSelectRowKernel())
+		if (blitterRowKernel && blitterRowKernel())
+			inner_loop = 0;
+
 		while (inner_loop--)
 		{
 if (specialLog)
@@ -983,97 +1967,7 @@ Lesse, with pre-add we'd have:
   |rolls back to here. Hmm.
 
 */
-//NOTE: The way to fix the CD BIOS is to uncomment below and comment the stuff after
-//      the phrase mode mucking around. But it fucks up everything else...
-//#define SCREWY_CD_DEPENDENT
-#ifdef SCREWY_CD_DEPENDENT
-		a1_x += a1_step_x;
-		a1_y += a1_step_y;
-		a2_x += a2_step_x;
-		a2_y += a2_step_y;//*/
-#endif
-
-		//New: Phrase mode taken into account! :-p
-/*		if (a1_phrase_mode)			// v1
-		{
-			// Bump the pointer to the next phrase boundary
-			// Even though it works, this is crappy... Clean it up!
-			uint32_t size = 64 / a1_psize;
-
-			// Crappy kludge... ('aligning' source to destination)
-			if (a2_phrase_mode && DSTA2)
-			{
-				uint32_t extra = (a2_start >> 16) % size;
-				a1_x += extra << 16;
-			}
-
-			uint32_t newx = (a1_x >> 16) / size;
-			uint32_t newxrem = (a1_x >> 16) % size;
-			a1_x &= 0x0000FFFF;
-			a1_x |= (((newx + (newxrem == 0 ? 0 : 1)) * size) & 0xFFFF) << 16;
-		}//*/
-		if (a1_phrase_mode)			// v2
-		{
-			// Bump the pointer to the next phrase boundary
-			// Even though it works, this is crappy... Clean it up!
-			uint32_t size = 64 / a1_psize;
-
-			// Crappy kludge... ('aligning' source to destination)
-			if (a2_phrase_mode && DSTA2)
-			{
-				uint32_t extra = (a2_start >> 16) % size;
-				a1_x += extra << 16;
-			}
-
-			uint32_t pixelSize = (size - 1) << 16;
-			a1_x = (a1_x + pixelSize) & ~pixelSize;
-		}
-
-/*		if (a2_phrase_mode)			// v1
-		{
-			// Bump the pointer to the next phrase boundary
-			// Even though it works, this is crappy... Clean it up!
-			uint32_t size = 64 / a2_psize;
-
-			// Crappy kludge... ('aligning' source to destination)
-			// Prolly should do this for A1 channel as well... [DONE]
-			if (a1_phrase_mode && !DSTA2)
-			{
-				uint32_t extra = (a1_start >> 16) % size;
-				a2_x += extra << 16;
-			}
-
-			uint32_t newx = (a2_x >> 16) / size;
-			uint32_t newxrem = (a2_x >> 16) % size;
-			a2_x &= 0x0000FFFF;
-			a2_x |= (((newx + (newxrem == 0 ? 0 : 1)) * size) & 0xFFFF) << 16;
-		}//*/
-		if (a2_phrase_mode)			// v1
-		{
-			// Bump the pointer to the next phrase boundary
-			// Even though it works, this is crappy... Clean it up!
-			uint32_t size = 64 / a2_psize;
-
-			// Crappy kludge... ('aligning' source to destination)
-			// Prolly should do this for A1 channel as well... [DONE]
-			if (a1_phrase_mode && !DSTA2)
-			{
-				uint32_t extra = (a1_start >> 16) % size;
-				a2_x += extra << 16;
-			}
-
-			uint32_t pixelSize = (size - 1) << 16;
-			a2_x = (a2_x + pixelSize) & ~pixelSize;
-		}
-
-		//Not entirely: This still mucks things up... !!! FIX !!!
-		//Should this go before or after the phrase mode mucking around?
-#ifndef SCREWY_CD_DEPENDENT
-		a1_x += a1_step_x;
-		a1_y += a1_step_y;
-		a2_x += a2_step_x;
-		a2_y += a2_step_y;//*/
-#endif
+		BlitterEndLine(cmd, a1_start, a2_start);
 	}
 
 	// write values back to registers
@@ -1519,6 +2413,8 @@ if (blit_start_log)
 //	op_start_log = 1;
 }
 
+	BlitterSelectRowKernel(cmd);
+
 	blitter_working = 1;
 //#ifndef USE_GENERIC_BLITTER
 //	if (!blitter_execute_cached_code(blitter_in_cache(cmd)))
@@ -1547,6 +2443,229 @@ if (blit_start_log)
 *******************************************************************************/
 
 
+//
+// Asynchronous blits (vjs.asyncBlitter). The blit goes off to a thread of its
+// own & whoever started it carries on; since B_CMD always reads back as idle,
+// nobody on the Jaguar side can tell. To keep it that way, everything the blit
+// can write is fenced off from everybody else (and everything it can read,
+// from writes; see MMUFence()), and anyone who runs into a fence or touches the
+// blitter's registers waits for the blit to finish first. So nobody ever sees
+// a half done blit, and what comes out is the same as doing it right away.
+//
+enum { BLIT_IDLE, BLIT_GO, BLIT_DONE, BLIT_QUIT };
+
+static std::thread * blitterThread = NULL;
+static std::atomic<int> blitterState(BLIT_IDLE);
+
+
+static void BlitterThreadLoop(void)
+{
+	uint32_t idleSpins = 0;
+
+	while (true)
+	{
+		int state = blitterState.load(std::memory_order_acquire);
+
+		if (state == BLIT_QUIT)
+			return;
+
+		if (state != BLIT_GO)
+		{
+			// Back off if nothing's come in for a while (emulator paused, etc.)
+			if (++idleSpins > BLIT_IDLE_SPINS)
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			else
+				std::this_thread::yield();
+
+			continue;
+		}
+
+		idleSpins = 0;
+		BlitterExecute();
+		blitterState.store(BLIT_DONE, std::memory_order_release);
+	}
+}
+
+
+//
+// Wait for the blit on the blitter thread (if there is one) to finish
+//
+void BlitterSync(void)
+{
+	if (blitterState.load(std::memory_order_acquire) == BLIT_IDLE)
+		return;
+
+	while (blitterState.load(std::memory_order_acquire) != BLIT_DONE)
+		std::this_thread::yield();
+
+	MMUUnfence();
+	blitterState.store(BLIT_IDLE, std::memory_order_relaxed);
+}
+
+
+// Blits with anything outside of these command bits always run right away
+#define BLIT_ASYNC_CMD_MASK		0x1FE1DF49
+
+//
+// Whether A1 or A2 goes exactly the pixel count along every line: adding
+// pixels, or adding phrases from a phrase boundary a whole phrase at a time
+//
+static bool BlitterEvenLines(bool a2, uint32_t cmd)
+{
+	uint32_t flags = REG(a2 ? A2_FLAGS : A1_FLAGS), xadd = (flags >> 16) & 0x03;
+	uint32_t phrase = 64 >> std::min((flags >> 3) & 0x07, (uint32_t)5);
+	uint32_t x = GET16(blitter_ram, (a2 ? A2_PIXEL : A1_PIXEL) + 2);
+	uint32_t stepX = GET16(blitter_ram, (a2 ? A2_STEP : A1_STEP) + 2);
+	uint32_t pixels = GET16(blitter_ram, PIXLINECOUNTER + 2);
+
+	if (xadd == XADDPIX)
+		return true;
+
+	if (!(a2 ? UPDA2 : (UPDA1 || UPDA1F)))
+		stepX = 0;
+
+	// (On A1 the fraction could carry it off of the phrase boundary)
+	return xadd == XADDPHR && !(flags & 0x080000) && (a2 || !UPDA1F || !GET16(blitter_ram, A1_FSTEP + 2))
+		&& (x % phrase) == 0 && (pixels % phrase) == 0 && (stepX % phrase) == 0;
+}
+
+
+//
+// Where in main RAM A1 or A2 can go during the blit that's about to start.
+// This only has to be conservative, not exact, and it only knows about the
+// plain cases (adding pixels or phrases, nothing outside of main RAM); for
+// anything else it's false & the blit just runs right away.
+//
+static bool BlitterBounds(uint32_t & lo, uint32_t & hi, bool a2, uint32_t cmd)
+{
+	uint32_t flags = REG(a2 ? A2_FLAGS : A1_FLAGS);
+	uint32_t pixel = REG(a2 ? A2_PIXEL : A1_PIXEL), step = REG(a2 ? A2_STEP : A1_STEP);
+	uint32_t depth = (flags >> 3) & 0x07, xadd = (flags >> 16) & 0x03;
+	int64_t base = REG(a2 ? A2_BASE : A1_BASE) & 0xFFFFF8;
+	int64_t widthM = 0x04 | ((flags >> 9) & 0x03), widthE = (flags >> 11) & 0x0F;
+	int64_t lines = GET16(blitter_ram, PIXLINECOUNTER), pixels = GET16(blitter_ram, PIXLINECOUNTER + 2);
+
+	if (depth > 5 || lines == 0 || pixels == 0 || (xadd != XADDPHR && xadd != XADDPIX)
+		|| (a2 && (flags & 0x8000)))
+		return false;
+
+	// How far x & y go over a line. The inner loop goes a pixel at a time (a
+	// phrase at a time if the destination's adding phrases), and both sides
+	// take one add per go; if they're the same kind of add & everything lines
+	// up, that's exactly the pixel count. If not, it's anywhere out to a
+	// couple of phrases past however far the adds can take it. (Midsummer
+	// doesn't look at the sign when it's adding phrases, the other one does,
+	// and it can drag the source along with the destination's sign.)
+	uint32_t dstFlags = REG(DSTA2 ? A2_FLAGS : A1_FLAGS);
+	int64_t dstPhrase = 64 >> std::min((dstFlags >> 3) & 0x07, (uint32_t)5);
+	int64_t steps = (((dstFlags >> 16) & 0x03) == XADDPHR ? pixels / dstPhrase + 2 : pixels);
+	int64_t phrase = 64 >> depth, slack = 2 * std::max(phrase, dstPhrase);
+	int64_t reach = std::max(pixels, steps * (xadd == XADDPHR ? phrase : 1)) + slack;
+	int64_t xLo = 0, xHi = reach, yLo = 0, yHi = 0;
+	bool even = BlitterEvenLines(a2, cmd) && (a2 == (bool)DSTA2
+		|| (BlitterEvenLines(DSTA2, cmd) && ((dstFlags ^ flags) & 0x0B0038) == 0));
+
+	if (even)
+		xLo = xHi = ((flags & 0x080000) ? -pixels : pixels);
+	else if (a2 == (bool)DSTA2 && xadd == XADDPIX && (flags & 0x080000))
+		xLo = -reach, xHi = 0;
+	else if (a2 != (bool)DSTA2 || (flags & 0x080000))
+		xLo = -reach;
+
+	// (Y goes by A1's YADD1, whichever side it's on--see adda_yconst)
+	if ((REG(A1_FLAGS) | flags) & 0x040000)
+		yLo = -std::max(pixels, steps), yHi = std::max(pixels, steps);
+
+	// ...and from the start of one line to the start of the next, if it steps
+	// at all (on A1, the fractional parts can carry one more)
+	int64_t stepX = 0, stepY = 0, stepXLo = 0, stepXHi = 0, stepYLo = 0, stepYHi = 0;
+
+	if (a2 ? UPDA2 : (UPDA1 || UPDA1F))
+		stepX = (int16_t)(step & 0xFFFF), stepY = (int16_t)(step >> 16);
+
+	// (Midsummer takes the integer step along with the fraction on UPDA1F, the
+	// other one doesn't, so it could go either way)
+	if (!a2 && UPDA1F && !UPDA1)
+		stepXLo = std::min((int64_t)0, stepX), stepXHi = std::max((int64_t)0, stepX),
+		stepYLo = std::min((int64_t)0, stepY), stepYHi = std::max((int64_t)0, stepY);
+	else
+		stepXLo = stepXHi = stepX, stepYLo = stepYHi = stepY;
+
+	bool frac = !a2 && UPDA1F;
+	int64_t lineXLo = xLo + stepXLo - frac, lineXHi = xHi + stepXHi + frac;
+	int64_t lineYLo = yLo + stepYLo - frac, lineYHi = yHi + stepYHi + frac;
+
+	int64_t x = (int16_t)(pixel & 0xFFFF), y = (int16_t)(pixel >> 16);
+	int64_t xMin = x + std::min((int64_t)0, (lines - 1) * lineXLo) + std::min((int64_t)0, xLo);
+	int64_t xMax = x + std::max((int64_t)0, (lines - 1) * lineXHi) + std::max((int64_t)0, xHi);
+	int64_t yMin = y + std::min((int64_t)0, (lines - 1) * lineYLo) + std::min((int64_t)0, yLo);
+	int64_t yMax = y + std::max((int64_t)0, (lines - 1) * lineYHi) + std::max((int64_t)0, yHi);
+
+	if (xMin < 0 || xMax > 0x7FFF || yMin < 0 || yMax > 0x0FFF)
+		return false;
+
+	// Phrases are 1, 2, 4 or 3 phrases apart (by pitch); allow for reading a
+	// phrase ahead on either side. (Midsummer's ADDRGEN rounds the width down
+	// after multiplying by y, the other one before; either can happen.)
+	static const int64_t spacing[4] = { 1, 2, 4, 3 };
+	int64_t first = (((yMin * ((widthM << widthE) >> 2)) + xMin) << depth) >> 6;
+	int64_t last = (((((yMax * widthM) << widthE) >> 2) + xMax) << depth) >> 6;
+	int64_t start = base + (first - 1) * 8 * spacing[flags & 0x03];
+	int64_t end = base + (last + 2) * 8 * spacing[flags & 0x03] - 1;
+
+	if (start < 0 || end > 0x7FFFFF)
+		return false;
+
+	lo = (uint32_t)start, hi = (uint32_t)end;
+	return true;
+}
+
+
+//
+// Hand the blit off to the blitter thread, if we can; if not, it's up to the
+// caller to do it
+//
+static bool BlitterQueue(void)
+{
+#ifdef JAGUAR_MULTI_INSTANCE
+	return false;								// Blitter thread can't see our state
+#else
+	uint32_t cmd = GET32(blitter_ram, COMMAND);
+	bool srcRead = (cmd & 0x00000005);			// SRCEN or SRCENX
+	uint32_t dstLo, dstHi, srcLo, srcHi;
+
+	// Z sits a few phrases off from the pixels, so anything touching it (or
+	// anything else out of the ordinary) goes right away
+	if ((cmd & ~BLIT_ASYNC_CMD_MASK) || !BlitterBounds(dstLo, dstHi, DSTA2, cmd)
+		|| (srcRead && !BlitterBounds(srcLo, srcHi, !DSTA2, cmd)))
+		return false;
+
+	if (srcRead)
+		MMUFence(srcLo, srcHi, false, BlitterSync);
+
+	MMUFence(dstLo, dstHi, true, BlitterSync);
+
+	if (!blitterThread)
+		blitterThread = new std::thread(BlitterThreadLoop);
+
+	blitterState.store(BLIT_GO, std::memory_order_release);
+	return true;
+#endif
+}
+
+
+//
+// Do the blit in B_CMD with whichever blitter's switched on
+//
+static void BlitterExecute(void)
+{
+	if (vjs.useFastBlitter)
+		blitter_blit(GET32(blitter_ram, 0x38));
+	else
+		BlitterMidsummer2();
+}
+
+
 void BlitterInit(void)
 {
 	BlitterReset();
@@ -1555,18 +2674,96 @@ void BlitterInit(void)
 
 void BlitterReset(void)
 {
+	BlitterSync();
 	memset(blitter_ram, 0x00, 0xA0);
 }
 
 
 void BlitterDone(void)
 {
+	BlitterSync();
+
+	if (blitterThread)
+	{
+		blitterState.store(BLIT_QUIT, std::memory_order_release);
+		blitterThread->join();
+		delete blitterThread;
+		blitterThread = NULL;
+		blitterState.store(BLIT_IDLE, std::memory_order_relaxed);
+	}
+
+	BlitterStopWorkers();
+
+	if (blitterLockstepBlits)
+		WriteLog("BLIT: Blitters disagreed on memory in %u & registers in %u of %u lockstep blits\n",
+			blitterLockstepMemory, blitterLockstepRegisters, blitterLockstepBlits);
+
 	WriteLog("BLIT: Done.\n");
 }
 
 
+#ifdef USE_BOTH_BLITTERS
+//
+// Lockstep (see lockstep.h): do the blit with the blitter that isn't switched
+// on, rewind, then do it again with the one that is, & see if they agree on
+// what ended up in memory & in the registers
+//
+static void BlitterLockstep(void)
+{
+	uint8_t regsIn[0x100], regsOut[0x100];
+	uint32_t cmd = GET32(blitter_ram, COMMAND);
+	const char * name[2] = { "Midsummer", "original" };
+	memcpy(regsIn, blitter_ram, 0x100);
+
+	LockstepStart();
+
+	if (vjs.useFastBlitter)
+		BlitterMidsummer2();
+	else
+		blitter_blit(cmd);
+
+	memcpy(regsOut, blitter_ram, 0x100);
+	LockstepRewind();
+	memcpy(blitter_ram, regsIn, 0x100);
+
+	if (vjs.useFastBlitter)
+		blitter_blit(cmd);
+	else
+		BlitterMidsummer2();
+
+	uint32_t differences = LockstepFinish();
+	bool regsDiffer = (memcmp(regsOut, blitter_ram, 0xA0) != 0);
+	blitterLockstepBlits++;
+
+	// Only the first one of each is worth the log space (the rest are likely
+	// the same thing again). The registers on their own are worth knowing
+	// about, but shouldn't hide it when memory comes out wrong.
+	bool first = (differences && blitterLockstepMemory++ == 0);
+	first = (regsDiffer && blitterLockstepRegisters++ == 0) || first;
+
+	if (first)
+	{
+		WriteLog("BLIT: %s & %s blitters disagree on blit #%u\n", name[!vjs.useFastBlitter],
+			name[vjs.useFastBlitter], blitterLockstepBlits);
+		LockstepLogDifferences(name[!vjs.useFastBlitter], name[vjs.useFastBlitter]);
+
+		for(uint32_t i=0; i<0xA0; i++)
+			if (regsOut[i] != blitter_ram[i])
+				WriteLog("    F022%02X: %02X vs. %02X (was %02X)\n", i, regsOut[i], blitter_ram[i], regsIn[i]);
+
+		WriteLog("    Going in:\n");
+		memcpy(regsOut, blitter_ram, 0x100);
+		memcpy(blitter_ram, regsIn, 0x100);
+		LogBlit();
+		memcpy(blitter_ram, regsOut, 0x100);
+	}
+}
+#endif
+
+
 uint8_t BlitterReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
+	BlitterSync();
 	offset &= 0xFF;
 
 	// status register
@@ -1614,6 +2811,7 @@ void BlitterWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 {
 /*if (offset & 0xFF == 0x7B)
 	WriteLog("--> Wrote to B_STOP: value -> %02X\n", data);*/
+	BlitterSync();
 	offset &= 0xFF;
 /*if ((offset >= PATTERNDATA) && (offset < PATTERNDATA + 8))
 {
@@ -1744,10 +2942,10 @@ if (blit_start_log)
 #endif
 #else
 	{
-		if (vjs.useFastBlitter)
-			blitter_blit(GET32(blitter_ram, 0x38));
-		else
-			BlitterMidsummer2();
+		if (vjs.lockstepBlitter)
+			BlitterLockstep();
+		else if (!vjs.asyncBlitter || !BlitterQueue())
+			BlitterExecute();
 	}
 #endif
 }
@@ -2122,8 +3320,7 @@ sread:							// Source data read
 
 	if ((DSTA2 ? a1_phrase_mode : a2_phrase_mode) == 1)
 	{
-		srcData = ((uint64_t)JaguarReadLong(srcAddr, BLITTER) << 32)
-			| (uint64_t)JaguarReadLong(srcAddr + 4, BLITTER);
+		srcData = JaguarReadPhrase(srcAddr, BLITTER);
 	}
 	else
 	{
@@ -2203,8 +3400,7 @@ if STEP
 
 	if ((DSTA2 ? a2_phrase_mode : a1_phrase_mode) == 1)
 	{
-		dstData = ((uint64_t)JaguarReadLong(srcAddr, BLITTER) << 32)
-			| (uint64_t)JaguarReadLong(srcAddr + 4, BLITTER);
+		dstData = JaguarReadPhrase(srcAddr, BLITTER);
 	}
 	else
 	{
@@ -2367,8 +3563,7 @@ Blit!
 
 	if ((DSTA2 ? a2_phrase_mode : a1_phrase_mode) == 1)
 	{
-		JaguarWriteLong(dstAddr, writeData >> 32, BLITTER);
-		JaguarWriteLong(dstAddr + 4, writeData & 0xFFFFFFFF, BLITTER);
+		JaguarWritePhrase(dstAddr, writeData, BLITTER);
 	}
 	else
 	{
@@ -2698,6 +3893,7 @@ void ADDBMUX(int16_t &addb_x, int16_t &addb_y, uint8_t addbsel, int16_t a1_x, in
 void DATAMUX(int16_t &data_x, int16_t &data_y, uint32_t gpu_din, int16_t addq_x, int16_t addq_y, bool addqsel);
 void ADDRADD(int16_t &addq_x, int16_t &addq_y, bool a1fracldi,
 	uint16_t adda_x, uint16_t adda_y, uint16_t addb_x, uint16_t addb_y, uint8_t modx, bool suba_x, bool suba_y);
+template <bool logBlit>
 void DATA(uint64_t &wdata, uint8_t &dcomp, uint8_t &zcomp, bool &nowrite,
 	bool big_pix, bool cmpdst, uint8_t daddasel, uint8_t daddbsel, uint8_t daddmode, bool daddq_sel, uint8_t data_sel,
 	uint8_t dbinh, uint8_t dend, uint8_t dstart, uint64_t dstd, uint32_t iinc, uint8_t lfu_func, uint64_t &patd, bool patdadd,
@@ -2709,6 +3905,13 @@ void COMP_CTRL(uint8_t &dbinh, bool &nowrite,
 	uint8_t pixsize, bool phrase_mode, uint8_t srcd, uint8_t zcomp);
 #define VERBOSE_BLITTER_LOGGING
 
+// Command bits that a plan bakes in: everything but CLIP_A1 & the UPDA* bits
+// (which only matter once per line, if that) & BUSHI (which we don't do)
+#define MIDSUMMER_PLAN_MASK		0x5FFFF83F
+#define MIDSUMMER_PLAN_NONE		0xFFFFFFFF
+
+template <bool logBlit, uint32_t planCmd> static void BlitterMidsummer2Blit(uint32_t cmd);
+
 void BlitterMidsummer2(void)
 {
 #ifdef LOG_BLITS
@@ -2823,6 +4026,65 @@ if (cmd == 0x00011040
 	&& (GET16(blitter_ram, PIXLINECOUNTER + 2) == 18))
 	logBlit = true;*/
 
+	// Everything from here on checks logBlit all over the place, so there's one
+	// of it with the logging & one without. The one without also comes in a few
+	// flavors with the command baked in (see below), for the blits that
+	// everybody does all the time.
+	if (logBlit)
+	{
+		BlitterMidsummer2Blit<true, MIDSUMMER_PLAN_NONE>(cmd);
+		return;
+	}
+
+	switch (cmd & MIDSUMMER_PLAN_MASK)
+	{
+	case 0x00010000:	// PATDSEL (clearing the screen & such)
+		BlitterMidsummer2Blit<false, 0x00010000>(cmd);
+		break;
+	case 0x00011000:	// GOURD PATDSEL
+		BlitterMidsummer2Blit<false, 0x00011000>(cmd);
+		break;
+	case 0x00011008:	// DSTEN GOURD PATDSEL
+		BlitterMidsummer2Blit<false, 0x00011008>(cmd);
+		break;
+	case 0x01800001:	// SRCEN LFUFUNC=C
+		BlitterMidsummer2Blit<false, 0x01800001>(cmd);
+		break;
+	case 0x01800005:	// SRCEN SRCENX LFUFUNC=C
+		BlitterMidsummer2Blit<false, 0x01800005>(cmd);
+		break;
+	case 0x01800801:	// SRCEN DSTA2 LFUFUNC=C
+		BlitterMidsummer2Blit<false, 0x01800801>(cmd);
+		break;
+	case 0x09800001:	// SRCEN LFUFUNC=C DCOMPEN
+		BlitterMidsummer2Blit<false, 0x09800001>(cmd);
+		break;
+	case 0x09800009:	// SRCEN DSTEN LFUFUNC=C DCOMPEN
+		BlitterMidsummer2Blit<false, 0x09800009>(cmd);
+		break;
+	case 0x05810001:	// SRCEN PATDSEL BCOMPEN
+		BlitterMidsummer2Blit<false, 0x05810001>(cmd);
+		break;
+	case 0x01902839:	// SRCEN DSTEN DSTENZ DSTWRZ DSTA2 GOURZ ZMODE=4 LFUFUNC=C
+		BlitterMidsummer2Blit<false, 0x01902839>(cmd);
+		break;
+	default:
+		BlitterMidsummer2Blit<false, MIDSUMMER_PLAN_NONE>(cmd);
+	}
+}
+
+
+template <bool logBlit, uint32_t planCmd>
+static void BlitterMidsummer2Blit(uint32_t cmd)
+{
+	// If we've got a plan, everything under MIDSUMMER_PLAN_MASK comes from it
+	// instead of from the command register; since that's a constant, every line
+	// below that's derived from it (and everything that only depends on those)
+	// gets folded away by the compiler, leaving just the parts of the state
+	// machine that this particular blit can actually get to.
+	if (planCmd != MIDSUMMER_PLAN_NONE)
+		cmd = (cmd & ~MIDSUMMER_PLAN_MASK) | planCmd;
+
 	// Line states passed in via the command register
 
 	bool srcen = (SRCEN), srcenx = (SRCENX), srcenz = (SRCENZ),
@@ -3804,8 +5066,7 @@ if (logBlit)
 //	a1_x, a1_y, a1_base, a1_pitch, a1_pixsize, a1_width, a1_zoffset,
 //	a2_x, a2_y, a2_base, a2_pitch, a2_pixsize, a2_width, a2_zoffset);
 					srcd2 = srcd1;
-					srcd1 = ((uint64_t)JaguarReadLong(address + 0, BLITTER) << 32)
-						| (uint64_t)JaguarReadLong(address + 4, BLITTER);
+					srcd1 = JaguarReadPhrase(address, BLITTER);
 //Kludge to take pixel size into account...
 //Hmm. If we're not in phrase mode, this is most likely NOT going to be used...
 //Actually, it would be--because of BCOMPEN expansion, for example...
@@ -3837,7 +5098,7 @@ if (logBlit)
 	WriteLog("  Entering SZREADX state...");
 #endif
 					srcz2 = srcz1;
-					srcz1 = ((uint64_t)JaguarReadLong(address, BLITTER) << 32) | (uint64_t)JaguarReadLong(address + 4, BLITTER);
+					srcz1 = JaguarReadPhrase(address, BLITTER);
 #ifdef VERBOSE_BLITTER_LOGGING
 if (logBlit)
 	WriteLog(" Src Z extra read address/pix address: %08X/%1X [%08X%08X]\n", address, pixAddr,
@@ -3856,7 +5117,7 @@ if (logBlit)
 //	a1_x, a1_y, a1_base, a1_pitch, a1_pixsize, a1_width, a1_zoffset,
 //	a2_x, a2_y, a2_base, a2_pitch, a2_pixsize, a2_width, a2_zoffset);
 srcd2 = srcd1;
-srcd1 = ((uint64_t)JaguarReadLong(address, BLITTER) << 32) | (uint64_t)JaguarReadLong(address + 4, BLITTER);
+srcd1 = JaguarReadPhrase(address, BLITTER);
 //Kludge to take pixel size into account...
 if (!phrase_mode)
 {
@@ -3892,7 +5153,7 @@ WriteLog("  Entering SZREAD state...");
 }
 #endif
 					srcz2 = srcz1;
-					srcz1 = ((uint64_t)JaguarReadLong(address, BLITTER) << 32) | (uint64_t)JaguarReadLong(address + 4, BLITTER);
+					srcz1 = JaguarReadPhrase(address, BLITTER);
 //Kludge to take pixel size into account... I believe that it only has to take 16BPP mode into account. Not sure tho.
 if (!phrase_mode && pixsize == 4)
 	srcz1 >>= 48;
@@ -3916,7 +5177,7 @@ if (logBlit)
 //ADDRGEN(dstAddr, pixAddr, gena2i, zaddr,
 //	a1_x, a1_y, a1_base, a1_pitch, a1_pixsize, a1_width, a1_zoffset,
 //	a2_x, a2_y, a2_base, a2_pitch, a2_pixsize, a2_width, a2_zoffset);
-dstd = ((uint64_t)JaguarReadLong(address, BLITTER) << 32) | (uint64_t)JaguarReadLong(address + 4, BLITTER);
+dstd = JaguarReadPhrase(address, BLITTER);
 //Kludge to take pixel size into account...
 if (!phrase_mode)
 {
@@ -3941,7 +5202,7 @@ if (logBlit)
 if (logBlit)
 	WriteLog("  Entering DZREAD state...");
 #endif
-					dstz = ((uint64_t)JaguarReadLong(address, BLITTER) << 32) | (uint64_t)JaguarReadLong(address + 4, BLITTER);
+					dstz = JaguarReadPhrase(address, BLITTER);
 //Kludge to take pixel size into account... I believe that it only has to take 16BPP mode into account. Not sure tho.
 if (!phrase_mode && pixsize == 4)
 	dstz >>= 48;
@@ -4084,7 +5345,7 @@ if (logBlit)
 //More testing... This is almost certainly wrong, but how else does this work???
 //Seems to kinda work... But still, this doesn't seem to make any sense!
 if (phrase_mode && !dsten)
-	dstd = ((uint64_t)JaguarReadLong(address, BLITTER) << 32) | (uint64_t)JaguarReadLong(address + 4, BLITTER);
+	dstd = JaguarReadPhrase(address, BLITTER);
 
 //Testing only... for now...
 //This is wrong because the write data is a combination of srcd and dstd--either run
@@ -4185,7 +5446,7 @@ if (patfadd)
 
 uint64_t wdata;
 uint8_t dcomp, zcomp;
-DATA(wdata, dcomp, zcomp, winhibit,
+DATA<logBlit>(wdata, dcomp, zcomp, winhibit,
 	true, cmpdst, daddasel, daddbsel, daddmode, daddq_sel, data_sel, 0/*dbinh*/,
 	dend, dstart, dstd, iinc, lfufunc, patd, patdadd,
 	phrase_mode, srcd, false/*srcdread*/, false/*srczread*/, srcz2add, zmode,
@@ -4280,8 +5541,7 @@ if (!winhibit)
 {
 	if (phrase_mode)
 	{
-		JaguarWriteLong(address + 0, wdata >> 32, BLITTER);
-		JaguarWriteLong(address + 4, wdata & 0xFFFFFFFF, BLITTER);
+		JaguarWritePhrase(address, wdata, BLITTER);
 	}
 	else
 	{
@@ -4331,8 +5591,7 @@ if (!winhibit)
 {
 	if (phrase_mode)
 	{
-		JaguarWriteLong(address + 0, srcz >> 32, BLITTER);
-		JaguarWriteLong(address + 4, srcz & 0xFFFFFFFF, BLITTER);
+		JaguarWritePhrase(address, srcz, BLITTER);
 	}
 	else
 	{
@@ -5037,7 +6296,7 @@ void ADDARRAY(uint16_t * addq, uint8_t daddasel, uint8_t daddbsel, uint8_t daddm
 
 	uint8_t cinsel = (daddmode >= 1 && daddmode <= 4 ? 1 : 0);
 
-static uint8_t co[4];//These are preserved between calls...
+static PER_MACHINE uint8_t co[4];//These are preserved between calls...
 	uint8_t cin[4];
 
 	for(int i=0; i<4; i++)
@@ -5366,7 +6625,7 @@ Ci_y		:= EO (ci_y, cyt[1], suba_y);*/
 
 ////////////////////////////////////// C++ CODE //////////////////////////////////////
 //I'm sure the following will generate a bunch of warnings, but will have to do for now.
-	static uint16_t co_x = 0, co_y = 0;	// Carry out has to propogate between function calls...
+	static PER_MACHINE uint16_t co_x = 0, co_y = 0;	// Carry out has to propogate between function calls...
 	uint16_t ci_x = co_x ^ (suba_x ? 1 : 0);
 	uint16_t ci_y = co_y ^ (suba_y ? 1 : 0);
 	uint32_t addqt_x = adda_x + addb_x + ci_x;
@@ -5464,6 +6723,7 @@ INT32/	gpu_din			// GPU data bus
 		:IN);
 */
 
+template <bool logBlit>
 void DATA(uint64_t &wdata, uint8_t &dcomp, uint8_t &zcomp, bool &nowrite,
 	bool big_pix, bool cmpdst, uint8_t daddasel, uint8_t daddbsel, uint8_t daddmode, bool daddq_sel, uint8_t data_sel,
 	uint8_t dbinh, uint8_t dend, uint8_t dstart, uint64_t dstd, uint32_t iinc, uint8_t lfu_func, uint64_t &patd, bool patdadd,
@@ -11,6 +11,7 @@
 void BlitterInit(void);
 void BlitterReset(void);
 void BlitterDone(void);
+void BlitterSync(void);
 
 uint8_t BlitterReadByte(uint32_t, uint32_t who = UNKNOWN);
 uint16_t BlitterReadWord(uint32_t, uint32_t who = UNKNOWN);
@@ -22,7 +23,7 @@ void BlitterWriteLong(uint32_t, uint32_t, uint32_t who = UNKNOWN);
 uint32_t blitter_reg_read(uint32_t offset);
 void blitter_reg_write(uint32_t offset, uint32_t data);
 
-extern uint8_t blitter_working;
+extern PER_MACHINE uint8_t blitter_working;
 
 //For testing only...
 void LogBlit(void);
@@ -178,12 +178,12 @@ const char * BReg[12] = { "BUTCH", "DSCNTRL", "DS_DATA", "???", "I2CNTRL",
 //extern const char * whoName[9];
 
 
-static uint8_t cdRam[0x100];
-static uint16_t cdCmd = 0, cdPtr = 0;
-static bool haveCDGoodness;
-static uint32_t min, sec, frm, block;
-static uint8_t cdBuf[2352 + 96];
-static uint32_t cdBufPtr = 2352;
+static PER_MACHINE uint8_t cdRam[0x100];
+static PER_MACHINE uint16_t cdCmd = 0, cdPtr = 0;
+static PER_MACHINE bool haveCDGoodness;
+static PER_MACHINE uint32_t min, sec, frm, block;
+static PER_MACHINE uint8_t cdBuf[2352 + 96];
+static PER_MACHINE uint32_t cdBufPtr = 2352;
 //Also need to set up (save/restore) the CD's NVRAM
 
 
@@ -304,7 +304,7 @@ uint8_t CDROMReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 	return cdRam[offset & 0xFF];
 }
 
-static uint8_t trackNum = 1, minTrack, maxTrack;
+static PER_MACHINE uint8_t trackNum = 1, minTrack, maxTrack;
 //static uint8_t minutes[16] = {  0,  0,  2,  5,  7, 10, 12, 15, 17, 20, 22, 25, 27, 30, 32, 35 };
 //static uint8_t seconds[16] = {  0,  0, 30,  0, 30,  0, 30,  0, 30,  0, 30,  0, 30,  0, 30,  0 };
 //static uint8_t frames[16]  = {  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0 };
@@ -685,12 +685,12 @@ void CDROMWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 //
 
 enum ButchState { ST_INIT, ST_RISING, ST_FALLING };
-static ButchState currentState = ST_INIT;
-static uint16_t counter = 0;
-static bool cmdTx = false;
-static uint16_t busCmd;
-static uint16_t rxData, txData;
-static uint16_t rxDataBit;
+static PER_MACHINE ButchState currentState = ST_INIT;
+static PER_MACHINE uint16_t counter = 0;
+static PER_MACHINE bool cmdTx = false;
+static PER_MACHINE uint16_t busCmd;
+static PER_MACHINE uint16_t rxData, txData;
+static PER_MACHINE uint16_t rxDataBit;
 static bool firstTime = false;
 
 static void CDROMBusWrite(uint16_t data)
@@ -808,7 +808,7 @@ static uint16_t CDROMBusRead(void)
 // This simulates a read from BUTCH over the SSI to JERRY. Uses real reading!
 //
 //temp, until I can fix my CD image... Argh!
-static uint8_t cdBuf2[2532 + 96], cdBuf3[2532 + 96];
+static PER_MACHINE uint8_t cdBuf2[2532 + 96], cdBuf3[2532 + 96];
 uint16_t GetWordFromButchSSI(uint32_t offset, uint32_t who/*= UNKNOWN*/)
 {
 	bool go = ((offset & 0x0F) == 0x0A || (offset & 0x0F) == 0x0E ? true : false);
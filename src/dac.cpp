@@ -12,6 +12,8 @@
 // ---  ----------  -------------------------------------------------------------
 // JLH  01/16/2010  Created this log ;-)
 // JLH  04/30/2012  Changed SDL audio handler to run JERRY
+//                  (since moved back: the DSP runs in JaguarExecuteNew() and
+//                  the SDL audio handler only drains a sample ring)
 //
 
 // Need to set up defaults that the BIOS sets for the SSI here in DACInit()... !!! FIX !!!
@@ -25,13 +27,16 @@
 // interrupt is not enabled/running on the DSP, then there is no audio. Also,
 // audio can be muted by clearing bit 8 of JOYSTICK (JOY1).
 //
-// Approach: We can run the DSP in the host system's audio IRQ, by running the
-// DSP for the alloted time (depending on the host buffer size & sample rate)
-// by simply reading the L/R_I2S (L/RTXD) registers at regular intervals. We
-// would also have to time the I2S/TIMER0/TIMER1 interrupts in the DSP as well.
-// This way, we can run the host audio IRQ at, say, 48 KHz and not have to care
-// so much about SCLK and running a separate buffer and all the attendant
-// garbage that comes with that awful approach.
+// Approach: The DSP runs on the emulation timeline, right alongside the 68K and
+// the GPU. A 48 KHz sample clock on that same timeline reads the L/R_I2S
+// (L/RTXD) registers at regular intervals and pushes the samples into a
+// lock-free single producer/single consumer ring. The host audio IRQ does
+// nothing but drain that ring. This way DSP timing doesn't depend on the host
+// buffer size, nothing on the audio thread touches JERRY, and we don't have to
+// care so much about SCLK.
+//
+// (We used to run the DSP in the host audio IRQ itself, which made it race
+// the 68K & GPU for JERRY and stall whenever the emulation fell behind.)
 //
 // There would still be potential gotchas, as the SCLK can theoretically drive
 // the I2S at 26590906 / 2 (for SCLK == 0) = 13.3 MHz which corresponds to an
@@ -42,6 +47,7 @@
 
 #include "dac.h"
 
+#include <atomic>
 #include "SDL.h"
 #include "cdrom.h"
 #include "dsp.h"
@@ -58,6 +64,8 @@
 
 #define BUFFER_SIZE			0x10000				// Make the DAC buffers 64K x 16 bits
 #define DAC_AUDIO_RATE		48000				// Set the audio rate to 48 KHz
+#define SAMPLE_RING_SIZE	0x2000				// L/R sample pairs, must be a power of 2
+#define SAMPLE_RING_MASK	(SAMPLE_RING_SIZE - 1)
 
 // Jaguar memory locations
 
@@ -76,7 +84,17 @@
 // Local variables
 
 static SDL_AudioSpec desired;
-static bool SDLSoundInitialized;
+static PER_MACHINE bool SDLSoundInitialized;
+static PER_MACHINE uint32_t sampleTickFraction = 0;	// Leftover RISC ticks * DAC_AUDIO_RATE
+
+// Sample ring: written only by the emulation thread (head), read only by the
+// SDL audio thread (tail). There's only one host audio device, so it belongs to
+// whichever machine got to open it (see machine.h).
+static uint16_t sampleRing[SAMPLE_RING_SIZE * 2];
+static std::atomic<uint32_t> sampleRingHead(0);
+static std::atomic<uint32_t> sampleRingTail(0);
+static uint32_t sampleRingHighWater;			// Max. pairs queued (bounds latency)
+static uint16_t lastLeft, lastRight;			// Replayed on underrun
 //static uint8_t SCLKFrequencyDivider = 19;			// Default is roughly 22 KHz (20774 Hz in NTSC mode)
 // /*static*/ uint16_t serialMode = 0;
 
@@ -86,6 +104,21 @@ void SDLSoundCallback(void * userdata, Uint8 * buffer, int length);
 void DSPSampleCallback(void);
 
 
+//
+// The RISC clock doesn't divide evenly by the host sample rate, so we carry the
+// remainder from sample to sample (Bresenham style); that way the sample clock
+// never drifts against the master clock.
+//
+static inline uint32_t TicksToNextSample(void)
+{
+	sampleTickFraction += masterClockRate;
+	uint32_t ticks = sampleTickFraction / DAC_AUDIO_RATE;
+	sampleTickFraction %= DAC_AUDIO_RATE;
+
+	return ticks;
+}
+
+
 //
 // Initialize the SDL sound system
 //
@@ -111,6 +144,8 @@ void DACInit(void)
 	else
 	{
 		SDLSoundInitialized = true;
+		// Keep two host buffers' worth queued at most; any more is just latency
+		sampleRingHighWater = desired.samples * 2;
 		DACReset();
 		SDL_PauseAudio(false);					// Start playback!
 		WriteLog("DAC: Successfully initialized. Sample rate: %u\n", desired.freq);
@@ -132,6 +167,13 @@ void DACReset(void)
 {
 //	LeftFIFOHeadPtr = LeftFIFOTailPtr = 0, RightFIFOHeadPtr = RightFIFOTailPtr = 1;
 	ltxd = lrxd = desired.silence;
+	sampleTickFraction = 0;
+
+	// The sample clock only runs when there's someone to hear it
+	RemoveCallback(DSPSampleCallback);
+
+	if (SDLSoundInitialized)
+		SetCallbackTicks(DSPSampleCallback, TicksToNextSample());
 }
 
 
@@ -159,90 +201,61 @@ void DACDone(void)
 }
 
 
-// Approach: Run the DSP for however many cycles needed to correspond to whatever sample rate
-// we've set the audio to run at. So, e.g., if we run it at 48 KHz, then we would run the DSP
-// for however much time it takes to fill the buffer. So with a 2K buffer, this would correspond
-// to running the DSP for 0.042666... seconds. At 26590906 Hz, this would correspond to
-// running the DSP for 1134545 cycles. You would then sample the L/RTXD registers every
-// 1134545 / 2048 = 554 cycles to fill the buffer. You would also have to manage interrupt
-// timing as well (generating them at the proper times), but that shouldn't be too difficult...
-// If the DSP isn't running, then fill the buffer with L/RTXD and exit.
-
 //
 // SDL callback routine to fill audio buffer
 //
 // Note: The samples are packed in the buffer in 16 bit left/16 bit right pairs.
 //       Also, length is the length of the buffer in BYTES
 //
-static Uint8 * sampleBuffer;
-static int bufferIndex = 0;
-static int numberOfSamples = 0;
-static bool bufferDone = false;
+// This runs on SDL's audio thread, so all it does is drain the sample ring. If
+// the emulation has fallen behind, we hold the last sample instead of clicking.
+//
 void SDLSoundCallback(void * userdata, Uint8 * buffer, int length)
 {
-	// 1st, check to see if the DSP is running. If not, fill the buffer with L/RXTD and exit.
-
-	if (!DSPIsRunning())
+	uint16_t * out = (uint16_t *)buffer;
+	uint32_t pairs = length / 4;
+	uint32_t tail = sampleRingTail.load(std::memory_order_relaxed);
+	uint32_t head = sampleRingHead.load(std::memory_order_acquire);
+	uint32_t available = head - tail;
+	uint32_t count = (available < pairs ? available : pairs);
+
+	for(uint32_t i=0; i<count; i++, tail++)
 	{
-		for(int i=0; i<(length/2); i+=2)
-		{
-			((uint16_t *)buffer)[i + 0] = ltxd;
-			((uint16_t *)buffer)[i + 1] = rtxd;
-		}
-
-		return;
+		*out++ = sampleRing[((tail & SAMPLE_RING_MASK) * 2) + 0];
+		*out++ = sampleRing[((tail & SAMPLE_RING_MASK) * 2) + 1];
 	}
 
-	// The length of time we're dealing with here is 1/48000 s, so we multiply this
-	// by the number of cycles per second to get the number of cycles for one sample.
-//	uint32_t riscClockRate = (vjs.hardwareTypeNTSC ? RISC_CLOCK_RATE_NTSC : RISC_CLOCK_RATE_PAL);
-//	uint32_t cyclesPerSample = riscClockRate / DAC_AUDIO_RATE;
-	// This is the length of time
-//	timePerSample = (1000000.0 / (double)riscClockRate) * ();
-
-	// Now, run the DSP for that length of time for each sample we need to make
-
-	bufferIndex = 0;
-	sampleBuffer = buffer;
-// If length is the length of the sample buffer in BYTES, then shouldn't the # of
-// samples be / 4? No, because we bump the sample count by 2, so this is OK.
-	numberOfSamples = length / 2;
-	bufferDone = false;
+	sampleRingTail.store(tail, std::memory_order_release);
 
-	SetCallbackTime(DSPSampleCallback, 1000000.0 / (double)DAC_AUDIO_RATE, EVENT_JERRY);
+	if (count > 0)
+		lastLeft = out[-2], lastRight = out[-1];
 
-	// These timings are tied to NTSC, need to fix that in event.cpp/h! [FIXED]
-	do
+	for(uint32_t i=count; i<pairs; i++)
 	{
-		double timeToNextEvent = GetTimeToNextEvent(EVENT_JERRY);
-
-		if (vjs.DSPEnabled)
-		{
-			if (vjs.usePipelinedDSP)
-				DSPExecP2(USEC_TO_RISC_CYCLES(timeToNextEvent));
-			else
-				DSPExec(USEC_TO_RISC_CYCLES(timeToNextEvent));
-		}
-
-		HandleNextEvent(EVENT_JERRY);
+		*out++ = lastLeft;
+		*out++ = lastRight;
 	}
-	while (!bufferDone);
 }
 
 
+//
+// Sample clock, runs on the emulation timeline at DAC_AUDIO_RATE
+//
 void DSPSampleCallback(void)
 {
-	((uint16_t *)sampleBuffer)[bufferIndex + 0] = ltxd;
-	((uint16_t *)sampleBuffer)[bufferIndex + 1] = rtxd;
-	bufferIndex += 2;
+	uint32_t head = sampleRingHead.load(std::memory_order_relaxed);
+	uint32_t tail = sampleRingTail.load(std::memory_order_acquire);
 
-	if (bufferIndex == numberOfSamples)
+	// If the host isn't keeping up (or we're running faster than real time),
+	// drop the sample rather than let the latency pile up
+	if ((head - tail) < sampleRingHighWater)
 	{
-		bufferDone = true;
-		return;
+		sampleRing[((head & SAMPLE_RING_MASK) * 2) + 0] = ltxd;
+		sampleRing[((head & SAMPLE_RING_MASK) * 2) + 1] = rtxd;
+		sampleRingHead.store(head + 1, std::memory_order_release);
 	}
 
-	SetCallbackTime(DSPSampleCallback, 1000000.0 / (double)DAC_AUDIO_RATE, EVENT_JERRY);
+	SetCallbackTicks(DSPSampleCallback, TicksToNextSample());
 }
 
 
@@ -18,14 +18,19 @@
 
 #include <SDL.h>								// Used only for SDL_GetTicks...
 #include <stdlib.h>
+#include <string.h>								// For memcmp
 #include "dac.h"
 #include "gpu.h"
 #include "jagdasm.h"
 #include "jaguar.h"
 #include "jerry.h"
+#include "jit.h"
+#include "lockstep.h"
 #include "log.h"
 #include "m68000/m68kinterface.h"
 //#include "memory.h"
+#include "risc.h"
+#include "settings.h"
 
 
 // Seems alignment in loads & stores was off...
@@ -37,7 +42,6 @@
 //#define DSP_DEBUG_PL2
 //#define DSP_DEBUG_STALL
 //#define DSP_DEBUG_CC
-#define NEW_SCOREBOARD
 
 // Disassembly definitions
 
@@ -168,16 +172,55 @@ const bool affectsScoreboard[64] =
 	false, false, false,  true
 };
 
+const bool readAffected[64][2] =
+{
+	{ true,  true}, { true,  true}, {false,  true}, {false,  true},
+	{ true,  true}, { true,  true}, {false,  true}, {false,  true},
+	{false,  true}, { true,  true}, { true,  true}, { true,  true},
+	{false,  true}, {false,  true}, {false,  true}, {false,  true},
+
+	{ true,  true}, { true,  true}, { true,  true}, {false,  true},
+	{ true,  true}, { true,  true}, {false,  true}, { true,  true},
+	{false,  true}, {false,  true}, { true,  true}, {false,  true},
+	{ true,  true}, {false,  true}, { true,  true}, {false,  true},
+
+	{false,  true}, {false,  true}, { true, false}, {false, false},
+	{ true, false}, {false, false}, {false, false}, { true, false},
+	{ true, false}, { true, false}, {false,  true}, { true, false},
+	{ true, false}, { true,  true}, { true,  true}, { true,  true},
+
+	{false,  true}, { true,  true}, { true,  true}, {false,  true},
+	{ true, false}, { true, false}, { true,  true}, { true, false},
+	{ true, false}, {false, false}, { true, false}, { true, false},
+	{ true,  true}, { true,  true}, {false, false}, {false,  true}
+};
+
+const bool isLoadStore[65] =
+{
+	false, false, false, false, false, false, false, false,
+	false, false, false, false, false, false, false, false,
+
+	false, false, false, false, false, false, false, false,
+	false, false, false, false, false, false, false, false,
+
+	false, false, false, false, false, false, false,  true,
+	 true,  true, false,  true,  true,  true,  true,  true,
+
+	false,  true,  true, false, false, false, false, false,
+	false, false,  true,  true,  true,  true, false, false, false
+};
+
 struct PipelineStage
 {
-	uint16_t instruction;
-	uint8_t opcode, operand1, operand2;
-	uint32_t reg1, reg2, areg1, areg2;
+	uint32_t reg1, reg2;				// RM & RN, as read in stage 1
 	uint32_t result;
-	uint8_t writebackRegister;
+	uint32_t writeMask;					// RN's bit, if it's on the scoreboard
 	// General memory store...
 	uint32_t address;
 	uint32_t value;
+	uint16_t instruction;
+	uint8_t opcode, operand1, operand2;
+	uint8_t writebackRegister;
 	uint8_t type;
 };
 
@@ -185,14 +228,23 @@ struct PipelineStage
 #define TYPE_WORD			1
 #define TYPE_DWORD			2
 #define PIPELINE_STALL		64						// Set to # of opcodes + 1
-#ifndef NEW_SCOREBOARD
-bool scoreboard[32];
-#else
-uint8_t scoreboard[32];
-#endif
-uint8_t plPtrFetch, plPtrRead, plPtrExec, plPtrWrite;
-PipelineStage pipeline[4];
-bool IMASKCleared = false;
+
+// What each opcode reads & writes, as far as the scoreboard is concerned. These
+// get boiled down from the tables above by dsp_build_tables().
+#define PL_READS_RM			0x01
+#define PL_READS_RN			0x02
+#define PL_READS_R14		0x04
+#define PL_READS_R15		0x08
+#define PL_WRITES_RN		0x10
+#define PL_LOAD_STORE		0x20
+
+static uint8_t dspPipeFlags[65];
+
+// There's no scoreboard as such: it's just the writeMasks of whatever's in
+// the execute & write stages
+PER_MACHINE PipelineStage pipeline[3];
+PER_MACHINE PipelineStage * plRead, * plExec, * plWrite;
+PER_MACHINE bool IMASKCleared = false;
 
 // DSP flags (old--have to get rid of this crap)
 
@@ -244,25 +296,45 @@ bool IMASKCleared = false;
 
 extern uint32_t jaguar_mainRom_crc32;
 
+// Everything the RISC core touches (see risc.h)
+
+PER_MACHINE RiscState dspState;
+
+// The rest of this file still goes by the old names
+#define dsp_pc						dspState.pc
+#define dsp_control					dspState.control
+#define dsp_flags					dspState.flags
+#define dsp_flag_z					dspState.flagZ
+#define dsp_flag_n					dspState.flagN
+#define dsp_flag_c					dspState.flagC
+#define dsp_acc						dspState.acc			// 40 bit register, NOT 32!
+#define dsp_remain					dspState.remain
+#define dsp_matrix_control			dspState.matrixControl
+#define dsp_pointer_to_matrix		dspState.pointerToMatrix
+#define dsp_data_organization		dspState.dataOrganization
+#define dsp_div_control				dspState.divControl
+#define dsp_reg						dspState.reg
+#define dsp_alternate_reg			dspState.alternateReg
+#define dsp_reg_bank_0				dspState.regBank0
+#define dsp_reg_bank_1				dspState.regBank1
+#define dsp_opcode_first_parameter	dspState.firstParameter
+#define dsp_opcode_second_parameter	dspState.secondParameter
+
+// What RiscCore<> needs to know about the DSP
+struct DSPVariant
+{
+	static inline RiscState & State(void) { return dspState; }
+	static inline void Exec(int32_t cycles) { DSPExec(cycles); }
+	static inline uint16_t ReadWord(uint32_t offset) { return DSPReadWord(offset, DSP); }
+};
+
+typedef RiscCore<DSPVariant> DSPCore;
+
+// The opcodes that are the DSP's alone (or that it does its own way)
+
 // Is opcode 62 *really* a NOP? Seems like it...
-static void dsp_opcode_abs(void);
-static void dsp_opcode_add(void);
-static void dsp_opcode_addc(void);
-static void dsp_opcode_addq(void);
 static void dsp_opcode_addqmod(void);
-static void dsp_opcode_addqt(void);
-static void dsp_opcode_and(void);
-static void dsp_opcode_bclr(void);
-static void dsp_opcode_bset(void);
-static void dsp_opcode_btst(void);
-static void dsp_opcode_cmp(void);
-static void dsp_opcode_cmpq(void);
 static void dsp_opcode_div(void);
-static void dsp_opcode_imacn(void);
-static void dsp_opcode_imult(void);
-static void dsp_opcode_imultn(void);
-static void dsp_opcode_jr(void);
-static void dsp_opcode_jump(void);
 static void dsp_opcode_load(void);
 static void dsp_opcode_loadb(void);
 static void dsp_opcode_loadw(void);
@@ -271,31 +343,8 @@ static void dsp_opcode_load_r14_ri(void);
 static void dsp_opcode_load_r15_indexed(void);
 static void dsp_opcode_load_r15_ri(void);
 static void dsp_opcode_mirror(void);
-static void dsp_opcode_mmult(void);
-static void dsp_opcode_move(void);
-static void dsp_opcode_movei(void);
-static void dsp_opcode_movefa(void);
-static void dsp_opcode_move_pc(void);
-static void dsp_opcode_moveq(void);
-static void dsp_opcode_moveta(void);
-static void dsp_opcode_mtoi(void);
-static void dsp_opcode_mult(void);
-static void dsp_opcode_neg(void);
-static void dsp_opcode_nop(void);
-static void dsp_opcode_normi(void);
-static void dsp_opcode_not(void);
-static void dsp_opcode_or(void);
-static void dsp_opcode_resmac(void);
-static void dsp_opcode_ror(void);
-static void dsp_opcode_rorq(void);
-static void dsp_opcode_xor(void);
 static void dsp_opcode_sat16s(void);
 static void dsp_opcode_sat32s(void);
-static void dsp_opcode_sh(void);
-static void dsp_opcode_sha(void);
-static void dsp_opcode_sharq(void);
-static void dsp_opcode_shlq(void);
-static void dsp_opcode_shrq(void);
 static void dsp_opcode_store(void);
 static void dsp_opcode_storeb(void);
 static void dsp_opcode_storew(void);
@@ -303,11 +352,7 @@ static void dsp_opcode_store_r14_indexed(void);
 static void dsp_opcode_store_r14_ri(void);
 static void dsp_opcode_store_r15_indexed(void);
 static void dsp_opcode_store_r15_ri(void);
-static void dsp_opcode_sub(void);
-static void dsp_opcode_subc(void);
-static void dsp_opcode_subq(void);
 static void dsp_opcode_subqmod(void);
-static void dsp_opcode_subqt(void);
 static void dsp_opcode_illegal(void);
 
 /*uint8_t dsp_opcode_cycles[64] =
@@ -342,25 +387,25 @@ uint8_t dsp_opcode_cycles[64] =
 
 void (* dsp_opcode[64])() =
 {
-	dsp_opcode_add,					dsp_opcode_addc,				dsp_opcode_addq,				dsp_opcode_addqt,
-	dsp_opcode_sub,					dsp_opcode_subc,				dsp_opcode_subq,				dsp_opcode_subqt,
-	dsp_opcode_neg,					dsp_opcode_and,					dsp_opcode_or,					dsp_opcode_xor,
-	dsp_opcode_not,					dsp_opcode_btst,				dsp_opcode_bset,				dsp_opcode_bclr,
-	dsp_opcode_mult,				dsp_opcode_imult,				dsp_opcode_imultn,				dsp_opcode_resmac,
-	dsp_opcode_imacn,				dsp_opcode_div,					dsp_opcode_abs,					dsp_opcode_sh,
-	dsp_opcode_shlq,				dsp_opcode_shrq,				dsp_opcode_sha,					dsp_opcode_sharq,
-	dsp_opcode_ror,					dsp_opcode_rorq,				dsp_opcode_cmp,					dsp_opcode_cmpq,
-	dsp_opcode_subqmod,				dsp_opcode_sat16s,				dsp_opcode_move,				dsp_opcode_moveq,
-	dsp_opcode_moveta,				dsp_opcode_movefa,				dsp_opcode_movei,				dsp_opcode_loadb,
-	dsp_opcode_loadw,				dsp_opcode_load,				dsp_opcode_sat32s,				dsp_opcode_load_r14_indexed,
-	dsp_opcode_load_r15_indexed,	dsp_opcode_storeb,				dsp_opcode_storew,				dsp_opcode_store,
-	dsp_opcode_mirror,				dsp_opcode_store_r14_indexed,	dsp_opcode_store_r15_indexed,	dsp_opcode_move_pc,
-	dsp_opcode_jump,				dsp_opcode_jr,					dsp_opcode_mmult,				dsp_opcode_mtoi,
-	dsp_opcode_normi,				dsp_opcode_nop,					dsp_opcode_load_r14_ri,			dsp_opcode_load_r15_ri,
-	dsp_opcode_store_r14_ri,		dsp_opcode_store_r15_ri,		dsp_opcode_illegal,				dsp_opcode_addqmod,
+	DSPCore::opcode_add,				DSPCore::opcode_addc,				DSPCore::opcode_addq,				DSPCore::opcode_addqt,
+	DSPCore::opcode_sub,				DSPCore::opcode_subc,				DSPCore::opcode_subq,				DSPCore::opcode_subqt,
+	DSPCore::opcode_neg,				DSPCore::opcode_and,				DSPCore::opcode_or,					DSPCore::opcode_xor,
+	DSPCore::opcode_not,				DSPCore::opcode_btst,				DSPCore::opcode_bset,				DSPCore::opcode_bclr,
+	DSPCore::opcode_mult,				DSPCore::opcode_imult,				DSPCore::opcode_imultn,				DSPCore::opcode_resmac,
+	DSPCore::opcode_imacn,				dsp_opcode_div,						DSPCore::opcode_abs,				DSPCore::opcode_sh,
+	DSPCore::opcode_shlq,				DSPCore::opcode_shrq,				DSPCore::opcode_sha,				DSPCore::opcode_sharq,
+	DSPCore::opcode_ror,				DSPCore::opcode_rorq,				DSPCore::opcode_cmp,				DSPCore::opcode_cmpq,
+	dsp_opcode_subqmod,					dsp_opcode_sat16s,					DSPCore::opcode_move,				DSPCore::opcode_moveq,
+	DSPCore::opcode_moveta,				DSPCore::opcode_movefa,				DSPCore::opcode_movei,				dsp_opcode_loadb,
+	dsp_opcode_loadw,					dsp_opcode_load,					dsp_opcode_sat32s,					dsp_opcode_load_r14_indexed,
+	dsp_opcode_load_r15_indexed,		dsp_opcode_storeb,					dsp_opcode_storew,					dsp_opcode_store,
+	dsp_opcode_mirror,					dsp_opcode_store_r14_indexed,		dsp_opcode_store_r15_indexed,		DSPCore::opcode_move_pc,
+	DSPCore::opcode_jump,				DSPCore::opcode_jr,					DSPCore::opcode_mmult,				DSPCore::opcode_mtoi,
+	DSPCore::opcode_normi,				DSPCore::opcode_nop,				dsp_opcode_load_r14_ri,				dsp_opcode_load_r15_ri,
+	dsp_opcode_store_r14_ri,			dsp_opcode_store_r15_ri,			dsp_opcode_illegal,					dsp_opcode_addqmod,
 };
 
-uint32_t dsp_opcode_use[65];
+PER_MACHINE uint32_t dsp_opcode_use[65];
 
 const char * dsp_opcode_str[65]=
 {
@@ -383,22 +428,7 @@ const char * dsp_opcode_str[65]=
 	"STALL"
 };
 
-uint32_t dsp_pc;
-static uint64_t dsp_acc;								// 40 bit register, NOT 32!
-static uint32_t dsp_remain;
-static uint32_t dsp_modulo;
-static uint32_t dsp_flags;
-static uint32_t dsp_matrix_control;
-static uint32_t dsp_pointer_to_matrix;
-static uint32_t dsp_data_organization;
-uint32_t dsp_control;
-static uint32_t dsp_div_control;
-static uint8_t dsp_flag_z, dsp_flag_n, dsp_flag_c;
-static uint32_t * dsp_reg = NULL, * dsp_alternate_reg = NULL;
-uint32_t dsp_reg_bank_0[32], dsp_reg_bank_1[32];
-
-static uint32_t dsp_opcode_first_parameter;
-static uint32_t dsp_opcode_second_parameter;
+static PER_MACHINE uint32_t dsp_modulo;
 
 #define DSP_RUNNING			(dsp_control & 0x01)
 
@@ -420,19 +450,78 @@ static uint32_t dsp_opcode_second_parameter;
 #define SET_ZNC_ADD(a,b,r)	SET_N(r); SET_Z(r); SET_C_ADD(a,b)
 #define SET_ZNC_SUB(a,b,r)	SET_N(r); SET_Z(r); SET_C_SUB(a,b)
 
-uint32_t dsp_convert_zero[32] = {
-	32, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
-	17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31
+static uint16_t mirror_table[65536];
+static PER_MACHINE uint8_t dsp_ram_8[0x2000];
+
+//
+// Predecode cache for the pipelined core (see DSPExecP2() below). Every word of
+// local RAM gets an entry with the opcode already pulled apart & the registers
+// it reads & writes already worked out for the scoreboard. MOVEI's immediate
+// data isn't kept here; that's read from RAM every time.
+//
+struct DSPDecodedOp
+{
+	uint32_t readMask;						// Registers it has to wait for
+	uint32_t writeMask;						// RN's bit, if it's on the scoreboard
+	uint16_t instruction;
+	uint8_t opcode, operand1, operand2;
+	bool valid;
 };
 
-uint8_t dsp_branch_condition_table[32 * 8];
-static uint16_t mirror_table[65536];
-static uint8_t dsp_ram_8[0x2000];
+static PER_MACHINE DSPDecodedOp dspDecodeCache[0x1000];
+
+// Every word of local RAM that went into a translated block is marked here
+// (see DSPJITCompile() below); writing to one throws them all away.
+static PER_MACHINE uint8_t dspJITCovered[0x1000];
+static PER_MACHINE bool dspJITFlushPending = false;
+
+#ifdef JIT_X86_64
+static void DSPJITDone(void);
+#endif
+
+static inline void DSPInvalidateDecodeCache(uint32_t offset, uint32_t size)
+{
+	for(uint32_t i=(offset >> 1); i<=((offset + size - 1) >> 1); i++)
+	{
+		dspDecodeCache[i & 0xFFF].valid = false;
+
+		if (dspJITCovered[i & 0xFFF])
+			dspJITFlushPending = true;
+	}
+}
 
-#define BRANCH_CONDITION(x)		dsp_branch_condition_table[(x) + ((jaguar_flags & 7) << 5)]
+#define BRANCH_CONDITION(x)		riscBranchCondition[(x) + ((jaguar_flags & 7) << 5)]
+
+static PER_MACHINE uint32_t dsp_in_exec = 0;
+static PER_MACHINE uint32_t dsp_releaseTimeSlice_flag = 0;
+
+// Spin loop detection (see DSPCheckSpinLoop() below)
+#define DSP_SPIN_MAX_SIZE	32			// In bytes
+#define DSP_SPIN_REPORTS	16
+
+// Opcodes that can't change anything but the registers they load/move into
+static const uint8_t dsp_spin_safe[64] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0,			// add, addc, addq, addqt, sub, subc, subq, subqt
+	0, 0, 0, 0, 0, 1, 0, 0,			// neg, and, or, xor, not, btst, bset, bclr
+	0, 0, 0, 0, 0, 0, 0, 0,			// mult, imult, imultn, resmac, imacn, div, abs, sh
+	0, 0, 0, 0, 0, 0, 1, 1,			// shlq, shrq, sha, sharq, ror, rorq, cmp, cmpq
+	0, 0, 1, 1, 0, 0, 1, 1,			// subqmod, sat16s, move, moveq, moveta, movefa, movei, loadb
+	1, 1, 0, 1, 1, 0, 0, 0,			// loadw, load, sat32s, load_r14_i, load_r15_i, storeb, storew, store
+	0, 0, 0, 0, 1, 1, 0, 0,			// mirror, store_r14_i, store_r15_i, move_pc, jump, jr, mmult, mtoi
+	0, 1, 1, 1, 0, 0, 0, 0			// normi, nop, load_r14_ri, load_r15_ri, store_r14_ri, store_r15_ri, illegal, addqmod
+};
 
-static uint32_t dsp_in_exec = 0;
-static uint32_t dsp_releaseTimeSlice_flag = 0;
+static PER_MACHINE bool dspSideEffect = false;	// Set on any write (or side effecting read)
+static PER_MACHINE uint32_t dspSpinHead;
+static PER_MACHINE uint32_t dspPipeBranchPC = 0xFFFFFFFF;	// See DSPPipelineBranch()
+static PER_MACHINE uint32_t dspLockstepSlices = 0;			// See DSPExecLockstep()
+static PER_MACHINE uint32_t dspLockstepDiverged = 0;
+static PER_MACHINE bool dspSpinSafe;
+static PER_MACHINE uint32_t dspSpinRegs[32];
+static PER_MACHINE uint8_t dspSpinFlags;
+static PER_MACHINE uint32_t dspSpinReported[DSP_SPIN_REPORTS];
+static PER_MACHINE uint32_t numDSPSpinsReported = 0;
 
 FILE * dsp_fp;
 
@@ -465,8 +554,14 @@ void DSPReleaseTimeslice(void)
 }
 
 
-void dsp_build_branch_condition_table(void)
+void dsp_build_tables(void)
 {
+	// These are shared by every machine (see machine.h), so only do this once
+	static bool tablesBuilt = false;
+
+	if (tablesBuilt)
+		return;
+
 	// Fill in the mirror table
 	for(int i=0; i<65536; i++)
 	{
@@ -480,28 +575,23 @@ void dsp_build_branch_condition_table(void)
 			| ((i << 13) & 0x4000) | ((i << 15) & 0x8000);
 	}
 
-	// Fill in the condition table
-	for(int i=0; i<8; i++)
+	// Boil the pipeline tables down to one set of flags per opcode
+	for(int i=0; i<64; i++)
 	{
-		for(int j=0; j<32; j++)
-		{
-			int result = 1;
-
-			if ((j & 1) && (i & ZERO_FLAG))
-				result = 0;
-
-			if ((j & 2) && (!(i & ZERO_FLAG)))
-				result = 0;
+		dspPipeFlags[i] = (readAffected[i][0] ? PL_READS_RM : 0)
+			| (readAffected[i][1] ? PL_READS_RN : 0)
+			| (i == 43 || i == 58 ? PL_READS_R14 : 0)
+			| (i == 44 || i == 59 ? PL_READS_R15 : 0)
+			| (affectsScoreboard[i] ? PL_WRITES_RN : 0)
+			| (isLoadStore[i] ? PL_LOAD_STORE : 0);
+	}
 
-			if ((j & 4) && (i & (CARRY_FLAG << (j >> 4))))
-				result = 0;
+	dspPipeFlags[PIPELINE_STALL] = 0;
 
-			if ((j & 8) && (!(i & (CARRY_FLAG << (j >> 4)))))
-				result = 0;
+	// The condition table & such are the GPU's too
+	RiscBuildTables();
 
-			dsp_branch_condition_table[i * 32 + j] = result;
-		}
-	}
+	tablesBuilt = true;
 }
 
 
@@ -535,6 +625,9 @@ uint8_t DSPReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 			return (data & 0xFF);
 	}
 
+	if ((offset & 0xFFFF00) == 0xDFFF00)	// BUTCH reads aren't idempotent
+		dspSideEffect = true;
+
 	return JaguarReadByte(offset, who);
 }
 
@@ -563,6 +656,9 @@ uint16_t DSPReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 			return data >> 16;
 	}
 
+	if ((offset & 0xFFFF00) == 0xDFFF00)	// BUTCH reads aren't idempotent
+		dspSideEffect = true;
+
 	return JaguarReadWord(offset, who);
 }
 
@@ -608,12 +704,17 @@ uint32_t DSPReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 		return 0xFFFFFFFF;
 	}
 
+	if ((offset & 0xFFFF00) == 0xDFFF00)	// BUTCH reads aren't idempotent
+		dspSideEffect = true;
+
 	return JaguarReadLong(offset, who);
 }
 
 
 void DSPWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 {
+	dspSideEffect = true;
+
 	if (offset >= 0xF1A000 && offset <= 0xF1A0FF)
 		WriteLog("DSP: WriteByte--Attempt to write to DSP register file by %s!\n", whoName[who]);
 
@@ -621,6 +722,7 @@ void DSPWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 	{
 		offset -= DSP_WORK_RAM_BASE;
 		dsp_ram_8[offset] = data;
+		DSPInvalidateDecodeCache(offset, 1);
 //This is rather stupid! !!! FIX !!!
 /*		if (dsp_in_exec == 0)
 		{
@@ -655,6 +757,8 @@ void DSPWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 
 void DSPWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 {
+	dspSideEffect = true;
+
 	if (offset >= 0xF1A000 && offset <= 0xF1A0FF)
 		WriteLog("DSP: WriteWord--Attempt to write to DSP register file by %s!\n", whoName[who]);
 	offset &= 0xFFFFFFFE;
@@ -672,6 +776,7 @@ void DSPWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 		offset -= DSP_WORK_RAM_BASE;
 		dsp_ram_8[offset] = data >> 8;
 		dsp_ram_8[offset+1] = data & 0xFF;
+		DSPInvalidateDecodeCache(offset, 2);
 //This is rather stupid! !!! FIX !!!
 /*		if (dsp_in_exec == 0)
 		{
@@ -718,6 +823,8 @@ SET16(ram2, offset, data);
 //bool badWrite = false;
 void DSPWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 {
+	dspSideEffect = true;
+
 	if (offset >= 0xF1A000 && offset <= 0xF1A0FF)
 		WriteLog("DSP: WriteLong--Attempt to write to DSP register file by %s!\n", whoName[who]);
 	// ??? WHY ???
@@ -735,6 +842,7 @@ void DSPWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 }//*/
 		offset -= DSP_WORK_RAM_BASE;
 		SET32(dsp_ram_8, offset, data);
+		DSPInvalidateDecodeCache(offset, 4);
 //CC only!
 #ifdef DSP_DEBUG_CC
 SET32(ram1, offset, data),
@@ -917,6 +1025,85 @@ void DSPUpdateRegisterBanks(void)
 }
 
 
+//
+// Pull an instruction apart for the pipelined core
+//
+static void DSPPipelineDecode(DSPDecodedOp & op, uint16_t instruction)
+{
+	op.instruction = instruction;
+	op.opcode = instruction >> 10;
+	op.operand1 = (instruction >> 5) & 0x1F;
+	op.operand2 = instruction & 0x1F;
+
+	uint8_t flags = dspPipeFlags[op.opcode];
+	op.readMask = (flags & PL_READS_RM ? 1 << op.operand1 : 0)
+		| (flags & PL_READS_RN ? 1 << op.operand2 : 0)
+		| (flags & PL_READS_R14 ? 1 << 14 : 0)
+		| (flags & PL_READS_R15 ? 1 << 15 : 0);
+	op.writeMask = (flags & PL_WRITES_RN ? 1 << op.operand2 : 0);
+	op.valid = true;
+}
+
+
+//
+// Fetch & decode the instruction at the PC into a pipeline stage. Hands back
+// the decoded op, so the caller can check it against the scoreboard.
+//
+static inline const DSPDecodedOp & DSPPipelineFetch(PipelineStage & stage)
+{
+	static PER_MACHINE DSPDecodedOp uncached;
+	uint32_t offset = (dsp_pc & 0xFFFFFFFE) - DSP_WORK_RAM_BASE;
+	DSPDecodedOp * op = &uncached;
+
+	// It's nearly always running out of local RAM, so go straight there
+	if (offset < 0x2000)
+	{
+		op = &dspDecodeCache[offset >> 1];
+
+		if (!op->valid)
+			DSPPipelineDecode(*op, GET16(dsp_ram_8, offset));
+	}
+	else
+		DSPPipelineDecode(uncached, DSPReadWord(dsp_pc, DSP));
+
+	stage.instruction = op->instruction;
+	stage.opcode = op->opcode;
+	stage.operand1 = op->operand1;
+	stage.operand2 = op->operand2;
+
+	if (op->opcode == 38)
+	{
+		if (offset <= 0x2000 - 6)
+			stage.result = (uint32_t)GET16(dsp_ram_8, offset + 2)
+				| ((uint32_t)GET16(dsp_ram_8, offset + 4) << 16);
+		else
+			stage.result = (uint32_t)DSPReadWord(dsp_pc + 2, DSP)
+				| ((uint32_t)DSPReadWord(dsp_pc + 4, DSP) << 16);
+	}
+
+	return *op;
+}
+
+
+//
+// Do the register (or memory) writeback for a pipeline stage
+//
+static inline void DSPPipelineWriteback(PipelineStage & stage)
+{
+	if (stage.opcode == PIPELINE_STALL || stage.writebackRegister == 0xFF)
+		return;
+
+	if (stage.writebackRegister != 0xFE)
+		dsp_reg[stage.writebackRegister] = stage.result;
+	else if (stage.type == TYPE_BYTE)
+		JaguarWriteByte(stage.address, stage.value);
+	else if (stage.type == TYPE_WORD)
+		JaguarWriteWord(stage.address, stage.value);
+	else
+		JaguarWriteLong(stage.address, stage.value);
+}
+
+
 //
 // Check for and handle any asserted DSP IRQs
 //
@@ -974,37 +1161,11 @@ void DSPHandleIRQs(void)
 //writeback into register 0?
 #ifdef DSP_DEBUG_IRQ
 WriteLog("--> Pipeline dump [DSP_PC=%08X]...\n", dsp_pc);
-WriteLog("\tR -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister, dsp_opcode_str[pipeline[plPtrRead].opcode]);
-WriteLog("\tE -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister, dsp_opcode_str[pipeline[plPtrExec].opcode]);
-WriteLog("\tW -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrWrite].opcode, pipeline[plPtrWrite].operand1, pipeline[plPtrWrite].operand2, pipeline[plPtrWrite].reg1, pipeline[plPtrWrite].reg2, pipeline[plPtrWrite].result, pipeline[plPtrWrite].writebackRegister, dsp_opcode_str[pipeline[plPtrWrite].opcode]);
-#endif
-	if (pipeline[plPtrWrite].opcode != PIPELINE_STALL)
-	{
-		if (pipeline[plPtrWrite].writebackRegister != 0xFF)
-		{
-			if (pipeline[plPtrWrite].writebackRegister != 0xFE)
-				dsp_reg[pipeline[plPtrWrite].writebackRegister] = pipeline[plPtrWrite].result;
-			else
-			{
-				if (pipeline[plPtrWrite].type == TYPE_BYTE)
-					JaguarWriteByte(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-				else if (pipeline[plPtrWrite].type == TYPE_WORD)
-					JaguarWriteWord(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-				else
-					JaguarWriteLong(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-			}
-		}
-
-#ifndef NEW_SCOREBOARD
-		if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-			scoreboard[pipeline[plPtrWrite].operand2] = false;
-#else
-//Yup, sequential MOVEQ # problem fixing (I hope!)...
-		if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-			if (scoreboard[pipeline[plPtrWrite].operand2])
-				scoreboard[pipeline[plPtrWrite].operand2]--;
+WriteLog("\tR -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", plRead->opcode, plRead->operand1, plRead->operand2, plRead->reg1, plRead->reg2, plRead->result, plRead->writebackRegister, dsp_opcode_str[plRead->opcode]);
+WriteLog("\tE -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", plExec->opcode, plExec->operand1, plExec->operand2, plExec->reg1, plExec->reg2, plExec->result, plExec->writebackRegister, dsp_opcode_str[plExec->opcode]);
+WriteLog("\tW -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", plWrite->opcode, plWrite->operand1, plWrite->operand2, plWrite->reg1, plWrite->reg2, plWrite->result, plWrite->writebackRegister, dsp_opcode_str[plWrite->opcode]);
 #endif
-	}
+	DSPPipelineWriteback(*plWrite);
 
 	dsp_flags |= IMASK;
 //CC only!
@@ -1015,7 +1176,7 @@ ctrl2[4] = dsp_flags;
 	DSPUpdateRegisterBanks();
 #ifdef DSP_DEBUG_IRQ
 //	WriteLog(" [PC will return to %08X, R31 = %08X]\n", dsp_pc, dsp_reg[31]);
-	WriteLog(" [PC will return to %08X, R31 = %08X]\n", dsp_pc - (pipeline[plPtrExec].opcode == 38 ? 6 : (pipeline[plPtrExec].opcode == PIPELINE_STALL ? 0 : 2)), dsp_reg[31]);
+	WriteLog(" [PC will return to %08X, R31 = %08X]\n", dsp_pc - (plExec->opcode == 38 ? 6 : (plExec->opcode == PIPELINE_STALL ? 0 : 2)), dsp_reg[31]);
 #endif
 
 	// subqt  #4,r31		; pre-decrement stack pointer
@@ -1043,10 +1204,10 @@ regs2[31] -= 4;
 // instruction stream...
 
 //	DSPWriteLong(dsp_reg[31], dsp_pc - 2, DSP);
-	DSPWriteLong(dsp_reg[31], dsp_pc - 2 - (pipeline[plPtrExec].opcode == 38 ? 6 : (pipeline[plPtrExec].opcode == PIPELINE_STALL ? 0 : 2)), DSP);
+	DSPWriteLong(dsp_reg[31], dsp_pc - 2 - (plExec->opcode == 38 ? 6 : (plExec->opcode == PIPELINE_STALL ? 0 : 2)), DSP);
 //CC only!
 #ifdef DSP_DEBUG_CC
-SET32(ram2, regs2[31] - 0xF1B000, dsp_pc - 2 - (pipeline[plPtrExec].opcode == 38 ? 6 : (pipeline[plPtrExec].opcode == PIPELINE_STALL ? 0 : 2)));
+SET32(ram2, regs2[31] - 0xF1B000, dsp_pc - 2 - (plExec->opcode == 38 ? 6 : (plExec->opcode == PIPELINE_STALL ? 0 : 2)));
 #endif
 //!!!!!!!!
 
@@ -1186,9 +1347,15 @@ ctrl1[8] = ctrl2[8] = dsp_control;
 	if (state)
 	{
 		dsp_control |= mask;						// Set the latch bit
-#warning !!! No checking done to see if we're using pipelined DSP or not !!!
-//		DSPHandleIRQs();
-		DSPHandleIRQsNP();
+
+		// The pipelined core can only take it between clocks; if it's in the
+		// middle of one, it'll pick up the latch at the top of its loop
+		if (!vjs.usePipelinedDSP)
+			DSPHandleIRQsNP();
+		else if (dsp_in_exec)
+			IMASKCleared = true;
+		else
+			DSPHandleIRQs();
 //CC only!
 #ifdef DSP_DEBUG_CC
 ctrl1[8] = ctrl2[8] = dsp_control;
@@ -1216,7 +1383,7 @@ void DSPInit(void)
 //	memory_malloc_secure((void **)&dsp_reg_bank_0, 32 * sizeof(int32_t), "DSP bank 0 regs");
 //	memory_malloc_secure((void **)&dsp_reg_bank_1, 32 * sizeof(int32_t), "DSP bank 1 regs");
 
-	dsp_build_branch_condition_table();
+	dsp_build_tables();
 	DSPReset();
 }
 
@@ -1234,6 +1401,7 @@ void DSPReset(void)
 	dsp_control			  = 0x00002000;				// Report DSP version 2
 	dsp_div_control		  = 0x00000000;
 	dsp_in_exec			  = 0;
+	numDSPSpinsReported	  = 0;
 
 	dsp_reg = dsp_reg_bank_0;
 	dsp_alternate_reg = dsp_reg_bank_1;
@@ -1249,6 +1417,8 @@ void DSPReset(void)
 	// Contents of local RAM are quasi-stable; we simulate this by randomizing RAM contents
 	for(uint32_t i=0; i<8192; i+=4)
 		*((uint32_t *)(&dsp_ram_8[i])) = rand();
+
+	DSPInvalidateDecodeCache(0, 0x2000);
 }
 
 
@@ -1316,6 +1486,9 @@ void DSPDone(void)
 	WriteLog("DSP: Stopped at PC=%08X dsp_modulo=%08X (dsp was%s running)\n", dsp_pc, dsp_modulo, (DSP_RUNNING ? "" : "n't"));
 	WriteLog("DSP: %sin interrupt handler\n", (dsp_flags & IMASK ? "" : "not "));
 
+	if (dspLockstepSlices)
+		WriteLog("DSP: Cores diverged in %u of %u lockstep slices\n", dspLockstepDiverged, dspLockstepSlices);
+
 	// Get the active interrupt bits
 	int bits = ((dsp_control >> 10) & 0x20) | ((dsp_control >> 6) & 0x1F);
 	// Get the interrupt mask
@@ -1328,6 +1501,10 @@ void DSPDone(void)
 	DSPDumpRegisters();
 	WriteLog("\n");
 
+#ifdef JIT_X86_64
+	DSPJITDone();
+#endif
+
 	static char buffer[512];
 	int j = DSP_WORK_RAM_BASE;
 
@@ -1348,12 +1525,11 @@ void DSPDone(void)
 }
 
 
-
 //
 // DSP comparison core...
 //
 #ifdef DSP_DEBUG_CC
-static uint16_t lastExec;
+static PER_MACHINE uint16_t lastExec;
 void DSPExecComp(int32_t cycles)
 {
 	while (cycles > 0 && DSP_RUNNING)
@@ -1450,7 +1626,7 @@ DSPUpdateRegisterBanks();
 		{
 //			WriteLog("\nCores diverged at instruction tick #%u!\nAttemping to synchronize...\n\n", count);
 
-//			uint32_t ppc = ctrl2[0] - (pipeline[plPtrExec].opcode == 38 ? 6 : (pipeline[plPtrExec].opcode == PIPELINE_STALL ? 0 : 2)) - (pipeline[plPtrWrite].opcode == 38 ? 6 : (pipeline[plPtrWrite].opcode == PIPELINE_STALL ? 0 : 2));
+//			uint32_t ppc = ctrl2[0] - (plExec->opcode == 38 ? 6 : (plExec->opcode == PIPELINE_STALL ? 0 : 2)) - (plWrite->opcode == 38 ? 6 : (plWrite->opcode == PIPELINE_STALL ? 0 : 2));
 //WriteLog("[DSP_PC1=%08X, DSP_PC2=%08X]\n", ctrl1[0], ppc);
 //			if (ctrl1[0] < ppc)						// P ran ahead of NP
 //How to test this crap???
@@ -1550,1156 +1726,1044 @@ for(int k=0; k<2; k++)
 
 
 //
-// DSP execution core
+// Spin loop detection
 //
-//static bool R20Set = false, tripwire = false;
-//static uint32_t pcQueue[32], ptrPCQ = 0;
-void DSPExec(int32_t cycles)
+// Same deal as on the GPU: DSP code likes to sit in short loops polling a flag
+// in local RAM or a mailbox from the 68K or GPU. Nothing else writes to memory
+// while the DSP's running its timeslice, so if we come back around to the top
+// of a loop that only loads & compares with the same registers & flags and
+// without having written anything, we can skip the rest of the timeslice.
+//
+static bool DSPCheckSpinLoop(uint32_t branchPC)
 {
-#ifdef DSP_SINGLE_STEPPING
-	if (dsp_control & 0x18)
+	if (dsp_pc != dspSpinHead || (dspSpinSafe && dspSideEffect))
 	{
-		cycles = 1;
-		dsp_control &= ~0x10;
+		// New loop (or the code may have changed): see if it's a candidate
+		dspSpinHead = dsp_pc;
+		dspSpinSafe = (dsp_pc >= DSP_WORK_RAM_BASE)
+			&& (branchPC + 2 <= DSP_WORK_RAM_BASE + 0x1FFE);
+
+		for(uint32_t pc=dsp_pc; dspSpinSafe && pc<=branchPC+2;)
+		{
+			uint32_t index = GET16(dsp_ram_8, pc - DSP_WORK_RAM_BASE) >> 10;
+			dspSpinSafe = dsp_spin_safe[index];
+			pc += (index == 38 ? 6 : 2);		// MOVEI has 32 bits of immediate data
+		}
 	}
-#endif
-//There is *no* good reason to do this here!
-//	DSPHandleIRQs();
-	dsp_releaseTimeSlice_flag = 0;
-	dsp_in_exec++;
+	else if (!dspSpinSafe)
+		return false;
+	else if (dspSpinFlags == ((dsp_flag_n << 2) | (dsp_flag_c << 1) | dsp_flag_z)
+		&& memcmp(dsp_reg, dspSpinRegs, sizeof(dspSpinRegs)) == 0)
+	{
+		for(uint32_t i=0; i<numDSPSpinsReported; i++)
+		{
+			if (dspSpinReported[i] == dsp_pc)
+				return true;
+		}
 
-	while (cycles > 0 && DSP_RUNNING)
+		WriteLog("DSP: Spin loop detected at $%06X\n", dsp_pc);
+
+		if (numDSPSpinsReported < DSP_SPIN_REPORTS)
+			dspSpinReported[numDSPSpinsReported++] = dsp_pc;
+
+		return true;
+	}
+
+	if (dspSpinSafe)
 	{
-/*extern uint32_t totalFrames;
-//F1B2F6: LOAD   (R14+$04), R24 [NCZ:001, R14+$04=00F20018, R24=FFFFFFFF] -> Jaguar: Unknown word read at 00F20018 by DSP (M68K PC=00E32E)
-//-> 43 + 1 + 24 -> $2B + $01 + $18 -> 101011 00001 11000 -> 1010 1100 0011 1000 -> AC38
-//C470 -> 1100 0100 0111 0000 -> 110001 00011 10000 -> 49, 3, 16 -> STORE R16, (R14+$0C)
-//F1B140:
-if (totalFrames >= 377 && GET16(dsp_ram_8, 0x0002F6) == 0xAC38 && dsp_pc == 0xF1B140)
-{
-	doDSPDis = true;
-	WriteLog("Starting disassembly at frame #%u...\n", totalFrames);
+		dspSpinFlags = (dsp_flag_n << 2) | (dsp_flag_c << 1) | dsp_flag_z;
+		memcpy(dspSpinRegs, dsp_reg, sizeof(dspSpinRegs));
+	}
+
+	dspSideEffect = false;
+	return false;
 }
-if (dsp_pc == 0xF1B092)
-	doDSPDis = false;//*/
-/*if (dsp_pc == 0xF1B140)
-	doDSPDis = true;//*/
 
-		if (IMASKCleared)						// If IMASK was cleared,
-		{
-#ifdef DSP_DEBUG_IRQ
-			WriteLog("DSP: Finished interrupt. PC=$%06X\n", dsp_pc);
-#endif
-			DSPHandleIRQsNP();					// See if any other interrupts are pending!
-			IMASKCleared = false;
-		}
 
-/*if (badWrite)
+//
+// DSP recompiler
+//
+// Works just like the GPU's (see GPUJITCompile() in gpu.cpp), only for code in
+// the DSP's 8K of local RAM & with vjs.useDSPJIT on. On top of the ops the GPU
+// does natively, the sound code staples get done natively too: ADDQMOD &
+// SUBQMOD (thru D_MOD), SAT16S & SAT32S, MIRROR, and the multiplies that feed
+// the accumulator (IMULTN, IMACN & RESMAC). The one thing the GPU doesn't have
+// to worry about is IMASK getting cleared by a store to D_FLAGS; the
+// interpreter checks for pending interrupts before every instruction when that
+// happens, so we bail out to it after any handler that sets IMASKCleared.
+//
+// Register usage is the same: RBX points at dsp_reg, R12 at dsp_pc & R13 holds
+// a JUMP's target across its delay slot. A block returns the address of the
+// last instruction it ran, and leaves the cycles it used in dspJITCycles.
+//
+#ifdef JIT_X86_64
+#define DSP_JIT_CODE_SIZE	0x100000
+#define DSP_JIT_SLOP		0x4000			// More than the biggest block can take
+#define DSP_JIT_MAX_OPS		64
+#define DSP_JIT_MIN_CYCLES	DSP_JIT_MAX_OPS	// Not worth translating with less left
+
+#define DSP_JIT_VAR(v)		R12, (int32_t)((uint8_t *)&(v) - (uint8_t *)&dsp_pc)
+#define DSP_JIT_REG(r)		RBX, (int32_t)((r) * 4)
+
+struct DSPJITBlock
 {
-	WriteLog("\nDSP: Encountered bad write in Atari Synth module. PC=%08X, R15=%08X\n", dsp_pc, dsp_reg[15]);
-	for(int i=0; i<80; i+=4)
-		WriteLog("     %08X: %08X\n", dsp_reg[15]+i, JaguarReadLong(dsp_reg[15]+i));
-	WriteLog("\n");
-}//*/
-/*if (dsp_pc == 0xF1B55E)
+	uint32_t (* code)(void);					// NULL if there's no translation
+	int32_t cycles;								// What running all of it costs
+};
+
+struct DSPJITExit
 {
-	WriteLog("DSP: At $F1B55E--R15 = %08X at %u ms%s...\n", dsp_reg[15], SDL_GetTicks(), (dsp_flags & IMASK ? " (inside interrupt)" : ""));
-}//*/
-/*if (dsp_pc == 0xF1B7D2)	// Start here???
-	doDSPDis = true;
-pcQueue[ptrPCQ++] = dsp_pc;
-ptrPCQ %= 32;*/
-		uint16_t opcode = DSPReadWord(dsp_pc, DSP);
-		uint32_t index = opcode >> 10;
-		dsp_opcode_first_parameter = (opcode >> 5) & 0x1F;
-		dsp_opcode_second_parameter = opcode & 0x1F;
-		dsp_pc += 2;
-		dsp_opcode[index]();
-		dsp_opcode_use[index]++;
-		cycles -= dsp_opcode_cycles[index];
-/*if (dsp_reg_bank_0[20] == 0xF1A100 & !R20Set)
+	uint8_t * jump;
+	uint32_t pc;
+	int32_t cycles;
+};
+
+static PER_MACHINE DSPJITBlock dspJITBlocks[0x1000];
+static PER_MACHINE uint8_t * dspJITCode = NULL;
+static PER_MACHINE uint32_t dspJITCodeUsed = 0;
+static PER_MACHINE bool dspJITBroken = false;	// Couldn't get going; don't try again
+static PER_MACHINE int32_t dspJITCycles;
+static PER_MACHINE uint32_t dspJITBlocksTranslated = 0;
+static PER_MACHINE uint32_t dspJITFlushes = 0;
+
+
+static void DSPJITFlush(void)
 {
-	WriteLog("DSP: R20 set to $F1A100 at %u ms%s...\n", SDL_GetTicks(), (dsp_flags & IMASK ? " (inside interrupt)" : ""));
-	R20Set = true;
+	memset(dspJITBlocks, 0, sizeof(dspJITBlocks));
+	memset(dspJITCovered, 0, sizeof(dspJITCovered));
+	dspJITCodeUsed = 0;
+	dspJITFlushPending = false;
+	dspJITFlushes++;
 }
-if (dsp_reg_bank_0[20] != 0xF1A100 && R20Set)
+
+
+// Everything translated code touches has to be within 2 GB of dsp_pc
+static bool DSPJITReachable(void * var)
 {
-	WriteLog("DSP: R20 corrupted at %u ms from starting%s!\nAborting!\n", SDL_GetTicks(), (dsp_flags & IMASK ? " (inside interrupt)" : ""));
-	DSPDumpRegisters();
-	DSPDumpDisassembly();
-	exit(1);
+	int64_t disp = (uint8_t *)var - (uint8_t *)&dsp_pc;
+
+	return (disp >= INT32_MIN && disp <= INT32_MAX);
 }
-if ((dsp_pc < 0xF1B000 || dsp_pc > 0xF1CFFE) && !tripwire)
+
+
+static void DSPJITSetZN(uint8_t *& p)
 {
-	char buffer[512];
-	WriteLog("DSP: Jumping outside of DSP RAM at %u ms. Register dump:\n", SDL_GetTicks());
-	DSPDumpRegisters();
-	tripwire = true;
-	WriteLog("\nBacktrace:\n");
-	for(int i=0; i<32; i++)
-	{
-		dasmjag(JAGUAR_DSP, buffer, pcQueue[(ptrPCQ + i) % 32]);
-		WriteLog("\t%08X: %s\n", pcQueue[(ptrPCQ + i) % 32], buffer);
-	}
-	WriteLog("\n");
-}*/
-	}
+	JITSetccMem(p, CC_Z, DSP_JIT_VAR(dsp_flag_z));
+	JITSetccMem(p, CC_S, DSP_JIT_VAR(dsp_flag_n));
+}
 
-	dsp_in_exec--;
+
+static void DSPJITSetZNC(uint8_t *& p)
+{
+	JITSetccMem(p, CC_C, DSP_JIT_VAR(dsp_flag_c));
+	DSPJITSetZN(p);
 }
 
 
-//
-// DSP opcode handlers
-//
+static void DSPJITEmitReturn(uint8_t *& p, uint32_t lastPC, int32_t cycles)
+{
+	JITStoreImm(p, DSP_JIT_VAR(dspJITCycles), cycles);
+	JITMovRegImm(p, RAX, lastPC);
+	JITAdjustStack(p, 32);
+	JITPop(p, R13);
+	JITPop(p, R12);
+	JITPop(p, RBX);
+	JITRet(p);
+}
 
-// There is a problem here with interrupt handlers the JUMP and JR instructions that
-// can cause trouble because an interrupt can occur *before* the instruction following the
-// jump can execute... !!! FIX !!!
-static void dsp_opcode_jump(void)
+
+static void DSPJITEmitShift(uint8_t *& p, int op, uint32_t reg, uint8_t count, uint8_t carryBit)
 {
-#ifdef DSP_DIS_JUMP
-const char * condition[32] =
-{	"T", "nz", "z", "???", "nc", "nc nz", "nc z", "???", "c", "c nz",
-	"c z", "???", "???", "???", "???", "???", "???", "???", "???",
-	"???", "nn", "nn nz", "nn z", "???", "n", "n nz", "n z", "???",
-	"???", "???", "???", "F" };
-	if (doDSPDis)
-		WriteLog("%06X: JUMP   %s, (R%02u) [NCZ:%u%u%u, R%02u=%08X] ", dsp_pc-2, condition[IMM_2], IMM_1, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM);
-#endif
-	// normalize flags
-/*	dsp_flag_c=dsp_flag_c?1:0;
-	dsp_flag_z=dsp_flag_z?1:0;
-	dsp_flag_n=dsp_flag_n?1:0;*/
-	// KLUDGE: Used by BRANCH_CONDITION
-	uint32_t jaguar_flags = (dsp_flag_n << 2) | (dsp_flag_c << 1) | dsp_flag_z;
+	JITLoad(p, RAX, DSP_JIT_REG(reg));
+	JITBtRegImm(p, RAX, carryBit);
+	JITSetccMem(p, CC_C, DSP_JIT_VAR(dsp_flag_c));
+	JITShiftRegImm(p, op, RAX, count);
+	JITTestRegReg(p, RAX, RAX);
+	DSPJITSetZN(p);
+	JITStore(p, DSP_JIT_REG(reg), RAX);
+}
+
 
-	if (BRANCH_CONDITION(IMM_2))
+//
+// MULT, IMULT & friends only look at the low words of their operands; the
+// product ends up in EAX (with the flags set from it)
+//
+static void DSPJITEmitMultiply(uint8_t *& p, uint32_t reg1, uint32_t reg2, bool isSigned)
+{
+	if (isSigned)
 	{
-#ifdef DSP_DIS_JUMP
-	if (doDSPDis)
-		WriteLog("Branched!\n");
-#endif
-		uint32_t delayed_pc = RM;
-		DSPExec(1);
-		dsp_pc = delayed_pc;
+		JITLoadS16(p, RAX, DSP_JIT_REG(reg2));
+		JITLoadS16(p, RCX, DSP_JIT_REG(reg1));
 	}
-#ifdef DSP_DIS_JUMP
 	else
-		if (doDSPDis)
-			WriteLog("Branch NOT taken.\n");
-#endif
+	{
+		JITLoadU16(p, RAX, DSP_JIT_REG(reg2));
+		JITLoadU16(p, RCX, DSP_JIT_REG(reg1));
+	}
+
+	JITImulRegReg(p, RAX, RCX);
+	JITTestRegReg(p, RAX, RAX);
 }
 
 
-static void dsp_opcode_jr(void)
+//
+// Translate an instruction into native code, if it's one we know how to do.
+// These have to match their handlers (mostly in risc.h) exactly!
+//
+static bool DSPJITEmitNative(uint8_t *& p, uint32_t pc, uint16_t opcode)
 {
-#ifdef DSP_DIS_JR
-const char * condition[32] =
-{	"T", "nz", "z", "???", "nc", "nc nz", "nc z", "???", "c", "c nz",
-	"c z", "???", "???", "???", "???", "???", "???", "???", "???",
-	"???", "nn", "nn nz", "nn z", "???", "n", "n nz", "n z", "???",
-	"???", "???", "???", "F" };
-	if (doDSPDis)
-		WriteLog("%06X: JR     %s, %06X [NCZ:%u%u%u] ", dsp_pc-2, condition[IMM_2], dsp_pc+((IMM_1 & 0x10 ? 0xFFFFFFF0 | IMM_1 : IMM_1) * 2), dsp_flag_n, dsp_flag_c, dsp_flag_z);
-#endif
-	// normalize flags
-/*	dsp_flag_c=dsp_flag_c?1:0;
-	dsp_flag_z=dsp_flag_z?1:0;
-	dsp_flag_n=dsp_flag_n?1:0;*/
-	// KLUDGE: Used by BRANCH_CONDITION
-	uint32_t jaguar_flags = (dsp_flag_n << 2) | (dsp_flag_c << 1) | dsp_flag_z;
+	uint32_t imm1 = (opcode >> 5) & 0x1F, imm2 = opcode & 0x1F;
 
-	if (BRANCH_CONDITION(IMM_2))
+	switch (opcode >> 10)
 	{
-#ifdef DSP_DIS_JR
-	if (doDSPDis)
-		WriteLog("Branched!\n");
-#endif
-		int32_t offset = (IMM_1 & 0x10 ? 0xFFFFFFF0 | IMM_1 : IMM_1);		// Sign extend IMM_1
-		int32_t delayed_pc = dsp_pc + (offset * 2);
-		DSPExec(1);
-		dsp_pc = delayed_pc;
+	case 0:										// ADD Rm, Rn
+	case 4:										// SUB Rm, Rn
+		JITLoad(p, RAX, DSP_JIT_REG(imm2));
+		JITAluRegMem(p, ((opcode >> 10) == 0 ? ALU_ADD : ALU_SUB), RAX, DSP_JIT_REG(imm1));
+		DSPJITSetZNC(p);
+		JITStore(p, DSP_JIT_REG(imm2), RAX);
+		break;
+	case 2:										// ADDQ #n, Rn
+		JITAluMemImm(p, ALU_ADD, DSP_JIT_REG(imm2), riscConvertZero[imm1]);
+		DSPJITSetZNC(p);
+		break;
+	case 3:										// ADDQT #n, Rn
+		JITAluMemImm(p, ALU_ADD, DSP_JIT_REG(imm2), riscConvertZero[imm1]);
+		break;
+	case 6:										// SUBQ #n, Rn
+		JITAluMemImm(p, ALU_SUB, DSP_JIT_REG(imm2), riscConvertZero[imm1]);
+		DSPJITSetZNC(p);
+		break;
+	case 7:										// SUBQT #n, Rn
+		JITAluMemImm(p, ALU_SUB, DSP_JIT_REG(imm2), riscConvertZero[imm1]);
+		break;
+	case 8:										// NEG Rn
+		JITNegMem(p, DSP_JIT_REG(imm2));
+		DSPJITSetZNC(p);
+		break;
+	case 9:										// AND Rm, Rn
+	case 10:									// OR Rm, Rn
+	case 11:									// XOR Rm, Rn
+		JITLoad(p, RAX, DSP_JIT_REG(imm1));
+		JITAluMemReg(p, ((opcode >> 10) == 9 ? ALU_AND : (opcode >> 10) == 10 ? ALU_OR : ALU_XOR), DSP_JIT_REG(imm2), RAX);
+		DSPJITSetZN(p);
+		break;
+	case 12:									// NOT Rn
+		JITLoad(p, RAX, DSP_JIT_REG(imm2));
+		JITNotReg(p, RAX);
+		JITStore(p, DSP_JIT_REG(imm2), RAX);
+		JITTestRegReg(p, RAX, RAX);
+		DSPJITSetZN(p);
+		break;
+	case 13:									// BTST #n, Rn
+		JITTestMemImm(p, DSP_JIT_REG(imm2), 1 << imm1);
+		JITSetccMem(p, CC_Z, DSP_JIT_VAR(dsp_flag_z));
+		break;
+	case 14:									// BSET #n, Rn
+		JITAluMemImm(p, ALU_OR, DSP_JIT_REG(imm2), 1 << imm1);
+		DSPJITSetZN(p);
+		break;
+	case 15:									// BCLR #n, Rn
+		JITAluMemImm(p, ALU_AND, DSP_JIT_REG(imm2), ~(1 << imm1));
+		DSPJITSetZN(p);
+		break;
+	case 16:									// MULT Rm, Rn
+	case 17:									// IMULT Rm, Rn
+		DSPJITEmitMultiply(p, imm1, imm2, (opcode >> 10) == 17);
+		DSPJITSetZN(p);
+		JITStore(p, DSP_JIT_REG(imm2), RAX);
+		break;
+	case 18:									// IMULTN Rm, Rn
+		DSPJITEmitMultiply(p, imm1, imm2, true);
+		DSPJITSetZN(p);
+		JITSignExtend64(p, RAX);
+		JITStore64(p, DSP_JIT_VAR(dsp_acc), RAX);
+		break;
+	case 19:									// RESMAC Rn
+		JITLoad(p, RAX, DSP_JIT_VAR(dsp_acc));
+		JITStore(p, DSP_JIT_REG(imm2), RAX);
+		break;
+	case 20:									// IMACN Rm, Rn
+		DSPJITEmitMultiply(p, imm1, imm2, true);
+		JITSignExtend64(p, RAX);
+		JITAluMemReg64(p, ALU_ADD, DSP_JIT_VAR(dsp_acc), RAX);
+		break;
+	case 24:									// SHLQ #n, Rn
+		// SHLQ #32 & friends are left to the handlers, whatever they do
+		if (imm1 == 0)
+			return false;
+
+		DSPJITEmitShift(p, SHIFT_SHL, imm2, 32 - imm1, 31);
+		break;
+	case 25:									// SHRQ #n, Rn
+		if (imm1 == 0)
+			return false;
+
+		DSPJITEmitShift(p, SHIFT_SHR, imm2, imm1, 0);
+		break;
+	case 27:									// SHARQ #n, Rn
+		if (imm1 == 0)
+			return false;
+
+		DSPJITEmitShift(p, SHIFT_SAR, imm2, imm1, 0);
+		break;
+	case 29:									// RORQ #n, Rn
+		if (imm1 == 0)
+			return false;
+
+		DSPJITEmitShift(p, SHIFT_ROR, imm2, imm1, 31);
+		break;
+	case 30:									// CMP Rm, Rn
+		JITLoad(p, RAX, DSP_JIT_REG(imm2));
+		JITAluRegMem(p, ALU_CMP, RAX, DSP_JIT_REG(imm1));
+		DSPJITSetZNC(p);
+		break;
+	case 31:									// CMPQ #n, Rn
+		JITAluMemImm(p, ALU_CMP, DSP_JIT_REG(imm2), (imm1 & 0x10 ? 0xFFFFFFF0 | imm1 : imm1));
+		DSPJITSetZNC(p);
+		break;
+	case 32:									// SUBQMOD #n, Rn
+	case 63:									// ADDQMOD #n, Rn
+		// The carry comes from the whole add; the bits in D_MOD are kept from Rn
+		JITLoad(p, RAX, DSP_JIT_REG(imm2));
+		JITMovRegReg(p, RCX, RAX);
+		JITAluRegImm(p, ((opcode >> 10) == 63 ? ALU_ADD : ALU_SUB), RCX, riscConvertZero[imm1]);
+		JITSetccMem(p, CC_C, DSP_JIT_VAR(dsp_flag_c));
+		JITLoad(p, RDX, DSP_JIT_VAR(dsp_modulo));
+		JITAluRegReg(p, ALU_AND, RAX, RDX);
+		JITNotReg(p, RDX);
+		JITAluRegReg(p, ALU_AND, RCX, RDX);
+		JITAluRegReg(p, ALU_OR, RCX, RAX);
+		DSPJITSetZN(p);
+		JITStore(p, DSP_JIT_REG(imm2), RCX);
+		break;
+	case 33:									// SAT16S Rn
+		JITLoad(p, RCX, DSP_JIT_REG(imm2));
+		JITMovRegImm(p, RDX, 0xFFFF8000);
+		JITAluRegReg(p, ALU_CMP, RCX, RDX);
+		JITCmov(p, CC_L, RCX, RDX);
+		JITMovRegImm(p, RDX, 0x00007FFF);
+		JITAluRegReg(p, ALU_CMP, RCX, RDX);
+		JITCmov(p, CC_G, RCX, RDX);
+		JITTestRegReg(p, RCX, RCX);
+		DSPJITSetZN(p);
+		JITStore(p, DSP_JIT_REG(imm2), RCX);
+		break;
+	case 34:									// MOVE Rm, Rn
+		JITLoad(p, RAX, DSP_JIT_REG(imm1));
+		JITStore(p, DSP_JIT_REG(imm2), RAX);
+		break;
+	case 35:									// MOVEQ #n, Rn
+		JITStoreImm(p, DSP_JIT_REG(imm2), imm1);
+		break;
+	case 36:									// MOVETA Rm, Rn
+		JITLoad64(p, RCX, DSP_JIT_VAR(dsp_alternate_reg));
+		JITLoad(p, RAX, DSP_JIT_REG(imm1));
+		JITStore(p, RCX, imm2 * 4, RAX);
+		break;
+	case 37:									// MOVEFA Rm, Rn
+		JITLoad64(p, RCX, DSP_JIT_VAR(dsp_alternate_reg));
+		JITLoad(p, RAX, RCX, imm1 * 4);
+		JITStore(p, DSP_JIT_REG(imm2), RAX);
+		break;
+	case 38:									// MOVEI #n, Rn
+		JITStoreImm(p, DSP_JIT_REG(imm2), (uint32_t)GET16(dsp_ram_8, pc + 2 - DSP_WORK_RAM_BASE)
+			| ((uint32_t)GET16(dsp_ram_8, pc + 4 - DSP_WORK_RAM_BASE) << 16));
+		break;
+	case 42:									// SAT32S Rn
+		// Saturates on the top 32 bits of the accumulator
+		JITLoad64(p, RAX, DSP_JIT_VAR(dsp_acc));
+		JITShiftReg64Imm(p, SHIFT_SHR, RAX, 32);
+		JITLoad(p, RCX, DSP_JIT_REG(imm2));
+		JITMovRegImm(p, RDX, 0x80000000);
+		JITAluRegImm(p, ALU_CMP, RAX, 0xFFFFFFFF);
+		JITCmov(p, CC_L, RCX, RDX);
+		JITMovRegImm(p, RDX, 0x7FFFFFFF);
+		JITTestRegReg(p, RAX, RAX);
+		JITCmov(p, CC_G, RCX, RDX);
+		JITTestRegReg(p, RCX, RCX);
+		DSPJITSetZN(p);
+		JITStore(p, DSP_JIT_REG(imm2), RCX);
+		break;
+	case 48:									// MIRROR Rn
+		// Bit reverses all 32 bits: bytes, then nybbles, bit pairs & bits
+		JITLoad(p, RAX, DSP_JIT_REG(imm2));
+		JITBswap(p, RAX);
+
+		for(int i=4; i>0; i>>=1)
+		{
+			uint32_t mask = (i == 4 ? 0x0F0F0F0F : i == 2 ? 0x33333333 : 0x55555555);
+			JITMovRegReg(p, RCX, RAX);
+			JITShiftRegImm(p, SHIFT_SHR, RAX, i);
+			JITAluRegImm(p, ALU_AND, RAX, mask);
+			JITAluRegImm(p, ALU_AND, RCX, mask);
+			JITShiftRegImm(p, SHIFT_SHL, RCX, i);
+			JITAluRegReg(p, ALU_OR, RAX, RCX);
+		}
+
+		DSPJITSetZN(p);
+		JITStore(p, DSP_JIT_REG(imm2), RAX);
+		break;
+	case 51:									// MOVE PC, Rn
+		JITStoreImm(p, DSP_JIT_REG(imm2), pc);
+		break;
+	case 57:									// NOP
+		break;
+	default:
+		return false;
 	}
-#ifdef DSP_DIS_JR
-	else
-		if (doDSPDis)
-			WriteLog("Branch NOT taken.\n");
-#endif
+
+	return true;
 }
 
 
-static void dsp_opcode_add(void)
-{
-#ifdef DSP_DIS_ADD
-	if (doDSPDis)
-		WriteLog("%06X: ADD    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN + RM;
-	SET_ZNC_ADD(RN, RM, res);
-	RN = res;
-#ifdef DSP_DIS_ADD
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
+//
+// Anything we can't do natively goes thru its handler
+//
+static void DSPJITEmitCall(uint8_t *& p, uint32_t pc, uint16_t opcode, int32_t cycles,
+	DSPJITExit * exits, int & numExits)
+{
+	JITStoreImm(p, DSP_JIT_VAR(dsp_pc), pc + 2);
+	JITStoreImm(p, DSP_JIT_VAR(dsp_opcode_first_parameter), (opcode >> 5) & 0x1F);
+	JITStoreImm(p, DSP_JIT_VAR(dsp_opcode_second_parameter), opcode & 0x1F);
+	JITCall(p, (void *)dsp_opcode[opcode >> 10]);
+	JITLoad64(p, RBX, DSP_JIT_VAR(dsp_reg));
+
+	JITAluMemImm(p, ALU_CMP, DSP_JIT_VAR(dsp_pc), pc + 2);
+	exits[numExits].jump = JITJcc(p, CC_NZ);
+	exits[numExits].pc = pc, exits[numExits++].cycles = cycles;
+	JITTestMemImm(p, DSP_JIT_VAR(dsp_control), 0x01);
+	exits[numExits].jump = JITJcc(p, CC_Z);
+	exits[numExits].pc = pc, exits[numExits++].cycles = cycles;
+	JITAluMemImm8(p, ALU_CMP, DSP_JIT_VAR(dspJITFlushPending), 0);
+	exits[numExits].jump = JITJcc(p, CC_NZ);
+	exits[numExits].pc = pc, exits[numExits++].cycles = cycles;
+	JITAluMemImm8(p, ALU_CMP, DSP_JIT_VAR(IMASKCleared), 0);
+	exits[numExits].jump = JITJcc(p, CC_NZ);
+	exits[numExits].pc = pc, exits[numExits++].cycles = cycles;
 }
 
 
-static void dsp_opcode_addc(void)
+//
+// JUMP & JR: the condition's done natively, the delay slot thru DSPExec(1).
+// Either way, this is the end of the block.
+//
+static void DSPJITEmitBranch(uint8_t *& p, uint32_t pc, uint16_t opcode, int32_t cycles)
 {
-#ifdef DSP_DIS_ADDC
-	if (doDSPDis)
-		WriteLog("%06X: ADDC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN + RM + dsp_flag_c;
-	uint32_t carry = dsp_flag_c;
-//	SET_ZNC_ADD(RN, RM, res); //???BUG??? Yes!
-	SET_ZNC_ADD(RN + carry, RM, res);
-//	SET_ZNC_ADD(RN, RM + carry, res);
-	RN = res;
-#ifdef DSP_DIS_ADDC
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+	uint32_t imm1 = (opcode >> 5) & 0x1F, condition = opcode & 0x1F;
+	uint8_t & flag = (condition & 0x10 ? dsp_flag_n : dsp_flag_c);
+	uint8_t * notTaken[4];
+	int numNotTaken = 0;
 
+	if (condition & 0x01)
+	{
+		JITAluMemImm8(p, ALU_CMP, DSP_JIT_VAR(dsp_flag_z), 0);
+		notTaken[numNotTaken++] = JITJcc(p, CC_NZ);
+	}
 
-static void dsp_opcode_addq(void)
-{
-#ifdef DSP_DIS_ADDQ
-	if (doDSPDis)
-		WriteLog("%06X: ADDQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = dsp_convert_zero[IMM_1];
-	uint32_t res = RN + r1;
-	CLR_ZNC; SET_ZNC_ADD(RN, r1, res);
-	RN = res;
-#ifdef DSP_DIS_ADDQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	if (condition & 0x02)
+	{
+		JITAluMemImm8(p, ALU_CMP, DSP_JIT_VAR(dsp_flag_z), 0);
+		notTaken[numNotTaken++] = JITJcc(p, CC_Z);
+	}
 
+	if (condition & 0x04)
+	{
+		JITAluMemImm8(p, ALU_CMP, DSP_JIT_VAR(flag), 0);
+		notTaken[numNotTaken++] = JITJcc(p, CC_NZ);
+	}
 
-static void dsp_opcode_sub(void)
-{
-#ifdef DSP_DIS_SUB
-	if (doDSPDis)
-		WriteLog("%06X: SUB    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN - RM;
-	SET_ZNC_SUB(RN, RM, res);
-	RN = res;
-#ifdef DSP_DIS_SUB
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+	if (condition & 0x08)
+	{
+		JITAluMemImm8(p, ALU_CMP, DSP_JIT_VAR(flag), 0);
+		notTaken[numNotTaken++] = JITJcc(p, CC_Z);
+	}
 
+	// JUMP's target is read before the delay slot runs
+	if ((opcode >> 10) == 52)
+		JITLoad(p, R13, DSP_JIT_REG(imm1));
 
-static void dsp_opcode_subc(void)
-{
-#ifdef DSP_DIS_SUBC
-	if (doDSPDis)
-		WriteLog("%06X: SUBC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	// This is how the DSP ALU does it--Two's complement with inverted carry
-	uint64_t res = (uint64_t)RN + (uint64_t)(RM ^ 0xFFFFFFFF) + (dsp_flag_c ^ 1);
-	// Carry out of the result is inverted too
-	dsp_flag_c = ((res >> 32) & 0x01) ^ 1;
-	RN = (res & 0xFFFFFFFF);
-	SET_ZN(RN);
-#ifdef DSP_DIS_SUBC
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+	JITStoreImm(p, DSP_JIT_VAR(dsp_pc), pc + 2);
+	JITMovRegImm(p, JIT_ARG0, 1);
+	JITCall(p, (void *)DSPExec);
 
+	if ((opcode >> 10) == 52)
+		JITStore(p, DSP_JIT_VAR(dsp_pc), R13);
+	else
+		JITStoreImm(p, DSP_JIT_VAR(dsp_pc), pc + 2 + ((imm1 & 0x10 ? 0xFFFFFFF0 | imm1 : imm1) * 2));
 
-static void dsp_opcode_subq(void)
-{
-#ifdef DSP_DIS_SUBQ
-	if (doDSPDis)
-		WriteLog("%06X: SUBQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = dsp_convert_zero[IMM_1];
-	uint32_t res = RN - r1;
-	SET_ZNC_SUB(RN, r1, res);
-	RN = res;
-#ifdef DSP_DIS_SUBQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	DSPJITEmitReturn(p, pc, cycles);
 
+	for(int i=0; i<numNotTaken; i++)
+		JITPatch(notTaken[i], p);
 
-static void dsp_opcode_cmp(void)
-{
-#ifdef DSP_DIS_CMP
-	if (doDSPDis)
-		WriteLog("%06X: CMP    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN - RM;
-	SET_ZNC_SUB(RN, RM, res);
-#ifdef DSP_DIS_CMP
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z);
-#endif
+	JITStoreImm(p, DSP_JIT_VAR(dsp_pc), pc + 2);
+	DSPJITEmitReturn(p, pc, cycles);
 }
 
 
-static void dsp_opcode_cmpq(void)
+//
+// Translate the block starting at pc (which has to be in local RAM)
+//
+static DSPJITBlock * DSPJITCompile(uint32_t pc)
 {
-	static int32_t sqtable[32] =
-		{ 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,-16,-15,-14,-13,-12,-11,-10,-9,-8,-7,-6,-5,-4,-3,-2,-1 };
-#ifdef DSP_DIS_CMPQ
-	if (doDSPDis)
-		WriteLog("%06X: CMPQ   #%d, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, sqtable[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = sqtable[IMM_1 & 0x1F]; // I like this better -> (INT8)(jaguar.op >> 2) >> 3;
-	uint32_t res = RN - r1;
-	SET_ZNC_SUB(RN, r1, res);
-#ifdef DSP_DIS_CMPQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z);
-#endif
-}
+	if (dspJITCode == NULL)
+	{
+		if (DSPJITReachable(&dsp_control) && DSPJITReachable(&dsp_flag_z)
+			&& DSPJITReachable(&dsp_flag_n) && DSPJITReachable(&dsp_flag_c)
+			&& DSPJITReachable(&dsp_reg) && DSPJITReachable(&dsp_alternate_reg)
+			&& DSPJITReachable(&dsp_acc) && DSPJITReachable(&dsp_modulo)
+			&& DSPJITReachable(&IMASKCleared)
+			&& DSPJITReachable(&dsp_opcode_first_parameter)
+			&& DSPJITReachable(&dsp_opcode_second_parameter)
+			&& DSPJITReachable(&dspJITCycles) && DSPJITReachable(&dspJITFlushPending))
+			dspJITCode = JITAlloc(DSP_JIT_CODE_SIZE);
+
+		if (dspJITCode == NULL)
+		{
+			WriteLog("DSP: Couldn't start the recompiler; interpreting instead\n");
+			dspJITBroken = true;
+			return NULL;
+		}
+	}
 
+	if (dspJITCodeUsed + DSP_JIT_SLOP > DSP_JIT_CODE_SIZE)
+		DSPJITFlush();
+
+	DSPJITBlock * block = &dspJITBlocks[(pc - DSP_WORK_RAM_BASE) >> 1];
+	uint8_t * start = dspJITCode + dspJITCodeUsed, * p = start;
+	DSPJITExit exits[DSP_JIT_MAX_OPS * 4];
+	int numExits = 0;
+	int32_t cycles = 0;
+	uint32_t lastPC = pc;
+	bool ended = false;
+
+	JITPush(p, RBX);
+	JITPush(p, R12);
+	JITPush(p, R13);
+	JITAdjustStack(p, -32);						// Keeps the stack aligned (& Win64 happy)
+	JITMovRegImm64(p, R12, (uint64_t)&dsp_pc);
+	JITLoad64(p, RBX, DSP_JIT_VAR(dsp_reg));
+
+	for(int i=0; i<DSP_JIT_MAX_OPS && !ended; i++)
+	{
+		uint16_t opcode = GET16(dsp_ram_8, pc - DSP_WORK_RAM_BASE);
+		uint32_t index = opcode >> 10;
+		uint32_t size = (index == 38 ? 6 : 2);	// MOVEI has 32 bits of immediate data
 
-static void dsp_opcode_and(void)
-{
-#ifdef DSP_DIS_AND
-	if (doDSPDis)
-		WriteLog("%06X: AND    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN & RM;
-	SET_ZN(RN);
-#ifdef DSP_DIS_AND
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+		if (pc + size > DSP_WORK_RAM_BASE + 0x2000)
+			break;
 
+		for(uint32_t j=0; j<size; j+=2)
+			dspJITCovered[(pc + j - DSP_WORK_RAM_BASE) >> 1] = 1;
 
-static void dsp_opcode_or(void)
-{
-#ifdef DSP_DIS_OR
-	if (doDSPDis)
-		WriteLog("%06X: OR     R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN | RM;
-	SET_ZN(RN);
-#ifdef DSP_DIS_OR
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+		cycles += dsp_opcode_cycles[index];
+		lastPC = pc;
 
+		if (index == 52 || index == 53)
+		{
+			DSPJITEmitBranch(p, pc, opcode, cycles);
+			ended = true;
+		}
+		else if (!DSPJITEmitNative(p, pc, opcode))
+			DSPJITEmitCall(p, pc, opcode, cycles, exits, numExits);
 
-static void dsp_opcode_xor(void)
-{
-#ifdef DSP_DIS_XOR
-	if (doDSPDis)
-		WriteLog("%06X: XOR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN ^ RM;
-	SET_ZN(RN);
-#ifdef DSP_DIS_XOR
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+		pc += size;
+	}
 
+	// Nothing fit (MOVEI at the very end of RAM); leave it to the interpreter
+	if (cycles == 0)
+		return NULL;
 
-static void dsp_opcode_not(void)
-{
-#ifdef DSP_DIS_NOT
-	if (doDSPDis)
-		WriteLog("%06X: NOT    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	RN = ~RN;
-	SET_ZN(RN);
-#ifdef DSP_DIS_NOT
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	if (!ended)
+	{
+		JITStoreImm(p, DSP_JIT_VAR(dsp_pc), pc);
+		DSPJITEmitReturn(p, lastPC, cycles);
+	}
 
+	// Bail outs after calls; they all leave dsp_pc alone
+	uint8_t * stub = NULL;
 
-static void dsp_opcode_move_pc(void)
-{
-	RN = dsp_pc - 2;
-}
+	for(int i=0; i<numExits; i++)
+	{
+		if (i == 0 || exits[i].pc != exits[i - 1].pc)
+		{
+			stub = p;
+			DSPJITEmitReturn(p, exits[i].pc, exits[i].cycles);
+		}
 
+		JITPatch(exits[i].jump, stub);
+	}
 
-static void dsp_opcode_store_r14_indexed(void)
-{
-#ifdef DSP_DIS_STORE14I
-	if (doDSPDis)
-		WriteLog("%06X: STORE  R%02u, (R14+$%02X) [NCZ:%u%u%u, R%02u=%08X, R14+$%02X=%08X]\n", dsp_pc-2, IMM_2, dsp_convert_zero[IMM_1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, dsp_convert_zero[IMM_1] << 2, dsp_reg[14]+(dsp_convert_zero[IMM_1] << 2));
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT_STORE
-	DSPWriteLong((dsp_reg[14] & 0xFFFFFFFC) + (dsp_convert_zero[IMM_1] << 2), RN, DSP);
-#else
-	DSPWriteLong(dsp_reg[14] + (dsp_convert_zero[IMM_1] << 2), RN, DSP);
-#endif
+	dspJITCodeUsed = (dspJITCodeUsed + (p - start) + 15) & ~15;
+	dspJITBlocksTranslated++;
+	block->code = (uint32_t (*)(void))start;
+	block->cycles = cycles;
+
+	return block;
 }
 
 
-static void dsp_opcode_store_r15_indexed(void)
+static void DSPJITDone(void)
 {
-#ifdef DSP_DIS_STORE15I
-	if (doDSPDis)
-		WriteLog("%06X: STORE  R%02u, (R15+$%02X) [NCZ:%u%u%u, R%02u=%08X, R15+$%02X=%08X]\n", dsp_pc-2, IMM_2, dsp_convert_zero[IMM_1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, dsp_convert_zero[IMM_1] << 2, dsp_reg[15]+(dsp_convert_zero[IMM_1] << 2));
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT_STORE
-	DSPWriteLong((dsp_reg[15] & 0xFFFFFFFC) + (dsp_convert_zero[IMM_1] << 2), RN, DSP);
-#else
-	DSPWriteLong(dsp_reg[15] + (dsp_convert_zero[IMM_1] << 2), RN, DSP);
-#endif
+	if (dspJITBlocksTranslated)
+		WriteLog("DSP: Recompiler translated %u blocks (code thrown away %u times)\n", dspJITBlocksTranslated, dspJITFlushes);
+
+	JITFree(dspJITCode, DSP_JIT_CODE_SIZE);
+	dspJITCode = NULL;
+	DSPJITFlush();
 }
 
 
-static void dsp_opcode_load_r14_ri(void)
+//
+// Only called from the outermost DSPExec(), so it's safe to throw the
+// translations away here
+//
+static inline DSPJITBlock * DSPJITLookup(uint32_t pc, int32_t cycles)
 {
-#ifdef DSP_DIS_LOAD14R
-	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R14+R%02u), R%02u [NCZ:%u%u%u, R14+R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM+dsp_reg[14], IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	RN = DSPReadLong((dsp_reg[14] + RM) & 0xFFFFFFFC, DSP);
-#else
-	RN = DSPReadLong(dsp_reg[14] + RM, DSP);
-#endif
-#ifdef DSP_DIS_LOAD14R
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	if (dspJITFlushPending)
+		DSPJITFlush();
 
+	DSPJITBlock * block = &dspJITBlocks[(pc - DSP_WORK_RAM_BASE) >> 1];
 
-static void dsp_opcode_load_r15_ri(void)
-{
-#ifdef DSP_DIS_LOAD15R
-	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R15+R%02u), R%02u [NCZ:%u%u%u, R15+R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM+dsp_reg[15], IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	RN = DSPReadLong((dsp_reg[15] + RM) & 0xFFFFFFFC, DSP);
-#else
-	RN = DSPReadLong(dsp_reg[15] + RM, DSP);
-#endif
-#ifdef DSP_DIS_LOAD15R
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	if (block->code == NULL && !dspJITBroken && cycles >= DSP_JIT_MIN_CYCLES)
+		return DSPJITCompile(pc);
+
+	return (block->code ? block : NULL);
 }
+#endif	// JIT_X86_64
 
 
-static void dsp_opcode_store_r14_ri(void)
-{
-	DSPWriteLong(dsp_reg[14] + RM, RN, DSP);
-}
-
-
-static void dsp_opcode_store_r15_ri(void)
-{
-	DSPWriteLong(dsp_reg[15] + RM, RN, DSP);
-}
-
-
-static void dsp_opcode_nop(void)
-{
-#ifdef DSP_DIS_NOP
-	if (doDSPDis)
-		WriteLog("%06X: NOP    [NCZ:%u%u%u]\n", dsp_pc-2, dsp_flag_n, dsp_flag_c, dsp_flag_z);
-#endif
-}
-
+//
+// DSP execution core
+//
+//static bool R20Set = false, tripwire = false;
+//static uint32_t pcQueue[32], ptrPCQ = 0;
 
-static void dsp_opcode_storeb(void)
+//
+// Same deal as the GPU: without debugHooks, the opcode stats are compiled out
+// (see JaguarUpdateDebugHooks())
+//
+template <bool debugHooks>
+static void DSPExecLoop(int32_t cycles)
 {
-#ifdef DSP_DIS_STOREB
-	if (doDSPDis)
-		WriteLog("%06X: STOREB R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_pc-2, IMM_2, IMM_1, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, IMM_1, RM);
-#endif
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		DSPWriteLong(RM, RN & 0xFF, DSP);
-	else
-		JaguarWriteByte(RM, RN, DSP);
-}
-
-
-static void dsp_opcode_storew(void)
+	while (cycles > 0 && DSP_RUNNING)
+	{
+/*extern uint32_t totalFrames;
+//F1B2F6: LOAD   (R14+$04), R24 [NCZ:001, R14+$04=00F20018, R24=FFFFFFFF] -> Jaguar: Unknown word read at 00F20018 by DSP (M68K PC=00E32E)
+//-> 43 + 1 + 24 -> $2B + $01 + $18 -> 101011 00001 11000 -> 1010 1100 0011 1000 -> AC38
+//C470 -> 1100 0100 0111 0000 -> 110001 00011 10000 -> 49, 3, 16 -> STORE R16, (R14+$0C)
+//F1B140:
+if (totalFrames >= 377 && GET16(dsp_ram_8, 0x0002F6) == 0xAC38 && dsp_pc == 0xF1B140)
 {
-#ifdef DSP_DIS_STOREW
-	if (doDSPDis)
-		WriteLog("%06X: STOREW R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_pc-2, IMM_2, IMM_1, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, IMM_1, RM);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT_STORE
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		DSPWriteLong(RM & 0xFFFFFFFE, RN & 0xFFFF, DSP);
-	else
-		JaguarWriteWord(RM & 0xFFFFFFFE, RN, DSP);
-#else
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		DSPWriteLong(RM, RN & 0xFFFF, DSP);
-	else
-		JaguarWriteWord(RM, RN, DSP);
-#endif
+	doDSPDis = true;
+	WriteLog("Starting disassembly at frame #%u...\n", totalFrames);
 }
+if (dsp_pc == 0xF1B092)
+	doDSPDis = false;//*/
+/*if (dsp_pc == 0xF1B140)
+	doDSPDis = true;//*/
 
-
-static void dsp_opcode_store(void)
-{
-#ifdef DSP_DIS_STORE
-	if (doDSPDis)
-		WriteLog("%06X: STORE  R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_pc-2, IMM_2, IMM_1, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, IMM_1, RM);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT_STORE
-	DSPWriteLong(RM & 0xFFFFFFFC, RN, DSP);
-#else
-	DSPWriteLong(RM, RN, DSP);
+		if (IMASKCleared)						// If IMASK was cleared,
+		{
+#ifdef DSP_DEBUG_IRQ
+			WriteLog("DSP: Finished interrupt. PC=$%06X\n", dsp_pc);
 #endif
-}
+			DSPHandleIRQsNP();					// See if any other interrupts are pending!
+			IMASKCleared = false;
+		}
 
+#ifdef JIT_X86_64
+		// Translated code gets first crack at it, unless we're in a delay slot
+		if (!debugHooks && vjs.useDSPJIT && dsp_in_exec == 1
+			&& (dsp_pc - DSP_WORK_RAM_BASE) < 0x2000 && !(dsp_pc & 0x01))
+		{
+			DSPJITBlock * block = DSPJITLookup(dsp_pc, cycles);
 
-static void dsp_opcode_loadb(void)
-{
-#ifdef DSP_DIS_LOADB
-	if (doDSPDis)
-		WriteLog("%06X: LOADB  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		RN = DSPReadLong(RM, DSP) & 0xFF;
-	else
-		RN = JaguarReadByte(RM, DSP);
-#ifdef DSP_DIS_LOADB
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+			if (block && block->cycles <= cycles)
+			{
+				uint32_t oldPC = block->code();
+				cycles -= dspJITCycles;
 
+				if ((dsp_pc <= oldPC) && ((oldPC - dsp_pc) <= DSP_SPIN_MAX_SIZE)
+					&& DSPCheckSpinLoop(oldPC))
+					cycles = 0;
 
-static void dsp_opcode_loadw(void)
-{
-#ifdef DSP_DIS_LOADW
-	if (doDSPDis)
-		WriteLog("%06X: LOADW  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		RN = DSPReadLong(RM & 0xFFFFFFFE, DSP) & 0xFFFF;
-	else
-		RN = JaguarReadWord(RM & 0xFFFFFFFE, DSP);
-#else
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		RN = DSPReadLong(RM, DSP) & 0xFFFF;
-	else
-		RN = JaguarReadWord(RM, DSP);
-#endif
-#ifdef DSP_DIS_LOADW
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+				continue;
+			}
+		}
 #endif
-}
-
 
-static void dsp_opcode_load(void)
+/*if (badWrite)
 {
-#ifdef DSP_DIS_LOAD
-	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	RN = DSPReadLong(RM & 0xFFFFFFFC, DSP);
-#else
-	RN = DSPReadLong(RM, DSP);
-#endif
-#ifdef DSP_DIS_LOAD
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void dsp_opcode_load_r14_indexed(void)
+	WriteLog("\nDSP: Encountered bad write in Atari Synth module. PC=%08X, R15=%08X\n", dsp_pc, dsp_reg[15]);
+	for(int i=0; i<80; i+=4)
+		WriteLog("     %08X: %08X\n", dsp_reg[15]+i, JaguarReadLong(dsp_reg[15]+i));
+	WriteLog("\n");
+}//*/
+/*if (dsp_pc == 0xF1B55E)
 {
-#ifdef DSP_DIS_LOAD14I
-	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R14+$%02X), R%02u [NCZ:%u%u%u, R14+$%02X=%08X, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1] << 2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, dsp_convert_zero[IMM_1] << 2, dsp_reg[14]+(dsp_convert_zero[IMM_1] << 2), IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	RN = DSPReadLong((dsp_reg[14] & 0xFFFFFFFC) + (dsp_convert_zero[IMM_1] << 2), DSP);
-#else
-	RN = DSPReadLong(dsp_reg[14] + (dsp_convert_zero[IMM_1] << 2), DSP);
-#endif
-#ifdef DSP_DIS_LOAD14I
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
-
+	WriteLog("DSP: At $F1B55E--R15 = %08X at %u ms%s...\n", dsp_reg[15], SDL_GetTicks(), (dsp_flags & IMASK ? " (inside interrupt)" : ""));
+}//*/
+/*if (dsp_pc == 0xF1B7D2)	// Start here???
+	doDSPDis = true;
+pcQueue[ptrPCQ++] = dsp_pc;
+ptrPCQ %= 32;*/
+		uint16_t opcode = DSPReadWord(dsp_pc, DSP);
+		uint32_t index = opcode >> 10;
+		dsp_opcode_first_parameter = (opcode >> 5) & 0x1F;
+		dsp_opcode_second_parameter = opcode & 0x1F;
+		uint32_t oldPC = dsp_pc;
+		dsp_pc += 2;
+		dsp_opcode[index]();
 
-static void dsp_opcode_load_r15_indexed(void)
-{
-#ifdef DSP_DIS_LOAD15I
-	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R15+$%02X), R%02u [NCZ:%u%u%u, R15+$%02X=%08X, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1] << 2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, dsp_convert_zero[IMM_1] << 2, dsp_reg[15]+(dsp_convert_zero[IMM_1] << 2), IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	RN = DSPReadLong((dsp_reg[15] & 0xFFFFFFFC) + (dsp_convert_zero[IMM_1] << 2), DSP);
-#else
-	RN = DSPReadLong(dsp_reg[15] + (dsp_convert_zero[IMM_1] << 2), DSP);
-#endif
-#ifdef DSP_DIS_LOAD15I
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+		if (debugHooks)
+			dsp_opcode_use[index]++;
 
+		cycles -= dsp_opcode_cycles[index];
 
-static void dsp_opcode_movei(void)
+		// Only short backward jumps are candidates
+		if ((dsp_pc <= oldPC) && ((oldPC - dsp_pc) <= DSP_SPIN_MAX_SIZE)
+			&& DSPCheckSpinLoop(oldPC))
+			cycles = 0;
+/*if (dsp_reg_bank_0[20] == 0xF1A100 & !R20Set)
 {
-#ifdef DSP_DIS_MOVEI
-	if (doDSPDis)
-		WriteLog("%06X: MOVEI  #$%08X, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, (uint32_t)DSPReadWord(dsp_pc) | ((uint32_t)DSPReadWord(dsp_pc + 2) << 16), IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	// This instruction is followed by 32-bit value in LSW / MSW format...
-	RN = (uint32_t)DSPReadWord(dsp_pc, DSP) | ((uint32_t)DSPReadWord(dsp_pc + 2, DSP) << 16);
-	dsp_pc += 4;
-#ifdef DSP_DIS_MOVEI
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	WriteLog("DSP: R20 set to $F1A100 at %u ms%s...\n", SDL_GetTicks(), (dsp_flags & IMASK ? " (inside interrupt)" : ""));
+	R20Set = true;
 }
-
-
-static void dsp_opcode_moveta(void)
+if (dsp_reg_bank_0[20] != 0xF1A100 && R20Set)
 {
-#ifdef DSP_DIS_MOVETA
-	if (doDSPDis)
-		WriteLog("%06X: MOVETA R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, ALTERNATE_RN);
-#endif
-	ALTERNATE_RN = RM;
-#ifdef DSP_DIS_MOVETA
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, ALTERNATE_RN);
-#endif
+	WriteLog("DSP: R20 corrupted at %u ms from starting%s!\nAborting!\n", SDL_GetTicks(), (dsp_flags & IMASK ? " (inside interrupt)" : ""));
+	DSPDumpRegisters();
+	DSPDumpDisassembly();
+	exit(1);
 }
-
-
-static void dsp_opcode_movefa(void)
+if ((dsp_pc < 0xF1B000 || dsp_pc > 0xF1CFFE) && !tripwire)
 {
-#ifdef DSP_DIS_MOVEFA
-	if (doDSPDis)
-		WriteLog("%06X: MOVEFA R%02u, R%02u [NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, ALTERNATE_RM, IMM_2, RN);
-#endif
-	RN = ALTERNATE_RM;
-#ifdef DSP_DIS_MOVEFA
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, ALTERNATE_RM, IMM_2, RN);
-#endif
+	char buffer[512];
+	WriteLog("DSP: Jumping outside of DSP RAM at %u ms. Register dump:\n", SDL_GetTicks());
+	DSPDumpRegisters();
+	tripwire = true;
+	WriteLog("\nBacktrace:\n");
+	for(int i=0; i<32; i++)
+	{
+		dasmjag(JAGUAR_DSP, buffer, pcQueue[(ptrPCQ + i) % 32]);
+		WriteLog("\t%08X: %s\n", pcQueue[(ptrPCQ + i) % 32], buffer);
+	}
+	WriteLog("\n");
+}*/
+	}
 }
 
 
-static void dsp_opcode_move(void)
+void DSPExec(int32_t cycles)
 {
-#ifdef DSP_DIS_MOVE
-	if (doDSPDis)
-		WriteLog("%06X: MOVE   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RM;
-#ifdef DSP_DIS_MOVE
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
+#ifdef DSP_SINGLE_STEPPING
+	if (dsp_control & 0x18)
+	{
+		cycles = 1;
+		dsp_control &= ~0x10;
+	}
 #endif
-}
+//There is *no* good reason to do this here!
+//	DSPHandleIRQs();
+	dsp_releaseTimeSlice_flag = 0;
 
+	// Delay slots are run through here too; don't lose track of the loop
+	if (!dsp_in_exec)
+		dspSpinHead = 0xFFFFFFFF;
 
-static void dsp_opcode_moveq(void)
-{
-#ifdef DSP_DIS_MOVEQ
-	if (doDSPDis)
-		WriteLog("%06X: MOVEQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	RN = IMM_1;
-#ifdef DSP_DIS_MOVEQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	dsp_in_exec++;
 
+	if (jaguarDebugHooks)
+		DSPExecLoop<true>(cycles);
+	else
+		DSPExecLoop<false>(cycles);
 
-static void dsp_opcode_resmac(void)
-{
-#ifdef DSP_DIS_RESMAC
-	if (doDSPDis)
-		WriteLog("%06X: RESMAC R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_ACC=%02X%08X] -> ", dsp_pc-2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
-#endif
-	RN = (uint32_t)dsp_acc;
-#ifdef DSP_DIS_RESMAC
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	dsp_in_exec--;
 }
 
 
-static void dsp_opcode_imult(void)
-{
-#ifdef DSP_DIS_IMULT
-	if (doDSPDis)
-		WriteLog("%06X: IMULT  R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = (int16_t)RN * (int16_t)RM;
-	SET_ZN(RN);
-#ifdef DSP_DIS_IMULT
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+//
+// DSP opcode handlers
+//
 
 
-static void dsp_opcode_mult(void)
+static void dsp_opcode_store_r14_indexed(void)
 {
-#ifdef DSP_DIS_MULT
+#ifdef DSP_DIS_STORE14I
 	if (doDSPDis)
-		WriteLog("%06X: MULT   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
+		WriteLog("%06X: STORE  R%02u, (R14+$%02X) [NCZ:%u%u%u, R%02u=%08X, R14+$%02X=%08X]\n", dsp_pc-2, IMM_2, riscConvertZero[IMM_1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, riscConvertZero[IMM_1] << 2, dsp_reg[14]+(riscConvertZero[IMM_1] << 2));
 #endif
-	RN = (uint16_t)RM * (uint16_t)RN;
-	SET_ZN(RN);
-#ifdef DSP_DIS_MULT
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
+#ifdef DSP_CORRECT_ALIGNMENT_STORE
+	DSPWriteLong((dsp_reg[14] & 0xFFFFFFFC) + (riscConvertZero[IMM_1] << 2), RN, DSP);
+#else
+	DSPWriteLong(dsp_reg[14] + (riscConvertZero[IMM_1] << 2), RN, DSP);
 #endif
 }
 
 
-static void dsp_opcode_bclr(void)
+static void dsp_opcode_store_r15_indexed(void)
 {
-#ifdef DSP_DIS_BCLR
+#ifdef DSP_DIS_STORE15I
 	if (doDSPDis)
-		WriteLog("%06X: BCLR   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+		WriteLog("%06X: STORE  R%02u, (R15+$%02X) [NCZ:%u%u%u, R%02u=%08X, R15+$%02X=%08X]\n", dsp_pc-2, IMM_2, riscConvertZero[IMM_1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, riscConvertZero[IMM_1] << 2, dsp_reg[15]+(riscConvertZero[IMM_1] << 2));
 #endif
-	uint32_t res = RN & ~(1 << IMM_1);
-	RN = res;
-	SET_ZN(res);
-#ifdef DSP_DIS_BCLR
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+#ifdef DSP_CORRECT_ALIGNMENT_STORE
+	DSPWriteLong((dsp_reg[15] & 0xFFFFFFFC) + (riscConvertZero[IMM_1] << 2), RN, DSP);
+#else
+	DSPWriteLong(dsp_reg[15] + (riscConvertZero[IMM_1] << 2), RN, DSP);
 #endif
 }
 
 
-static void dsp_opcode_btst(void)
+static void dsp_opcode_load_r14_ri(void)
 {
-#ifdef DSP_DIS_BTST
-	if (doDSPDis)
-		WriteLog("%06X: BTST   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	dsp_flag_z = (~RN >> IMM_1) & 1;
-#ifdef DSP_DIS_BTST
+#ifdef DSP_DIS_LOAD14R
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+		WriteLog("%06X: LOAD   (R14+R%02u), R%02u [NCZ:%u%u%u, R14+R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM+dsp_reg[14], IMM_2, RN);
 #endif
-}
-
-
-static void dsp_opcode_bset(void)
-{
-#ifdef DSP_DIS_BSET
-	if (doDSPDis)
-		WriteLog("%06X: BSET   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+#ifdef DSP_CORRECT_ALIGNMENT
+	RN = DSPReadLong((dsp_reg[14] + RM) & 0xFFFFFFFC, DSP);
+#else
+	RN = DSPReadLong(dsp_reg[14] + RM, DSP);
 #endif
-	uint32_t res = RN | (1 << IMM_1);
-	RN = res;
-	SET_ZN(res);
-#ifdef DSP_DIS_BSET
+#ifdef DSP_DIS_LOAD14R
 	if (doDSPDis)
 		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
 #endif
 }
 
 
-static void dsp_opcode_subqt(void)
+static void dsp_opcode_load_r15_ri(void)
 {
-#ifdef DSP_DIS_SUBQT
-	if (doDSPDis)
-		WriteLog("%06X: SUBQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	RN -= dsp_convert_zero[IMM_1];
-#ifdef DSP_DIS_SUBQT
+#ifdef DSP_DIS_LOAD15R
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+		WriteLog("%06X: LOAD   (R15+R%02u), R%02u [NCZ:%u%u%u, R15+R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM+dsp_reg[15], IMM_2, RN);
 #endif
-}
-
-
-static void dsp_opcode_addqt(void)
-{
-#ifdef DSP_DIS_ADDQT
-	if (doDSPDis)
-		WriteLog("%06X: ADDQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+#ifdef DSP_CORRECT_ALIGNMENT
+	RN = DSPReadLong((dsp_reg[15] + RM) & 0xFFFFFFFC, DSP);
+#else
+	RN = DSPReadLong(dsp_reg[15] + RM, DSP);
 #endif
-	RN += dsp_convert_zero[IMM_1];
-#ifdef DSP_DIS_ADDQT
+#ifdef DSP_DIS_LOAD15R
 	if (doDSPDis)
 		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
 #endif
 }
 
 
-static void dsp_opcode_imacn(void)
-{
-#ifdef DSP_DIS_IMACN
-	if (doDSPDis)
-		WriteLog("%06X: IMACN  R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	int32_t res = (int16_t)RM * (int16_t)RN;
-	dsp_acc += (int64_t)res;
-//Should we AND the result to fit into 40 bits here???
-#ifdef DSP_DIS_IMACN
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, DSP_ACC=%02X%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
-#endif
-}
-
-
-static void dsp_opcode_mtoi(void)
-{
-	RN = (((int32_t)RM >> 8) & 0xFF800000) | (RM & 0x007FFFFF);
-	SET_ZN(RN);
-}
-
-
-static void dsp_opcode_normi(void)
-{
-	uint32_t _Rm = RM;
-	uint32_t res = 0;
-
-	if (_Rm)
-	{
-		while ((_Rm & 0xffc00000) == 0)
-		{
-			_Rm <<= 1;
-			res--;
-		}
-		while ((_Rm & 0xff800000) != 0)
-		{
-			_Rm >>= 1;
-			res++;
-		}
-	}
-	RN = res;
-	SET_ZN(RN);
-}
-
-
-static void dsp_opcode_mmult(void)
-{
-	int count	= dsp_matrix_control&0x0f;
-	uint32_t addr = dsp_pointer_to_matrix; // in the dsp ram
-	int64_t accum = 0;
-	uint32_t res;
-
-	if (!(dsp_matrix_control & 0x10))
-	{
-		for (int i = 0; i < count; i++)
-		{
-			int16_t a;
-			if (i&0x01)
-				a=(int16_t)((dsp_alternate_reg[dsp_opcode_first_parameter + (i>>1)]>>16)&0xffff);
-			else
-				a=(int16_t)(dsp_alternate_reg[dsp_opcode_first_parameter + (i>>1)]&0xffff);
-			int16_t b=((int16_t)DSPReadWord(addr + 2, DSP));
-			accum += a*b;
-			addr += 4;
-		}
-	}
-	else
-	{
-		for (int i = 0; i < count; i++)
-		{
-			int16_t a;
-			if (i&0x01)
-				a=(int16_t)((dsp_alternate_reg[dsp_opcode_first_parameter + (i>>1)]>>16)&0xffff);
-			else
-				a=(int16_t)(dsp_alternate_reg[dsp_opcode_first_parameter + (i>>1)]&0xffff);
-			int16_t b=((int16_t)DSPReadWord(addr + 2, DSP));
-			accum += a*b;
-			addr += 4 * count;
-		}
-	}
-	RN = res = (int32_t)accum;
-	// carry flag to do
-//NOTE: The flags are set based upon the last add/multiply done...
-	SET_ZN(RN);
-}
-
-
-static void dsp_opcode_abs(void)
+static void dsp_opcode_store_r14_ri(void)
 {
-#ifdef DSP_DIS_ABS
-	if (doDSPDis)
-		WriteLog("%06X: ABS    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t _Rn = RN;
-	uint32_t res;
-
-	if (_Rn == 0x80000000)
-		dsp_flag_n = 1;
-	else
-	{
-		dsp_flag_c = ((_Rn & 0x80000000) >> 31);
-		res = RN = (_Rn & 0x80000000 ? -_Rn : _Rn);
-		CLR_ZN; SET_Z(res);
-	}
-#ifdef DSP_DIS_ABS
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	DSPWriteLong(dsp_reg[14] + RM, RN, DSP);
 }
 
 
-static void dsp_opcode_div(void)
-{
-#if 0
-	if (RM)
-	{
-		if (dsp_div_control & 0x01)		// 16.16 division
-		{
-			dsp_remain = ((uint64_t)RN << 16) % RM;
-			RN = ((uint64_t)RN << 16) / RM;
-		}
-		else
-		{
-			// We calculate the remainder first because we destroy RN after
-			// this by assigning it to itself.
-			dsp_remain = RN % RM;
-			RN = RN / RM;
-		}
-
-	}
-	else
-	{
-		// This is what happens according to SCPCD. NYAN!
-		RN = 0xFFFFFFFF;
-		dsp_remain = 0;
-	}
-#else
-	// Real algorithm, courtesy of SCPCD: NYAN!
-	uint32_t q = RN;
-	uint32_t r = 0;
-
-	// If 16.16 division, stuff top 16 bits of RN into remainder and put the
-	// bottom 16 of RN in top 16 of quotient
-	if (dsp_div_control & 0x01)
-		q <<= 16, r = RN >> 16;
-
-	for(int i=0; i<32; i++)
-	{
-//		uint32_t sign = (r >> 31) & 0x01;
-		uint32_t sign = r & 0x80000000;
-		r = (r << 1) | ((q >> 31) & 0x01);
-		r += (sign ? RM : -RM);
-		q = (q << 1) | (((~r) >> 31) & 0x01);
-	}
+static void dsp_opcode_store_r15_ri(void)
+{
+	DSPWriteLong(dsp_reg[15] + RM, RN, DSP);
+}
 
-	RN = q;
-	dsp_remain = r;
+
+static void dsp_opcode_storeb(void)
+{
+#ifdef DSP_DIS_STOREB
+	if (doDSPDis)
+		WriteLog("%06X: STOREB R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_pc-2, IMM_2, IMM_1, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, IMM_1, RM);
 #endif
+	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
+		DSPWriteLong(RM, RN & 0xFF, DSP);
+	else
+		JaguarWriteByte(RM, RN, DSP);
 }
 
 
-static void dsp_opcode_imultn(void)
+static void dsp_opcode_storew(void)
 {
-#ifdef DSP_DIS_IMULTN
+#ifdef DSP_DIS_STOREW
 	if (doDSPDis)
-		WriteLog("%06X: IMULTN R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
+		WriteLog("%06X: STOREW R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_pc-2, IMM_2, IMM_1, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, IMM_1, RM);
 #endif
-	// This is OK, since this multiply won't overflow 32 bits...
-	int32_t res = (int32_t)((int16_t)RN * (int16_t)RM);
-	dsp_acc = (int64_t)res;
-	SET_ZN(res);
-#ifdef DSP_DIS_IMULTN
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, DSP_ACC=%02X%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
+#ifdef DSP_CORRECT_ALIGNMENT_STORE
+	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
+		DSPWriteLong(RM & 0xFFFFFFFE, RN & 0xFFFF, DSP);
+	else
+		JaguarWriteWord(RM & 0xFFFFFFFE, RN, DSP);
+#else
+	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
+		DSPWriteLong(RM, RN & 0xFFFF, DSP);
+	else
+		JaguarWriteWord(RM, RN, DSP);
 #endif
 }
 
 
-static void dsp_opcode_neg(void)
+static void dsp_opcode_store(void)
 {
-#ifdef DSP_DIS_NEG
+#ifdef DSP_DIS_STORE
 	if (doDSPDis)
-		WriteLog("%06X: NEG    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+		WriteLog("%06X: STORE  R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_pc-2, IMM_2, IMM_1, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, IMM_1, RM);
 #endif
-	uint32_t res = -RN;
-	SET_ZNC_SUB(0, RN, res);
-	RN = res;
-#ifdef DSP_DIS_NEG
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+#ifdef DSP_CORRECT_ALIGNMENT_STORE
+	DSPWriteLong(RM & 0xFFFFFFFC, RN, DSP);
+#else
+	DSPWriteLong(RM, RN, DSP);
 #endif
 }
 
 
-static void dsp_opcode_shlq(void)
+static void dsp_opcode_loadb(void)
 {
-#ifdef DSP_DIS_SHLQ
+#ifdef DSP_DIS_LOADB
 	if (doDSPDis)
-		WriteLog("%06X: SHLQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, 32 - IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+		WriteLog("%06X: LOADB  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
 #endif
-	// NB: This instruction is the *only* one that does (32 - immediate data).
-	int32_t r1 = 32 - IMM_1;
-	uint32_t res = RN << r1;
-	SET_ZN(res); dsp_flag_c = (RN >> 31) & 1;
-	RN = res;
-#ifdef DSP_DIS_SHLQ
+	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
+		RN = DSPReadLong(RM, DSP) & 0xFF;
+	else
+		RN = JaguarReadByte(RM, DSP);
+#ifdef DSP_DIS_LOADB
 	if (doDSPDis)
 		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
 #endif
 }
 
 
-static void dsp_opcode_shrq(void)
+static void dsp_opcode_loadw(void)
 {
-#ifdef DSP_DIS_SHRQ
+#ifdef DSP_DIS_LOADW
 	if (doDSPDis)
-		WriteLog("%06X: SHRQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+		WriteLog("%06X: LOADW  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
 #endif
-	int32_t r1 = dsp_convert_zero[IMM_1];
-	uint32_t res = RN >> r1;
-	SET_ZN(res); dsp_flag_c = RN & 1;
-	RN = res;
-#ifdef DSP_DIS_SHRQ
+#ifdef DSP_CORRECT_ALIGNMENT
+	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
+		RN = DSPReadLong(RM & 0xFFFFFFFE, DSP) & 0xFFFF;
+	else
+		RN = JaguarReadWord(RM & 0xFFFFFFFE, DSP);
+#else
+	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
+		RN = DSPReadLong(RM, DSP) & 0xFFFF;
+	else
+		RN = JaguarReadWord(RM, DSP);
+#endif
+#ifdef DSP_DIS_LOADW
 	if (doDSPDis)
 		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
 #endif
 }
 
 
-static void dsp_opcode_ror(void)
+static void dsp_opcode_load(void)
 {
-#ifdef DSP_DIS_ROR
+#ifdef DSP_DIS_LOAD
 	if (doDSPDis)
-		WriteLog("%06X: ROR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
+		WriteLog("%06X: LOAD   (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
 #endif
-	uint32_t r1 = RM & 0x1F;
-	uint32_t res = (RN >> r1) | (RN << (32 - r1));
-	SET_ZN(res); dsp_flag_c = (RN >> 31) & 1;
-	RN = res;
-#ifdef DSP_DIS_ROR
+#ifdef DSP_CORRECT_ALIGNMENT
+	RN = DSPReadLong(RM & 0xFFFFFFFC, DSP);
+#else
+	RN = DSPReadLong(RM, DSP);
+#endif
+#ifdef DSP_DIS_LOAD
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
 #endif
 }
 
 
-static void dsp_opcode_rorq(void)
+static void dsp_opcode_load_r14_indexed(void)
 {
-#ifdef DSP_DIS_RORQ
+#ifdef DSP_DIS_LOAD14I
 	if (doDSPDis)
-		WriteLog("%06X: RORQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+		WriteLog("%06X: LOAD   (R14+$%02X), R%02u [NCZ:%u%u%u, R14+$%02X=%08X, R%02u=%08X] -> ", dsp_pc-2, riscConvertZero[IMM_1] << 2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, riscConvertZero[IMM_1] << 2, dsp_reg[14]+(riscConvertZero[IMM_1] << 2), IMM_2, RN);
 #endif
-	uint32_t r1 = dsp_convert_zero[IMM_1 & 0x1F];
-	uint32_t r2 = RN;
-	uint32_t res = (r2 >> r1) | (r2 << (32 - r1));
-	RN = res;
-	SET_ZN(res); dsp_flag_c = (r2 >> 31) & 0x01;
-#ifdef DSP_DIS_RORQ
+#ifdef DSP_CORRECT_ALIGNMENT
+	RN = DSPReadLong((dsp_reg[14] & 0xFFFFFFFC) + (riscConvertZero[IMM_1] << 2), DSP);
+#else
+	RN = DSPReadLong(dsp_reg[14] + (riscConvertZero[IMM_1] << 2), DSP);
+#endif
+#ifdef DSP_DIS_LOAD14I
 	if (doDSPDis)
 		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
 #endif
 }
 
 
-static void dsp_opcode_sha(void)
-{
-	int32_t sRm=(int32_t)RM;
-	uint32_t _Rn=RN;
-
-	if (sRm<0)
-	{
-		uint32_t shift=-sRm;
-		if (shift>=32) shift=32;
-		dsp_flag_c=(_Rn&0x80000000)>>31;
-		while (shift)
-		{
-			_Rn<<=1;
-			shift--;
-		}
-	}
-	else
-	{
-		uint32_t shift=sRm;
-		if (shift>=32) shift=32;
-		dsp_flag_c=_Rn&0x1;
-		while (shift)
-		{
-			_Rn=((int32_t)_Rn)>>1;
-			shift--;
-		}
-	}
-	RN = _Rn;
-	SET_ZN(RN);
-}
-
-
-static void dsp_opcode_sharq(void)
+static void dsp_opcode_load_r15_indexed(void)
 {
-#ifdef DSP_DIS_SHARQ
+#ifdef DSP_DIS_LOAD15I
 	if (doDSPDis)
-		WriteLog("%06X: SHARQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+		WriteLog("%06X: LOAD   (R15+$%02X), R%02u [NCZ:%u%u%u, R15+$%02X=%08X, R%02u=%08X] -> ", dsp_pc-2, riscConvertZero[IMM_1] << 2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, riscConvertZero[IMM_1] << 2, dsp_reg[15]+(riscConvertZero[IMM_1] << 2), IMM_2, RN);
 #endif
-	uint32_t res = (int32_t)RN >> dsp_convert_zero[IMM_1];
-	SET_ZN(res); dsp_flag_c = RN & 0x01;
-	RN = res;
-#ifdef DSP_DIS_SHARQ
+#ifdef DSP_CORRECT_ALIGNMENT
+	RN = DSPReadLong((dsp_reg[15] & 0xFFFFFFFC) + (riscConvertZero[IMM_1] << 2), DSP);
+#else
+	RN = DSPReadLong(dsp_reg[15] + (riscConvertZero[IMM_1] << 2), DSP);
+#endif
+#ifdef DSP_DIS_LOAD15I
 	if (doDSPDis)
 		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
 #endif
 }
 
 
-static void dsp_opcode_sh(void)
+static void dsp_opcode_div(void)
 {
-	int32_t sRm=(int32_t)RM;
-	uint32_t _Rn=RN;
-
-	if (sRm<0)
+#if 0
+	if (RM)
 	{
-		uint32_t shift=(-sRm);
-		if (shift>=32) shift=32;
-		dsp_flag_c=(_Rn&0x80000000)>>31;
-		while (shift)
+		if (dsp_div_control & 0x01)		// 16.16 division
 		{
-			_Rn<<=1;
-			shift--;
+			dsp_remain = ((uint64_t)RN << 16) % RM;
+			RN = ((uint64_t)RN << 16) / RM;
+		}
+		else
+		{
+			// We calculate the remainder first because we destroy RN after
+			// this by assigning it to itself.
+			dsp_remain = RN % RM;
+			RN = RN / RM;
 		}
+
 	}
 	else
 	{
-		uint32_t shift=sRm;
-		if (shift>=32) shift=32;
-		dsp_flag_c=_Rn&0x1;
-		while (shift)
-		{
-			_Rn>>=1;
-			shift--;
-		}
+		// This is what happens according to SCPCD. NYAN!
+		RN = 0xFFFFFFFF;
+		dsp_remain = 0;
 	}
-	RN = _Rn;
-	SET_ZN(RN);
+#else
+	// Real algorithm, courtesy of SCPCD: NYAN!
+	uint32_t q = RN;
+	uint32_t r = 0;
+
+	// If 16.16 division, stuff top 16 bits of RN into remainder and put the
+	// bottom 16 of RN in top 16 of quotient
+	if (dsp_div_control & 0x01)
+		q <<= 16, r = RN >> 16;
+
+	for(int i=0; i<32; i++)
+	{
+//		uint32_t sign = (r >> 31) & 0x01;
+		uint32_t sign = r & 0x80000000;
+		r = (r << 1) | ((q >> 31) & 0x01);
+		r += (sign ? RM : -RM);
+		q = (q << 1) | (((~r) >> 31) & 0x01);
+	}
+
+	RN = q;
+	dsp_remain = r;
+#endif
 }
 
+
 void dsp_opcode_addqmod(void)
 {
 #ifdef DSP_DIS_ADDQMOD
 	if (doDSPDis)
-		WriteLog("%06X: ADDQMOD #%u, R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_MOD=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, dsp_modulo);
+		WriteLog("%06X: ADDQMOD #%u, R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_MOD=%08X] -> ", dsp_pc-2, riscConvertZero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, dsp_modulo);
 #endif
-	uint32_t r1 = dsp_convert_zero[IMM_1];
+	uint32_t r1 = riscConvertZero[IMM_1];
 	uint32_t r2 = RN;
 	uint32_t res = r2 + r1;
 	res = (res & (~dsp_modulo)) | (r2 & dsp_modulo);
@@ -2713,7 +2777,7 @@ void dsp_opcode_addqmod(void)
 
 void dsp_opcode_subqmod(void)
 {
-	uint32_t r1 = dsp_convert_zero[IMM_1];
+	uint32_t r1 = riscConvertZero[IMM_1];
 	uint32_t r2 = RN;
 	uint32_t res = r2 - r1;
 	res = (res & (~dsp_modulo)) | (r2 & dsp_modulo);
@@ -2844,53 +2908,15 @@ void (* DSPOpcode[64])() =
 	DSP_store_r14_r,	DSP_store_r15_r,	DSP_illegal,		DSP_addqmod
 };
 
-bool readAffected[64][2] =
-{
-	{ true,  true}, { true,  true}, {false,  true}, {false,  true},
-	{ true,  true}, { true,  true}, {false,  true}, {false,  true},
-	{false,  true}, { true,  true}, { true,  true}, { true,  true},
-	{false,  true}, {false,  true}, {false,  true}, {false,  true},
-
-	{ true,  true}, { true,  true}, { true,  true}, {false,  true},
-	{ true,  true}, { true,  true}, {false,  true}, { true,  true},
-	{false,  true}, {false,  true}, { true,  true}, {false,  true},
-	{ true,  true}, {false,  true}, { true,  true}, {false,  true},
-
-	{false,  true}, {false,  true}, { true, false}, {false, false},
-	{ true, false}, {false, false}, {false, false}, { true, false},
-	{ true, false}, { true, false}, {false,  true}, { true, false},
-	{ true, false}, { true,  true}, { true,  true}, { true,  true},
-
-	{false,  true}, { true,  true}, { true,  true}, {false,  true},
-	{ true, false}, { true, false}, { true,  true}, { true, false},
-	{ true, false}, {false, false}, { true, false}, { true, false},
-	{ true,  true}, { true,  true}, {false, false}, {false,  true}
-};
-
-bool isLoadStore[65] =
-{
-	false, false, false, false, false, false, false, false,
-	false, false, false, false, false, false, false, false,
-
-	false, false, false, false, false, false, false, false,
-	false, false, false, false, false, false, false, false,
-
-	false, false, false, false, false, false, false,  true,
-	 true,  true, false,  true,  true,  true,  true,  true,
-
-	false,  true,  true, false, false, false, false, false,
-	false, false,  true,  true,  true,  true, false, false, false
-};
-
 void FlushDSPPipeline(void)
 {
-	plPtrFetch = 3, plPtrRead = 2, plPtrExec = 1, plPtrWrite = 0;
+	plRead = &pipeline[2], plExec = &pipeline[1], plWrite = &pipeline[0];
 
-	for(int i=0; i<4; i++)
+	for(int i=0; i<3; i++)
+	{
 		pipeline[i].opcode = PIPELINE_STALL;
-
-	for(int i=0; i<32; i++)
-		scoreboard[i] = 0;
+		pipeline[i].writeMask = 0;
+	}
 }
 
 //
@@ -3145,76 +3171,54 @@ F1B122: MOVEI  #$00F1A100, R01 [NCZ:000, R01=00F1B0D0] -> [NCZ:000, R01=00F1A100
 [STALL...]
 F1B128: STORE  R00, (R01) [NCZ:000, R00=00004231, R01=00F1A100]
 DSP: Writing 00004231 to DSP_FLAGS by DSP (REGPAGE is set)...
-DSP: Finished interrupt.
-DSP: Generating interrupt #1... [PC will return to 00F1B12A, R31 = 00F1CFE0]
-[STALL...]
-F1B010: MOVEI  #$00F1B1FC, R30 [NCZ:001, R30=00F1B010] -> [NCZ:001, R30=00F1B1FC]
-[STALL...]
-[STALL...]
-F1B016: JUMP   T, (R30) [NCZ:001, R30=00F1B1FC] Branched!
-F1B016: NOP    [NCZ:001]
-[STALL...]
-F1B1FC: MOVEI  #$00F1A100, R01 [NCZ:001, R01=00F1A100] -> [NCZ:001, R01=00F1A100]
-*/
-
-uint32_t pcQueue1[0x400];
-uint32_t pcQPtr1 = 0;
-static uint32_t prevR1;
-//Let's try a 3 stage pipeline....
-//Looks like 3 stage is correct, otherwise bad things happen...
-void DSPExecP2(int32_t cycles)
-{
-	dsp_releaseTimeSlice_flag = 0;
-	dsp_in_exec++;
-
-	while (cycles > 0 && DSP_RUNNING)
-	{
-/*extern uint32_t totalFrames;
-//F1B2F6: LOAD   (R14+$04), R24 [NCZ:001, R14+$04=00F20018, R24=FFFFFFFF] -> Jaguar: Unknown word read at 00F20018 by DSP (M68K PC=00E32E)
-//-> 43 + 1 + 24 -> $2B + $01 + $18 -> 101011 00001 11000 -> 1010 1100 0011 1000 -> AC38
-//C470 -> 1100 0100 0111 0000 -> 110001 00011 10000 -> 49, 3, 16 -> STORE R16, (R14+$0C)
-//F1B140:
-if (totalFrames >= 377 && GET16(dsp_ram_8, 0x0002F6) == 0xAC38 && dsp_pc == 0xF1B140)
-{
-	doDSPDis = true;
-	WriteLog("Starting disassembly at frame #%u...\n", totalFrames);
-}
-if (dsp_pc == 0xF1B092)
-	doDSPDis = false;//*/
-/*if (totalFrames >= 373 && GET16(dsp_ram_8, 0x0002F6) == 0xAC38)
-	doDSPDis = true;//*/
-/*if (totalFrames >= 373 && dsp_pc == 0xF1B0A0)
-	doDSPDis = true;//*/
-/*if (dsp_pc == 0xF1B0A0)
-	doDSPDis = true;//*/
-/*if (dsp_pc == 0xF1B0D2) && dsp_reg[1] == 0x2140C)
-	doDSPDis = true;//*/
-//Two parter... (not sure how to write this)
-//if (dsp_pc == 0xF1B0D2)
-//	prevR1 = dsp_reg[1];
-
-//F1B0D2: ADDQT  #8, R01 [NCZ:000, R01=0002140C] -> [NCZ:000, R01=00021414]
-//F1B0D2: ADDQT  #8, R01 [NCZ:000, R01=0002140C] -> [NCZ:000, R01=00021414]
-
-
-pcQueue1[pcQPtr1++] = dsp_pc;
-pcQPtr1 &= 0x3FF;
+DSP: Finished interrupt.
+DSP: Generating interrupt #1... [PC will return to 00F1B12A, R31 = 00F1CFE0]
+[STALL...]
+F1B010: MOVEI  #$00F1B1FC, R30 [NCZ:001, R30=00F1B010] -> [NCZ:001, R30=00F1B1FC]
+[STALL...]
+[STALL...]
+F1B016: JUMP   T, (R30) [NCZ:001, R30=00F1B1FC] Branched!
+F1B016: NOP    [NCZ:001]
+[STALL...]
+F1B1FC: MOVEI  #$00F1A100, R01 [NCZ:001, R01=00F1A100] -> [NCZ:001, R01=00F1A100]
+*/
 
 #ifdef DSP_DEBUG_PL2
-if ((dsp_pc < 0xF1B000 || dsp_pc > 0xF1CFFF) && !doDSPDis)
+static PER_MACHINE uint32_t pcQueue1[0x400];
+static PER_MACHINE uint32_t pcQPtr1 = 0;
+#endif
+
+//
+// Pipelined DSP core
+//
+// Three stages, & each trip around the loop is one clock: read (fetch, decode &
+// read the registers), execute & write back. The instruction being read stalls
+// if it needs a register that one further down the pipe hasn't written back
+// yet, or if it & the one executing both go to memory.
+//
+template <bool debugHooks>
+static void DSPExecP2Loop(int32_t cycles)
 {
-	WriteLog("DSP: PC has stepped out of bounds...\n\nBacktrace:\n\n");
-	doDSPDis = true;
+	while (cycles > 0 && DSP_RUNNING)
+	{
+#ifdef DSP_DEBUG_PL2
+		pcQueue1[pcQPtr1++] = dsp_pc;
+		pcQPtr1 &= 0x3FF;
 
-	char buffer[512];
+		if ((dsp_pc < 0xF1B000 || dsp_pc > 0xF1CFFF) && !doDSPDis)
+		{
+			WriteLog("DSP: PC has stepped out of bounds...\n\nBacktrace:\n\n");
+			doDSPDis = true;
 
-	for(int i=0; i<0x400; i++)
-	{
-		dasmjag(JAGUAR_DSP, buffer, pcQueue1[(i + pcQPtr1) & 0x3FF]);
-		WriteLog("\t%08X: %s\n", pcQueue1[(i + pcQPtr1) & 0x3FF], buffer);
-	}
-	WriteLog("\n");
-}//*/
+			char buffer[512];
+
+			for(int i=0; i<0x400; i++)
+			{
+				dasmjag(JAGUAR_DSP, buffer, pcQueue1[(i + pcQPtr1) & 0x3FF]);
+				WriteLog("\t%08X: %s\n", pcQueue1[(i + pcQPtr1) & 0x3FF], buffer);
+			}
+			WriteLog("\n");
+		}
 #endif
 
 		if (IMASKCleared)						// If IMASK was cleared,
@@ -3226,191 +3230,267 @@ if ((dsp_pc < 0xF1B000 || dsp_pc > 0xF1CFFF) && !doDSPDis)
 			IMASKCleared = false;
 		}
 
-//if (dsp_flags & REGPAGE)
-//	WriteLog("  --> REGPAGE has just been set!\n");
-#ifdef DSP_DEBUG_PL2
-if (doDSPDis)
-{
-WriteLog("DSPExecP: Pipeline status [PC=%08X]...\n", dsp_pc);
-WriteLog("\tR -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister, dsp_opcode_str[pipeline[plPtrRead].opcode]);
-WriteLog("\tE -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister, dsp_opcode_str[pipeline[plPtrExec].opcode]);
-WriteLog("\tW -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrWrite].opcode, pipeline[plPtrWrite].operand1, pipeline[plPtrWrite].operand2, pipeline[plPtrWrite].reg1, pipeline[plPtrWrite].reg2, pipeline[plPtrWrite].result, pipeline[plPtrWrite].writebackRegister, dsp_opcode_str[pipeline[plPtrWrite].opcode]);
-WriteLog("  --> Scoreboard: ");
-for(int i=0; i<32; i++)
-	WriteLog("%s ", scoreboard[i] ? "T" : "F");
-WriteLog("\n");
-}
-#endif
-		// Stage 1a: Instruction fetch
-		pipeline[plPtrRead].instruction = DSPReadWord(dsp_pc, DSP);
-		pipeline[plPtrRead].opcode = pipeline[plPtrRead].instruction >> 10;
-		pipeline[plPtrRead].operand1 = (pipeline[plPtrRead].instruction >> 5) & 0x1F;
-		pipeline[plPtrRead].operand2 = pipeline[plPtrRead].instruction & 0x1F;
-		if (pipeline[plPtrRead].opcode == 38)
-			pipeline[plPtrRead].result = (uint32_t)DSPReadWord(dsp_pc + 2, DSP)
-				| ((uint32_t)DSPReadWord(dsp_pc + 4, DSP) << 16);
-#ifdef DSP_DEBUG_PL2
-if (doDSPDis)
-{
-WriteLog("DSPExecP: Fetching instruction (%04X) from DSP_PC = %08X...\n", pipeline[plPtrRead].instruction, dsp_pc);
-WriteLog("DSPExecP: Pipeline status (after stage 1a) [PC=%08X]...\n", dsp_pc);
-WriteLog("\tR -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister, dsp_opcode_str[pipeline[plPtrRead].opcode]);
-WriteLog("\tE -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister, dsp_opcode_str[pipeline[plPtrExec].opcode]);
-WriteLog("\tW -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrWrite].opcode, pipeline[plPtrWrite].operand1, pipeline[plPtrWrite].operand2, pipeline[plPtrWrite].reg1, pipeline[plPtrWrite].reg2, pipeline[plPtrWrite].result, pipeline[plPtrWrite].writebackRegister, dsp_opcode_str[pipeline[plPtrWrite].opcode]);
-}
-#endif
-		// Stage 1b: Read registers
-//Small problem--when say LOAD or STORE (R14/5+$nn) is executed AFTER an instruction that
-//modifies R14/5, we don't check the scoreboard for R14/5 (and we need to!)... !!! FIX !!!
-//Ugly, but [DONE]
-//Another problem: Any sequential combination of LOAD and STORE operations will cause the
-//pipeline to stall, and we don't take care of that here. !!! FIX !!!
-		if ((scoreboard[pipeline[plPtrRead].operand1] && readAffected[pipeline[plPtrRead].opcode][0])
-			|| (scoreboard[pipeline[plPtrRead].operand2] && readAffected[pipeline[plPtrRead].opcode][1])
-			|| ((pipeline[plPtrRead].opcode == 43 || pipeline[plPtrRead].opcode == 58) && scoreboard[14])
-			|| ((pipeline[plPtrRead].opcode == 44 || pipeline[plPtrRead].opcode == 59) && scoreboard[15])
-//Not sure that this is the best way to fix the LOAD/STORE problem... But it seems to
-//work--somewhat...
-			|| (isLoadStore[pipeline[plPtrRead].opcode] && isLoadStore[pipeline[plPtrExec].opcode]))
+		PipelineStage & read = *plRead;
+		PipelineStage & exec = *plExec;
+
+		// Stage 1: Fetch, decode & read registers
+		const DSPDecodedOp & op = DSPPipelineFetch(read);
+
+		if ((op.readMask & (exec.writeMask | plWrite->writeMask))
+			|| (dspPipeFlags[op.opcode] & dspPipeFlags[exec.opcode] & PL_LOAD_STORE))
+		{
 			// We have a hit in the scoreboard, so we have to stall the pipeline...
-#ifdef DSP_DEBUG_PL2
-{
-if (doDSPDis)
-{
-WriteLog("  --> Stalling pipeline: ");
-if (readAffected[pipeline[plPtrRead].opcode][0])
-	WriteLog("scoreboard[%u] = %s (reg 1) ", pipeline[plPtrRead].operand1, scoreboard[pipeline[plPtrRead].operand1] ? "true" : "false");
-if (readAffected[pipeline[plPtrRead].opcode][1])
-	WriteLog("scoreboard[%u] = %s (reg 2)", pipeline[plPtrRead].operand2, scoreboard[pipeline[plPtrRead].operand2] ? "true" : "false");
-WriteLog("\n");
-}
-#endif
-			pipeline[plPtrRead].opcode = PIPELINE_STALL;
-#ifdef DSP_DEBUG_PL2
-}
-#endif
+			read.opcode = PIPELINE_STALL;
+			read.writeMask = 0;
+		}
 		else
 		{
-			pipeline[plPtrRead].reg1 = dsp_reg[pipeline[plPtrRead].operand1];
-			pipeline[plPtrRead].reg2 = dsp_reg[pipeline[plPtrRead].operand2];
-			pipeline[plPtrRead].writebackRegister = pipeline[plPtrRead].operand2;	// Set it to RN
+			read.reg1 = dsp_reg[read.operand1];
+			read.reg2 = dsp_reg[read.operand2];
+			read.writebackRegister = read.operand2;	// Set it to RN
+			read.writeMask = op.writeMask;
+			dsp_pc += (read.opcode == 38 ? 6 : 2);
+		}
 
-			// Shouldn't we be more selective with the register scoreboarding?
-			// Yes, we should. !!! FIX !!! Kinda [DONE]
-#ifndef NEW_SCOREBOARD
-			scoreboard[pipeline[plPtrRead].operand2] = affectsScoreboard[pipeline[plPtrRead].opcode];
-#else
-//Hopefully this will fix the dual MOVEQ # problem...
-			scoreboard[pipeline[plPtrRead].operand2] += (affectsScoreboard[pipeline[plPtrRead].opcode] ? 1 : 0);
+		// Stage 2: Execute
+		if (exec.opcode != PIPELINE_STALL)
+		{
+//CC only!
+#ifdef DSP_DEBUG_CC
+lastExec = exec.instruction;
 #endif
+			cycles -= dsp_opcode_cycles[exec.opcode];
 
-//Advance PC here??? Yes.
-			dsp_pc += (pipeline[plPtrRead].opcode == 38 ? 6 : 2);
+			if (debugHooks)
+				dsp_opcode_use[exec.opcode]++;
+
+			DSPOpcode[exec.opcode]();
 		}
 
-#ifdef DSP_DEBUG_PL2
-if (doDSPDis)
+		// Stage 3: Write back register/memory address
+		DSPPipelineWriteback(*plWrite);
+
+		// Push instructions through the pipeline...
+		PipelineStage * done = plWrite;
+		plWrite = plExec;
+		plExec = plRead;
+		plRead = done;
+
+		// A taken branch leaves the pipeline empty, so this is as good a place
+		// as any to look for a spin loop. Only short backward jumps count.
+		if (dspPipeBranchPC != 0xFFFFFFFF)
+		{
+			if ((dsp_pc <= dspPipeBranchPC)
+				&& ((dspPipeBranchPC - dsp_pc) <= DSP_SPIN_MAX_SIZE)
+				&& DSPCheckSpinLoop(dspPipeBranchPC))
+				cycles = 0;
+
+			dspPipeBranchPC = 0xFFFFFFFF;
+		}
+	}
+}
+
+
+void DSPExecP2(int32_t cycles)
 {
-WriteLog("DSPExecP: Pipeline status (after stage 1b) [PC=%08X]...\n", dsp_pc);
-WriteLog("\tR -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister, dsp_opcode_str[pipeline[plPtrRead].opcode]);
-WriteLog("\tE -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister, dsp_opcode_str[pipeline[plPtrExec].opcode]);
-WriteLog("\tW -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrWrite].opcode, pipeline[plPtrWrite].operand1, pipeline[plPtrWrite].operand2, pipeline[plPtrWrite].reg1, pipeline[plPtrWrite].reg2, pipeline[plPtrWrite].result, pipeline[plPtrWrite].writebackRegister, dsp_opcode_str[pipeline[plPtrWrite].opcode]);
+	dsp_releaseTimeSlice_flag = 0;
+
+	if (!dsp_in_exec)
+		dspSpinHead = 0xFFFFFFFF;
+
+	dsp_in_exec++;
+
+	if (jaguarDebugHooks)
+		DSPExecP2Loop<true>(cycles);
+	else
+		DSPExecP2Loop<false>(cycles);
+
+	dsp_in_exec--;
 }
-#endif
-		// Stage 2: Execute
-		if (pipeline[plPtrExec].opcode != PIPELINE_STALL)
-		{
-#ifdef DSP_DEBUG_PL2
-if (doDSPDis)
-	WriteLog("\t[inst=%02u][R28=%08X, alt R28=%08X, REGPAGE=%s]\n", pipeline[plPtrExec].opcode, dsp_reg[28], dsp_alternate_reg[28], (dsp_flags & REGPAGE ? "set" : "not set"));
 
-if (doDSPDis)
+
+//
+// Lockstep (see lockstep.h): run the pipelined core for the timeslice, then the
+// non-pipelined one from the same place for just as many instructions, & see
+// if they agree. The pipelined core goes first, since it's the one that can't
+// stop just anywhere; it gets drained at the end of the slice, so everything
+// it executed has been written back. Whichever core is switched on carries on
+// from its own registers & RAM, but what went out on the bus is always the
+// non-pipelined core's (it's the one that ran last). This runs with the debug hooks on, so the opcode stats
+// count instructions for us & the recompiler stays out of the way.
+//
+struct DSPLockstepState
 {
-WriteLog("DSPExecP: About to execute opcode %s...\n", dsp_opcode_str[pipeline[plPtrExec].opcode]);
+	RiscState state;
+	uint8_t ram[0x2000];
+	uint32_t modulo;
+	bool IMASKCleared;
+	uint32_t opcodeUse[65];
+};
+
+static PER_MACHINE DSPLockstepState * dspLockstep[2];
+
+
+static void DSPLockstepSave(DSPLockstepState & ls)
+{
+	ls.state = dspState;
+	memcpy(ls.ram, dsp_ram_8, 0x2000);
+	ls.modulo = dsp_modulo;
+	ls.IMASKCleared = IMASKCleared;
+	memcpy(ls.opcodeUse, dsp_opcode_use, sizeof(dsp_opcode_use));
 }
-#endif
-//CC only!
-#ifdef DSP_DEBUG_CC
-lastExec = pipeline[plPtrExec].instruction;
-//WriteLog("[lastExec = %04X]\n", lastExec);
-#endif
-			cycles -= dsp_opcode_cycles[pipeline[plPtrExec].opcode];
-			dsp_opcode_use[pipeline[plPtrExec].opcode]++;
-			DSPOpcode[pipeline[plPtrExec].opcode]();
-//WriteLog("    --> Returned from execute. DSP_PC: %08X\n", dsp_pc);
-		}
-		else
+
+
+static void DSPLockstepRestore(const DSPLockstepState & ls)
 {
-//Let's not, until we do the stalling correctly...
-//But, we gotta while we're doing the comparison core...!
-//Or do we?			cycles--;
-//Really, the whole thing is wrong. When the pipeline is correctly stuffed, most instructions
-//will execute in one clock cycle (others, like DIV, will likely not). So, the challenge is
-//to model this clock cycle behavior correctly...
-//Also, the pipeline stalls too much--mostly because the transparent writebacks at stage 3
-//don't affect the reads at stage 1...
-#ifdef DSP_DEBUG_STALL
-if (doDSPDis)
-	WriteLog("[STALL... DSP_PC = %08X]\n", dsp_pc);
-#endif
+	// The bank pointers come along for the ride; they point into dspState
+	dspState = ls.state;
+	memcpy(dsp_ram_8, ls.ram, 0x2000);
+	DSPInvalidateDecodeCache(0, 0x2000);
+	dsp_modulo = ls.modulo;
+	IMASKCleared = ls.IMASKCleared;
+	memcpy(dsp_opcode_use, ls.opcodeUse, sizeof(dsp_opcode_use));
 }
 
-#ifdef DSP_DEBUG_PL2
-if (doDSPDis)
+
+static uint32_t DSPInstructionCount(void)
 {
-WriteLog("DSPExecP: Pipeline status (after stage 2) [PC=%08X]...\n", dsp_pc);
-WriteLog("\tR -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister, dsp_opcode_str[pipeline[plPtrRead].opcode]);
-WriteLog("\tE -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister, dsp_opcode_str[pipeline[plPtrExec].opcode]);
-WriteLog("\tW -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrWrite].opcode, pipeline[plPtrWrite].operand1, pipeline[plPtrWrite].operand2, pipeline[plPtrWrite].reg1, pipeline[plPtrWrite].reg2, pipeline[plPtrWrite].result, pipeline[plPtrWrite].writebackRegister, dsp_opcode_str[pipeline[plPtrWrite].opcode]);
-WriteLog("\n");
+	uint32_t count = 0;
+
+	for(int i=0; i<64; i++)
+		count += dsp_opcode_use[i];
+
+	return count;
 }
-#endif
-		// Stage 3: Write back register/memory address
-		if (pipeline[plPtrWrite].opcode != PIPELINE_STALL)
-		{
-/*if (pipeline[plPtrWrite].writebackRegister == 3
-	&& (pipeline[plPtrWrite].result < 0xF14000 || pipeline[plPtrWrite].result > 0xF1CFFF)
-	&& !doDSPDis)
+
+
+//
+// Write back whatever's in flight & back the PC up to the oldest instruction
+// that hasn't executed yet
+//
+static void DSPPipelineDrain(void)
 {
-	WriteLog("DSP: Register R03 has stepped out of bounds...\n\n");
-	doDSPDis = true;
-}//*/
-			if (pipeline[plPtrWrite].writebackRegister != 0xFF)
-			{
-				if (pipeline[plPtrWrite].writebackRegister != 0xFE)
-					dsp_reg[pipeline[plPtrWrite].writebackRegister] = pipeline[plPtrWrite].result;
-				else
-				{
-					if (pipeline[plPtrWrite].type == TYPE_BYTE)
-						JaguarWriteByte(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else if (pipeline[plPtrWrite].type == TYPE_WORD)
-						JaguarWriteWord(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else
-						JaguarWriteLong(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-				}
-			}
+	DSPPipelineWriteback(*plWrite);
+	dsp_pc -= (plExec->opcode == 38 ? 6 : (plExec->opcode == PIPELINE_STALL ? 0 : 2));
+	FlushDSPPipeline();
+}
 
-#ifndef NEW_SCOREBOARD
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				scoreboard[pipeline[plPtrWrite].operand2] = false;
-#else
-//Yup, sequential MOVEQ # problem fixing (I hope!)...
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				if (scoreboard[pipeline[plPtrWrite].operand2])
-					scoreboard[pipeline[plPtrWrite].operand2]--;
-#endif
-		}
 
-		// Push instructions through the pipeline...
-		plPtrRead = (++plPtrRead) & 0x03;
-		plPtrExec = (++plPtrExec) & 0x03;
-		plPtrWrite = (++plPtrWrite) & 0x03;
+static void DSPLockstepReport(const DSPLockstepState & start, uint32_t executed)
+{
+	const DSPLockstepState & p = *dspLockstep[1];
+	const RiscState & ps = p.state;
+	static const char * name[3] = { "N", "C", "Z" };
+	bool bankP = (ps.reg == dspState.regBank1), bankNP = (dsp_reg == dsp_reg_bank_1);
+
+	WriteLog("DSP: Pipelined & non-pipelined cores diverged after %u instructions, starting at PC=%06X (slice #%u)\n",
+		executed, start.state.pc, dspLockstepSlices);
+
+	if (ps.pc != dsp_pc)
+		WriteLog("    PC: %06X vs. %06X\n", ps.pc, dsp_pc);
+
+	uint8_t flagP[3] = { ps.flagN, ps.flagC, ps.flagZ }, flagNP[3] = { dsp_flag_n, dsp_flag_c, dsp_flag_z };
+
+	for(int i=0; i<3; i++)
+		if (flagP[i] != flagNP[i])
+			WriteLog("    %s: %u vs. %u\n", name[i], flagP[i], flagNP[i]);
+
+	if ((ps.flags & ~0x07) != (dsp_flags & ~0x07))
+		WriteLog("    D_FLAGS: %08X vs. %08X\n", ps.flags & ~0x07, dsp_flags & ~0x07);
+
+	if (ps.control != dsp_control)
+		WriteLog("    D_CTRL: %08X vs. %08X\n", ps.control, dsp_control);
+
+	if (bankP != bankNP)
+		WriteLog("    Register bank: %u vs. %u\n", bankP, bankNP);
+
+	if ((ps.acc & 0xFFFFFFFFFFLL) != (dsp_acc & 0xFFFFFFFFFFLL))
+		WriteLog("    ACC: %010llX vs. %010llX\n", (unsigned long long)(ps.acc & 0xFFFFFFFFFFLL), (unsigned long long)(dsp_acc & 0xFFFFFFFFFFLL));
+
+	if (ps.remain != dsp_remain)
+		WriteLog("    D_REMAIN: %08X vs. %08X\n", ps.remain, dsp_remain);
+
+	for(int i=0; i<32; i++)
+	{
+		if (ps.regBank0[i] != dsp_reg_bank_0[i])
+			WriteLog("    Bank 0 R%02u: %08X vs. %08X (was %08X)\n", i, ps.regBank0[i], dsp_reg_bank_0[i], start.state.regBank0[i]);
+
+		if (ps.regBank1[i] != dsp_reg_bank_1[i])
+			WriteLog("    Bank 1 R%02u: %08X vs. %08X (was %08X)\n", i, ps.regBank1[i], dsp_reg_bank_1[i], start.state.regBank1[i]);
 	}
 
-	dsp_in_exec--;
+	for(uint32_t i=0; i<0x2000; i++)
+		if (p.ram[i] != dsp_ram_8[i])
+			WriteLog("    %06X: %02X vs. %02X (was %02X)\n", DSP_WORK_RAM_BASE + i, p.ram[i], dsp_ram_8[i], start.ram[i]);
+
+	LockstepLogDifferences("pipelined", "non-pipelined");
+
+	WriteLog("    Registers going in:\n");
+
+	for(int i=0; i<32; i+=4)
+		WriteLog("    R%02u: %08X R%02u: %08X R%02u: %08X R%02u: %08X\n",
+			i + 0, start.state.reg == dspState.regBank1 ? start.state.regBank1[i + 0] : start.state.regBank0[i + 0],
+			i + 1, start.state.reg == dspState.regBank1 ? start.state.regBank1[i + 1] : start.state.regBank0[i + 1],
+			i + 2, start.state.reg == dspState.regBank1 ? start.state.regBank1[i + 2] : start.state.regBank0[i + 2],
+			i + 3, start.state.reg == dspState.regBank1 ? start.state.regBank1[i + 3] : start.state.regBank0[i + 3]);
+
+	char buffer[512];
+
+	for(uint32_t pc=start.state.pc, i=0; i<32 && (pc - DSP_WORK_RAM_BASE) < 0x2000; i++)
+	{
+		uint32_t oldPC = pc;
+		pc += dasmjag(JAGUAR_DSP, buffer, pc);
+		WriteLog("\t%08X: %s\n", oldPC, buffer);
+	}
 }
 
 
+void DSPExecLockstep(int32_t cycles)
+{
+	for(int i=0; i<2; i++)
+		if (dspLockstep[i] == NULL)
+			dspLockstep[i] = new DSPLockstepState;
+
+	DSPLockstepState & start = *dspLockstep[0];
+	DSPLockstepSave(start);
+	uint32_t count = DSPInstructionCount();
+	LockstepStart();
+
+	DSPExecP2(cycles);
+	DSPPipelineDrain();
+	uint32_t executed = DSPInstructionCount() - count;
+	DSPLockstepSave(*dspLockstep[1]);
+
+	LockstepRewind();
+	DSPLockstepRestore(start);
+
+	// One at a time, so we stop right where the pipelined core did. A branch
+	// takes its delay slot along with it on both.
+	while (DSP_RUNNING && (DSPInstructionCount() - count) < executed)
+		DSPExec(1);
+
+	// The DSP's own RAM & registers don't go out on the bus from the
+	// non-pipelined core, so they get checked here instead
+	uint32_t differences = LockstepFinish(DSP_CONTROL_RAM_BASE, DSP_WORK_RAM_BASE + 0x1FFF);
+	const RiscState & ps = dspLockstep[1]->state;
+	dspLockstepSlices++;
+
+	if (differences || ps.pc != dsp_pc || ps.flagZ != dsp_flag_z || ps.flagN != dsp_flag_n
+		|| ps.flagC != dsp_flag_c || (ps.flags & ~0x07) != (dsp_flags & ~0x07)
+		|| ps.control != dsp_control || (ps.reg == dspState.regBank1) != (dsp_reg == dsp_reg_bank_1)
+		|| (ps.acc & 0xFFFFFFFFFFLL) != (dsp_acc & 0xFFFFFFFFFFLL) || ps.remain != dsp_remain
+		|| memcmp(ps.regBank0, dsp_reg_bank_0, 32 * 4) || memcmp(ps.regBank1, dsp_reg_bank_1, 32 * 4)
+		|| memcmp(dspLockstep[1]->ram, dsp_ram_8, 0x2000))
+	{
+		// Only the first one's worth the log space; it's likely to snowball
+		if (dspLockstepDiverged++ == 0)
+			DSPLockstepReport(start, executed);
+	}
+
+	if (vjs.usePipelinedDSP)
+		DSPLockstepRestore(*dspLockstep[1]);
+}
+
 
 /*
 //#define DSP_DEBUG_PL3
@@ -3524,16 +3604,16 @@ WriteLog("\n");
 // DSP pipelined opcode handlers
 //
 
-#define PRM				pipeline[plPtrExec].reg1
-#define PRN				pipeline[plPtrExec].reg2
-#define PIMM1			pipeline[plPtrExec].operand1
-#define PIMM2			pipeline[plPtrExec].operand2
-#define PRES			pipeline[plPtrExec].result
-#define PWBR			pipeline[plPtrExec].writebackRegister
-#define NO_WRITEBACK	pipeline[plPtrExec].writebackRegister = 0xFF
-//#define DSP_PPC			dsp_pc - (pipeline[plPtrRead].opcode == 38 ? 6 : 2) - (pipeline[plPtrExec].opcode == 38 ? 6 : 2)
-#define DSP_PPC			dsp_pc - (pipeline[plPtrRead].opcode == 38 ? 6 : (pipeline[plPtrRead].opcode == PIPELINE_STALL ? 0 : 2)) - (pipeline[plPtrExec].opcode == 38 ? 6 : (pipeline[plPtrExec].opcode == PIPELINE_STALL ? 0 : 2))
-#define WRITEBACK_ADDR	pipeline[plPtrExec].writebackRegister = 0xFE
+#define PRM				plExec->reg1
+#define PRN				plExec->reg2
+#define PIMM1			plExec->operand1
+#define PIMM2			plExec->operand2
+#define PRES			plExec->result
+#define PWBR			plExec->writebackRegister
+#define NO_WRITEBACK	plExec->writebackRegister = 0xFF
+//#define DSP_PPC			dsp_pc - (plRead->opcode == 38 ? 6 : 2) - (plExec->opcode == 38 ? 6 : 2)
+#define DSP_PPC			dsp_pc - (plRead->opcode == 38 ? 6 : (plRead->opcode == PIPELINE_STALL ? 0 : 2)) - (plExec->opcode == 38 ? 6 : (plExec->opcode == PIPELINE_STALL ? 0 : 2))
+#define WRITEBACK_ADDR	plExec->writebackRegister = 0xFE
 
 static void DSP_abs(void)
 {
@@ -3594,9 +3674,9 @@ static void DSP_addq(void)
 {
 #ifdef DSP_DIS_ADDQ
 	if (doDSPDis)
-		WriteLog("%06X: ADDQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: ADDQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, riscConvertZero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
 #endif
-	uint32_t r1 = dsp_convert_zero[PIMM1];
+	uint32_t r1 = riscConvertZero[PIMM1];
 	uint32_t res = PRN + r1;
 	CLR_ZNC; SET_ZNC_ADD(PRN, r1, res);
 	PRES = res;
@@ -3610,9 +3690,9 @@ static void DSP_addqmod(void)
 {
 #ifdef DSP_DIS_ADDQMOD
 	if (doDSPDis)
-		WriteLog("%06X: ADDQMOD #%u, R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_MOD=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, dsp_modulo);
+		WriteLog("%06X: ADDQMOD #%u, R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_MOD=%08X] -> ", DSP_PPC, riscConvertZero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, dsp_modulo);
 #endif
-	uint32_t r1 = dsp_convert_zero[PIMM1];
+	uint32_t r1 = riscConvertZero[PIMM1];
 	uint32_t r2 = PRN;
 	uint32_t res = r2 + r1;
 	res = (res & (~dsp_modulo)) | (r2 & dsp_modulo);
@@ -3628,9 +3708,9 @@ static void DSP_addqt(void)
 {
 #ifdef DSP_DIS_ADDQT
 	if (doDSPDis)
-		WriteLog("%06X: ADDQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: ADDQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, riscConvertZero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
 #endif
-	PRES = PRN + dsp_convert_zero[PIMM1];
+	PRES = PRN + riscConvertZero[PIMM1];
 #ifdef DSP_DIS_ADDQT
 	if (doDSPDis)
 		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
@@ -3807,6 +3887,54 @@ static void DSP_illegal(void)
 	NO_WRITEBACK;
 }
 
+//
+// A taken JUMP or JR. The instruction in the delay slot has to go through with
+// it, then the pipeline gets flushed & we carry on from the new PC.
+//
+static void DSPPipelineBranch(uint32_t newPC)
+{
+	// Where the branch itself is, for the spin loop check in DSPExecP2()
+	dspPipeBranchPC = dsp_pc - 2 - (plRead->opcode == 38 ? 6
+		: (plRead->opcode == PIPELINE_STALL ? 0 : 2));
+
+	// Step 1: Handle writebacks at stage 3 of pipeline
+	DSPPipelineWriteback(*plWrite);
+
+	// Step 2: Execute the following instruction right where it is (in the
+	// read stage), then write it back. This is the same as pushing it through
+	// the rest of the pipeline, since nothing else gets to run in between.
+	PipelineStage & delaySlot = *plRead;
+
+	// If the delay slot stalled, it never got read, so do it now
+	if (delaySlot.opcode == PIPELINE_STALL)
+	{
+		DSPPipelineFetch(delaySlot);
+		delaySlot.reg1 = dsp_reg[delaySlot.operand1];
+		delaySlot.reg2 = dsp_reg[delaySlot.operand2];
+		delaySlot.writebackRegister = delaySlot.operand2;	// Set it to RN
+	}
+
+	PipelineStage * branchStage = plExec;
+	plExec = plRead;
+	dsp_pc += 2;	// For DSP_DIS_* accuracy
+	DSPOpcode[delaySlot.opcode]();
+	plExec = branchStage;
+
+	if (jaguarDebugHooks)
+		dsp_opcode_use[delaySlot.opcode]++;
+
+	DSPPipelineWriteback(delaySlot);
+
+	// Step 3: Flush pipeline & set new PC
+	for(int i=0; i<3; i++)
+	{
+		pipeline[i].opcode = PIPELINE_STALL;
+		pipeline[i].writeMask = 0;
+	}
+
+	dsp_pc = newPC;
+}
+
 // There is a problem here with interrupt handlers the JUMP and JR instructions that
 // can cause trouble because an interrupt can occur *before* the instruction following the
 // jump can execute... !!! FIX !!!
@@ -3835,79 +3963,10 @@ const char * condition[32] =
 #endif
 		int32_t offset = (PIMM1 & 0x10 ? 0xFFFFFFF0 | PIMM1 : PIMM1);		// Sign extend PIMM1
 //Account for pipeline effects...
-		uint32_t newPC = dsp_pc + (offset * 2) - (pipeline[plPtrRead].opcode == 38 ? 6 : (pipeline[plPtrRead].opcode == PIPELINE_STALL ? 0 : 2));
+		uint32_t newPC = dsp_pc + (offset * 2) - (plRead->opcode == 38 ? 6 : (plRead->opcode == PIPELINE_STALL ? 0 : 2));
 //WriteLog("  --> Old PC: %08X, new PC: %08X\n", dsp_pc, newPC);
 
-		// Now that we've branched, we have to make sure that the following instruction
-		// is executed atomically with this one and then flush the pipeline before setting
-		// the new PC.
-
-		// Step 1: Handle writebacks at stage 3 of pipeline
-/*		if (pipeline[plPtrWrite].opcode != PIPELINE_STALL)
-		{
-			if (pipeline[plPtrWrite].writebackRegister != 0xFF)
-				dsp_reg[pipeline[plPtrWrite].writebackRegister] = pipeline[plPtrWrite].result;
-
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				scoreboard[pipeline[plPtrWrite].operand2] = false;
-		}//*/
-		if (pipeline[plPtrWrite].opcode != PIPELINE_STALL)
-		{
-			if (pipeline[plPtrWrite].writebackRegister != 0xFF)
-			{
-				if (pipeline[plPtrWrite].writebackRegister != 0xFE)
-					dsp_reg[pipeline[plPtrWrite].writebackRegister] = pipeline[plPtrWrite].result;
-				else
-				{
-					if (pipeline[plPtrWrite].type == TYPE_BYTE)
-						JaguarWriteByte(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else if (pipeline[plPtrWrite].type == TYPE_WORD)
-						JaguarWriteWord(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else
-						JaguarWriteLong(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-				}
-			}
-
-#ifndef NEW_SCOREBOARD
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				scoreboard[pipeline[plPtrWrite].operand2] = false;
-#else
-//Yup, sequential MOVEQ # problem fixing (I hope!)...
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				if (scoreboard[pipeline[plPtrWrite].operand2])
-					scoreboard[pipeline[plPtrWrite].operand2]--;
-#endif
-		}
-
-		// Step 2: Push instruction through pipeline & execute following instruction
-		// NOTE: By putting our following instruction at stage 3 of the pipeline,
-		//       we effectively handle the final push of the instruction through the
-		//       pipeline when the new PC takes effect (since when we return, the
-		//       pipeline code will be executing the writeback stage. If we reverse
-		//       the execution order of the pipeline stages, this will no longer be
-		//       the case!)...
-		pipeline[plPtrExec] = pipeline[plPtrRead];
-//This is BAD. We need to get that next opcode and execute it!
-//NOTE: The problem is here because of a bad stall. Once those are fixed, we can probably
-//      remove this crap.
-		if (pipeline[plPtrExec].opcode == PIPELINE_STALL)
-		{
-		uint16_t instruction = DSPReadWord(dsp_pc, DSP);
-		pipeline[plPtrExec].opcode = instruction >> 10;
-		pipeline[plPtrExec].operand1 = (instruction >> 5) & 0x1F;
-		pipeline[plPtrExec].operand2 = instruction & 0x1F;
-			pipeline[plPtrExec].reg1 = dsp_reg[pipeline[plPtrExec].operand1];
-			pipeline[plPtrExec].reg2 = dsp_reg[pipeline[plPtrExec].operand2];
-			pipeline[plPtrExec].writebackRegister = pipeline[plPtrExec].operand2;	// Set it to RN
-		}//*/
-	dsp_pc += 2;	// For DSP_DIS_* accuracy
-		DSPOpcode[pipeline[plPtrExec].opcode]();
-		dsp_opcode_use[pipeline[plPtrExec].opcode]++;
-		pipeline[plPtrWrite] = pipeline[plPtrExec];
-
-		// Step 3: Flush pipeline & set new PC
-		pipeline[plPtrRead].opcode = pipeline[plPtrExec].opcode = PIPELINE_STALL;
-		dsp_pc = newPC;
+		DSPPipelineBranch(newPC);
 	}
 	else
 #ifdef DSP_DIS_JR
@@ -3942,78 +4001,7 @@ const char * condition[32] =
 	if (doDSPDis)
 		WriteLog("Branched!\n");
 #endif
-		uint32_t PCSave = PRM;
-		// Now that we've branched, we have to make sure that the following instruction
-		// is executed atomically with this one and then flush the pipeline before setting
-		// the new PC.
-
-		// Step 1: Handle writebacks at stage 3 of pipeline
-/*		if (pipeline[plPtrWrite].opcode != PIPELINE_STALL)
-		{
-			if (pipeline[plPtrWrite].writebackRegister != 0xFF)
-				dsp_reg[pipeline[plPtrWrite].writebackRegister] = pipeline[plPtrWrite].result;
-
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				scoreboard[pipeline[plPtrWrite].operand2] = false;
-		}//*/
-		if (pipeline[plPtrWrite].opcode != PIPELINE_STALL)
-		{
-			if (pipeline[plPtrWrite].writebackRegister != 0xFF)
-			{
-				if (pipeline[plPtrWrite].writebackRegister != 0xFE)
-					dsp_reg[pipeline[plPtrWrite].writebackRegister] = pipeline[plPtrWrite].result;
-				else
-				{
-					if (pipeline[plPtrWrite].type == TYPE_BYTE)
-						JaguarWriteByte(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else if (pipeline[plPtrWrite].type == TYPE_WORD)
-						JaguarWriteWord(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else
-						JaguarWriteLong(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-				}
-			}
-
-#ifndef NEW_SCOREBOARD
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				scoreboard[pipeline[plPtrWrite].operand2] = false;
-#else
-//Yup, sequential MOVEQ # problem fixing (I hope!)...
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				if (scoreboard[pipeline[plPtrWrite].operand2])
-					scoreboard[pipeline[plPtrWrite].operand2]--;
-#endif
-		}
-
-		// Step 2: Push instruction through pipeline & execute following instruction
-		// NOTE: By putting our following instruction at stage 3 of the pipeline,
-		//       we effectively handle the final push of the instruction through the
-		//       pipeline when the new PC takes effect (since when we return, the
-		//       pipeline code will be executing the writeback stage. If we reverse
-		//       the execution order of the pipeline stages, this will no longer be
-		//       the case!)...
-		pipeline[plPtrExec] = pipeline[plPtrRead];
-//This is BAD. We need to get that next opcode and execute it!
-//Also, same problem in JR!
-//NOTE: The problem is here because of a bad stall. Once those are fixed, we can probably
-//      remove this crap.
-		if (pipeline[plPtrExec].opcode == PIPELINE_STALL)
-		{
-		uint16_t instruction = DSPReadWord(dsp_pc, DSP);
-		pipeline[plPtrExec].opcode = instruction >> 10;
-		pipeline[plPtrExec].operand1 = (instruction >> 5) & 0x1F;
-		pipeline[plPtrExec].operand2 = instruction & 0x1F;
-			pipeline[plPtrExec].reg1 = dsp_reg[pipeline[plPtrExec].operand1];
-			pipeline[plPtrExec].reg2 = dsp_reg[pipeline[plPtrExec].operand2];
-			pipeline[plPtrExec].writebackRegister = pipeline[plPtrExec].operand2;	// Set it to RN
-		}//*/
-	dsp_pc += 2;	// For DSP_DIS_* accuracy
-		DSPOpcode[pipeline[plPtrExec].opcode]();
-		dsp_opcode_use[pipeline[plPtrExec].opcode]++;
-		pipeline[plPtrWrite] = pipeline[plPtrExec];
-
-		// Step 3: Flush pipeline & set new PC
-		pipeline[plPtrRead].opcode = pipeline[plPtrExec].opcode = PIPELINE_STALL;
-		dsp_pc = PCSave;
+		DSPPipelineBranch(PRM);
 	}
 	else
 #ifdef DSP_DIS_JUMP
@@ -4087,12 +4075,12 @@ static void DSP_load_r14_i(void)
 {
 #ifdef DSP_DIS_LOAD14I
 	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R14+$%02X), R%02u [NCZ:%u%u%u, R14+$%02X=%08X, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1] << 2, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, dsp_convert_zero[PIMM1] << 2, dsp_reg[14]+(dsp_convert_zero[PIMM1] << 2), PIMM2, PRN);
+		WriteLog("%06X: LOAD   (R14+$%02X), R%02u [NCZ:%u%u%u, R14+$%02X=%08X, R%02u=%08X] -> ", DSP_PPC, riscConvertZero[PIMM1] << 2, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, riscConvertZero[PIMM1] << 2, dsp_reg[14]+(riscConvertZero[PIMM1] << 2), PIMM2, PRN);
 #endif
 #ifdef DSP_CORRECT_ALIGNMENT
-	PRES = DSPReadLong((dsp_reg[14] & 0xFFFFFFFC) + (dsp_convert_zero[PIMM1] << 2), DSP);
+	PRES = DSPReadLong((dsp_reg[14] & 0xFFFFFFFC) + (riscConvertZero[PIMM1] << 2), DSP);
 #else
-	PRES = DSPReadLong(dsp_reg[14] + (dsp_convert_zero[PIMM1] << 2), DSP);
+	PRES = DSPReadLong(dsp_reg[14] + (riscConvertZero[PIMM1] << 2), DSP);
 #endif
 #ifdef DSP_DIS_LOAD14I
 	if (doDSPDis)
@@ -4121,12 +4109,12 @@ static void DSP_load_r15_i(void)
 {
 #ifdef DSP_DIS_LOAD15I
 	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R15+$%02X), R%02u [NCZ:%u%u%u, R15+$%02X=%08X, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1] << 2, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, dsp_convert_zero[PIMM1] << 2, dsp_reg[15]+(dsp_convert_zero[PIMM1] << 2), PIMM2, PRN);
+		WriteLog("%06X: LOAD   (R15+$%02X), R%02u [NCZ:%u%u%u, R15+$%02X=%08X, R%02u=%08X] -> ", DSP_PPC, riscConvertZero[PIMM1] << 2, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, riscConvertZero[PIMM1] << 2, dsp_reg[15]+(riscConvertZero[PIMM1] << 2), PIMM2, PRN);
 #endif
 #ifdef DSP_CORRECT_ALIGNMENT
-	PRES = DSPReadLong((dsp_reg[15] &0xFFFFFFFC) + (dsp_convert_zero[PIMM1] << 2), DSP);
+	PRES = DSPReadLong((dsp_reg[15] &0xFFFFFFFC) + (riscConvertZero[PIMM1] << 2), DSP);
 #else
-	PRES = DSPReadLong(dsp_reg[15] + (dsp_convert_zero[PIMM1] << 2), DSP);
+	PRES = DSPReadLong(dsp_reg[15] + (riscConvertZero[PIMM1] << 2), DSP);
 #endif
 #ifdef DSP_DIS_LOAD15I
 	if (doDSPDis)
@@ -4253,7 +4241,7 @@ static void DSP_movepc(void)
 //Need to fix this to take into account pipelining effects... !!! FIX !!! [DONE]
 //	PRES = dsp_pc - 2;
 //Account for pipeline effects...
-	PRES = dsp_pc - 2 - (pipeline[plPtrRead].opcode == 38 ? 6 : (pipeline[plPtrRead].opcode == PIPELINE_STALL ? 0 : 2));
+	PRES = dsp_pc - 2 - (plRead->opcode == 38 ? 6 : (plRead->opcode == PIPELINE_STALL ? 0 : 2));
 #ifdef DSP_DIS_MOVEPC
 	if (doDSPDis)
 		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
@@ -4417,9 +4405,9 @@ static void DSP_rorq(void)
 {
 #ifdef DSP_DIS_RORQ
 	if (doDSPDis)
-		WriteLog("%06X: RORQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: RORQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, riscConvertZero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
 #endif
-	uint32_t r1 = dsp_convert_zero[PIMM1 & 0x1F];
+	uint32_t r1 = riscConvertZero[PIMM1 & 0x1F];
 	uint32_t r2 = PRN;
 	uint32_t res = (r2 >> r1) | (r2 << (32 - r1));
 	PRES = res;
@@ -4531,9 +4519,9 @@ static void DSP_sharq(void)
 {
 #ifdef DSP_DIS_SHARQ
 	if (doDSPDis)
-		WriteLog("%06X: SHARQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: SHARQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, riscConvertZero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
 #endif
-	uint32_t res = (int32_t)PRN >> dsp_convert_zero[PIMM1];
+	uint32_t res = (int32_t)PRN >> riscConvertZero[PIMM1];
 	SET_ZN(res); dsp_flag_c = PRN & 0x01;
 	PRES = res;
 #ifdef DSP_DIS_SHARQ
@@ -4562,9 +4550,9 @@ static void DSP_shrq(void)
 {
 #ifdef DSP_DIS_SHRQ
 	if (doDSPDis)
-		WriteLog("%06X: SHRQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: SHRQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, riscConvertZero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
 #endif
-	int32_t r1 = dsp_convert_zero[PIMM1];
+	int32_t r1 = riscConvertZero[PIMM1];
 	uint32_t res = PRN >> r1;
 	SET_ZN(res); dsp_flag_c = PRN & 1;
 	PRES = res;
@@ -4583,12 +4571,12 @@ static void DSP_store(void)
 //	DSPWriteLong(PRM, PRN, DSP);
 //	NO_WRITEBACK;
 #ifdef DSP_CORRECT_ALIGNMENT_STORE
-	pipeline[plPtrExec].address = PRM & 0xFFFFFFFC;
+	plExec->address = PRM & 0xFFFFFFFC;
 #else
-	pipeline[plPtrExec].address = PRM;
+	plExec->address = PRM;
 #endif
-	pipeline[plPtrExec].value = PRN;
-	pipeline[plPtrExec].type = TYPE_DWORD;
+	plExec->value = PRN;
+	plExec->type = TYPE_DWORD;
 	WRITEBACK_ADDR;
 }
 
@@ -4604,17 +4592,17 @@ static void DSP_storeb(void)
 //		JaguarWriteByte(PRM, PRN, DSP);
 //
 //	NO_WRITEBACK;
-	pipeline[plPtrExec].address = PRM;
+	plExec->address = PRM;
 
 	if (PRM >= DSP_WORK_RAM_BASE && PRM <= (DSP_WORK_RAM_BASE + 0x1FFF))
 	{
-		pipeline[plPtrExec].value = PRN & 0xFF;
-		pipeline[plPtrExec].type = TYPE_DWORD;
+		plExec->value = PRN & 0xFF;
+		plExec->type = TYPE_DWORD;
 	}
 	else
 	{
-		pipeline[plPtrExec].value = PRN;
-		pipeline[plPtrExec].type = TYPE_BYTE;
+		plExec->value = PRN;
+		plExec->type = TYPE_BYTE;
 	}
 
 	WRITEBACK_ADDR;
@@ -4633,20 +4621,20 @@ static void DSP_storew(void)
 //
 //	NO_WRITEBACK;
 #ifdef DSP_CORRECT_ALIGNMENT_STORE
-	pipeline[plPtrExec].address = PRM & 0xFFFFFFFE;
+	plExec->address = PRM & 0xFFFFFFFE;
 #else
-	pipeline[plPtrExec].address = PRM;
+	plExec->address = PRM;
 #endif
 
 	if (PRM >= DSP_WORK_RAM_BASE && PRM <= (DSP_WORK_RAM_BASE + 0x1FFF))
 	{
-		pipeline[plPtrExec].value = PRN & 0xFFFF;
-		pipeline[plPtrExec].type = TYPE_DWORD;
+		plExec->value = PRN & 0xFFFF;
+		plExec->type = TYPE_DWORD;
 	}
 	else
 	{
-		pipeline[plPtrExec].value = PRN;
-		pipeline[plPtrExec].type = TYPE_WORD;
+		plExec->value = PRN;
+		plExec->type = TYPE_WORD;
 	}
 	WRITEBACK_ADDR;
 }
@@ -4655,17 +4643,17 @@ static void DSP_store_r14_i(void)
 {
 #ifdef DSP_DIS_STORE14I
 	if (doDSPDis)
-		WriteLog("%06X: STORE  R%02u, (R14+$%02X) [NCZ:%u%u%u, R%02u=%08X, R14+$%02X=%08X]\n", DSP_PPC, PIMM2, dsp_convert_zero[PIMM1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, dsp_convert_zero[PIMM1] << 2, dsp_reg[14]+(dsp_convert_zero[PIMM1] << 2));
+		WriteLog("%06X: STORE  R%02u, (R14+$%02X) [NCZ:%u%u%u, R%02u=%08X, R14+$%02X=%08X]\n", DSP_PPC, PIMM2, riscConvertZero[PIMM1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, riscConvertZero[PIMM1] << 2, dsp_reg[14]+(riscConvertZero[PIMM1] << 2));
 #endif
-//	DSPWriteLong(dsp_reg[14] + (dsp_convert_zero[PIMM1] << 2), PRN, DSP);
+//	DSPWriteLong(dsp_reg[14] + (riscConvertZero[PIMM1] << 2), PRN, DSP);
 //	NO_WRITEBACK;
 #ifdef DSP_CORRECT_ALIGNMENT_STORE
-	pipeline[plPtrExec].address = (dsp_reg[14] & 0xFFFFFFFC) + (dsp_convert_zero[PIMM1] << 2);
+	plExec->address = (dsp_reg[14] & 0xFFFFFFFC) + (riscConvertZero[PIMM1] << 2);
 #else
-	pipeline[plPtrExec].address = dsp_reg[14] + (dsp_convert_zero[PIMM1] << 2);
+	plExec->address = dsp_reg[14] + (riscConvertZero[PIMM1] << 2);
 #endif
-	pipeline[plPtrExec].value = PRN;
-	pipeline[plPtrExec].type = TYPE_DWORD;
+	plExec->value = PRN;
+	plExec->type = TYPE_DWORD;
 	WRITEBACK_ADDR;
 }
 
@@ -4674,12 +4662,12 @@ static void DSP_store_r14_r(void)
 //	DSPWriteLong(dsp_reg[14] + PRM, PRN, DSP);
 //	NO_WRITEBACK;
 #ifdef DSP_CORRECT_ALIGNMENT_STORE
-	pipeline[plPtrExec].address = (dsp_reg[14] + PRM) & 0xFFFFFFFC;
+	plExec->address = (dsp_reg[14] + PRM) & 0xFFFFFFFC;
 #else
-	pipeline[plPtrExec].address = dsp_reg[14] + PRM;
+	plExec->address = dsp_reg[14] + PRM;
 #endif
-	pipeline[plPtrExec].value = PRN;
-	pipeline[plPtrExec].type = TYPE_DWORD;
+	plExec->value = PRN;
+	plExec->type = TYPE_DWORD;
 	WRITEBACK_ADDR;
 }
 
@@ -4687,17 +4675,17 @@ static void DSP_store_r15_i(void)
 {
 #ifdef DSP_DIS_STORE15I
 	if (doDSPDis)
-		WriteLog("%06X: STORE  R%02u, (R15+$%02X) [NCZ:%u%u%u, R%02u=%08X, R15+$%02X=%08X]\n", DSP_PPC, PIMM2, dsp_convert_zero[PIMM1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, dsp_convert_zero[PIMM1] << 2, dsp_reg[15]+(dsp_convert_zero[PIMM1] << 2));
+		WriteLog("%06X: STORE  R%02u, (R15+$%02X) [NCZ:%u%u%u, R%02u=%08X, R15+$%02X=%08X]\n", DSP_PPC, PIMM2, riscConvertZero[PIMM1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, riscConvertZero[PIMM1] << 2, dsp_reg[15]+(riscConvertZero[PIMM1] << 2));
 #endif
-//	DSPWriteLong(dsp_reg[15] + (dsp_convert_zero[PIMM1] << 2), PRN, DSP);
+//	DSPWriteLong(dsp_reg[15] + (riscConvertZero[PIMM1] << 2), PRN, DSP);
 //	NO_WRITEBACK;
 #ifdef DSP_CORRECT_ALIGNMENT_STORE
-	pipeline[plPtrExec].address = (dsp_reg[15] & 0xFFFFFFFC) + (dsp_convert_zero[PIMM1] << 2);
+	plExec->address = (dsp_reg[15] & 0xFFFFFFFC) + (riscConvertZero[PIMM1] << 2);
 #else
-	pipeline[plPtrExec].address = dsp_reg[15] + (dsp_convert_zero[PIMM1] << 2);
+	plExec->address = dsp_reg[15] + (riscConvertZero[PIMM1] << 2);
 #endif
-	pipeline[plPtrExec].value = PRN;
-	pipeline[plPtrExec].type = TYPE_DWORD;
+	plExec->value = PRN;
+	plExec->type = TYPE_DWORD;
 	WRITEBACK_ADDR;
 }
 
@@ -4706,12 +4694,12 @@ static void DSP_store_r15_r(void)
 //	DSPWriteLong(dsp_reg[15] + PRM, PRN, DSP);
 //	NO_WRITEBACK;
 #ifdef DSP_CORRECT_ALIGNMENT_STORE
-	pipeline[plPtrExec].address = (dsp_reg[15] + PRM) & 0xFFFFFFFC;
+	plExec->address = (dsp_reg[15] + PRM) & 0xFFFFFFFC;
 #else
-	pipeline[plPtrExec].address = dsp_reg[15] + PRM;
+	plExec->address = dsp_reg[15] + PRM;
 #endif
-	pipeline[plPtrExec].value = PRN;
-	pipeline[plPtrExec].type = TYPE_DWORD;
+	plExec->value = PRN;
+	plExec->type = TYPE_DWORD;
 	WRITEBACK_ADDR;
 }
 
@@ -4750,9 +4738,9 @@ static void DSP_subq(void)
 {
 #ifdef DSP_DIS_SUBQ
 	if (doDSPDis)
-		WriteLog("%06X: SUBQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: SUBQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, riscConvertZero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
 #endif
-	uint32_t r1 = dsp_convert_zero[PIMM1];
+	uint32_t r1 = riscConvertZero[PIMM1];
 	uint32_t res = PRN - r1;
 	SET_ZNC_SUB(PRN, r1, res);
 	PRES = res;
@@ -4764,7 +4752,7 @@ static void DSP_subq(void)
 
 static void DSP_subqmod(void)
 {
-	uint32_t r1 = dsp_convert_zero[PIMM1];
+	uint32_t r1 = riscConvertZero[PIMM1];
 	uint32_t r2 = PRN;
 	uint32_t res = r2 - r1;
 	res = (res & (~dsp_modulo)) | (r2 & dsp_modulo);
@@ -4776,9 +4764,9 @@ static void DSP_subqt(void)
 {
 #ifdef DSP_DIS_SUBQT
 	if (doDSPDis)
-		WriteLog("%06X: SUBQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: SUBQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, riscConvertZero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
 #endif
-	PRES = PRN - dsp_convert_zero[PIMM1];
+	PRES = PRN - riscConvertZero[PIMM1];
 #ifdef DSP_DIS_SUBQT
 	if (doDSPDis)
 		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
@@ -6,6 +6,7 @@
 #define __DSP_H__
 
 #include "memory.h"
+#include "risc.h"
 
 #define DSP_CONTROL_RAM_BASE    0x00F1A100
 #define DSP_WORK_RAM_BASE		0x00F1B000
@@ -28,13 +29,14 @@ bool DSPIsRunning(void);
 
 void DSPExecP(int32_t cycles);
 void DSPExecP2(int32_t cycles);
+void DSPExecLockstep(int32_t cycles);
 //void DSPExecP3(int32_t cycles);
 void DSPExecComp(int32_t cycles);
 
 // Exported vars
 
 extern bool doDSPDis;
-extern uint32_t dsp_reg_bank_0[], dsp_reg_bank_1[];
+extern PER_MACHINE RiscState dspState;
 
 // DSP interrupt numbers (in $F1A100, bits 4-8 & 16)
 
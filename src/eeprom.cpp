@@ -23,8 +23,8 @@
 
 //#define eeprom_LOG
 
-static uint16_t eeprom_ram[64];
-static uint16_t cdromEEPROM[64];
+static PER_MACHINE uint16_t eeprom_ram[64];
+static PER_MACHINE uint16_t cdromEEPROM[64];
 
 //
 // Private function prototypes
@@ -45,20 +45,20 @@ enum { EE_STATE_START = 1, EE_STATE_OP_A, EE_STATE_OP_B, EE_STATE_0, EE_STATE_1,
 
 // Local global variables
 
-static uint16_t jerry_ee_state = EE_STATE_START;
-static uint16_t jerry_ee_op = 0;
-static uint16_t jerry_ee_rstate = 0;
-static uint16_t jerry_ee_address_data = 0;
-static uint16_t jerry_ee_address_cnt = 6;
-static uint16_t jerry_ee_data = 0;
-static uint16_t jerry_ee_data_cnt = 16;
-static uint16_t jerry_writes_enabled = 0;
-static uint16_t jerry_ee_direct_jump = 0;
-
-static char eeprom_filename[MAX_PATH];
-static char cdromEEPROMFilename[MAX_PATH];
-static bool haveEEPROM = false;
-static bool haveCDROMEEPROM = false;
+static PER_MACHINE uint16_t jerry_ee_state = EE_STATE_START;
+static PER_MACHINE uint16_t jerry_ee_op = 0;
+static PER_MACHINE uint16_t jerry_ee_rstate = 0;
+static PER_MACHINE uint16_t jerry_ee_address_data = 0;
+static PER_MACHINE uint16_t jerry_ee_address_cnt = 6;
+static PER_MACHINE uint16_t jerry_ee_data = 0;
+static PER_MACHINE uint16_t jerry_ee_data_cnt = 16;
+static PER_MACHINE uint16_t jerry_writes_enabled = 0;
+static PER_MACHINE uint16_t jerry_ee_direct_jump = 0;
+
+static PER_MACHINE char eeprom_filename[MAX_PATH];
+static PER_MACHINE char cdromEEPROMFilename[MAX_PATH];
+static PER_MACHINE bool haveEEPROM = false;
+static PER_MACHINE bool haveCDROMEEPROM = false;
 
 
 void EepromInit(void)
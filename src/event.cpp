@@ -19,12 +19,14 @@
 
 #include "event.h"
 
-#include <stdint.h>
+#include <stdlib.h>
+#include "jaguar.h"
 #include "log.h"
+#include "settings.h"
 
 
-//#define EVENT_LIST_SIZE       512
-#define EVENT_LIST_SIZE       32
+// Initial size of the event pool; it grows on demand so there is no hard limit
+#define EVENT_POOL_INITIAL_SIZE		32
 
 
 // Now, a bit of weirdness: It seems that the number of lines displayed on the screen
@@ -32,230 +34,389 @@
 
 // NOTE ABOUT TIMING SYSTEM DATA STRUCTURES:
 
-// A queue won't work for this system because we can't guarantee that an event will go
-// in with a time that is later than the ones already queued up. So we just use a simple
-// list.
-
-// Although if we used an insertion sort we could, but it wouldn't work for adjusting
-// times... (For that, you would have to remove the event then reinsert it.)
+// Events live in a pool and are ordered by a binary min-heap per list (MAIN &
+// JERRY), keyed on the absolute time in RISC clock ticks at which they fire.
+// The next event is always at the top of the heap, so finding it is O(1);
+// adding, removing and adjusting an event is O(log n). Times are integers, so
+// nothing drifts no matter how long we run: each list keeps its own clock,
+// which jumps to an event's time when that event is handled.
+//
+// Events with the same time fire in the order they were scheduled.
+//
+// Handles carry the slot's serial number, so a handle to an event that has
+// already fired (and whose slot has since been reused) is simply ignored.
 
 struct Event
 {
-	bool valid;
+	uint64_t eventTime;							// Absolute time in RISC ticks
+	uint64_t sequence;							// Tiebreaker for equal times
+	uint32_t serial;							// Bumped each time the slot is freed
+	int32_t heapIndex;							// Position in heap, -1 if not queued
 	int eventType;
-	double eventTime;
 	void (* timerCallback)(void);
+	uint32_t nextFree;
+};
+
+struct EventQueue
+{
+	uint32_t * heap;							// Indices into eventPool
+	uint32_t size;
+	uint32_t capacity;
+	uint64_t clock;								// Current time of this list, in RISC ticks
 };
 
 
-static Event eventList[EVENT_LIST_SIZE];
-static Event eventListJERRY[EVENT_LIST_SIZE];
-static uint32_t nextEvent;
-static uint32_t nextEventJERRY;
-static uint32_t numberOfEvents;
+#define NO_EVENT		0xFFFFFFFF
 
+static PER_MACHINE Event * eventPool = NULL;
+static PER_MACHINE uint32_t eventPoolSize = 0;
+static PER_MACHINE uint32_t freeEventList = NO_EVENT;	// Head of free slot list
+static PER_MACHINE uint64_t eventSequence;
+static PER_MACHINE EventQueue eventQueue[2];	// EVENT_MAIN & EVENT_JERRY
+static PER_MACHINE uint32_t numberOfEvents;
+static PER_MACHINE double usecPerTick = RISC_CYCLE_IN_USEC;	// Only used by the µs interface
 
-void InitializeEventList(void)
+PER_MACHINE uint32_t masterClockRate = RISC_CLOCK_RATE_NTSC;
+
+
+static inline bool EventBefore(uint32_t a, uint32_t b)
+{
+	if (eventPool[a].eventTime != eventPool[b].eventTime)
+		return eventPool[a].eventTime < eventPool[b].eventTime;
+
+	return eventPool[a].sequence < eventPool[b].sequence;
+}
+
+
+static inline void HeapPlace(EventQueue & q, uint32_t pos, uint32_t slot)
+{
+	q.heap[pos] = slot;
+	eventPool[slot].heapIndex = pos;
+}
+
+
+static void SiftUp(EventQueue & q, uint32_t pos)
 {
-	for(uint32_t i=0; i<EVENT_LIST_SIZE; i++)
+	uint32_t slot = q.heap[pos];
+
+	while (pos > 0)
 	{
-		eventList[i].valid = false;
-		eventListJERRY[i].valid = false;
+		uint32_t parent = (pos - 1) >> 1;
+
+		if (!EventBefore(slot, q.heap[parent]))
+			break;
+
+		HeapPlace(q, pos, q.heap[parent]);
+		pos = parent;
 	}
 
-	numberOfEvents = 0;
-	WriteLog("EVENT: Cleared event list.\n");
+	HeapPlace(q, pos, slot);
 }
 
 
-// Set callback time in µs. This is fairly arbitrary, but works well enough for our purposes.
-//We just slap the next event into the list in the first available slot, no checking, no nada...
-void SetCallbackTime(void (* callback)(void), double time, int type/*= EVENT_MAIN*/)
+static void SiftDown(EventQueue & q, uint32_t pos)
 {
-	if (type == EVENT_MAIN)
+	uint32_t slot = q.heap[pos];
+
+	while (true)
 	{
-		for(uint32_t i=0; i<EVENT_LIST_SIZE; i++)
-		{
-			if (!eventList[i].valid)
-			{
-//WriteLog("EVENT: Found callback slot #%u...\n", i);
-				eventList[i].timerCallback = callback;
-				eventList[i].eventTime = time;
-				eventList[i].eventType = type;
-				eventList[i].valid = true;
-				numberOfEvents++;
-
-				return;
-			}
-		}
+		uint32_t child = (pos * 2) + 1;
+
+		if (child >= q.size)
+			break;
+
+		if ((child + 1 < q.size) && EventBefore(q.heap[child + 1], q.heap[child]))
+			child++;
 
-		WriteLog("EVENT: SetCallbackTime() failed to find an empty slot in the main list (%u events)!\n", numberOfEvents);
+		if (!EventBefore(q.heap[child], slot))
+			break;
+
+		HeapPlace(q, pos, q.heap[child]);
+		pos = child;
 	}
-	else
+
+	HeapPlace(q, pos, slot);
+}
+
+
+static uint32_t AllocateEvent(void)
+{
+	if (freeEventList == NO_EVENT)
 	{
-		for(uint32_t i=0; i<EVENT_LIST_SIZE; i++)
+		uint32_t newSize = (eventPoolSize ? eventPoolSize * 2 : EVENT_POOL_INITIAL_SIZE);
+		eventPool = (Event *)realloc(eventPool, newSize * sizeof(Event));
+
+		for(uint32_t i=eventPoolSize; i<newSize; i++)
 		{
-			if (!eventListJERRY[i].valid)
-			{
-//WriteLog("EVENT: Found callback slot #%u...\n", i);
-				eventListJERRY[i].timerCallback = callback;
-				eventListJERRY[i].eventTime = time;
-				eventListJERRY[i].eventType = type;
-				eventListJERRY[i].valid = true;
-				numberOfEvents++;
-
-				return;
-			}
+			eventPool[i].serial = 1;
+			eventPool[i].heapIndex = -1;
+			eventPool[i].nextFree = (i + 1 < newSize ? i + 1 : NO_EVENT);
 		}
 
-		WriteLog("EVENT: SetCallbackTime() failed to find an empty slot in the main list (%u events)!\n", numberOfEvents);
+		// Both heaps can hold every event in the pool, so grow them in step
+		for(int i=0; i<2; i++)
+		{
+			eventQueue[i].heap = (uint32_t *)realloc(eventQueue[i].heap, newSize * sizeof(uint32_t));
+			eventQueue[i].capacity = newSize;
+		}
+
+		freeEventList = eventPoolSize;
+		eventPoolSize = newSize;
+//WriteLog("EVENT: Grew event pool to %u slots...\n", newSize);
 	}
+
+	uint32_t slot = freeEventList;
+	freeEventList = eventPool[slot].nextFree;
+
+	return slot;
 }
 
 
-void RemoveCallback(void (* callback)(void))
+static void FreeEvent(uint32_t slot)
+{
+	eventPool[slot].heapIndex = -1;
+	eventPool[slot].serial++;
+	eventPool[slot].nextFree = freeEventList;
+	freeEventList = slot;
+}
+
+
+static void UnlinkEvent(uint32_t slot)
 {
-	for(uint32_t i=0; i<EVENT_LIST_SIZE; i++)
+	EventQueue & q = eventQueue[eventPool[slot].eventType];
+	uint32_t pos = eventPool[slot].heapIndex;
+	uint32_t last = q.heap[--q.size];
+
+	if (pos != q.size)
 	{
-		if (eventList[i].valid && eventList[i].timerCallback == callback)
-		{
-			eventList[i].valid = false;
-			numberOfEvents--;
+		HeapPlace(q, pos, last);
 
-			return;
-		}
-		else if (eventListJERRY[i].valid && eventListJERRY[i].timerCallback == callback)
-		{
-			eventListJERRY[i].valid = false;
-			numberOfEvents--;
+		if (pos > 0 && EventBefore(last, q.heap[(pos - 1) >> 1]))
+			SiftUp(q, pos);
+		else
+			SiftDown(q, pos);
+	}
+
+	FreeEvent(slot);
+	numberOfEvents--;
+}
 
-			return;
+
+static inline EventHandle MakeHandle(uint32_t slot)
+{
+	return ((uint64_t)eventPool[slot].serial << 32) | slot;
+}
+
+
+// Returns the slot for a handle, or NO_EVENT if the event is gone
+static inline uint32_t HandleToSlot(EventHandle handle)
+{
+	uint32_t slot = (uint32_t)handle;
+
+	if (handle == EVENT_HANDLE_NONE || slot >= eventPoolSize
+		|| eventPool[slot].serial != (uint32_t)(handle >> 32)
+		|| eventPool[slot].heapIndex < 0)
+		return NO_EVENT;
+
+	return slot;
+}
+
+
+static uint32_t FindCallback(void (* callback)(void))
+{
+	// There are only ever a handful of events queued, so this is cheap
+	for(int i=0; i<2; i++)
+	{
+		for(uint32_t j=0; j<eventQueue[i].size; j++)
+		{
+			if (eventPool[eventQueue[i].heap[j]].timerCallback == callback)
+				return eventQueue[i].heap[j];
 		}
 	}
+
+	return NO_EVENT;
 }
 
 
-void AdjustCallbackTime(void (* callback)(void), double time)
+static inline uint64_t UsecToTicks(double time)
+{
+	if (time <= 0)
+		return 0;
+
+	return (uint64_t)((time / usecPerTick) + 0.5);
+}
+
+
+void InitializeEventList(void)
 {
-	for(uint32_t i=0; i<EVENT_LIST_SIZE; i++)
+	// Resolve the timebase once here, so nothing in the execution loop has to
+	// care whether we're NTSC or PAL
+	masterClockRate = (vjs.hardwareTypeNTSC ? RISC_CLOCK_RATE_NTSC : RISC_CLOCK_RATE_PAL);
+	usecPerTick = (vjs.hardwareTypeNTSC ? RISC_CYCLE_IN_USEC : RISC_CYCLE_PAL_IN_USEC);
+	freeEventList = NO_EVENT;
+
+	// Put every slot back on the free list (lowest slot first)
+	for(uint32_t i=eventPoolSize; i>0; i--)
 	{
-		if (eventList[i].valid && eventList[i].timerCallback == callback)
-		{
-			eventList[i].eventTime = time;
+		if (eventPool[i - 1].heapIndex >= 0)
+			eventPool[i - 1].serial++;
 
-			return;
-		}
-		else if (eventListJERRY[i].valid && eventListJERRY[i].timerCallback == callback)
-		{
-			eventListJERRY[i].eventTime = time;
+		eventPool[i - 1].heapIndex = -1;
+		eventPool[i - 1].nextFree = freeEventList;
+		freeEventList = i - 1;
+	}
 
-			return;
-		}
+	for(int i=0; i<2; i++)
+	{
+		eventQueue[i].size = 0;
+		eventQueue[i].clock = 0;
 	}
+
+	eventSequence = 0;
+	numberOfEvents = 0;
+	WriteLog("EVENT: Cleared event list.\n");
 }
 
 
 //
-// Since our list is unordered WRT time, we have to search it to find the next event
-// Returns time to next event & sets nextEvent to that event
+// Give the event pool back (InitializeEventList() has to be called before the
+// event list can be used again)
 //
-double GetTimeToNextEvent(int type/*= EVENT_MAIN*/)
+void FreeEventList(void)
 {
-#if 0
-	double time = 0;
-	bool firstTime = true;
+	free(eventPool);
+	eventPool = NULL;
+	eventPoolSize = 0;
+	freeEventList = NO_EVENT;
 
-	for(uint32 i=0; i<EVENT_LIST_SIZE; i++)
+	for(int i=0; i<2; i++)
 	{
-		if (eventList[i].valid)
-		{
-			if (firstTime)
-				time = eventList[i].eventTime, nextEvent = i, firstTime = false;
-			else
-			{
-				if (eventList[i].eventTime < time)
-					time = eventList[i].eventTime, nextEvent = i;
-			}
-		}
+		free(eventQueue[i].heap);
+		eventQueue[i].heap = NULL;
+		eventQueue[i].size = eventQueue[i].capacity = 0;
 	}
-#else
-	if (type == EVENT_MAIN)
-	{
-		double time = eventList[0].eventTime;
-		nextEvent = 0;
+}
 
-		for(uint32_t i=1; i<EVENT_LIST_SIZE; i++)
-		{
-			if (eventList[i].valid && (eventList[i].eventTime < time))
-			{
-				time = eventList[i].eventTime;
-				nextEvent = i;
-			}
-		}
 
-		return time;
-	}
-	else
-	{
-		double time = eventListJERRY[0].eventTime;
-		nextEventJERRY = 0;
+// Set callback time in µs. This is fairly arbitrary, but works well enough for our purposes.
+// The time is rounded to the nearest RISC clock tick.
+EventHandle SetCallbackTime(void (* callback)(void), double time, int type/*= EVENT_MAIN*/)
+{
+	return SetCallbackTicks(callback, UsecToTicks(time), type);
+}
 
-		for(uint32_t i=1; i<EVENT_LIST_SIZE; i++)
-		{
-			if (eventListJERRY[i].valid && (eventListJERRY[i].eventTime < time))
-			{
-				time = eventListJERRY[i].eventTime;
-				nextEventJERRY = i;
-			}
-		}
 
-		return time;
-	}
-#endif
+// Set callback time in RISC clock ticks from now
+EventHandle SetCallbackTicks(void (* callback)(void), uint64_t ticks, int type/*= EVENT_MAIN*/)
+{
+	uint32_t slot = AllocateEvent();
+	EventQueue & q = eventQueue[type];
+
+	eventPool[slot].timerCallback = callback;
+	eventPool[slot].eventTime = q.clock + ticks;
+	eventPool[slot].sequence = eventSequence++;
+	eventPool[slot].eventType = type;
+
+	q.heap[q.size] = slot;
+	SiftUp(q, q.size++);
+	numberOfEvents++;
+
+	return MakeHandle(slot);
 }
 
 
-void HandleNextEvent(int type/*= EVENT_MAIN*/)
+void RemoveCallback(void (* callback)(void))
 {
-	if (type == EVENT_MAIN)
-	{
-		double elapsedTime = eventList[nextEvent].eventTime;
-		void (* event)(void) = eventList[nextEvent].timerCallback;
+	uint32_t slot = FindCallback(callback);
 
-		for(uint32_t i=0; i<EVENT_LIST_SIZE; i++)
-		{
-	//We can skip the check & just subtract from everything, since the check is probably
-	//just as heavy as the code after and we won't use the elapsed time from an invalid event anyway.
-	//		if (eventList[i].valid)
-				eventList[i].eventTime -= elapsedTime;
-		}
+	if (slot != NO_EVENT)
+		UnlinkEvent(slot);
+}
 
-		eventList[nextEvent].valid = false;			// Remove event from list...
-		numberOfEvents--;
 
-		(*event)();
-	}
+void RemoveEvent(EventHandle handle)
+{
+	uint32_t slot = HandleToSlot(handle);
+
+	if (slot != NO_EVENT)
+		UnlinkEvent(slot);
+}
+
+
+static void AdjustEvent(uint32_t slot, uint64_t ticks)
+{
+	EventQueue & q = eventQueue[eventPool[slot].eventType];
+	uint64_t oldTime = eventPool[slot].eventTime;
+	eventPool[slot].eventTime = q.clock + ticks;
+
+	if (eventPool[slot].eventTime < oldTime)
+		SiftUp(q, eventPool[slot].heapIndex);
 	else
-	{
-		double elapsedTime = eventListJERRY[nextEventJERRY].eventTime;
-		void (* event)(void) = eventListJERRY[nextEventJERRY].timerCallback;
+		SiftDown(q, eventPool[slot].heapIndex);
+}
 
-		for(uint32_t i=0; i<EVENT_LIST_SIZE; i++)
-		{
-	//We can skip the check & just subtract from everything, since the check is probably
-	//just as heavy as the code after and we won't use the elapsed time from an invalid event anyway.
-	//		if (eventList[i].valid)
-				eventListJERRY[i].eventTime -= elapsedTime;
-		}
 
-		eventListJERRY[nextEventJERRY].valid = false;	// Remove event from list...
-		numberOfEvents--;
+void AdjustCallbackTime(void (* callback)(void), double time)
+{
+	uint32_t slot = FindCallback(callback);
 
-		(*event)();
-	}
+	if (slot != NO_EVENT)
+		AdjustEvent(slot, UsecToTicks(time));
 }
 
 
+void AdjustEventTicks(EventHandle handle, uint64_t ticks)
+{
+	uint32_t slot = HandleToSlot(handle);
+
+	if (slot != NO_EVENT)
+		AdjustEvent(slot, ticks);
+}
+
+
+//
+// Returns time to next event (in RISC clock ticks)
+//
+uint64_t GetTicksToNextEvent(int type/*= EVENT_MAIN*/)
+{
+	EventQueue & q = eventQueue[type];
+
+	if (q.size == 0)
+		return 0;
+
+	return eventPool[q.heap[0]].eventTime - q.clock;
+}
+
+
+//
+// Returns the current time of the list (in RISC clock ticks since reset)
+//
+uint64_t GetMasterClock(int type/*= EVENT_MAIN*/)
+{
+	return eventQueue[type].clock;
+}
+
+
+void HandleNextEvent(int type/*= EVENT_MAIN*/)
+{
+	EventQueue & q = eventQueue[type];
+
+	if (q.size == 0)
+		return;
+
+	uint32_t slot = q.heap[0];
+	void (* event)(void) = eventPool[slot].timerCallback;
+	q.clock = eventPool[slot].eventTime;
+
+	// Remove event from list *before* calling it, as the callback will
+	// usually put itself right back in...
+	UnlinkEvent(slot);
+
+	(*event)();
+}
+
+
+
 /*
 void OPCallback(void)
 {
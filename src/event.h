@@ -7,6 +7,11 @@
 #ifndef __EVENT_H__
 #define __EVENT_H__
 
+#include <stdint.h>
+#include "machine.h"
+
+// Everything runs on the EVENT_MAIN timeline; EVENT_JERRY is a separate list
+// with its own clock, for things that need to be driven independently
 enum { EVENT_MAIN, EVENT_JERRY };
 
 //NTSC Timings...
@@ -19,14 +24,28 @@ enum { EVENT_MAIN, EVENT_JERRY };
 #define HORIZ_PERIOD_IN_USEC_NTSC	63.555555555
 #define HORIZ_PERIOD_IN_USEC_PAL	64.0
 
-#define USEC_TO_RISC_CYCLES(u) (uint32_t)(((u) / (vjs.hardwareTypeNTSC ? RISC_CYCLE_IN_USEC : RISC_CYCLE_PAL_IN_USEC)) + 0.5)
-#define USEC_TO_M68K_CYCLES(u) (uint32_t)(((u) / (vjs.hardwareTypeNTSC ? M68K_CYCLE_IN_USEC : M68K_CYCLE_PAL_IN_USEC)) + 0.5)
+// The master clock counts RISC clock ticks; the 68K runs at half that rate.
+// Half line periods in ticks (31.777... µs NTSC, 32 µs PAL)
+#define HALFLINE_TICKS_NTSC			845
+#define HALFLINE_TICKS_PAL			851
+
+// Opaque handle to a scheduled event; 0 is never a valid handle
+typedef uint64_t EventHandle;
+#define EVENT_HANDLE_NONE			0
+
+// Resolved from vjs.hardwareTypeNTSC by InitializeEventList()
+extern PER_MACHINE uint32_t masterClockRate;				// RISC ticks per second
 
 void InitializeEventList(void);
-void SetCallbackTime(void (* callback)(void), double time, int type = EVENT_MAIN);
+void FreeEventList(void);
+uint64_t GetMasterClock(int type = EVENT_MAIN);
+EventHandle SetCallbackTime(void (* callback)(void), double time, int type = EVENT_MAIN);
+EventHandle SetCallbackTicks(void (* callback)(void), uint64_t ticks, int type = EVENT_MAIN);
 void RemoveCallback(void (* callback)(void));
+void RemoveEvent(EventHandle handle);
 void AdjustCallbackTime(void (* callback)(void), double time);
-double GetTimeToNextEvent(int type = EVENT_MAIN);
+void AdjustEventTicks(EventHandle handle, uint64_t ticks);
+uint64_t GetTicksToNextEvent(int type = EVENT_MAIN);
 void HandleNextEvent(int type = EVENT_MAIN);
 
 #endif	// __EVENT_H__
@@ -136,9 +136,10 @@ bool JaguarLoadFile(char * path)
 	if (fileType == JST_ROM)
 	{
 		jaguarCartInserted = true;
-		memcpy(jagMemSpace + 0x800000, buffer, jaguarROMSize);
+		JagMemReleaseROM();
+		JagMemCopyIn(0x800000, buffer, jaguarROMSize);
 // Checking something...
-jaguarRunAddress = GET32(jagMemSpace, 0x800404);
+jaguarRunAddress = JagMemRead32(jaguarMainROM, 0x404);
 WriteLog("FILE: Cartridge run address is reported as $%X...\n", jaguarRunAddress);
 		delete[] buffer;
 		return true;
@@ -147,15 +148,16 @@ WriteLog("FILE: Cartridge run address is reported as $%X...\n", jaguarRunAddress
 	{
 		// File extension ".ROM": Alpine image that loads/runs at $802000
 		WriteLog("FILE: Setting up Alpine ROM... Run address: 00802000, length: %08X\n", jaguarROMSize);
-		memset(jagMemSpace + 0x800000, 0xFF, 0x2000);
-		memcpy(jagMemSpace + 0x802000, buffer, jaguarROMSize);
+		JagMemReleaseROM();
+		memset(jaguarMainROM, 0xFF, 0x2000);
+		JagMemCopyIn(0x802000, buffer, jaguarROMSize);
 		delete[] buffer;
 
 // Maybe instead of this, we could try requiring the STUBULATOR ROM? Just a thought...
 		// Try setting the vector to say, $1000 and putting an instruction there that loops forever:
 		// This kludge works! Yeah!
-		SET32(jaguarMainRAM, 0x10, 0x00001000);
-		SET16(jaguarMainRAM, 0x1000, 0x60FE);		// Here: bra Here
+		JagMemWrite32(jaguarMainRAM, 0x10, 0x00001000);
+		JagMemWrite16(jaguarMainRAM, 0x1000, 0x60FE);		// Here: bra Here
 		return true;
 	}
 	else if (fileType == JST_ABS_TYPE1)
@@ -164,7 +166,7 @@ WriteLog("FILE: Cartridge run address is reported as $%X...\n", jaguarRunAddress
 		uint32_t loadAddress = GET32(buffer, 0x16),
 			codeSize = GET32(buffer, 0x02) + GET32(buffer, 0x06);
 		WriteLog("FILE: Setting up homebrew (ABS-1)... Run address: %08X, length: %08X\n", loadAddress, codeSize);
-		memcpy(jagMemSpace + loadAddress, buffer + 0x24, codeSize);
+		JagMemCopyIn(loadAddress, buffer + 0x24, codeSize);
 		delete[] buffer;
 		jaguarRunAddress = loadAddress;
 		return true;
@@ -174,7 +176,7 @@ WriteLog("FILE: Cartridge run address is reported as $%X...\n", jaguarRunAddress
 		uint32_t loadAddress = GET32(buffer, 0x28), runAddress = GET32(buffer, 0x24),
 			codeSize = GET32(buffer, 0x18) + GET32(buffer, 0x1C);
 		WriteLog("FILE: Setting up homebrew (ABS-2)... Run address: %08X, length: %08X\n", runAddress, codeSize);
-		memcpy(jagMemSpace + loadAddress, buffer + 0xA8, codeSize);
+		JagMemCopyIn(loadAddress, buffer + 0xA8, codeSize);
 		delete[] buffer;
 		jaguarRunAddress = runAddress;
 		return true;
@@ -222,13 +224,13 @@ WriteLog("FILE: Cartridge run address is reported as $%X...\n", jaguarRunAddress
 			// Also, JAGR vs. JAGL (word command size vs. long command size)
 			uint32_t loadAddress = GET32(buffer, 0x22), runAddress = GET32(buffer, 0x2A);
 			WriteLog("FILE: Setting up homebrew (Jag Server)... Run address: $%X, length: $%X\n", runAddress, jaguarROMSize - 0x2E);
-			memcpy(jagMemSpace + loadAddress, buffer + 0x2E, jaguarROMSize - 0x2E);
+			JagMemCopyIn(loadAddress, buffer + 0x2E, jaguarROMSize - 0x2E);
 			delete[] buffer;
 			jaguarRunAddress = runAddress;
 
 // Hmm. Is this kludge necessary?
-SET32(jaguarMainRAM, 0x10, 0x00001000);		// Set Exception #4 (Illegal Instruction)
-SET16(jaguarMainRAM, 0x1000, 0x60FE);		// Here: bra Here
+JagMemWrite32(jaguarMainRAM, 0x10, 0x00001000);		// Set Exception #4 (Illegal Instruction)
+JagMemWrite16(jaguarMainRAM, 0x1000, 0x60FE);		// Here: bra Here
 
 			return true;
 //		}
@@ -246,7 +248,7 @@ SET16(jaguarMainRAM, 0x1000, 0x60FE);		// Here: bra Here
 	{
 		uint32_t loadAddress = (buffer[0x1F] << 24) | (buffer[0x1E] << 16) | (buffer[0x1D] << 8) | buffer[0x1C];
 		WriteLog("FILE: Setting up homebrew (GEMDOS WTFOMGBBQ type)... Run address: $%X, length: $%X\n", loadAddress, jaguarROMSize - 0x20);
-		memcpy(jagMemSpace + loadAddress, buffer + 0x20, jaguarROMSize - 0x20);
+		JagMemCopyIn(loadAddress, buffer + 0x20, jaguarROMSize - 0x20);
 		delete[] buffer;
 		jaguarRunAddress = loadAddress;
 		return true;
@@ -284,16 +286,17 @@ bool AlpineLoadFile(char * path)
 
 	WriteLog("FILE: Setting up Alpine ROM with non-standard length... Run address: 00802000, length: %08X\n", jaguarROMSize);
 
-	memset(jagMemSpace + 0x800000, 0xFF, 0x2000);
-	memcpy(jagMemSpace + 0x802000, buffer, jaguarROMSize);
+	JagMemReleaseROM();
+	memset(jaguarMainROM, 0xFF, 0x2000);
+	JagMemCopyIn(0x802000, buffer, jaguarROMSize);
 	delete[] buffer;
 
 // Maybe instead of this, we could try requiring the STUBULATOR ROM? Just a thought...
 	// Try setting the vector to say, $1000 and putting an instruction there
 	// that loops forever:
 	// This kludge works! Yeah!
-	SET32(jaguarMainRAM, 0x10, 0x00001000);		// Set Exception #4 (Illegal Instruction)
-	SET16(jaguarMainRAM, 0x1000, 0x60FE);		// Here: bra Here
+	JagMemWrite32(jaguarMainRAM, 0x10, 0x00001000);		// Set Exception #4 (Illegal Instruction)
+	JagMemWrite16(jaguarMainRAM, 0x1000, 0x60FE);		// Here: bra Here
 
 	return true;
 }
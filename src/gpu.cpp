@@ -28,12 +28,17 @@
 
 #include <stdlib.h>
 #include <string.h>								// For memset
+#include <atomic>
+#include <thread>
 #include "dsp.h"
 #include "jagdasm.h"
 #include "jaguar.h"
+#include "jit.h"
 #include "log.h"
 #include "m68000/m68kinterface.h"
 //#include "memory.h"
+#include "risc.h"
+#include "settings.h"
 #include "tom.h"
 
 
@@ -174,8 +179,8 @@ GPU opcodes use (BIOS flying ATARI logo):
 
 // External global variables
 
-extern int start_logging;
-extern int gpu_start_log;
+extern PER_MACHINE int start_logging;
+extern PER_MACHINE int gpu_start_log;
 
 // Private function prototypes
 
@@ -184,45 +189,46 @@ void GPUDumpDisassembly(void);
 void GPUDumpRegisters(void);
 void GPUDumpMemory(void);
 
-static void gpu_opcode_add(void);
-static void gpu_opcode_addc(void);
-static void gpu_opcode_addq(void);
-static void gpu_opcode_addqt(void);
-static void gpu_opcode_sub(void);
-static void gpu_opcode_subc(void);
-static void gpu_opcode_subq(void);
-static void gpu_opcode_subqt(void);
-static void gpu_opcode_neg(void);
-static void gpu_opcode_and(void);
-static void gpu_opcode_or(void);
-static void gpu_opcode_xor(void);
-static void gpu_opcode_not(void);
-static void gpu_opcode_btst(void);
-static void gpu_opcode_bset(void);
-static void gpu_opcode_bclr(void);
-static void gpu_opcode_mult(void);
-static void gpu_opcode_imult(void);
-static void gpu_opcode_imultn(void);
-static void gpu_opcode_resmac(void);
-static void gpu_opcode_imacn(void);
+// Everything the RISC core touches (see risc.h)
+
+PER_MACHINE RiscState gpuState;
+
+// The rest of this file still goes by the old names
+#define gpu_pc						gpuState.pc
+#define gpu_control					gpuState.control
+#define gpu_flags					gpuState.flags
+#define gpu_flag_z					gpuState.flagZ
+#define gpu_flag_n					gpuState.flagN
+#define gpu_flag_c					gpuState.flagC
+#define gpu_acc						gpuState.acc
+#define gpu_remain					gpuState.remain
+#define gpu_matrix_control			gpuState.matrixControl
+#define gpu_pointer_to_matrix		gpuState.pointerToMatrix
+#define gpu_data_organization		gpuState.dataOrganization
+#define gpu_div_control				gpuState.divControl
+#define gpu_reg						gpuState.reg
+#define gpu_alternate_reg			gpuState.alternateReg
+#define gpu_reg_bank_0				gpuState.regBank0
+#define gpu_reg_bank_1				gpuState.regBank1
+#define gpu_instruction				gpuState.instruction
+#define gpu_opcode_first_parameter	gpuState.firstParameter
+#define gpu_opcode_second_parameter	gpuState.secondParameter
+
+// What RiscCore<> needs to know about the GPU
+struct GPUVariant
+{
+	static inline RiscState & State(void) { return gpuState; }
+	static inline void Exec(int32_t cycles) { GPUExec(cycles); }
+	static inline uint16_t ReadWord(uint32_t offset) { return GPUReadWord(offset, GPU); }
+};
+
+typedef RiscCore<GPUVariant> GPUCore;
+
+// The opcodes that are the GPU's alone (or that it does its own way)
+
 static void gpu_opcode_div(void);
-static void gpu_opcode_abs(void);
-static void gpu_opcode_sh(void);
-static void gpu_opcode_shlq(void);
-static void gpu_opcode_shrq(void);
-static void gpu_opcode_sha(void);
-static void gpu_opcode_sharq(void);
-static void gpu_opcode_ror(void);
-static void gpu_opcode_rorq(void);
-static void gpu_opcode_cmp(void);
-static void gpu_opcode_cmpq(void);
 static void gpu_opcode_sat8(void);
 static void gpu_opcode_sat16(void);
-static void gpu_opcode_move(void);
-static void gpu_opcode_moveq(void);
-static void gpu_opcode_moveta(void);
-static void gpu_opcode_movefa(void);
-static void gpu_opcode_movei(void);
 static void gpu_opcode_loadb(void);
 static void gpu_opcode_loadw(void);
 static void gpu_opcode_load(void);
@@ -235,13 +241,6 @@ static void gpu_opcode_store(void);
 static void gpu_opcode_storep(void);
 static void gpu_opcode_store_r14_indexed(void);
 static void gpu_opcode_store_r15_indexed(void);
-static void gpu_opcode_move_pc(void);
-static void gpu_opcode_jump(void);
-static void gpu_opcode_jr(void);
-static void gpu_opcode_mmult(void);
-static void gpu_opcode_mtoi(void);
-static void gpu_opcode_normi(void);
-static void gpu_opcode_nop(void);
 static void gpu_opcode_load_r14_ri(void);
 static void gpu_opcode_load_r15_ri(void);
 static void gpu_opcode_store_r14_ri(void);
@@ -290,48 +289,65 @@ uint8_t gpu_opcode_cycles[64] =
 
 void (*gpu_opcode[64])()=
 {
-	gpu_opcode_add,					gpu_opcode_addc,				gpu_opcode_addq,				gpu_opcode_addqt,
-	gpu_opcode_sub,					gpu_opcode_subc,				gpu_opcode_subq,				gpu_opcode_subqt,
-	gpu_opcode_neg,					gpu_opcode_and,					gpu_opcode_or,					gpu_opcode_xor,
-	gpu_opcode_not,					gpu_opcode_btst,				gpu_opcode_bset,				gpu_opcode_bclr,
-	gpu_opcode_mult,				gpu_opcode_imult,				gpu_opcode_imultn,				gpu_opcode_resmac,
-	gpu_opcode_imacn,				gpu_opcode_div,					gpu_opcode_abs,					gpu_opcode_sh,
-	gpu_opcode_shlq,				gpu_opcode_shrq,				gpu_opcode_sha,					gpu_opcode_sharq,
-	gpu_opcode_ror,					gpu_opcode_rorq,				gpu_opcode_cmp,					gpu_opcode_cmpq,
-	gpu_opcode_sat8,				gpu_opcode_sat16,				gpu_opcode_move,				gpu_opcode_moveq,
-	gpu_opcode_moveta,				gpu_opcode_movefa,				gpu_opcode_movei,				gpu_opcode_loadb,
-	gpu_opcode_loadw,				gpu_opcode_load,				gpu_opcode_loadp,				gpu_opcode_load_r14_indexed,
-	gpu_opcode_load_r15_indexed,	gpu_opcode_storeb,				gpu_opcode_storew,				gpu_opcode_store,
-	gpu_opcode_storep,				gpu_opcode_store_r14_indexed,	gpu_opcode_store_r15_indexed,	gpu_opcode_move_pc,
-	gpu_opcode_jump,				gpu_opcode_jr,					gpu_opcode_mmult,				gpu_opcode_mtoi,
-	gpu_opcode_normi,				gpu_opcode_nop,					gpu_opcode_load_r14_ri,			gpu_opcode_load_r15_ri,
-	gpu_opcode_store_r14_ri,		gpu_opcode_store_r15_ri,		gpu_opcode_sat24,				gpu_opcode_pack,
+	GPUCore::opcode_add,				GPUCore::opcode_addc,				GPUCore::opcode_addq,				GPUCore::opcode_addqt,
+	GPUCore::opcode_sub,				GPUCore::opcode_subc,				GPUCore::opcode_subq,				GPUCore::opcode_subqt,
+	GPUCore::opcode_neg,				GPUCore::opcode_and,				GPUCore::opcode_or,					GPUCore::opcode_xor,
+	GPUCore::opcode_not,				GPUCore::opcode_btst,				GPUCore::opcode_bset,				GPUCore::opcode_bclr,
+	GPUCore::opcode_mult,				GPUCore::opcode_imult,				GPUCore::opcode_imultn,				GPUCore::opcode_resmac,
+	GPUCore::opcode_imacn,				gpu_opcode_div,						GPUCore::opcode_abs,				GPUCore::opcode_sh,
+	GPUCore::opcode_shlq,				GPUCore::opcode_shrq,				GPUCore::opcode_sha,				GPUCore::opcode_sharq,
+	GPUCore::opcode_ror,				GPUCore::opcode_rorq,				GPUCore::opcode_cmp,				GPUCore::opcode_cmpq,
+	gpu_opcode_sat8,					gpu_opcode_sat16,					GPUCore::opcode_move,				GPUCore::opcode_moveq,
+	GPUCore::opcode_moveta,				GPUCore::opcode_movefa,				GPUCore::opcode_movei,				gpu_opcode_loadb,
+	gpu_opcode_loadw,					gpu_opcode_load,					gpu_opcode_loadp,					gpu_opcode_load_r14_indexed,
+	gpu_opcode_load_r15_indexed,		gpu_opcode_storeb,					gpu_opcode_storew,					gpu_opcode_store,
+	gpu_opcode_storep,					gpu_opcode_store_r14_indexed,		gpu_opcode_store_r15_indexed,		GPUCore::opcode_move_pc,
+	GPUCore::opcode_jump,				GPUCore::opcode_jr,					GPUCore::opcode_mmult,				GPUCore::opcode_mtoi,
+	GPUCore::opcode_normi,				GPUCore::opcode_nop,				gpu_opcode_load_r14_ri,				gpu_opcode_load_r15_ri,
+	gpu_opcode_store_r14_ri,			gpu_opcode_store_r15_ri,			gpu_opcode_sat24,					gpu_opcode_pack,
+};
+
+static PER_MACHINE uint8_t gpu_ram_8[0x1000];
+static PER_MACHINE uint32_t gpu_hidata;
+
+//
+// Predecode cache for local RAM. Every word of local RAM gets an entry with the
+// opcode already pulled apart, so code running out of local RAM (which is
+// nearly all of it) doesn't have to go thru GPUReadWord() & decode on every
+// instruction. Anything that writes to local RAM invalidates what it touches.
+//
+struct GPUDecodedOp
+{
+	void (* handler)(void);						// NULL if the entry's stale
+	uint16_t opcode;
+	uint8_t index;
+	uint8_t firstParameter, secondParameter;
 };
 
-static uint8_t gpu_ram_8[0x1000];
-uint32_t gpu_pc;
-static uint32_t gpu_acc;
-static uint32_t gpu_remain;
-static uint32_t gpu_hidata;
-static uint32_t gpu_flags;
-static uint32_t gpu_matrix_control;
-static uint32_t gpu_pointer_to_matrix;
-static uint32_t gpu_data_organization;
-static uint32_t gpu_control;
-static uint32_t gpu_div_control;
-// There is a distinct advantage to having these separated out--there's no need
-// to clear a bit before writing a result. I.e., if the result of an operation
-// leaves a zero in the carry flag, you don't have to zero gpu_flag_c before
-// you can write that zero!
-static uint8_t gpu_flag_z, gpu_flag_n, gpu_flag_c;
-uint32_t gpu_reg_bank_0[32];
-uint32_t gpu_reg_bank_1[32];
-static uint32_t * gpu_reg;
-static uint32_t * gpu_alternate_reg;
-
-static uint32_t gpu_instruction;
-static uint32_t gpu_opcode_first_parameter;
-static uint32_t gpu_opcode_second_parameter;
+static PER_MACHINE GPUDecodedOp gpuDecodeCache[0x800];
+
+// Same goes for the recompiler (see GPUJITCompile() below). Every word of local
+// RAM that went into a translated block is marked here; since there's no
+// telling which blocks it went into, writing to one throws them all away.
+static PER_MACHINE uint8_t gpuJITCovered[0x800];
+static PER_MACHINE bool gpuJITFlushPending = false;
+
+#ifdef JIT_X86_64
+static void GPUJITDone(void);
+#endif
+
+static inline void GPUInvalidateDecodeCache(uint32_t offset, uint32_t size)
+{
+	offset &= 0xFFF;
+
+	for(uint32_t i=(offset >> 1); i<=((offset + size - 1) >> 1); i++)
+	{
+		gpuDecodeCache[i & 0x7FF].handler = NULL;
+
+		if (gpuJITCovered[i & 0x7FF])
+			gpuJITFlushPending = true;
+	}
+}
 
 #define GPU_RUNNING		(gpu_control & 0x01)
 
@@ -360,13 +376,8 @@ static uint32_t gpu_opcode_second_parameter;
 #define SET_ZNC_ADD(a,b,r)	SET_N(r); SET_Z(r); SET_C_ADD(a,b)
 #define SET_ZNC_SUB(a,b,r)	SET_N(r); SET_Z(r); SET_C_SUB(a,b)
 
-uint32_t gpu_convert_zero[32] =
-	{ 32,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31 };
 
-uint8_t * branch_condition_table = 0;
-#define BRANCH_CONDITION(x)	branch_condition_table[(x) + ((jaguar_flags & 7) << 5)]
-
-uint32_t gpu_opcode_use[64];
+PER_MACHINE uint32_t gpu_opcode_use[64];
 
 const char * gpu_opcode_str[64]=
 {
@@ -388,8 +399,53 @@ const char * gpu_opcode_str[64]=
 	"store_r14_ri",		"store_r15_ri",		"sat24",			"pack",
 };
 
-static uint32_t gpu_in_exec = 0;
-static uint32_t gpu_releaseTimeSlice_flag = 0;
+static PER_MACHINE uint32_t gpu_in_exec = 0;
+static PER_MACHINE uint32_t gpu_releaseTimeSlice_flag = 0;
+
+// Threaded GPU support (see GPUExecThreaded() below)
+enum { GPU_SLICE_IDLE, GPU_SLICE_GO, GPU_SLICE_RUNNING, GPU_SLICE_PARKED,
+	GPU_SLICE_DONE, GPU_SLICE_QUIT };
+
+#define GPU_IDLE_SPINS		0x10000
+
+static std::thread * gpuThread = NULL;
+static std::atomic<int> gpuSliceState(GPU_SLICE_IDLE);
+static std::atomic<bool> m68kSliceDone(false);
+static int32_t gpuSliceCycles;
+static bool gpuMustPark = false;		// Only touched by the GPU thread
+
+// Anything outside of the GPU's local RAM & control registers is shared with
+// the 68K; so is G_CTRL, since writing it can interrupt the 68K or the DSP.
+#define GPU_LOCAL_READ(a)	(((a) >= GPU_WORK_RAM_BASE && (a) <= GPU_WORK_RAM_BASE + 0x0FFF) \
+	|| ((a) >= GPU_CONTROL_RAM_BASE && (a) <= GPU_CONTROL_RAM_BASE + 0x1F))
+#define GPU_LOCAL_WRITE(a)	(GPU_LOCAL_READ(a) && (((a) & 0xFFFFFC) != GPU_CONTROL_RAM_BASE + 0x14))
+
+static void GPUPark(void);
+
+// Spin loop detection (see GPUCheckSpinLoop() below)
+#define GPU_SPIN_MAX_SIZE	32			// In bytes
+#define GPU_SPIN_REPORTS	16
+
+// Opcodes that can't change anything but the registers they load/move into
+static const uint8_t gpu_spin_safe[64] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0,			// add, addc, addq, addqt, sub, subc, subq, subqt
+	0, 0, 0, 0, 0, 1, 0, 0,			// neg, and, or, xor, not, btst, bset, bclr
+	0, 0, 0, 0, 0, 0, 0, 0,			// mult, imult, imultn, resmac, imacn, div, abs, sh
+	0, 0, 0, 0, 0, 0, 1, 1,			// shlq, shrq, sha, sharq, ror, rorq, cmp, cmpq
+	0, 0, 1, 1, 0, 0, 1, 1,			// sat8, sat16, move, moveq, moveta, movefa, movei, loadb
+	1, 1, 0, 1, 1, 0, 0, 0,			// loadw, load, loadp, load_r14_i, load_r15_i, storeb, storew, store
+	0, 0, 0, 0, 1, 1, 0, 0,			// storep, store_r14_i, store_r15_i, move_pc, jump, jr, mmult, mtoi
+	0, 1, 1, 1, 0, 0, 0, 0			// normi, nop, load_r14_ri, load_r15_ri, store_r14_ri, store_r15_ri, sat24, pack
+};
+
+static PER_MACHINE bool gpuSideEffect = false;	// Set on any write (or side effecting read)
+static PER_MACHINE uint32_t gpuSpinHead;
+static PER_MACHINE bool gpuSpinSafe;
+static PER_MACHINE uint32_t gpuSpinRegs[32];
+static PER_MACHINE uint8_t gpuSpinFlags;
+static PER_MACHINE uint32_t gpuSpinReported[GPU_SPIN_REPORTS];
+static PER_MACHINE uint32_t numGPUSpinsReported = 0;
 
 void GPUReleaseTimeslice(void)
 {
@@ -401,43 +457,15 @@ uint32_t GPUGetPC(void)
 	return gpu_pc;
 }
 
-void build_branch_condition_table(void)
-{
-	if (!branch_condition_table)
-	{
-		branch_condition_table = (uint8_t *)malloc(32 * 8 * sizeof(branch_condition_table[0]));
-
-		if (branch_condition_table)
-		{
-			for(int i=0; i<8; i++)
-			{
-				for(int j=0; j<32; j++)
-				{
-					int result = 1;
-					if (j & 1)
-						if (i & ZERO_FLAG)
-							result = 0;
-					if (j & 2)
-						if (!(i & ZERO_FLAG))
-							result = 0;
-					if (j & 4)
-						if (i & (CARRY_FLAG << (j >> 4)))
-							result = 0;
-					if (j & 8)
-						if (!(i & (CARRY_FLAG << (j >> 4))))
-							result = 0;
-					branch_condition_table[i * 32 + j] = result;
-				}
-			}
-		}
-	}
-}
 
 //
 // GPU byte access (read)
 //
 uint8_t GPUReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
+	if (gpuMustPark && who == GPU && !GPU_LOCAL_READ(offset))
+		GPUPark();
+
 	if (offset >= 0xF02000 && offset <= 0xF020FF)
 		WriteLog("GPU: ReadByte--Attempt to read from GPU register file by %s!\n", whoName[who]);
 
@@ -457,6 +485,9 @@ uint8_t GPUReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 			return data & 0xFF;
 	}
 
+	if ((offset & 0xFFFF00) == 0xDFFF00)	// BUTCH reads aren't idempotent
+		gpuSideEffect = true;
+
 	return JaguarReadByte(offset, who);
 }
 
@@ -465,6 +496,9 @@ uint8_t GPUReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 //
 uint16_t GPUReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
+	if (gpuMustPark && who == GPU && !GPU_LOCAL_READ(offset))
+		GPUPark();
+
 	if (offset >= 0xF02000 && offset <= 0xF020FF)
 		WriteLog("GPU: ReadWord--Attempt to read from GPU register file by %s!\n", whoName[who]);
 
@@ -493,6 +527,9 @@ uint16_t GPUReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 //if (offset >= 0xF0B000 && offset <= 0xF0BFFF)
 //WriteLog("[GPUR16] --> Possible GPU RAM mirror access by %s!", whoName[who]);
 
+	if ((offset & 0xFFFF00) == 0xDFFF00)	// BUTCH reads aren't idempotent
+		gpuSideEffect = true;
+
 	return JaguarReadWord(offset, who);
 }
 
@@ -501,6 +538,9 @@ uint16_t GPUReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 //
 uint32_t GPUReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
+	if (gpuMustPark && who == GPU && !GPU_LOCAL_READ(offset))
+		GPUPark();
+
 	if (offset >= 0xF02000 && offset <= 0xF020FF)
 	{
 		WriteLog("GPU: ReadLong--Attempt to read from GPU register file (%X) by %s!\n", offset, whoName[who]);
@@ -557,6 +597,9 @@ uint32_t GPUReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 /*if (offset >= 0xF1D000 && offset <= 0xF1DFFF)
 	WriteLog("[GPUR32] --> Reading from Wavetable ROM!\n");//*/
 
+	if ((offset & 0xFFFF00) == 0xDFFF00)	// BUTCH reads aren't idempotent
+		gpuSideEffect = true;
+
 	return (JaguarReadWord(offset, who) << 16) | JaguarReadWord(offset + 2, who);
 }
 
@@ -565,12 +608,18 @@ uint32_t GPUReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 //
 void GPUWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 {
+	if (gpuMustPark && who == GPU && !GPU_LOCAL_WRITE(offset))
+		GPUPark();
+
+	gpuSideEffect = true;
+
 	if (offset >= 0xF02000 && offset <= 0xF020FF)
 		WriteLog("GPU: WriteByte--Attempt to write to GPU register file by %s!\n", whoName[who]);
 
 	if ((offset >= GPU_WORK_RAM_BASE) && (offset <= GPU_WORK_RAM_BASE + 0x0FFF))
 	{
 		gpu_ram_8[offset & 0xFFF] = data;
+		GPUInvalidateDecodeCache(offset, 1);
 
 //This is the same stupid worthless code that was in the DSP!!! AARRRGGGGHHHHH!!!!!!
 /*		if (!gpu_in_exec)
@@ -606,6 +655,11 @@ void GPUWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 //
 void GPUWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 {
+	if (gpuMustPark && who == GPU && !GPU_LOCAL_WRITE(offset))
+		GPUPark();
+
+	gpuSideEffect = true;
+
 	if (offset >= 0xF02000 && offset <= 0xF020FF)
 		WriteLog("GPU: WriteWord--Attempt to write to GPU register file by %s!\n", whoName[who]);
 
@@ -613,6 +667,7 @@ void GPUWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 	{
 		gpu_ram_8[offset & 0xFFF] = (data>>8) & 0xFF;
 		gpu_ram_8[(offset+1) & 0xFFF] = data & 0xFF;//*/
+		GPUInvalidateDecodeCache(offset, 2);
 /*		offset &= 0xFFF;
 		SET16(gpu_ram_8, offset, data);//*/
 
@@ -681,6 +736,11 @@ void GPUWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 //
 void GPUWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 {
+	if (gpuMustPark && who == GPU && !GPU_LOCAL_WRITE(offset))
+		GPUPark();
+
+	gpuSideEffect = true;
+
 	if (offset >= 0xF02000 && offset <= 0xF020FF)
 		WriteLog("GPU: WriteLong--Attempt to write to GPU register file by %s!\n", whoName[who]);
 
@@ -697,6 +757,7 @@ void GPUWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 
 		offset &= 0xFFF;
 		SET32(gpu_ram_8, offset, data);
+		GPUInvalidateDecodeCache(offset, 4);
 		return;
 	}
 //	else if ((offset >= GPU_CONTROL_RAM_BASE) && (offset < GPU_CONTROL_RAM_BASE+0x20))
@@ -821,7 +882,7 @@ WriteLog("\n");
 //Try to disable the collision altogether!
 	}
 }//*/
-extern int effect_start5;
+extern PER_MACHINE int effect_start5;
 static bool finished = false;
 //if (GPU_RUNNING && effect_start5 && !finished)
 if (GPU_RUNNING && effect_start5 && gpu_pc == 0xF035D8)
@@ -944,6 +1005,11 @@ void GPUHandleIRQs(void)
 	if (gpu_flags & IMASK)
 		return;
 
+	// If the GPU thread is parked in the middle of an instruction, leave the
+	// interrupt latched; it'll be picked up at the start of the next slice.
+	if (gpuSliceState.load(std::memory_order_relaxed) == GPU_SLICE_PARKED)
+		return;
+
 	// Get the interrupt latch & enable bits
 	uint32_t bits = (gpu_control >> 6) & 0x1F, mask = (gpu_flags >> 4) & 0x1F;
 
@@ -1009,7 +1075,7 @@ void GPUInit(void)
 //	memory_malloc_secure((void **)&gpu_reg_bank_0, 32 * sizeof(int32_t), "GPU bank 0 regs");
 //	memory_malloc_secure((void **)&gpu_reg_bank_1, 32 * sizeof(int32_t), "GPU bank 1 regs");
 
-	build_branch_condition_table();
+	RiscBuildTables();
 
 	GPUReset();
 
@@ -1043,12 +1109,15 @@ void GPUReset(void)
 	CLR_ZNC;
 	memset(gpu_ram_8, 0xFF, 0x1000);
 	gpu_in_exec = 0;
+	numGPUSpinsReported = 0;
 //not needed	GPUInterruptPending = false;
 	GPUResetStats();
 
 	// Contents of local RAM are quasi-stable; we simulate this by randomizing RAM contents
 	for(uint32_t i=0; i<4096; i+=4)
 		*((uint32_t *)(&gpu_ram_8[i])) = rand();
+
+	GPUInvalidateDecodeCache(0, 0x1000);
 }
 
 
@@ -1116,6 +1185,15 @@ void GPUDumpMemory(void)
 
 void GPUDone(void)
 {
+	if (gpuThread)
+	{
+		gpuSliceState.store(GPU_SLICE_QUIT, std::memory_order_release);
+		gpuThread->join();
+		delete gpuThread;
+		gpuThread = NULL;
+		gpuSliceState.store(GPU_SLICE_IDLE, std::memory_order_relaxed);
+	}
+
 	WriteLog("\n\n---------------------------------------------------------------------\n");
 	WriteLog("GPU I/O Registers\n");
 	WriteLog("---------------------------------------------------------------------\n");
@@ -1139,6 +1217,10 @@ void GPUDone(void)
 	GPUDumpRegisters();
 	GPUDumpDisassembly();
 
+#ifdef JIT_X86_64
+	GPUJITDone();
+#endif
+
 	WriteLog("\nGPU opcodes use:\n");
 	for(int i=0; i<64; i++)
 	{
@@ -1150,35 +1232,569 @@ void GPUDone(void)
 
 
 //
-// Main GPU execution core
+// Spin loop detection
 //
-static int testCount = 1;
-static int len = 0;
-static bool tripwire = false;
-void GPUExec(int32_t cycles)
+// GPU code spends a lot of time in short loops waiting on a semaphore in local
+// RAM, the blitter or a mailbox from the 68K. Nothing else writes to memory
+// while the GPU's running its timeslice, so if we come back around to the top of
+// a loop that only loads & compares with the same registers & flags and without
+// having written anything, the rest of the timeslice would be more of the same.
+// Anything that wants to wake the GPU up has to do so between timeslices, and
+// each timeslice starts detection over from scratch.
+//
+static bool GPUCheckSpinLoop(uint32_t branchPC)
 {
-	if (!GPU_RUNNING)
-		return;
+	if (gpu_pc != gpuSpinHead || (gpuSpinSafe && gpuSideEffect))
+	{
+		// New loop (or the code may have changed): see if it's a candidate
+		gpuSpinHead = gpu_pc;
+		gpuSpinSafe = (gpu_pc >= GPU_WORK_RAM_BASE)
+			&& (branchPC + 2 <= GPU_WORK_RAM_BASE + 0x0FFE);
 
-#ifdef GPU_SINGLE_STEPPING
-	if (gpu_control & 0x18)
+		for(uint32_t pc=gpu_pc; gpuSpinSafe && pc<=branchPC+2;)
+		{
+			uint32_t index = GET16(gpu_ram_8, pc & 0xFFF) >> 10;
+			gpuSpinSafe = gpu_spin_safe[index];
+			pc += (index == 38 ? 6 : 2);		// MOVEI has 32 bits of immediate data
+		}
+	}
+	else if (!gpuSpinSafe)
+		return false;
+	else if (gpuSpinFlags == ((gpu_flag_n << 2) | (gpu_flag_c << 1) | gpu_flag_z)
+		&& memcmp(gpu_reg, gpuSpinRegs, sizeof(gpuSpinRegs)) == 0)
 	{
-		cycles = 1;
-		gpu_control &= ~0x10;
+		for(uint32_t i=0; i<numGPUSpinsReported; i++)
+		{
+			if (gpuSpinReported[i] == gpu_pc)
+				return true;
+		}
+
+		WriteLog("GPU: Spin loop detected at $%06X\n", gpu_pc);
+
+		if (numGPUSpinsReported < GPU_SPIN_REPORTS)
+			gpuSpinReported[numGPUSpinsReported++] = gpu_pc;
+
+		return true;
 	}
-#endif
-	GPUHandleIRQs();
-	gpu_releaseTimeSlice_flag = 0;
-	gpu_in_exec++;
 
+	if (gpuSpinSafe)
+	{
+		gpuSpinFlags = (gpu_flag_n << 2) | (gpu_flag_c << 1) | gpu_flag_z;
+		memcpy(gpuSpinRegs, gpu_reg, sizeof(gpuSpinRegs));
+	}
+
+	gpuSideEffect = false;
+	return false;
+}
+
+
+//
+// GPU recompiler
+//
+// With vjs.useGPUJIT on (and an x86-64 host), straight runs of code in local
+// RAM get translated into native code a block at a time. The interpreter picks
+// up whatever's left: code outside of local RAM, delay slots, debug hooks and
+// the tail end of a timeslice. A block ends at the first JUMP/JR (taken or
+// not) or after GPU_JIT_MAX_OPS instructions, and it's only run if there are
+// enough cycles left to run all of it, so a timeslice comes out exactly the
+// same as it would interpreted.
+//
+// The simple ALU ops & moves, and the branch conditions, are done natively.
+// Everything else calls the interpreter's handler, with gpu_pc & the operands
+// set up the same way the interpreter does it. A handler can do just about
+// anything (stop the GPU, take an interrupt, switch register banks, write over
+// the code we're running), so after each one we go back to the dispatcher if
+// gpu_pc isn't where it should be, the GPU's been stopped, or translated code
+// got written to. Taken branches run their delay slot thru GPUExec(1) like
+// GPUCore::opcode_jump() & opcode_jr() do, which means interrupts get checked
+// at the same spots as always: at the start of a timeslice, and in the delay
+// slot of a taken branch--i.e., only ever at a block boundary.
+//
+// In translated code, RBX points at gpu_reg (& gets reloaded after every call),
+// R12 points at gpu_pc (everything else is addressed relative to it), and R13
+// holds a JUMP's target across its delay slot. A block returns the address of
+// the last instruction it ran, and leaves the cycles it used in gpuJITCycles.
+//
+#ifdef JIT_X86_64
+#define GPU_JIT_CODE_SIZE	0x100000
+#define GPU_JIT_SLOP		0x4000			// More than the biggest block can take
+#define GPU_JIT_MAX_OPS		64
+#define GPU_JIT_MIN_CYCLES	GPU_JIT_MAX_OPS	// Not worth translating with less left
+
+#define GPU_JIT_VAR(v)		R12, (int32_t)((uint8_t *)&(v) - (uint8_t *)&gpu_pc)
+#define GPU_JIT_REG(r)		RBX, (int32_t)((r) * 4)
+
+struct GPUJITBlock
+{
+	uint32_t (* code)(void);					// NULL if there's no translation
+	int32_t cycles;								// What running all of it costs
+};
+
+struct GPUJITExit
+{
+	uint8_t * jump;
+	uint32_t pc;
+	int32_t cycles;
+};
+
+static PER_MACHINE GPUJITBlock gpuJITBlocks[0x800];
+static PER_MACHINE uint8_t * gpuJITCode = NULL;
+static PER_MACHINE uint32_t gpuJITCodeUsed = 0;
+static PER_MACHINE bool gpuJITBroken = false;	// Couldn't get going; don't try again
+static PER_MACHINE int32_t gpuJITCycles;
+static PER_MACHINE uint32_t gpuJITBlocksTranslated = 0;
+static PER_MACHINE uint32_t gpuJITFlushes = 0;
+
+
+static void GPUJITFlush(void)
+{
+	memset(gpuJITBlocks, 0, sizeof(gpuJITBlocks));
+	memset(gpuJITCovered, 0, sizeof(gpuJITCovered));
+	gpuJITCodeUsed = 0;
+	gpuJITFlushPending = false;
+	gpuJITFlushes++;
+}
+
+
+// Everything translated code touches has to be within 2 GB of gpu_pc
+static bool GPUJITReachable(void * var)
+{
+	int64_t disp = (uint8_t *)var - (uint8_t *)&gpu_pc;
+
+	return (disp >= INT32_MIN && disp <= INT32_MAX);
+}
+
+
+static void GPUJITSetZN(uint8_t *& p)
+{
+	JITSetccMem(p, CC_Z, GPU_JIT_VAR(gpu_flag_z));
+	JITSetccMem(p, CC_S, GPU_JIT_VAR(gpu_flag_n));
+}
+
+
+// The GPU's carry works like the x86's for adds & subtracts (borrow)
+static void GPUJITSetZNC(uint8_t *& p)
+{
+	JITSetccMem(p, CC_C, GPU_JIT_VAR(gpu_flag_c));
+	GPUJITSetZN(p);
+}
+
+
+static void GPUJITEmitReturn(uint8_t *& p, uint32_t lastPC, int32_t cycles)
+{
+	JITStoreImm(p, GPU_JIT_VAR(gpuJITCycles), cycles);
+	JITMovRegImm(p, RAX, lastPC);
+	JITAdjustStack(p, 32);
+	JITPop(p, R13);
+	JITPop(p, R12);
+	JITPop(p, RBX);
+	JITRet(p);
+}
+
+
+//
+// Shifts & rotates by a constant: the carry comes from bit 'carryBit' of the
+// original value, and Z & N from the result
+//
+static void GPUJITEmitShift(uint8_t *& p, int op, uint32_t reg, uint8_t count, uint8_t carryBit)
+{
+	JITLoad(p, RAX, GPU_JIT_REG(reg));
+	JITBtRegImm(p, RAX, carryBit);
+	JITSetccMem(p, CC_C, GPU_JIT_VAR(gpu_flag_c));
+	JITShiftRegImm(p, op, RAX, count);
+	JITTestRegReg(p, RAX, RAX);
+	GPUJITSetZN(p);
+	JITStore(p, GPU_JIT_REG(reg), RAX);
+}
+
+
+//
+// Translate an instruction into native code, if it's one we know how to do.
+// These have to match their handlers (mostly in risc.h) exactly!
+//
+static bool GPUJITEmitNative(uint8_t *& p, uint32_t pc, uint16_t opcode)
+{
+	uint32_t imm1 = (opcode >> 5) & 0x1F, imm2 = opcode & 0x1F;
+
+	switch (opcode >> 10)
+	{
+	case 0:										// ADD Rm, Rn
+	case 4:										// SUB Rm, Rn
+		JITLoad(p, RAX, GPU_JIT_REG(imm2));
+		JITAluRegMem(p, ((opcode >> 10) == 0 ? ALU_ADD : ALU_SUB), RAX, GPU_JIT_REG(imm1));
+		GPUJITSetZNC(p);
+		JITStore(p, GPU_JIT_REG(imm2), RAX);
+		break;
+	case 2:										// ADDQ #n, Rn
+		JITAluMemImm(p, ALU_ADD, GPU_JIT_REG(imm2), riscConvertZero[imm1]);
+		GPUJITSetZNC(p);
+		break;
+	case 3:										// ADDQT #n, Rn
+		JITAluMemImm(p, ALU_ADD, GPU_JIT_REG(imm2), riscConvertZero[imm1]);
+		break;
+	case 6:										// SUBQ #n, Rn
+		JITAluMemImm(p, ALU_SUB, GPU_JIT_REG(imm2), riscConvertZero[imm1]);
+		GPUJITSetZNC(p);
+		break;
+	case 7:										// SUBQT #n, Rn
+		JITAluMemImm(p, ALU_SUB, GPU_JIT_REG(imm2), riscConvertZero[imm1]);
+		break;
+	case 8:										// NEG Rn
+		JITNegMem(p, GPU_JIT_REG(imm2));
+		GPUJITSetZNC(p);
+		break;
+	case 9:										// AND Rm, Rn
+	case 10:									// OR Rm, Rn
+	case 11:									// XOR Rm, Rn
+		JITLoad(p, RAX, GPU_JIT_REG(imm1));
+		JITAluMemReg(p, ((opcode >> 10) == 9 ? ALU_AND : (opcode >> 10) == 10 ? ALU_OR : ALU_XOR), GPU_JIT_REG(imm2), RAX);
+		GPUJITSetZN(p);
+		break;
+	case 12:									// NOT Rn
+		JITLoad(p, RAX, GPU_JIT_REG(imm2));
+		JITNotReg(p, RAX);
+		JITStore(p, GPU_JIT_REG(imm2), RAX);
+		JITTestRegReg(p, RAX, RAX);
+		GPUJITSetZN(p);
+		break;
+	case 13:									// BTST #n, Rn
+		JITTestMemImm(p, GPU_JIT_REG(imm2), 1 << imm1);
+		JITSetccMem(p, CC_Z, GPU_JIT_VAR(gpu_flag_z));
+		break;
+	case 14:									// BSET #n, Rn
+		JITAluMemImm(p, ALU_OR, GPU_JIT_REG(imm2), 1 << imm1);
+		GPUJITSetZN(p);
+		break;
+	case 15:									// BCLR #n, Rn
+		JITAluMemImm(p, ALU_AND, GPU_JIT_REG(imm2), ~(1 << imm1));
+		GPUJITSetZN(p);
+		break;
+	case 24:									// SHLQ #n, Rn
+		// SHLQ #32 & friends are left to the handlers, whatever they do
+		if (imm1 == 0)
+			return false;
+
+		GPUJITEmitShift(p, SHIFT_SHL, imm2, 32 - imm1, 31);
+		break;
+	case 25:									// SHRQ #n, Rn
+		if (imm1 == 0)
+			return false;
+
+		GPUJITEmitShift(p, SHIFT_SHR, imm2, imm1, 0);
+		break;
+	case 27:									// SHARQ #n, Rn
+		if (imm1 == 0)
+			return false;
+
+		GPUJITEmitShift(p, SHIFT_SAR, imm2, imm1, 0);
+		break;
+	case 29:									// RORQ #n, Rn
+		if (imm1 == 0)
+			return false;
+
+		GPUJITEmitShift(p, SHIFT_ROR, imm2, imm1, 31);
+		break;
+	case 30:									// CMP Rm, Rn
+		JITLoad(p, RAX, GPU_JIT_REG(imm2));
+		JITAluRegMem(p, ALU_CMP, RAX, GPU_JIT_REG(imm1));
+		GPUJITSetZNC(p);
+		break;
+	case 31:									// CMPQ #n, Rn
+		JITAluMemImm(p, ALU_CMP, GPU_JIT_REG(imm2), (imm1 & 0x10 ? 0xFFFFFFF0 | imm1 : imm1));
+		GPUJITSetZNC(p);
+		break;
+	case 34:									// MOVE Rm, Rn
+		JITLoad(p, RAX, GPU_JIT_REG(imm1));
+		JITStore(p, GPU_JIT_REG(imm2), RAX);
+		break;
+	case 35:									// MOVEQ #n, Rn
+		JITStoreImm(p, GPU_JIT_REG(imm2), imm1);
+		break;
+	case 36:									// MOVETA Rm, Rn
+		JITLoad64(p, RCX, GPU_JIT_VAR(gpu_alternate_reg));
+		JITLoad(p, RAX, GPU_JIT_REG(imm1));
+		JITStore(p, RCX, imm2 * 4, RAX);
+		break;
+	case 37:									// MOVEFA Rm, Rn
+		JITLoad64(p, RCX, GPU_JIT_VAR(gpu_alternate_reg));
+		JITLoad(p, RAX, RCX, imm1 * 4);
+		JITStore(p, GPU_JIT_REG(imm2), RAX);
+		break;
+	case 38:									// MOVEI #n, Rn
+		JITStoreImm(p, GPU_JIT_REG(imm2), (uint32_t)GET16(gpu_ram_8, (pc + 2) & 0xFFF)
+			| ((uint32_t)GET16(gpu_ram_8, (pc + 4) & 0xFFF) << 16));
+		break;
+	case 51:									// MOVE PC, Rn
+		JITStoreImm(p, GPU_JIT_REG(imm2), pc);
+		break;
+	case 57:									// NOP
+		break;
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+
+//
+// Anything we can't do natively goes thru its handler
+//
+static void GPUJITEmitCall(uint8_t *& p, uint32_t pc, uint16_t opcode, int32_t cycles,
+	GPUJITExit * exits, int & numExits)
+{
+	JITStoreImm(p, GPU_JIT_VAR(gpu_pc), pc + 2);
+	JITStoreImm(p, GPU_JIT_VAR(gpu_instruction), opcode);
+	JITStoreImm(p, GPU_JIT_VAR(gpu_opcode_first_parameter), (opcode >> 5) & 0x1F);
+	JITStoreImm(p, GPU_JIT_VAR(gpu_opcode_second_parameter), opcode & 0x1F);
+	JITCall(p, (void *)gpu_opcode[opcode >> 10]);
+	JITLoad64(p, RBX, GPU_JIT_VAR(gpu_reg));
+
+	JITAluMemImm(p, ALU_CMP, GPU_JIT_VAR(gpu_pc), pc + 2);
+	exits[numExits].jump = JITJcc(p, CC_NZ);
+	exits[numExits].pc = pc, exits[numExits++].cycles = cycles;
+	JITTestMemImm(p, GPU_JIT_VAR(gpu_control), 0x01);
+	exits[numExits].jump = JITJcc(p, CC_Z);
+	exits[numExits].pc = pc, exits[numExits++].cycles = cycles;
+	JITAluMemImm8(p, ALU_CMP, GPU_JIT_VAR(gpuJITFlushPending), 0);
+	exits[numExits].jump = JITJcc(p, CC_NZ);
+	exits[numExits].pc = pc, exits[numExits++].cycles = cycles;
+}
+
+
+//
+// JUMP & JR: the condition's done natively (see RiscBuildTables()),
+// the delay slot thru GPUExec(1). Either way, this is the end of the block.
+//
+static void GPUJITEmitBranch(uint8_t *& p, uint32_t pc, uint16_t opcode, int32_t cycles)
+{
+	uint32_t imm1 = (opcode >> 5) & 0x1F, condition = opcode & 0x1F;
+	uint8_t & flag = (condition & 0x10 ? gpu_flag_n : gpu_flag_c);
+	uint8_t * notTaken[4];
+	int numNotTaken = 0;
+
+	if (condition & 0x01)
+	{
+		JITAluMemImm8(p, ALU_CMP, GPU_JIT_VAR(gpu_flag_z), 0);
+		notTaken[numNotTaken++] = JITJcc(p, CC_NZ);
+	}
+
+	if (condition & 0x02)
+	{
+		JITAluMemImm8(p, ALU_CMP, GPU_JIT_VAR(gpu_flag_z), 0);
+		notTaken[numNotTaken++] = JITJcc(p, CC_Z);
+	}
+
+	if (condition & 0x04)
+	{
+		JITAluMemImm8(p, ALU_CMP, GPU_JIT_VAR(flag), 0);
+		notTaken[numNotTaken++] = JITJcc(p, CC_NZ);
+	}
+
+	if (condition & 0x08)
+	{
+		JITAluMemImm8(p, ALU_CMP, GPU_JIT_VAR(flag), 0);
+		notTaken[numNotTaken++] = JITJcc(p, CC_Z);
+	}
+
+	// JUMP's target is read before the delay slot runs
+	if ((opcode >> 10) == 52)
+		JITLoad(p, R13, GPU_JIT_REG(imm1));
+
+	JITStoreImm(p, GPU_JIT_VAR(gpu_pc), pc + 2);
+	JITMovRegImm(p, JIT_ARG0, 1);
+	JITCall(p, (void *)GPUExec);
+
+	if ((opcode >> 10) == 52)
+		JITStore(p, GPU_JIT_VAR(gpu_pc), R13);
+	else
+		JITStoreImm(p, GPU_JIT_VAR(gpu_pc), pc + 2 + ((imm1 & 0x10 ? 0xFFFFFFF0 | imm1 : imm1) * 2));
+
+	GPUJITEmitReturn(p, pc, cycles);
+
+	for(int i=0; i<numNotTaken; i++)
+		JITPatch(notTaken[i], p);
+
+	JITStoreImm(p, GPU_JIT_VAR(gpu_pc), pc + 2);
+	GPUJITEmitReturn(p, pc, cycles);
+}
+
+
+//
+// Translate the block starting at pc (which has to be in local RAM)
+//
+static GPUJITBlock * GPUJITCompile(uint32_t pc)
+{
+	if (gpuJITCode == NULL)
+	{
+		if (GPUJITReachable(&gpu_control) && GPUJITReachable(&gpu_flag_z)
+			&& GPUJITReachable(&gpu_flag_n) && GPUJITReachable(&gpu_flag_c)
+			&& GPUJITReachable(&gpu_reg) && GPUJITReachable(&gpu_alternate_reg)
+			&& GPUJITReachable(&gpu_instruction)
+			&& GPUJITReachable(&gpu_opcode_first_parameter)
+			&& GPUJITReachable(&gpu_opcode_second_parameter)
+			&& GPUJITReachable(&gpuJITCycles) && GPUJITReachable(&gpuJITFlushPending))
+			gpuJITCode = JITAlloc(GPU_JIT_CODE_SIZE);
+
+		if (gpuJITCode == NULL)
+		{
+			WriteLog("GPU: Couldn't start the recompiler; interpreting instead\n");
+			gpuJITBroken = true;
+			return NULL;
+		}
+	}
+
+	if (gpuJITCodeUsed + GPU_JIT_SLOP > GPU_JIT_CODE_SIZE)
+		GPUJITFlush();
+
+	GPUJITBlock * block = &gpuJITBlocks[(pc & 0xFFF) >> 1];
+	uint8_t * start = gpuJITCode + gpuJITCodeUsed, * p = start;
+	GPUJITExit exits[GPU_JIT_MAX_OPS * 3];
+	int numExits = 0;
+	int32_t cycles = 0;
+	uint32_t lastPC = pc;
+	bool ended = false;
+
+	JITPush(p, RBX);
+	JITPush(p, R12);
+	JITPush(p, R13);
+	JITAdjustStack(p, -32);						// Keeps the stack aligned (& Win64 happy)
+	JITMovRegImm64(p, R12, (uint64_t)&gpu_pc);
+	JITLoad64(p, RBX, GPU_JIT_VAR(gpu_reg));
+
+	for(int i=0; i<GPU_JIT_MAX_OPS && !ended; i++)
+	{
+		uint16_t opcode = GET16(gpu_ram_8, pc & 0xFFF);
+		uint32_t index = opcode >> 10;
+		uint32_t size = (index == 38 ? 6 : 2);	// MOVEI has 32 bits of immediate data
+
+		if (pc + size > GPU_WORK_RAM_BASE + 0x1000)
+			break;
+
+		for(uint32_t j=0; j<size; j+=2)
+			gpuJITCovered[((pc + j) & 0xFFF) >> 1] = 1;
+
+		cycles += gpu_opcode_cycles[index];
+		lastPC = pc;
+
+		if (index == 52 || index == 53)
+		{
+			GPUJITEmitBranch(p, pc, opcode, cycles);
+			ended = true;
+		}
+		else if (!GPUJITEmitNative(p, pc, opcode))
+			GPUJITEmitCall(p, pc, opcode, cycles, exits, numExits);
+
+		pc += size;
+	}
+
+	// Nothing fit (MOVEI at the very end of RAM); leave it to the interpreter
+	if (cycles == 0)
+		return NULL;
+
+	if (!ended)
+	{
+		JITStoreImm(p, GPU_JIT_VAR(gpu_pc), pc);
+		GPUJITEmitReturn(p, lastPC, cycles);
+	}
+
+	// Bail outs after calls; they all leave gpu_pc alone
+	uint8_t * stub = NULL;
+
+	for(int i=0; i<numExits; i++)
+	{
+		if (i == 0 || exits[i].pc != exits[i - 1].pc)
+		{
+			stub = p;
+			GPUJITEmitReturn(p, exits[i].pc, exits[i].cycles);
+		}
+
+		JITPatch(exits[i].jump, stub);
+	}
+
+	gpuJITCodeUsed = (gpuJITCodeUsed + (p - start) + 15) & ~15;
+	gpuJITBlocksTranslated++;
+	block->code = (uint32_t (*)(void))start;
+	block->cycles = cycles;
+
+	return block;
+}
+
+
+static void GPUJITDone(void)
+{
+	if (gpuJITBlocksTranslated)
+		WriteLog("GPU: Recompiler translated %u blocks (code thrown away %u times)\n", gpuJITBlocksTranslated, gpuJITFlushes);
+
+	JITFree(gpuJITCode, GPU_JIT_CODE_SIZE);
+	gpuJITCode = NULL;
+	GPUJITFlush();
+}
+
+
+//
+// Only called from the outermost GPUExec(), i.e., never while translated code
+// is running, so it's safe to throw the translations away here
+//
+static inline GPUJITBlock * GPUJITLookup(uint32_t pc, int32_t cycles)
+{
+	if (gpuJITFlushPending)
+		GPUJITFlush();
+
+	GPUJITBlock * block = &gpuJITBlocks[(pc & 0xFFF) >> 1];
+
+	if (block->code == NULL && !gpuJITBroken && cycles >= GPU_JIT_MIN_CYCLES)
+		return GPUJITCompile(pc);
+
+	return (block->code ? block : NULL);
+}
+#endif	// JIT_X86_64
+
+
+//
+// Main GPU execution core
+//
+static int testCount = 1;
+static int len = 0;
+static PER_MACHINE bool tripwire = false;
+
+//
+// The GPU's instruction loop comes in two flavors. Without debugHooks, the
+// logging, opcode stats & tripwires are all compiled out (see
+// JaguarUpdateDebugHooks()).
+//
+template <bool debugHooks>
+static void GPUExecLoop(int32_t cycles)
+{
 	while (cycles > 0 && GPU_RUNNING)
 	{
-if (gpu_ram_8[0x054] == 0x98 && gpu_ram_8[0x055] == 0x0A && gpu_ram_8[0x056] == 0x03
+#ifdef JIT_X86_64
+		// Translated code gets first crack at it, unless we're in a delay slot
+		if (!debugHooks && vjs.useGPUJIT && gpu_in_exec == 1
+			&& (gpu_pc & ~0xFFE) == GPU_WORK_RAM_BASE)
+		{
+			GPUJITBlock * block = GPUJITLookup(gpu_pc, cycles);
+
+			if (block && block->cycles <= cycles)
+			{
+				uint32_t oldPC = block->code();
+				cycles -= gpuJITCycles;
+
+				if ((gpu_pc <= oldPC) && ((oldPC - gpu_pc) <= GPU_SPIN_MAX_SIZE)
+					&& GPUCheckSpinLoop(oldPC))
+					cycles = 0;
+
+				continue;
+			}
+		}
+#endif
+
+if (debugHooks && gpu_ram_8[0x054] == 0x98 && gpu_ram_8[0x055] == 0x0A && gpu_ram_8[0x056] == 0x03
 	&& gpu_ram_8[0x057] == 0x00 && gpu_ram_8[0x058] == 0x00 && gpu_ram_8[0x059] == 0x00)
 {
 	if (gpu_pc == 0xF03000)
 	{
-		extern uint32_t starCount;
+		extern PER_MACHINE uint32_t starCount;
 		starCount = 0;
 /*		WriteLog("GPU: Starting starfield generator... Dump of [R03=%08X]:\n", gpu_reg_bank_0[03]);
 		uint32_t base = gpu_reg_bank_0[3];
@@ -1215,11 +1831,39 @@ if (gpu_pc == 0xF03200)
 	doGPUDis = true;
 #endif
 
-		uint16_t opcode = GPUReadWord(gpu_pc, GPU);
-		uint32_t index = opcode >> 10;
-		gpu_instruction = opcode;				// Added for GPU #3...
-		gpu_opcode_first_parameter = (opcode >> 5) & 0x1F;
-		gpu_opcode_second_parameter = opcode & 0x1F;
+		uint32_t index;
+		void (* handler)(void);
+
+		// Aligned & in local RAM? Then it comes out of the predecode cache
+		if ((gpu_pc & ~0xFFE) == GPU_WORK_RAM_BASE)
+		{
+			GPUDecodedOp & op = gpuDecodeCache[(gpu_pc & 0xFFF) >> 1];
+
+			if (!op.handler)
+			{
+				uint16_t opcode = GET16(gpu_ram_8, gpu_pc & 0xFFF);
+				op.opcode = opcode;
+				op.index = opcode >> 10;
+				op.firstParameter = (opcode >> 5) & 0x1F;
+				op.secondParameter = opcode & 0x1F;
+				op.handler = gpu_opcode[op.index];
+			}
+
+			index = op.index;
+			handler = op.handler;
+			gpu_instruction = op.opcode;
+			gpu_opcode_first_parameter = op.firstParameter;
+			gpu_opcode_second_parameter = op.secondParameter;
+		}
+		else
+		{
+			uint16_t opcode = GPUReadWord(gpu_pc, GPU);
+			index = opcode >> 10;
+			handler = gpu_opcode[index];
+			gpu_instruction = opcode;				// Added for GPU #3...
+			gpu_opcode_first_parameter = (opcode >> 5) & 0x1F;
+			gpu_opcode_second_parameter = opcode & 0x1F;
+		}
 /*if (gpu_pc == 0xF03BE8)
 WriteLog("Start of OP frame write...\n");
 if (gpu_pc == 0xF03EEE)
@@ -1301,7 +1945,7 @@ if (gpu_pc == 0xF034DE)
 	GPUDumpDisassembly();
 }//*/
 
-if (gpu_start_log)
+if (debugHooks && gpu_start_log)
 {
 //	gpu_reset_stats();
 static char buffer[512];
@@ -1310,8 +1954,9 @@ WriteLog("GPU: [%08X] %s (RM=%08X, RN=%08X) -> ", gpu_pc, buffer, RM, RN);
 }//*/
 //$E400 -> 1110 01 -> $39 -> 57
 //GPU #1
+		uint32_t oldPC = gpu_pc;
 		gpu_pc += 2;
-		gpu_opcode[index]();
+		handler();
 //GPU #2
 //		gpu2_opcode[index]();
 //		gpu_pc += 2;
@@ -1342,405 +1987,196 @@ if (gpu_pc == 0xF03548 && firstTime)
 	gpu_flag_z = 0;//, gpu_start_log = 1;//*/
 
 		cycles -= gpu_opcode_cycles[index];
-		gpu_opcode_use[index]++;
-if (gpu_start_log)
+
+		if (debugHooks)
+			gpu_opcode_use[index]++;
+
+		// Only short backward jumps are candidates
+		if ((gpu_pc <= oldPC) && ((oldPC - gpu_pc) <= GPU_SPIN_MAX_SIZE)
+			&& GPUCheckSpinLoop(oldPC))
+			cycles = 0;
+if (debugHooks && gpu_start_log)
 	WriteLog("(RM=%08X, RN=%08X)\n", RM, RN);//*/
-if ((gpu_pc < 0xF03000 || gpu_pc > 0xF03FFF) && !tripwire)
+if (debugHooks && (gpu_pc < 0xF03000 || gpu_pc > 0xF03FFF) && !tripwire)
 {
 	WriteLog("GPU: Executing outside local RAM! GPU_PC: %08X\n", gpu_pc);
 	tripwire = true;
 }
 	}
-
-	gpu_in_exec--;
 }
 
-//
-// GPU opcodes
-//
-
-/*
-GPU opcodes use (offset punch--vertically below bad guy):
-	              add 18686
-	             addq 32621
-	              sub 7483
-	             subq 10252
-	              and 21229
-	               or 15003
-	             btst 1822
-	             bset 2072
-	             mult 141
-	              div 2392
-	             shlq 13449
-	             shrq 10297
-	            sharq 11104
-	              cmp 6775
-	             cmpq 5944
-	             move 31259
-	            moveq 4473
-	            movei 23277
-	            loadb 46
-	            loadw 4201
-	             load 28580
-	 load_r14_indexed 1183
-	 load_r15_indexed 1125
-	           storew 178
-	            store 10144
-	store_r14_indexed 320
-	store_r15_indexed 1
-	          move_pc 1742
-	             jump 24467
-	               jr 18090
-	              nop 41362
-*/
-
 
-static void gpu_opcode_jump(void)
+void GPUExec(int32_t cycles)
 {
-#ifdef GPU_DIS_JUMP
-const char * condition[32] =
-{	"T", "nz", "z", "???", "nc", "nc nz", "nc z", "???", "c", "c nz",
-	"c z", "???", "???", "???", "???", "???", "???", "???", "???",
-	"???", "nn", "nn nz", "nn z", "???", "n", "n nz", "n z", "???",
-	"???", "???", "???", "F" };
-	if (doGPUDis)
-		WriteLog("%06X: JUMP   %s, (R%02u) [NCZ:%u%u%u, R%02u=%08X] ", gpu_pc-2, condition[IMM_2], IMM_1, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM);
-#endif
-	// normalize flags
-/*	gpu_flag_c = (gpu_flag_c ? 1 : 0);
-	gpu_flag_z = (gpu_flag_z ? 1 : 0);
-	gpu_flag_n = (gpu_flag_n ? 1 : 0);*/
-	// KLUDGE: Used by BRANCH_CONDITION
-	uint32_t jaguar_flags = (gpu_flag_n << 2) | (gpu_flag_c << 1) | gpu_flag_z;
-
-	if (BRANCH_CONDITION(IMM_2))
-	{
-#ifdef GPU_DIS_JUMP
-	if (doGPUDis)
-		WriteLog("Branched!\n");
-#endif
-if (gpu_start_log)
-	WriteLog("    --> JUMP: Branch taken.\n");
-		uint32_t delayed_pc = RM;
-		GPUExec(1);
-		gpu_pc = delayed_pc;
-/*		uint16_t opcode = GPUReadWord(gpu_pc, GPU);
-		gpu_opcode_first_parameter = (opcode >> 5) & 0x1F;
-		gpu_opcode_second_parameter = opcode & 0x1F;
-
-		gpu_pc = delayed_pc;
-		gpu_opcode[opcode>>10]();//*/
-	}
-#ifdef GPU_DIS_JUMP
-	else
-		if (doGPUDis)
-			WriteLog("Branch NOT taken.\n");
-#endif
-}
-
+	if (!GPU_RUNNING)
+		return;
 
-static void gpu_opcode_jr(void)
-{
-#ifdef GPU_DIS_JR
-const char * condition[32] =
-{	"T", "nz", "z", "???", "nc", "nc nz", "nc z", "???", "c", "c nz",
-	"c z", "???", "???", "???", "???", "???", "???", "???", "???",
-	"???", "nn", "nn nz", "nn z", "???", "n", "n nz", "n z", "???",
-	"???", "???", "???", "F" };
-	if (doGPUDis)
-		WriteLog("%06X: JR     %s, %06X [NCZ:%u%u%u] ", gpu_pc-2, condition[IMM_2], gpu_pc+((IMM_1 & 0x10 ? 0xFFFFFFF0 | IMM_1 : IMM_1) * 2), gpu_flag_n, gpu_flag_c, gpu_flag_z);
-#endif
-/*	if (CONDITION(jaguar.op & 31))
-	{
-		int32_t r1 = (INT8)((jaguar.op >> 2) & 0xF8) >> 2;
-		uint32_t newpc = jaguar.PC + r1;
-		CALL_MAME_DEBUG;
-		jaguar.op = ROPCODE(jaguar.PC);
-		jaguar.PC = newpc;
-		(*jaguar.table[jaguar.op >> 10])();
-
-		jaguar_icount -= 3;	// 3 wait states guaranteed
-	}*/
-	// normalize flags
-/*	gpu_flag_n = (gpu_flag_n ? 1 : 0);
-	gpu_flag_c = (gpu_flag_c ? 1 : 0);
-	gpu_flag_z = (gpu_flag_z ? 1 : 0);*/
-	// KLUDGE: Used by BRANCH_CONDITION
-	uint32_t jaguar_flags = (gpu_flag_n << 2) | (gpu_flag_c << 1) | gpu_flag_z;
-
-	if (BRANCH_CONDITION(IMM_2))
+#ifdef GPU_SINGLE_STEPPING
+	if (gpu_control & 0x18)
 	{
-#ifdef GPU_DIS_JR
-	if (doGPUDis)
-		WriteLog("Branched!\n");
-#endif
-if (gpu_start_log)
-	WriteLog("    --> JR: Branch taken.\n");
-		int32_t offset = (IMM_1 & 0x10 ? 0xFFFFFFF0 | IMM_1 : IMM_1);		// Sign extend IMM_1
-		int32_t delayed_pc = gpu_pc + (offset * 2);
-		GPUExec(1);
-		gpu_pc = delayed_pc;
-/*		uint16_t opcode = GPUReadWord(gpu_pc, GPU);
-		gpu_opcode_first_parameter = (opcode >> 5) & 0x1F;
-		gpu_opcode_second_parameter = opcode & 0x1F;
-
-		gpu_pc = delayed_pc;
-		gpu_opcode[opcode>>10]();//*/
+		cycles = 1;
+		gpu_control &= ~0x10;
 	}
-#ifdef GPU_DIS_JR
-	else
-		if (doGPUDis)
-			WriteLog("Branch NOT taken.\n");
 #endif
-}
+	GPUHandleIRQs();
+	gpu_releaseTimeSlice_flag = 0;
 
+	// Delay slots are run through here too; don't lose track of the loop
+	if (!gpu_in_exec)
+		gpuSpinHead = 0xFFFFFFFF;
 
-static void gpu_opcode_add(void)
-{
-#ifdef GPU_DIS_ADD
-	if (doGPUDis)
-		WriteLog("%06X: ADD    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN + RM;
-	CLR_ZNC; SET_ZNC_ADD(RN, RM, res);
-	RN = res;
-#ifdef GPU_DIS_ADD
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+	gpu_in_exec++;
 
+	if (jaguarDebugHooks)
+		GPUExecLoop<true>(cycles);
+	else
+		GPUExecLoop<false>(cycles);
 
-static void gpu_opcode_addc(void)
-{
-#ifdef GPU_DIS_ADDC
-	if (doGPUDis)
-		WriteLog("%06X: ADDC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-/*	int dreg = jaguar.op & 31;
-	uint32_t r1 = jaguar.r[(jaguar.op >> 5) & 31];
-	uint32_t r2 = jaguar.r[dreg];
-	uint32_t res = r2 + r1 + ((jaguar.FLAGS >> 1) & 1);
-	jaguar.r[dreg] = res;
-	CLR_ZNC; SET_ZNC_ADD(r2,r1,res);*/
-
-	uint32_t res = RN + RM + gpu_flag_c;
-	uint32_t carry = gpu_flag_c;
-//	SET_ZNC_ADD(RN, RM, res); //???BUG??? Yes!
-	SET_ZNC_ADD(RN + carry, RM, res);
-//	SET_ZNC_ADD(RN, RM + carry, res);
-	RN = res;
-#ifdef GPU_DIS_ADDC
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
+	gpu_in_exec--;
 }
 
-
-static void gpu_opcode_addq(void)
+//
+// Threaded GPU execution
+//
+// The GPU slice is run on its own host thread while the 68K runs its slice on
+// ours. The GPU is free to run until it touches anything outside of its local
+// RAM & control registers, at which point it parks until the 68K has finished
+// its slice; the 68K in turn waits for the GPU to park (or finish) before it
+// touches GPU RAM, the GPU registers or the blitter. Either way, the GPU's local
+// run always happens before the 68K's slice and its shared run after it, so the
+// result doesn't depend on how the host schedules the two threads.
+//
+static void GPUThreadLoop(void)
 {
-#ifdef GPU_DIS_ADDQ
-	if (doGPUDis)
-		WriteLog("%06X: ADDQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = gpu_convert_zero[IMM_1];
-	uint32_t res = RN + r1;
-	CLR_ZNC; SET_ZNC_ADD(RN, r1, res);
-	RN = res;
-#ifdef GPU_DIS_ADDQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
+	uint32_t idleSpins = 0;
 
-static void gpu_opcode_addqt(void)
-{
-#ifdef GPU_DIS_ADDQT
-	if (doGPUDis)
-		WriteLog("%06X: ADDQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	RN += gpu_convert_zero[IMM_1];
-#ifdef GPU_DIS_ADDQT
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
+	while (true)
+	{
+		int state = gpuSliceState.load(std::memory_order_acquire);
 
+		if (state == GPU_SLICE_QUIT)
+			return;
 
-static void gpu_opcode_sub(void)
-{
-#ifdef GPU_DIS_SUB
-	if (doGPUDis)
-		WriteLog("%06X: SUB    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN - RM;
-	SET_ZNC_SUB(RN, RM, res);
-	RN = res;
-#ifdef GPU_DIS_SUB
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+		if (state != GPU_SLICE_GO)
+		{
+			// Back off if nothing's come in for a while (emulator paused, etc.)
+			if (++idleSpins > GPU_IDLE_SPINS)
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			else
+				std::this_thread::yield();
 
+			continue;
+		}
 
-static void gpu_opcode_subc(void)
-{
-#ifdef GPU_DIS_SUBC
-	if (doGPUDis)
-		WriteLog("%06X: SUBC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	// This is how the GPU ALU does it--Two's complement with inverted carry
-	uint64_t res = (uint64_t)RN + (uint64_t)(RM ^ 0xFFFFFFFF) + (gpu_flag_c ^ 1);
-	// Carry out of the result is inverted too
-	gpu_flag_c = ((res >> 32) & 0x01) ^ 1;
-	RN = (res & 0xFFFFFFFF);
-	SET_ZN(RN);
-#ifdef GPU_DIS_SUBC
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
+		idleSpins = 0;
+		gpuMustPark = true;
+		gpuSliceState.store(GPU_SLICE_RUNNING, std::memory_order_relaxed);
+		GPUExec(gpuSliceCycles);
+		gpuMustPark = false;
+		gpuSliceState.store(GPU_SLICE_DONE, std::memory_order_release);
+	}
 }
 
 
-static void gpu_opcode_subq(void)
+static void GPUPark(void)
 {
-#ifdef GPU_DIS_SUBQ
-	if (doGPUDis)
-		WriteLog("%06X: SUBQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = gpu_convert_zero[IMM_1];
-	uint32_t res = RN - r1;
-	SET_ZNC_SUB(RN, r1, res);
-	RN = res;
-#ifdef GPU_DIS_SUBQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
+	gpuMustPark = false;
+	gpuSliceState.store(GPU_SLICE_PARKED, std::memory_order_release);
 
+	while (!m68kSliceDone.load(std::memory_order_acquire))
+		std::this_thread::yield();
 
-static void gpu_opcode_subqt(void)
-{
-#ifdef GPU_DIS_SUBQT
-	if (doGPUDis)
-		WriteLog("%06X: SUBQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	RN -= gpu_convert_zero[IMM_1];
-#ifdef GPU_DIS_SUBQT
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
+	gpuSliceState.store(GPU_SLICE_RUNNING, std::memory_order_relaxed);
 }
 
 
-static void gpu_opcode_cmp(void)
+bool GPUIsRunning(void)
 {
-#ifdef GPU_DIS_CMP
-	if (doGPUDis)
-		WriteLog("%06X: CMP    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN - RM;
-	SET_ZNC_SUB(RN, RM, res);
-#ifdef GPU_DIS_CMP
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z);
-#endif
+	return GPU_RUNNING;
 }
 
 
-static void gpu_opcode_cmpq(void)
+//
+// Start a GPU slice on the GPU thread; the caller runs the 68K's slice and then
+// calls GPUWaitThreaded().
+//
+void GPUExecThreaded(int32_t cycles)
 {
-	static int32_t sqtable[32] =
-		{ 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,-16,-15,-14,-13,-12,-11,-10,-9,-8,-7,-6,-5,-4,-3,-2,-1 };
-#ifdef GPU_DIS_CMPQ
-	if (doGPUDis)
-		WriteLog("%06X: CMPQ   #%d, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, sqtable[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = sqtable[IMM_1 & 0x1F]; // I like this better -> (INT8)(jaguar.op >> 2) >> 3;
-	uint32_t res = RN - r1;
-	SET_ZNC_SUB(RN, r1, res);
-#ifdef GPU_DIS_CMPQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z);
-#endif
+	if (!gpuThread)
+		gpuThread = new std::thread(GPUThreadLoop);
+
+	gpuSliceCycles = cycles;
+	m68kSliceDone.store(false, std::memory_order_relaxed);
+	gpuSliceState.store(GPU_SLICE_GO, std::memory_order_release);
 }
 
 
-static void gpu_opcode_and(void)
+void GPUWaitThreaded(void)
 {
-#ifdef GPU_DIS_AND
-	if (doGPUDis)
-		WriteLog("%06X: AND    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN & RM;
-	SET_ZN(RN);
-#ifdef GPU_DIS_AND
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+	m68kSliceDone.store(true, std::memory_order_release);
 
+	while (gpuSliceState.load(std::memory_order_acquire) != GPU_SLICE_DONE)
+		std::this_thread::yield();
 
-static void gpu_opcode_or(void)
-{
-#ifdef GPU_DIS_OR
-	if (doGPUDis)
-		WriteLog("%06X: OR     R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN | RM;
-	SET_ZN(RN);
-#ifdef GPU_DIS_OR
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
+	gpuSliceState.store(GPU_SLICE_IDLE, std::memory_order_relaxed);
 }
 
 
-static void gpu_opcode_xor(void)
+//
+// Called by the 68K before it touches anything the GPU can get at while it's
+// running on its own
+//
+void GPUSync(void)
 {
-#ifdef GPU_DIS_XOR
-	if (doGPUDis)
-		WriteLog("%06X: XOR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN ^ RM;
-	SET_ZN(RN);
-#ifdef GPU_DIS_XOR
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+	while (true)
+	{
+		int state = gpuSliceState.load(std::memory_order_acquire);
 
+		if (state != GPU_SLICE_GO && state != GPU_SLICE_RUNNING)
+			return;
 
-static void gpu_opcode_not(void)
-{
-#ifdef GPU_DIS_NOT
-	if (doGPUDis)
-		WriteLog("%06X: NOT    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = ~RN;
-	SET_ZN(RN);
-#ifdef GPU_DIS_NOT
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
+		std::this_thread::yield();
+	}
 }
 
+//
+// GPU opcodes
+//
 
-static void gpu_opcode_move_pc(void)
-{
-#ifdef GPU_DIS_MOVEPC
-	if (doGPUDis)
-		WriteLog("%06X: MOVE   PC, R%02u [NCZ:%u%u%u, PC=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, gpu_pc-2, IMM_2, RN);
-#endif
-	// Should be previous PC--this might not always be previous instruction!
-	// Then again, this will point right at the *current* instruction, i.e., MOVE PC,R!
-	RN = gpu_pc - 2;
-#ifdef GPU_DIS_MOVEPC
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
+/*
+GPU opcodes use (offset punch--vertically below bad guy):
+	              add 18686
+	             addq 32621
+	              sub 7483
+	             subq 10252
+	              and 21229
+	               or 15003
+	             btst 1822
+	             bset 2072
+	             mult 141
+	              div 2392
+	             shlq 13449
+	             shrq 10297
+	            sharq 11104
+	              cmp 6775
+	             cmpq 5944
+	             move 31259
+	            moveq 4473
+	            movei 23277
+	            loadb 46
+	            loadw 4201
+	             load 28580
+	 load_r14_indexed 1183
+	 load_r15_indexed 1125
+	           storew 178
+	            store 10144
+	store_r14_indexed 320
+	store_r15_indexed 1
+	          move_pc 1742
+	             jump 24467
+	               jr 18090
+	              nop 41362
+*/
 
 
 static void gpu_opcode_sat8(void)
@@ -1775,17 +2211,17 @@ static void gpu_opcode_store_r14_indexed(void)
 {
 #ifdef GPU_DIS_STORE14I
 	if (doGPUDis)
-		WriteLog("%06X: STORE  R%02u, (R14+$%02X) [NCZ:%u%u%u, R%02u=%08X, R14+$%02X=%08X]\n", gpu_pc-2, IMM_2, gpu_convert_zero[IMM_1] << 2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN, gpu_convert_zero[IMM_1] << 2, gpu_reg[14]+(gpu_convert_zero[IMM_1] << 2));
+		WriteLog("%06X: STORE  R%02u, (R14+$%02X) [NCZ:%u%u%u, R%02u=%08X, R14+$%02X=%08X]\n", gpu_pc-2, IMM_2, riscConvertZero[IMM_1] << 2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN, riscConvertZero[IMM_1] << 2, gpu_reg[14]+(riscConvertZero[IMM_1] << 2));
 #endif
 #ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t address = gpu_reg[14] + (gpu_convert_zero[IMM_1] << 2);
+	uint32_t address = gpu_reg[14] + (riscConvertZero[IMM_1] << 2);
 	
 	if (address >= 0xF03000 && address <= 0xF03FFF)
 		GPUWriteLong(address & 0xFFFFFFFC, RN, GPU);
 	else
 		GPUWriteLong(address, RN, GPU);
 #else
-	GPUWriteLong(gpu_reg[14] + (gpu_convert_zero[IMM_1] << 2), RN, GPU);
+	GPUWriteLong(gpu_reg[14] + (riscConvertZero[IMM_1] << 2), RN, GPU);
 #endif
 }
 
@@ -1794,17 +2230,17 @@ static void gpu_opcode_store_r15_indexed(void)
 {
 #ifdef GPU_DIS_STORE15I
 	if (doGPUDis)
-		WriteLog("%06X: STORE  R%02u, (R15+$%02X) [NCZ:%u%u%u, R%02u=%08X, R15+$%02X=%08X]\n", gpu_pc-2, IMM_2, gpu_convert_zero[IMM_1] << 2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN, gpu_convert_zero[IMM_1] << 2, gpu_reg[15]+(gpu_convert_zero[IMM_1] << 2));
+		WriteLog("%06X: STORE  R%02u, (R15+$%02X) [NCZ:%u%u%u, R%02u=%08X, R15+$%02X=%08X]\n", gpu_pc-2, IMM_2, riscConvertZero[IMM_1] << 2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN, riscConvertZero[IMM_1] << 2, gpu_reg[15]+(riscConvertZero[IMM_1] << 2));
 #endif
 #ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t address = gpu_reg[15] + (gpu_convert_zero[IMM_1] << 2);
+	uint32_t address = gpu_reg[15] + (riscConvertZero[IMM_1] << 2);
 
 	if (address >= 0xF03000 && address <= 0xF03FFF)
 		GPUWriteLong(address & 0xFFFFFFFC, RN, GPU);
 	else
 		GPUWriteLong(address, RN, GPU);
 #else
-	GPUWriteLong(gpu_reg[15] + (gpu_convert_zero[IMM_1] << 2), RN, GPU);
+	GPUWriteLong(gpu_reg[15] + (riscConvertZero[IMM_1] << 2), RN, GPU);
 #endif
 }
 
@@ -1893,15 +2329,6 @@ static void gpu_opcode_store_r15_ri(void)
 }
 
 
-static void gpu_opcode_nop(void)
-{
-#ifdef GPU_DIS_NOP
-	if (doGPUDis)
-		WriteLog("%06X: NOP    [NCZ:%u%u%u]\n", gpu_pc-2, gpu_flag_n, gpu_flag_c, gpu_flag_z);
-#endif
-}
-
-
 static void gpu_opcode_pack(void)
 {
 #ifdef GPU_DIS_PACK
@@ -2102,17 +2529,17 @@ static void gpu_opcode_load_r14_indexed(void)
 {
 #ifdef GPU_DIS_LOAD14I
 	if (doGPUDis)
-		WriteLog("%06X: LOAD   (R14+$%02X), R%02u [NCZ:%u%u%u, R14+$%02X=%08X, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1] << 2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, gpu_convert_zero[IMM_1] << 2, gpu_reg[14]+(gpu_convert_zero[IMM_1] << 2), IMM_2, RN);
+		WriteLog("%06X: LOAD   (R14+$%02X), R%02u [NCZ:%u%u%u, R14+$%02X=%08X, R%02u=%08X] -> ", gpu_pc-2, riscConvertZero[IMM_1] << 2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, riscConvertZero[IMM_1] << 2, gpu_reg[14]+(riscConvertZero[IMM_1] << 2), IMM_2, RN);
 #endif
 #ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t address = gpu_reg[14] + (gpu_convert_zero[IMM_1] << 2);
+	uint32_t address = gpu_reg[14] + (riscConvertZero[IMM_1] << 2);
 
 	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
 		RN = GPUReadLong(address & 0xFFFFFFFC, GPU);
 	else
 		RN = GPUReadLong(address, GPU);
 #else
-	RN = GPUReadLong(gpu_reg[14] + (gpu_convert_zero[IMM_1] << 2), GPU);
+	RN = GPUReadLong(gpu_reg[14] + (riscConvertZero[IMM_1] << 2), GPU);
 #endif
 #ifdef GPU_DIS_LOAD14I
 	if (doGPUDis)
@@ -2125,17 +2552,17 @@ static void gpu_opcode_load_r15_indexed(void)
 {
 #ifdef GPU_DIS_LOAD15I
 	if (doGPUDis)
-		WriteLog("%06X: LOAD   (R15+$%02X), R%02u [NCZ:%u%u%u, R15+$%02X=%08X, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1] << 2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, gpu_convert_zero[IMM_1] << 2, gpu_reg[15]+(gpu_convert_zero[IMM_1] << 2), IMM_2, RN);
+		WriteLog("%06X: LOAD   (R15+$%02X), R%02u [NCZ:%u%u%u, R15+$%02X=%08X, R%02u=%08X] -> ", gpu_pc-2, riscConvertZero[IMM_1] << 2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, riscConvertZero[IMM_1] << 2, gpu_reg[15]+(riscConvertZero[IMM_1] << 2), IMM_2, RN);
 #endif
 #ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t address = gpu_reg[15] + (gpu_convert_zero[IMM_1] << 2);
+	uint32_t address = gpu_reg[15] + (riscConvertZero[IMM_1] << 2);
 
 	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
 		RN = GPUReadLong(address & 0xFFFFFFFC, GPU);
 	else
 		RN = GPUReadLong(address, GPU);
 #else
-	RN = GPUReadLong(gpu_reg[15] + (gpu_convert_zero[IMM_1] << 2), GPU);
+	RN = GPUReadLong(gpu_reg[15] + (riscConvertZero[IMM_1] << 2), GPU);
 #endif
 #ifdef GPU_DIS_LOAD15I
 	if (doGPUDis)
@@ -2144,264 +2571,6 @@ static void gpu_opcode_load_r15_indexed(void)
 }
 
 
-static void gpu_opcode_movei(void)
-{
-#ifdef GPU_DIS_MOVEI
-	if (doGPUDis)
-		WriteLog("%06X: MOVEI  #$%08X, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, (uint32_t)GPUReadWord(gpu_pc) | ((uint32_t)GPUReadWord(gpu_pc + 2) << 16), IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	// This instruction is followed by 32-bit value in LSW / MSW format...
-	RN = (uint32_t)GPUReadWord(gpu_pc, GPU) | ((uint32_t)GPUReadWord(gpu_pc + 2, GPU) << 16);
-	gpu_pc += 4;
-#ifdef GPU_DIS_MOVEI
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_moveta(void)
-{
-#ifdef GPU_DIS_MOVETA
-	if (doGPUDis)
-		WriteLog("%06X: MOVETA R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, ALTERNATE_RN);
-#endif
-	ALTERNATE_RN = RM;
-#ifdef GPU_DIS_MOVETA
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, ALTERNATE_RN);
-#endif
-}
-
-
-static void gpu_opcode_movefa(void)
-{
-#ifdef GPU_DIS_MOVEFA
-	if (doGPUDis)
-		WriteLog("%06X: MOVEFA R%02u, R%02u [NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, ALTERNATE_RM, IMM_2, RN);
-#endif
-	RN = ALTERNATE_RM;
-#ifdef GPU_DIS_MOVEFA
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, ALTERNATE_RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_move(void)
-{
-#ifdef GPU_DIS_MOVE
-	if (doGPUDis)
-		WriteLog("%06X: MOVE   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RM;
-#ifdef GPU_DIS_MOVE
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_moveq(void)
-{
-#ifdef GPU_DIS_MOVEQ
-	if (doGPUDis)
-		WriteLog("%06X: MOVEQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	RN = IMM_1;
-#ifdef GPU_DIS_MOVEQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_resmac(void)
-{
-	RN = gpu_acc;
-}
-
-
-static void gpu_opcode_imult(void)
-{
-#ifdef GPU_DIS_IMULT
-	if (doGPUDis)
-		WriteLog("%06X: IMULT  R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = (int16_t)RN * (int16_t)RM;
-	SET_ZN(RN);
-#ifdef GPU_DIS_IMULT
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_mult(void)
-{
-#ifdef GPU_DIS_MULT
-	if (doGPUDis)
-		WriteLog("%06X: MULT   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = (uint16_t)RM * (uint16_t)RN;
-//	RN = (RM & 0xFFFF) * (RN & 0xFFFF);
-	SET_ZN(RN);
-#ifdef GPU_DIS_MULT
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_bclr(void)
-{
-#ifdef GPU_DIS_BCLR
-	if (doGPUDis)
-		WriteLog("%06X: BCLR   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = RN & ~(1 << IMM_1);
-	RN = res;
-	SET_ZN(res);
-#ifdef GPU_DIS_BCLR
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_btst(void)
-{
-#ifdef GPU_DIS_BTST
-	if (doGPUDis)
-		WriteLog("%06X: BTST   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	gpu_flag_z = (~RN >> IMM_1) & 1;
-#ifdef GPU_DIS_BTST
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_bset(void)
-{
-#ifdef GPU_DIS_BSET
-	if (doGPUDis)
-		WriteLog("%06X: BSET   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = RN | (1 << IMM_1);
-	RN = res;
-	SET_ZN(res);
-#ifdef GPU_DIS_BSET
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_imacn(void)
-{
-	uint32_t res = (int16_t)RM * (int16_t)(RN);
-	gpu_acc += res;
-}
-
-
-static void gpu_opcode_mtoi(void)
-{
-	uint32_t _RM = RM;
-	uint32_t res = RN = (((int32_t)_RM >> 8) & 0xFF800000) | (_RM & 0x007FFFFF);
-	SET_ZN(res);
-}
-
-
-static void gpu_opcode_normi(void)
-{
-	uint32_t _RM = RM;
-	uint32_t res = 0;
-
-	if (_RM)
-	{
-		while ((_RM & 0xFFC00000) == 0)
-		{
-			_RM <<= 1;
-			res--;
-		}
-		while ((_RM & 0xFF800000) != 0)
-		{
-			_RM >>= 1;
-			res++;
-		}
-	}
-	RN = res;
-	SET_ZN(res);
-}
-
-static void gpu_opcode_mmult(void)
-{
-	int count	= gpu_matrix_control & 0x0F;	// Matrix width
-	uint32_t addr = gpu_pointer_to_matrix;		// In the GPU's RAM
-	int64_t accum = 0;
-	uint32_t res;
-
-	if (gpu_matrix_control & 0x10)				// Column stepping
-	{
-		for(int i=0; i<count; i++)
-		{
-			int16_t a;
-			if (i & 0x01)
-				a = (int16_t)((gpu_alternate_reg[IMM_1 + (i >> 1)] >> 16) & 0xFFFF);
-			else
-				a = (int16_t)(gpu_alternate_reg[IMM_1 + (i >> 1)] & 0xFFFF);
-
-			int16_t b = ((int16_t)GPUReadWord(addr + 2, GPU));
-			accum += a * b;
-			addr += 4 * count;
-		}
-	}
-	else										// Row stepping
-	{
-		for(int i=0; i<count; i++)
-		{
-			int16_t a;
-			if (i & 0x01)
-				a = (int16_t)((gpu_alternate_reg[IMM_1 + (i >> 1)] >> 16) & 0xFFFF);
-			else
-				a = (int16_t)(gpu_alternate_reg[IMM_1 + (i >> 1)] & 0xFFFF);
-
-			int16_t b = ((int16_t)GPUReadWord(addr + 2, GPU));
-			accum += a * b;
-			addr += 4;
-		}
-	}
-	RN = res = (int32_t)accum;
-	// carry flag to do (out of the last add)
-	SET_ZN(res);
-}
-
-
-static void gpu_opcode_abs(void)
-{
-#ifdef GPU_DIS_ABS
-	if (doGPUDis)
-		WriteLog("%06X: ABS    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	gpu_flag_c = RN >> 31;
-	if (RN == 0x80000000)
-	//Is 0x80000000 a positive number? If so, then we need to set C to 0 as well!
-		gpu_flag_n = 1, gpu_flag_z = 0;
-	else
-	{
-		if (gpu_flag_c)
-			RN = -RN;
-		gpu_flag_n = 0; SET_FLAG_Z(RN);
-	}
-#ifdef GPU_DIS_ABS
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
 static void gpu_opcode_div(void)	// RN / RM
 {
 #ifdef GPU_DIS_DIV
@@ -2460,217 +2629,6 @@ static void gpu_opcode_div(void)	// RN / RM
 }
 
 
-static void gpu_opcode_imultn(void)
-{
-	uint32_t res = (int32_t)((int16_t)RN * (int16_t)RM);
-	gpu_acc = (int32_t)res;
-	SET_FLAG_Z(res);
-	SET_FLAG_N(res);
-}
-
-
-static void gpu_opcode_neg(void)
-{
-#ifdef GPU_DIS_NEG
-	if (doGPUDis)
-		WriteLog("%06X: NEG    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = -RN;
-	SET_ZNC_SUB(0, RN, res);
-	RN = res;
-#ifdef GPU_DIS_NEG
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_shlq(void)
-{
-#ifdef GPU_DIS_SHLQ
-	if (doGPUDis)
-		WriteLog("%06X: SHLQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, 32 - IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-// Was a bug here...
-// (Look at Aaron's code: If r1 = 32, then 32 - 32 = 0 which is wrong!)
-	int32_t r1 = 32 - IMM_1;
-	uint32_t res = RN << r1;
-	SET_ZN(res); gpu_flag_c = (RN >> 31) & 1;
-	RN = res;
-#ifdef GPU_DIS_SHLQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_shrq(void)
-{
-#ifdef GPU_DIS_SHRQ
-	if (doGPUDis)
-		WriteLog("%06X: SHRQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	int32_t r1 = gpu_convert_zero[IMM_1];
-	uint32_t res = RN >> r1;
-	SET_ZN(res); gpu_flag_c = RN & 1;
-	RN = res;
-#ifdef GPU_DIS_SHRQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_ror(void)
-{
-#ifdef GPU_DIS_ROR
-	if (doGPUDis)
-		WriteLog("%06X: ROR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t r1 = RM & 0x1F;
-	uint32_t res = (RN >> r1) | (RN << (32 - r1));
-	SET_ZN(res); gpu_flag_c = (RN >> 31) & 1;
-	RN = res;
-#ifdef GPU_DIS_ROR
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_rorq(void)
-{
-#ifdef GPU_DIS_RORQ
-	if (doGPUDis)
-		WriteLog("%06X: RORQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = gpu_convert_zero[IMM_1 & 0x1F];
-	uint32_t r2 = RN;
-	uint32_t res = (r2 >> r1) | (r2 << (32 - r1));
-	RN = res;
-	SET_ZN(res); gpu_flag_c = (r2 >> 31) & 0x01;
-#ifdef GPU_DIS_RORQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_sha(void)
-{
-/*	int dreg = jaguar.op & 31;
-	int32_t r1 = (int32_t)jaguar.r[(jaguar.op >> 5) & 31];
-	uint32_t r2 = jaguar.r[dreg];
-	uint32_t res;
-
-	CLR_ZNC;
-	if (r1 < 0)
-	{
-		res = (r1 <= -32) ? 0 : (r2 << -r1);
-		jaguar.FLAGS |= (r2 >> 30) & 2;
-	}
-	else
-	{
-		res = (r1 >= 32) ? ((int32_t)r2 >> 31) : ((int32_t)r2 >> r1);
-		jaguar.FLAGS |= (r2 << 1) & 2;
-	}
-	jaguar.r[dreg] = res;
-	SET_ZN(res);*/
-
-#ifdef GPU_DIS_SHA
-	if (doGPUDis)
-		WriteLog("%06X: SHA    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res;
-
-	if ((int32_t)RM < 0)
-	{
-		res = ((int32_t)RM <= -32) ? 0 : (RN << -(int32_t)RM);
-		gpu_flag_c = RN >> 31;
-	}
-	else
-	{
-		res = ((int32_t)RM >= 32) ? ((int32_t)RN >> 31) : ((int32_t)RN >> (int32_t)RM);
-		gpu_flag_c = RN & 0x01;
-	}
-	RN = res;
-	SET_ZN(res);
-#ifdef GPU_DIS_SHA
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-
-/*	int32_t sRM=(int32_t)RM;
-	uint32_t _RN=RN;
-
-	if (sRM<0)
-	{
-		uint32_t shift=-sRM;
-		if (shift>=32) shift=32;
-		gpu_flag_c=(_RN&0x80000000)>>31;
-		while (shift)
-		{
-			_RN<<=1;
-			shift--;
-		}
-	}
-	else
-	{
-		uint32_t shift=sRM;
-		if (shift>=32) shift=32;
-		gpu_flag_c=_RN&0x1;
-		while (shift)
-		{
-			_RN=((int32_t)_RN)>>1;
-			shift--;
-		}
-	}
-	RN=_RN;
-	SET_FLAG_Z(_RN);
-	SET_FLAG_N(_RN);*/
-}
-
-
-static void gpu_opcode_sharq(void)
-{
-#ifdef GPU_DIS_SHARQ
-	if (doGPUDis)
-		WriteLog("%06X: SHARQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = (int32_t)RN >> gpu_convert_zero[IMM_1];
-	SET_ZN(res); gpu_flag_c = RN & 0x01;
-	RN = res;
-#ifdef GPU_DIS_SHARQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_sh(void)
-{
-#ifdef GPU_DIS_SH
-	if (doGPUDis)
-		WriteLog("%06X: SH     R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	if (RM & 0x80000000)		// Shift left
-	{
-		gpu_flag_c = RN >> 31;
-		RN = ((int32_t)RM <= -32 ? 0 : RN << -(int32_t)RM);
-	}
-	else						// Shift right
-	{
-		gpu_flag_c = RN & 0x01;
-		RN = (RM >= 32 ? 0 : RN >> RM);
-	}
-	SET_ZN(RN);
-#ifdef GPU_DIS_SH
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
 //Temporary: Testing only!
 //#include "gpu2.cpp"
 //#include "gpu3.cpp"
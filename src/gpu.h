@@ -7,6 +7,7 @@
 
 //#include "types.h"
 #include "memory.h"
+#include "risc.h"
 
 #define GPU_CONTROL_RAM_BASE    0x00F02100
 #define GPU_WORK_RAM_BASE		0x00F03000
@@ -18,6 +19,10 @@ void GPUDone(void);
 void GPUUpdateRegisterBanks(void);
 void GPUHandleIRQs(void);
 void GPUSetIRQLine(int irqline, int state);
+bool GPUIsRunning(void);
+void GPUExecThreaded(int32_t);
+void GPUWaitThreaded(void);
+void GPUSync(void);
 
 uint8_t GPUReadByte(uint32_t offset, uint32_t who = UNKNOWN);
 uint16_t GPUReadWord(uint32_t offset, uint32_t who = UNKNOWN);
@@ -37,6 +42,6 @@ enum { GPUIRQ_CPU = 0, GPUIRQ_DSP, GPUIRQ_TIMER, GPUIRQ_OBJECT, GPUIRQ_BLITTER }
 
 // Exported vars
 
-extern uint32_t gpu_reg_bank_0[], gpu_reg_bank_1[];
+extern PER_MACHINE RiscState gpuState;
 
 #endif	// __GPU_H__
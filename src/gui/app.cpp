@@ -188,6 +188,9 @@ bool ParseCommandLine(int argc, char * argv[])
 				"   --no-gpu          Disable GPU\n"
 				"   --dsp         -d  Enable DSP\n"
 				"   --no-dsp          Disable DSP\n"
+				"   --lockstep-dsp    Run both DSP cores & log where they differ\n"
+				"   --lockstep-blitter\n"
+				"                     Run both blitters & log where they differ\n"
 				"   --fullscreen  -f  Start in full screen mode\n"
 				"   --blur        -B  Enable GL bilinear filter\n"
 				"   --no-blur         Disable GL bilinear filtering\n"
@@ -298,6 +301,16 @@ void ParseOptions(int argc, char * argv[])
 			vjs.audioEnabled = false;
 		}
 
+		if (strcmp(argv[i], "--lockstep-dsp") == 0)
+		{
+			vjs.lockstepDSP = true;
+		}
+
+		if (strcmp(argv[i], "--lockstep-blitter") == 0)
+		{
+			vjs.lockstepBlitter = true;
+		}
+
 		if ((strcmp(argv[i], "--fullscreen") == 0) || (strcmp(argv[i], "-f") == 0))
 		{
 			vjs.fullscreen = true;
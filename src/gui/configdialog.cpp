@@ -78,6 +78,9 @@ void ConfigDialog::LoadDialogFromSettings(void)
 	generalTab->useFullScreen->setChecked(vjs.fullscreen);
 //	generalTab->useHostAudio->setChecked(vjs.audioEnabled);
 	generalTab->useFastBlitter->setChecked(vjs.useFastBlitter);
+	generalTab->useThreadedGPU->setChecked(vjs.threadedGPU);
+	generalTab->useGPUJIT->setChecked(vjs.useGPUJIT);
+	generalTab->useDSPJIT->setChecked(vjs.useDSPJIT);
 
 	if (vjs.hardwareTypeAlpine)
 	{
@@ -114,6 +117,9 @@ void ConfigDialog::UpdateVJSettings(void)
 	vjs.fullscreen     = generalTab->useFullScreen->isChecked();
 //	vjs.audioEnabled   = generalTab->useHostAudio->isChecked();
 	vjs.useFastBlitter = generalTab->useFastBlitter->isChecked();
+	vjs.threadedGPU    = generalTab->useThreadedGPU->isChecked();
+	vjs.useGPUJIT      = generalTab->useGPUJIT->isChecked();
+	vjs.useDSPJIT      = generalTab->useDSPJIT->isChecked();
 
 	if (vjs.hardwareTypeAlpine)
 	{
@@ -147,14 +147,14 @@ GPU Control:
 		"R20: %08X&nbsp;&nbsp;R21: %08X&nbsp;&nbsp;R22: %08X&nbsp;&nbsp;R23: %08X<br>"
 		"R24: %08X&nbsp;&nbsp;R25: %08X&nbsp;&nbsp;R26: %08X&nbsp;&nbsp;R27: %08X<br>"
 		"R28: %08X&nbsp;&nbsp;R29: %08X&nbsp;&nbsp;R30: %08X&nbsp;&nbsp;R31: %08X<br><br>",
-		gpu_reg_bank_0[0], gpu_reg_bank_0[1], gpu_reg_bank_0[2], gpu_reg_bank_0[3],
-		gpu_reg_bank_0[4], gpu_reg_bank_0[5], gpu_reg_bank_0[6], gpu_reg_bank_0[7],
-		gpu_reg_bank_0[8], gpu_reg_bank_0[9], gpu_reg_bank_0[10], gpu_reg_bank_0[11],
-		gpu_reg_bank_0[12], gpu_reg_bank_0[13], gpu_reg_bank_0[14], gpu_reg_bank_0[15],
-		gpu_reg_bank_0[16], gpu_reg_bank_0[17], gpu_reg_bank_0[18], gpu_reg_bank_0[19],
-		gpu_reg_bank_0[20], gpu_reg_bank_0[21], gpu_reg_bank_0[22], gpu_reg_bank_0[23],
-		gpu_reg_bank_0[24], gpu_reg_bank_0[25], gpu_reg_bank_0[26], gpu_reg_bank_0[27],
-		gpu_reg_bank_0[28], gpu_reg_bank_0[29], gpu_reg_bank_0[30], gpu_reg_bank_0[31]);
+		gpuState.regBank0[0], gpuState.regBank0[1], gpuState.regBank0[2], gpuState.regBank0[3],
+		gpuState.regBank0[4], gpuState.regBank0[5], gpuState.regBank0[6], gpuState.regBank0[7],
+		gpuState.regBank0[8], gpuState.regBank0[9], gpuState.regBank0[10], gpuState.regBank0[11],
+		gpuState.regBank0[12], gpuState.regBank0[13], gpuState.regBank0[14], gpuState.regBank0[15],
+		gpuState.regBank0[16], gpuState.regBank0[17], gpuState.regBank0[18], gpuState.regBank0[19],
+		gpuState.regBank0[20], gpuState.regBank0[21], gpuState.regBank0[22], gpuState.regBank0[23],
+		gpuState.regBank0[24], gpuState.regBank0[25], gpuState.regBank0[26], gpuState.regBank0[27],
+		gpuState.regBank0[28], gpuState.regBank0[29], gpuState.regBank0[30], gpuState.regBank0[31]);
 	s += QString(string);
 
 	sprintf(string, "Bank 1:<br>"
@@ -166,14 +166,14 @@ GPU Control:
 		"R20: %08X&nbsp;&nbsp;R21: %08X&nbsp;&nbsp;R22: %08X&nbsp;&nbsp;R23: %08X<br>"
 		"R24: %08X&nbsp;&nbsp;R25: %08X&nbsp;&nbsp;R26: %08X&nbsp;&nbsp;R27: %08X<br>"
 		"R28: %08X&nbsp;&nbsp;R29: %08X&nbsp;&nbsp;R30: %08X&nbsp;&nbsp;R31: %08X<br><br>",
-		gpu_reg_bank_1[0], gpu_reg_bank_1[1], gpu_reg_bank_1[2], gpu_reg_bank_1[3],
-		gpu_reg_bank_1[4], gpu_reg_bank_1[5], gpu_reg_bank_1[6], gpu_reg_bank_1[7],
-		gpu_reg_bank_1[8], gpu_reg_bank_1[9], gpu_reg_bank_1[10], gpu_reg_bank_1[11],
-		gpu_reg_bank_1[12], gpu_reg_bank_1[13], gpu_reg_bank_1[14], gpu_reg_bank_1[15],
-		gpu_reg_bank_1[16], gpu_reg_bank_1[17], gpu_reg_bank_1[18], gpu_reg_bank_1[19],
-		gpu_reg_bank_1[20], gpu_reg_bank_1[21], gpu_reg_bank_1[22], gpu_reg_bank_1[23],
-		gpu_reg_bank_1[24], gpu_reg_bank_1[25], gpu_reg_bank_1[26], gpu_reg_bank_1[27],
-		gpu_reg_bank_1[28], gpu_reg_bank_1[29], gpu_reg_bank_1[30], gpu_reg_bank_1[31]);
+		gpuState.regBank1[0], gpuState.regBank1[1], gpuState.regBank1[2], gpuState.regBank1[3],
+		gpuState.regBank1[4], gpuState.regBank1[5], gpuState.regBank1[6], gpuState.regBank1[7],
+		gpuState.regBank1[8], gpuState.regBank1[9], gpuState.regBank1[10], gpuState.regBank1[11],
+		gpuState.regBank1[12], gpuState.regBank1[13], gpuState.regBank1[14], gpuState.regBank1[15],
+		gpuState.regBank1[16], gpuState.regBank1[17], gpuState.regBank1[18], gpuState.regBank1[19],
+		gpuState.regBank1[20], gpuState.regBank1[21], gpuState.regBank1[22], gpuState.regBank1[23],
+		gpuState.regBank1[24], gpuState.regBank1[25], gpuState.regBank1[26], gpuState.regBank1[27],
+		gpuState.regBank1[28], gpuState.regBank1[29], gpuState.regBank1[30], gpuState.regBank1[31]);
 	s += QString(string);
 
 	// DSP
@@ -214,14 +214,14 @@ DSP Control:
 		"R20: %08X&nbsp;&nbsp;R21: %08X&nbsp;&nbsp;R22: %08X&nbsp;&nbsp;R23: %08X<br>"
 		"R24: %08X&nbsp;&nbsp;R25: %08X&nbsp;&nbsp;R26: %08X&nbsp;&nbsp;R27: %08X<br>"
 		"R28: %08X&nbsp;&nbsp;R29: %08X&nbsp;&nbsp;R30: %08X&nbsp;&nbsp;R31: %08X<br><br>",
-		dsp_reg_bank_0[0], dsp_reg_bank_0[1], dsp_reg_bank_0[2], dsp_reg_bank_0[3],
-		dsp_reg_bank_0[4], dsp_reg_bank_0[5], dsp_reg_bank_0[6], dsp_reg_bank_0[7],
-		dsp_reg_bank_0[8], dsp_reg_bank_0[9], dsp_reg_bank_0[10], dsp_reg_bank_0[11],
-		dsp_reg_bank_0[12], dsp_reg_bank_0[13], dsp_reg_bank_0[14], dsp_reg_bank_0[15],
-		dsp_reg_bank_0[16], dsp_reg_bank_0[17], dsp_reg_bank_0[18], dsp_reg_bank_0[19],
-		dsp_reg_bank_0[20], dsp_reg_bank_0[21], dsp_reg_bank_0[22], dsp_reg_bank_0[23],
-		dsp_reg_bank_0[24], dsp_reg_bank_0[25], dsp_reg_bank_0[26], dsp_reg_bank_0[27],
-		dsp_reg_bank_0[28], dsp_reg_bank_0[29], dsp_reg_bank_0[30], dsp_reg_bank_0[31]);
+		dspState.regBank0[0], dspState.regBank0[1], dspState.regBank0[2], dspState.regBank0[3],
+		dspState.regBank0[4], dspState.regBank0[5], dspState.regBank0[6], dspState.regBank0[7],
+		dspState.regBank0[8], dspState.regBank0[9], dspState.regBank0[10], dspState.regBank0[11],
+		dspState.regBank0[12], dspState.regBank0[13], dspState.regBank0[14], dspState.regBank0[15],
+		dspState.regBank0[16], dspState.regBank0[17], dspState.regBank0[18], dspState.regBank0[19],
+		dspState.regBank0[20], dspState.regBank0[21], dspState.regBank0[22], dspState.regBank0[23],
+		dspState.regBank0[24], dspState.regBank0[25], dspState.regBank0[26], dspState.regBank0[27],
+		dspState.regBank0[28], dspState.regBank0[29], dspState.regBank0[30], dspState.regBank0[31]);
 	s += QString(string);
 
 	sprintf(string, "Bank 1:<br>"
@@ -233,14 +233,14 @@ DSP Control:
 		"R20: %08X&nbsp;&nbsp;R21: %08X&nbsp;&nbsp;R22: %08X&nbsp;&nbsp;R23: %08X<br>"
 		"R24: %08X&nbsp;&nbsp;R25: %08X&nbsp;&nbsp;R26: %08X&nbsp;&nbsp;R27: %08X<br>"
 		"R28: %08X&nbsp;&nbsp;R29: %08X&nbsp;&nbsp;R30: %08X&nbsp;&nbsp;R31: %08X<br>",
-		dsp_reg_bank_1[0], dsp_reg_bank_1[1], dsp_reg_bank_1[2], dsp_reg_bank_1[3],
-		dsp_reg_bank_1[4], dsp_reg_bank_1[5], dsp_reg_bank_1[6], dsp_reg_bank_1[7],
-		dsp_reg_bank_1[8], dsp_reg_bank_1[9], dsp_reg_bank_1[10], dsp_reg_bank_1[11],
-		dsp_reg_bank_1[12], dsp_reg_bank_1[13], dsp_reg_bank_1[14], dsp_reg_bank_1[15],
-		dsp_reg_bank_1[16], dsp_reg_bank_1[17], dsp_reg_bank_1[18], dsp_reg_bank_1[19],
-		dsp_reg_bank_1[20], dsp_reg_bank_1[21], dsp_reg_bank_1[22], dsp_reg_bank_1[23],
-		dsp_reg_bank_1[24], dsp_reg_bank_1[25], dsp_reg_bank_1[26], dsp_reg_bank_1[27],
-		dsp_reg_bank_1[28], dsp_reg_bank_1[29], dsp_reg_bank_1[30], dsp_reg_bank_1[31]);
+		dspState.regBank1[0], dspState.regBank1[1], dspState.regBank1[2], dspState.regBank1[3],
+		dspState.regBank1[4], dspState.regBank1[5], dspState.regBank1[6], dspState.regBank1[7],
+		dspState.regBank1[8], dspState.regBank1[9], dspState.regBank1[10], dspState.regBank1[11],
+		dspState.regBank1[12], dspState.regBank1[13], dspState.regBank1[14], dspState.regBank1[15],
+		dspState.regBank1[16], dspState.regBank1[17], dspState.regBank1[18], dspState.regBank1[19],
+		dspState.regBank1[20], dspState.regBank1[21], dspState.regBank1[22], dspState.regBank1[23],
+		dspState.regBank1[24], dspState.regBank1[25], dspState.regBank1[26], dspState.regBank1[27],
+		dspState.regBank1[28], dspState.regBank1[29], dspState.regBank1[30], dspState.regBank1[31]);
 	s += QString(string);
 
 	text->clear();
@@ -64,7 +64,7 @@ void MemoryBrowserWindow::RefreshContents(void)
 
 		for(uint32_t j=0; j<16; j++)
 		{
-			sprintf(buf, "%02X ", jaguarMainRAM[memBase + i + j]);
+			sprintf(buf, "%02X ", JagMemRead8(jaguarMainRAM, memBase + i + j));
 			strcat(string, buf);
 		}
 
@@ -73,7 +73,7 @@ void MemoryBrowserWindow::RefreshContents(void)
 
 		for(uint32_t j=0; j<16; j++)
 		{
-			uint8_t c = jaguarMainRAM[memBase + i + j];
+			uint8_t c = JagMemRead8(jaguarMainRAM, memBase + i + j);
 			sprintf(buf, "&#%i;", c);
 
 			if (c == 0x20)
@@ -0,0 +1,228 @@
+//
+// emuthread.cpp - Emulation thread
+//
+// Runs JaguarExecuteNew() on its own thread, paced by its own clock, so that
+// nothing the GUI does (debug window refreshes, menus, resizes) can stall the
+// emulation. Anything else that touches the Jaguar core has to go through the
+// command queue (Post/Call), where it's run between frames.
+//
+
+#include "emuthread.h"
+
+#include "SDL.h"
+#include "jaguar.h"
+#include "settings.h"
+
+#define FRESH_FRAME		0x04				// Set in 'middle' when it holds an unseen frame
+
+// Nominal field periods, in ns (59.94 Hz NTSC, 50 Hz PAL)
+#define FRAME_PERIOD_NTSC	16683350
+#define FRAME_PERIOD_PAL	20000000
+
+
+EmuThread::EmuThread(QObject * parent/*= 0*/): QThread(parent), abort(false),
+	running(false), back(0), front(1), middle(2), frameTimePtr(0),
+	lastFrameTimestamp(0), framesPerTenSeconds(0)
+{
+	for(int i=0; i<3; i++)
+	{
+		frame[i] = new uint32_t[FRAME_BUFFER_WIDTH * FRAME_BUFFER_HEIGHT];
+		memset(frame[i], 0, FRAME_BUFFER_WIDTH * FRAME_BUFFER_HEIGHT * sizeof(uint32_t));
+	}
+
+	for(int i=0; i<FPS_RING_SIZE; i++)
+		frameTime[i] = 0;
+
+	JaguarSetScreenBuffer(frame[back]);
+}
+
+
+EmuThread::~EmuThread()
+{
+	mutex.lock();
+	abort = true;
+	condition.wakeOne();
+	mutex.unlock();
+
+	wait();
+
+	for(int i=0; i<3; i++)
+		delete[] frame[i];
+}
+
+
+void EmuThread::Go(void)
+{
+	start();
+}
+
+
+void EmuThread::SetRunning(bool state)
+{
+	QMutexLocker locker(&mutex);
+	running = state;
+	condition.wakeOne();
+}
+
+
+//
+// Queue up a command to be run on the emulation thread between frames, and
+// return right away.
+//
+void EmuThread::Post(std::function<void(void)> command)
+{
+	QMutexLocker locker(&mutex);
+	commands.enqueue(command);
+	condition.wakeOne();
+}
+
+
+//
+// Run a command on the emulation thread between frames, and wait for it to
+// finish. If the thread isn't going (yet), we just run it here.
+//
+void EmuThread::Call(std::function<void(void)> command)
+{
+	if (!isRunning() || QThread::currentThread() == this)
+	{
+		command();
+		return;
+	}
+
+	QMutex doneMutex;
+	QWaitCondition doneCondition;
+	bool done = false;
+
+	Post([&]()
+	{
+		command();
+		QMutexLocker locker(&doneMutex);
+		done = true;
+		doneCondition.wakeOne();
+	});
+
+	QMutexLocker locker(&doneMutex);
+
+	while (!done)
+		doneCondition.wait(&doneMutex);
+}
+
+
+void EmuThread::FrameAdvance(void)
+{
+	Call([this]() { ExecuteFrame(); });
+}
+
+
+//
+// Returns the newest finished frame; the GUI owns it until the next call.
+//
+uint32_t * EmuThread::NewestFrame(void)
+{
+	if (middle.load(std::memory_order_acquire) & FRESH_FRAME)
+		front = middle.exchange(front, std::memory_order_acq_rel) & 0x03;
+
+	return frame[front];
+}
+
+
+uint32_t EmuThread::FramesPerTenSeconds(void)
+{
+	return framesPerTenSeconds.load(std::memory_order_relaxed);
+}
+
+
+void EmuThread::RunCommands(void)
+{
+	mutex.lock();
+
+	while (!commands.isEmpty())
+	{
+		std::function<void(void)> command = commands.dequeue();
+		mutex.unlock();
+		command();
+		mutex.lock();
+	}
+
+	mutex.unlock();
+}
+
+
+void EmuThread::ExecuteFrame(void)
+{
+	JaguarExecuteNew();
+
+	// Publish the finished frame & pick up the old middle buffer to draw into
+	back = middle.exchange(back | FRESH_FRAME, std::memory_order_acq_rel) & 0x03;
+	JaguarSetScreenBuffer(frame[back]);
+
+	// FPS handling
+	// Approach: We use a ring buffer to store times (in ms) over a given
+	// amount of frames, then sum them to figure out the FPS.
+	uint32_t timestamp = SDL_GetTicks();
+	frameTimePtr = (frameTimePtr + 1) % FPS_RING_SIZE;
+	frameTime[frameTimePtr] = timestamp - lastFrameTimestamp;
+	lastFrameTimestamp = timestamp;
+	uint32_t elapsedTime = 0;
+
+	for(uint32_t i=0; i<FPS_RING_SIZE; i++)
+		elapsedTime += frameTime[i];
+
+	// elapsedTime must be non-zero
+	if (elapsedTime == 0)
+		elapsedTime = 1;
+
+	// This is in frames per 10 seconds, so we can have 1 decimal
+	framesPerTenSeconds.store((uint32_t)(((float)FPS_RING_SIZE / (float)elapsedTime) * 10000.0), std::memory_order_relaxed);
+}
+
+
+//
+// Here's the thread's actual execution path...
+//
+void EmuThread::run(void)
+{
+	QElapsedTimer clock;
+	clock.start();
+	qint64 nextFrame = 0;
+
+	while (true)
+	{
+		RunCommands();
+
+		mutex.lock();
+
+		if (abort)
+		{
+			mutex.unlock();
+			return;
+		}
+
+		// Nothing to do while we're paused or powered off, except wait for
+		// something to come in through the command queue
+		if (!running)
+		{
+			if (commands.isEmpty())
+				condition.wait(&mutex);
+
+			mutex.unlock();
+			nextFrame = clock.nsecsElapsed();
+			continue;
+		}
+
+		mutex.unlock();
+
+		ExecuteFrame();
+
+		// Pace ourselves against our own clock; if we've fallen way behind
+		// (debugger, host hiccup), just start over from now instead of trying
+		// to catch up all at once.
+		nextFrame += (vjs.hardwareTypeNTSC ? FRAME_PERIOD_NTSC : FRAME_PERIOD_PAL);
+		qint64 now = clock.nsecsElapsed();
+
+		if (nextFrame > now)
+			QThread::usleep((nextFrame - now) / 1000);
+		else if ((now - nextFrame) > (4 * FRAME_PERIOD_PAL))
+			nextFrame = now;
+	}
+}
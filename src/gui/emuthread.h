@@ -0,0 +1,60 @@
+//
+// emuthread.h: Emulation thread class definition
+//
+
+#ifndef __EMUTHREAD_H__
+#define __EMUTHREAD_H__
+
+#include <QtCore>
+#include <atomic>
+#include <functional>
+#include <stdint.h>
+
+#define FRAME_BUFFER_WIDTH		1024			// Same as the GL texture pitch
+#define FRAME_BUFFER_HEIGHT		512
+#define FPS_RING_SIZE			32
+
+class EmuThread: public QThread
+{
+	Q_OBJECT
+
+	public:
+		EmuThread(QObject * parent = 0);
+		~EmuThread();
+		void Go(void);
+		void SetRunning(bool state);
+		void Post(std::function<void(void)> command);
+		void Call(std::function<void(void)> command);
+		void FrameAdvance(void);
+		uint32_t * NewestFrame(void);
+		uint32_t FramesPerTenSeconds(void);
+
+	protected:
+		void run(void);
+
+	private:
+		void RunCommands(void);
+		void ExecuteFrame(void);
+
+	private:
+		QMutex mutex;
+		QWaitCondition condition;
+		QQueue<std::function<void(void)> > commands;
+		bool abort;
+		bool running;
+
+		// Triple buffer: the emulation renders into frame[back], the GUI shows
+		// frame[front], and the newest finished frame waits in the middle. The
+		// middle index (plus a "fresh" bit) is swapped atomically, so neither
+		// side ever waits on the other and nothing gets copied.
+		uint32_t * frame[3];
+		int back, front;
+		std::atomic<int> middle;
+
+		uint32_t frameTime[FPS_RING_SIZE];
+		uint32_t frameTimePtr;
+		uint32_t lastFrameTimestamp;
+		std::atomic<uint32_t> framesPerTenSeconds;
+};
+
+#endif	// __EMUTHREAD_H__
@@ -60,6 +60,9 @@ GeneralTab::GeneralTab(QWidget * parent/*= 0*/): QWidget(parent)
 //	useHostAudio       = new QCheckBox(tr("Enable audio playback (requires DSP)"));
 	useUnknownSoftware = new QCheckBox(tr("Show all files in file chooser"));
 	useFastBlitter     = new QCheckBox(tr("Use fast blitter"));
+	useThreadedGPU     = new QCheckBox(tr("Run GPU on its own thread"));
+	useGPUJIT          = new QCheckBox(tr("Translate GPU code to native code"));
+	useDSPJIT          = new QCheckBox(tr("Translate DSP code to native code"));
 
 	layout4->addWidget(useBIOS);
 	layout4->addWidget(useGPU);
@@ -68,6 +71,9 @@ GeneralTab::GeneralTab(QWidget * parent/*= 0*/): QWidget(parent)
 //	layout4->addWidget(useHostAudio);
 	layout4->addWidget(useUnknownSoftware);
 	layout4->addWidget(useFastBlitter);
+	layout4->addWidget(useThreadedGPU);
+	layout4->addWidget(useGPUJIT);
+	layout4->addWidget(useDSPJIT);
 
 	setLayout(layout4);
 }
@@ -24,6 +24,9 @@ class GeneralTab: public QWidget
 		QCheckBox * useFullScreen;
 		QCheckBox * useUnknownSoftware;
 		QCheckBox * useFastBlitter;
+		QCheckBox * useThreadedGPU;
+		QCheckBox * useGPUJIT;
+		QCheckBox * useDSPJIT;
 };
 
 #endif	// __GENERALTAB_H__
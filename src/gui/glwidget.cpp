@@ -36,8 +36,7 @@ GLWidget::GLWidget(QWidget * parent/*= 0*/): QGLWidget(parent), texture(0),
 
 GLWidget::~GLWidget()
 {
-	if (buffer)
-		delete[] buffer;
+	// We don't own buffer; it's one of the emulation thread's frame buffers
 }
 
 
@@ -116,10 +115,9 @@ void GLWidget::resizeGL(int /*width*/, int /*height*/)
 void GLWidget::CreateTextures(void)
 {
 	// Seems that power of 2 sizes are still mandatory...
+	// (The frame buffers handed to us in buffer have the same dimensions)
 	textureWidth  = 1024;
 	textureHeight = 512;
-	buffer = new uint32_t[textureWidth * textureHeight];
-	JaguarSetScreenBuffer(buffer);
 
 	glGenTextures(1, &texture);
 	glBindTexture(GL_TEXTURE_2D, texture);
@@ -10,6 +10,7 @@
 // JLH  12/23/2009  Created this file
 // JLH  12/20/2010  Added settings, menus & toolbars
 // JLH  07/05/2011  Added CD BIOS functionality to GUI
+//                  (Emulation now runs on its own thread, see emuthread.cpp)
 //
 
 // FIXED:
@@ -41,6 +42,7 @@
 #include "about.h"
 #include "configdialog.h"
 #include "controllertab.h"
+#include "emuthread.h"
 #include "filepicker.h"
 #include "gamepad.h"
 #include "generaltab.h"
@@ -86,21 +88,18 @@
 
 MainWin::MainWin(bool autoRun): running(true), powerButtonOn(false),
 	showUntunedTankCircuit(true), cartridgeLoaded(false), CDActive(false),
-	pauseForFileSelector(false), loadAndGo(autoRun), scannedSoftwareFolder(false), plzDontKillMyComputer(false)
+	pauseForFileSelector(false), loadAndGo(autoRun), loadingSoftware(false),
+	scannedSoftwareFolder(false), plzDontKillMyComputer(false)
 {
 	debugbar = NULL;
 
 	for(int i=0; i<8; i++)
 		keyHeld[i] = false;
 
-	// FPS management
-	for(int i=0; i<RING_BUFFER_SIZE; i++)
-		ringBuffer[i] = 0;
-
-	ringBufferPointer = RING_BUFFER_SIZE - 1;
-
 	videoWidget = new GLWidget(this);
 	setCentralWidget(videoWidget);
+	emuThread = new EmuThread(this);
+	videoWidget->buffer = emuThread->NewestFrame();
 	setWindowIcon(QIcon(":/res/vj-icon.png"));
 
 	QString title = QString(tr("Virtual Jaguar " VJ_RELEASE_VERSION ));
@@ -358,7 +357,8 @@ MainWin::MainWin(bool autoRun): running(true), powerButtonOn(false),
 		}
 	}
 
-	// Set up timer based loop for animation...
+	// Set up timer based loop for presentation (the emulation itself runs on
+	// its own thread, which paces itself)...
 	timer = new QTimer(this);
 	connect(timer, SIGNAL(timeout()), this, SLOT(Timer()));
 
@@ -376,7 +376,7 @@ MainWin::MainWin(bool autoRun): running(true), powerButtonOn(false),
 	WriteLog("VJ: Initializing jaguar subsystem...\n");
 	JaguarInit();
 //	memcpy(jagMemSpace + 0xE00000, jaguarBootROM, 0x20000);	// Use the stock BIOS
-	memcpy(jagMemSpace + 0xE00000, (vjs.biosType == BT_K_SERIES ? jaguarBootROM : jaguarBootROM2), 0x20000);	// Use the stock BIOS
+	JagMemCopyIn(0xE00000, (vjs.biosType == BT_K_SERIES ? jaguarBootROM : jaguarBootROM2), 0x20000);	// Use the stock BIOS
 
 	// Prevent the file scanner from running if filename passed
 	// in on the command line...
@@ -386,12 +386,17 @@ MainWin::MainWin(bool autoRun): running(true), powerButtonOn(false),
 	// Load up the default ROM if in Alpine mode:
 	if (vjs.hardwareTypeAlpine)
 	{
-		bool romLoaded = JaguarLoadFile(vjs.alpineROMPath);
+		bool romLoaded;
 
-		// If regular load failed, try just a straight file load
-		// (Dev only! I don't want people to start getting lazy with their releases again! :-P)
-		if (!romLoaded)
-			romLoaded = AlpineLoadFile(vjs.alpineROMPath);
+		emuThread->Call([&]()
+		{
+			romLoaded = JaguarLoadFile(vjs.alpineROMPath);
+
+			// If regular load failed, try just a straight file load
+			// (Dev only! I don't want people to start getting lazy with their releases again! :-P)
+			if (!romLoaded)
+				romLoaded = AlpineLoadFile(vjs.alpineROMPath);
+		});
 
 		if (romLoaded)
 			WriteLog("Alpine Mode: Successfully loaded file \"%s\".\n", vjs.alpineROMPath);
@@ -400,7 +405,7 @@ MainWin::MainWin(bool autoRun): running(true), powerButtonOn(false),
 
 		// Attempt to load/run the ABS file...
 		LoadSoftware(vjs.absROMPath);
-		memcpy(jagMemSpace + 0xE00000, jaguarDevBootROM2, 0x20000);	// Use the stub BIOS
+		emuThread->Call([]() { JagMemCopyIn(0xE00000, jaguarDevBootROM2, 0x20000); });	// Use the stub BIOS
 		// Prevent the scanner from running...
 		return;
 	}
@@ -438,12 +443,17 @@ void MainWin::SyncUI(void)
 	// Reset the timer to be what was set in the command line (if any):
 //	timer->setInterval(vjs.hardwareTypeNTSC ? 16 : 20);
 	timer->start(vjs.hardwareTypeNTSC ? 16 : 20);
+
+	// Everything that touches the Jaguar core from here on has to go through
+	// the emulation thread's command queue
+	emuThread->Go();
 }
 
 
 void MainWin::closeEvent(QCloseEvent * event)
 {
-	JaguarDone();
+	emuThread->SetRunning(false);
+	emuThread->Call([]() { JaguarDone(); });
 // This should only be done by the config dialog
 //	WriteSettings();
 	WriteUISettings();
@@ -457,9 +467,9 @@ void MainWin::keyPressEvent(QKeyEvent * e)
 	// From jaguar.cpp
 	extern bool startM68KTracing;
 	// From joystick.cpp
-	extern int blit_start_log;
+	extern PER_MACHINE int blit_start_log;
 	// From blitter.cpp
-	extern bool startConciseBlitLogging;
+	extern PER_MACHINE bool startConciseBlitLogging;
 #endif
 
 	// We ignore the Alt key for now, since it causes problems with the GUI
@@ -648,7 +658,10 @@ void MainWin::Configure(void)
 	// If the "Alpine" ROM is changed, then let's load it...
 	if (alpineBefore != alpineAfter)
 	{
-		if (!JaguarLoadFile(vjs.alpineROMPath) && !AlpineLoadFile(vjs.alpineROMPath))
+		bool romLoaded;
+		emuThread->Call([&]() { romLoaded = JaguarLoadFile(vjs.alpineROMPath) || AlpineLoadFile(vjs.alpineROMPath); });
+
+		if (!romLoaded)
 		{
 			// Oh crap, we couldn't get the file! Alert the media!
 			QMessageBox msg;
@@ -661,7 +674,10 @@ void MainWin::Configure(void)
 	// If the "ABS" ROM is changed, then let's load it...
 	if (absBefore != absAfter)
 	{
-		if (!JaguarLoadFile(vjs.absROMPath))
+		bool romLoaded;
+		emuThread->Call([&]() { romLoaded = JaguarLoadFile(vjs.absROMPath); });
+
+		if (!romLoaded)
 		{
 			// Oh crap, we couldn't get the file! Alert the media!
 			QMessageBox msg;
@@ -672,11 +688,10 @@ void MainWin::Configure(void)
 	}
 
 	// If the "Enable DSP" checkbox changed, then we have to re-init the DAC,
-	// since it's running in the host audio IRQ...
+	// since host audio playback is only opened when the DSP is enabled...
 	if (audioBefore != audioAfter)
 	{
-		DACDone();
-		DACInit();
+		emuThread->Call([]() { DACDone(); DACInit(); });
 	}
 
 	// Just in case we crash before a clean exit...
@@ -685,20 +700,11 @@ void MainWin::Configure(void)
 
 
 //
-// Here's the main emulator loop
+// Here's the main presentation loop. The emulation runs on its own thread;
+// all we do here is show the newest frame it has finished (if any).
 //
 void MainWin::Timer(void)
 {
-#if 0
-static uint32_t ntscTickCount;
-	if (vjs.hardwareTypeNTSC)
-	{
-		ntscTickCount++;
-		ntscTickCount %= 3;
-		timer->start(16 + (ntscTickCount == 0 ? 1 : 0));
-	}
-#endif
-
 	if (!running)
 		return;
 
@@ -721,9 +727,9 @@ static uint32_t ntscTickCount;
 	}
 	else
 	{
-		// Otherwise, run the Jaguar simulation
+		// Otherwise, pick up the Jaguar simulation's newest frame (no copying)
 		HandleGamepads();
-		JaguarExecuteNew();
+		videoWidget->buffer = emuThread->NewestFrame();
 		videoWidget->HandleMouseHiding();
 
 static uint32_t refresh = 0;
@@ -744,32 +750,22 @@ static uint32_t refresh = 0;
 
 	videoWidget->updateGL();
 
-	// FPS handling
-	// Approach: We use a ring buffer to store times (in ms) over a given
-	// amount of frames, then sum them to figure out the FPS.
-	uint32_t timestamp = SDL_GetTicks();
-	// This assumes the ring buffer size is a power of 2
-//	ringBufferPointer = (ringBufferPointer + 1) & (RING_BUFFER_SIZE - 1);
-	// Doing it this way is better. Ring buffer size can be arbitrary then.
-	ringBufferPointer = (ringBufferPointer + 1) % RING_BUFFER_SIZE;
-	ringBuffer[ringBufferPointer] = timestamp - oldTimestamp;
-	uint32_t elapsedTime = 0;
-
-	for(uint32_t i=0; i<RING_BUFFER_SIZE; i++)
-		elapsedTime += ringBuffer[i];
-
-	// elapsedTime must be non-zero
-	if (elapsedTime == 0)
-		elapsedTime = 1;
-
-	// This is in frames per 10 seconds, so we can have 1 decimal
-	uint32_t framesPerSecond = (uint32_t)(((float)RING_BUFFER_SIZE / (float)elapsedTime) * 10000.0);
+	// FPS handling (the emulation thread keeps track of this)
+	uint32_t framesPerSecond = emuThread->FramesPerTenSeconds();
 	uint32_t fpsIntegerPart = framesPerSecond / 10;
 	uint32_t fpsDecimalPart = framesPerSecond % 10;
 	// If this is updated too frequently to be useful, we can throttle it down
 	// so that it only updates every 10th frame or so
 	statusBar()->showMessage(QString("%1.%2 FPS").arg(fpsIntegerPart).arg(fpsDecimalPart));
-	oldTimestamp = timestamp;
+}
+
+
+//
+// The emulation thread only runs when we're powered on and not paused
+//
+void MainWin::UpdateEmulationState(void)
+{
+	emuThread->SetRunning(running && !showUntunedTankCircuit && !loadingSoftware);
 }
 
 
@@ -781,6 +777,9 @@ void MainWin::TogglePowerState(void)
 	// With the power off, we simulate white noise on the screen. :-)
 	if (!powerButtonOn)
 	{
+		// Stop the emulation first, so the screen buffer is ours
+		showUntunedTankCircuit = true;
+		UpdateEmulationState();
 		// Restore the mouse pointer, if hidden:
 		videoWidget->CheckAndRestoreMouseCursor();
 		useCDAct->setDisabled(false);
@@ -788,11 +787,10 @@ void MainWin::TogglePowerState(void)
 		ntscAct->setDisabled(false);
 		pauseAct->setChecked(false);
 		pauseAct->setDisabled(true);
-		showUntunedTankCircuit = true;
 		DACPauseAudioThread();
 		// This is just in case the ROM we were playing was in a narrow or wide
 		// field mode, so the untuned tank sim doesn't look wrong. :-)
-		TOMReset();
+		emuThread->Call([]() { TOMReset(); });
 
 		if (plzDontKillMyComputer)
 		{
@@ -829,8 +827,9 @@ void MainWin::TogglePowerState(void)
 		}
 
 		WriteLog("GUI: Resetting Jaguar...\n");
-		JaguarReset();
+		emuThread->Call([]() { JaguarReset(); });
 		DACPauseAudioThread(false);
+		UpdateEmulationState();
 	}
 }
 
@@ -838,9 +837,15 @@ void MainWin::TogglePowerState(void)
 void MainWin::ToggleRunState(void)
 {
 	running = !running;
+	UpdateEmulationState();
 
 	if (!running)
 	{
+		// Make sure we show the very last frame the emulation finished
+		// (it's stopped now, so there won't be another one behind it)
+		emuThread->Call([]() {});
+		videoWidget->buffer = emuThread->NewestFrame();
+
 		// Restore the mouse pointer, if hidden:
 		videoWidget->CheckAndRestoreMouseCursor();
 		frameAdvanceAct->setDisabled(false);
@@ -887,7 +892,7 @@ void MainWin::SetZoom300(void)
 void MainWin::SetNTSC(void)
 {
 	powerAct->setIcon(powerRed);
-	timer->setInterval(16);
+	timer->setInterval(16);						// Emulation thread paces itself
 	vjs.hardwareTypeNTSC = true;
 	ResizeMainWindow();
 	WriteSettings();
@@ -962,6 +967,8 @@ void MainWin::Unpause(void)
 void MainWin::LoadSoftware(QString file)
 {
 	running = false;							// Prevent bad things(TM) from happening...
+	loadingSoftware = true;						// Hold the emulation until we're done
+	UpdateEmulationState();
 	pauseForFileSelector = false;				// Reset the file selector pause flag
 
 	uint8_t * biosPointer = jaguarBootROM;
@@ -969,22 +976,29 @@ void MainWin::LoadSoftware(QString file)
 	if (vjs.hardwareTypeAlpine)
 		biosPointer = jaguarDevBootROM2;
 
-	memcpy(jagMemSpace + 0xE00000, biosPointer, 0x20000);
+	emuThread->Call([=]() { JagMemCopyIn(0xE00000, biosPointer, 0x20000); });
 
 	powerAct->setDisabled(false);
 	powerAct->setChecked(true);
 	powerButtonOn = false;
 	TogglePowerState();
 	// We have to load our software *after* the Jaguar RESET
-	cartridgeLoaded = JaguarLoadFile(file.toUtf8().data());
-	SET32(jaguarMainRAM, 0, 0x00200000);		// Set top of stack...
+	QByteArray filename = file.toUtf8();
+	emuThread->Call([&]()
+	{
+		cartridgeLoaded = JaguarLoadFile(filename.data());
+		JagMemWrite32(jaguarMainRAM, 0, 0x00200000);		// Set top of stack...
+
+		// This is icky because we've already done it
+		// it gets worse :-P
+		if (!vjs.useJaguarBIOS)
+			JagMemWrite32(jaguarMainRAM, 4, jaguarRunAddress);
 
-	// This is icky because we've already done it
-// it gets worse :-P
-if (!vjs.useJaguarBIOS)
-	SET32(jaguarMainRAM, 4, jaguarRunAddress);
+		m68k_pulse_reset();
+	});
 
-	m68k_pulse_reset();
+	loadingSoftware = false;
+	UpdateEmulationState();
 
 	if (!vjs.hardwareTypeAlpine && !loadAndGo)
 	{
@@ -1000,10 +1014,14 @@ void MainWin::ToggleCDUsage(void)
 	CDActive = !CDActive;
 
 	// Set up the Jaguar CD for execution, otherwise, clear memory
-	if (CDActive)
-		memcpy(jagMemSpace + 0x800000, jaguarCDBootROM, 0x40000);
-	else
-		memset(jagMemSpace + 0x800000, 0xFF, 0x40000);
+	bool active = CDActive;
+	emuThread->Call([=]()
+	{
+		if (active)
+			JagMemCopyIn(0x800000, jaguarCDBootROM, 0x40000);
+		else
+			memset(jaguarMainROM, 0xFF, 0x40000);
+	});
 }
 
 
@@ -1011,10 +1029,10 @@ void MainWin::FrameAdvance(void)
 {
 //printf("Frame Advance...\n");
 	// Execute 1 frame, then exit (only useful in Pause mode)
-	JaguarExecuteNew();
+	emuThread->FrameAdvance();
+	videoWidget->buffer = emuThread->NewestFrame();
 	videoWidget->updateGL();
-	// Need to execute 1 frames' worth of DSP thread as well :-/
-#warning "!!! Need to execute the DSP thread for 1 frame too !!!"
+	// (The DSP runs in JaguarExecuteNew() too, so it advances 1 frame as well)
 }
 
 
@@ -1156,7 +1174,7 @@ void MainWin::ReadSettings(void)
 	vjs.GPUEnabled       = settings.value("GPUEnabled", true).toBool();
 	vjs.DSPEnabled       = settings.value("DSPEnabled", true).toBool();
 	vjs.audioEnabled     = settings.value("audioEnabled", true).toBool();
-	vjs.usePipelinedDSP  = settings.value("usePipelinedDSP", false).toBool();
+	vjs.usePipelinedDSP  = settings.value("usePipelinedDSP", true).toBool();
 	vjs.fullscreen       = settings.value("fullscreen", false).toBool();
 	vjs.useOpenGL        = settings.value("useOpenGL", true).toBool();
 	vjs.glFilter         = settings.value("glFilterType", 1).toInt();
@@ -1164,6 +1182,11 @@ void MainWin::ReadSettings(void)
 	vjs.allowWritesToROM = settings.value("writeROM", false).toBool();
 	vjs.biosType         = settings.value("biosType", BT_M_SERIES).toInt();
 	vjs.useFastBlitter   = settings.value("useFastBlitter", false).toBool();
+	vjs.asyncBlitter     = settings.value("asyncBlitter", false).toBool();
+	vjs.parallelBlitter  = settings.value("parallelBlitter", false).toBool();
+	vjs.threadedGPU      = settings.value("threadedGPU", false).toBool();
+	vjs.useGPUJIT        = settings.value("useGPUJIT", false).toBool();
+	vjs.useDSPJIT        = settings.value("useDSPJIT", false).toBool();
 	strcpy(vjs.EEPROMPath, settings.value("EEPROMs", QStandardPaths::writableLocation(QStandardPaths::DataLocation).append("/eeproms/")).toString().toUtf8().data());
 	strcpy(vjs.ROMPath, settings.value("ROMs", QStandardPaths::writableLocation(QStandardPaths::DataLocation).append("/software/")).toString().toUtf8().data());
 	strcpy(vjs.alpineROMPath, settings.value("DefaultROM", "").toString().toUtf8().data());
@@ -1254,6 +1277,11 @@ void MainWin::WriteSettings(void)
 	settings.setValue("writeROM", vjs.allowWritesToROM);
 	settings.setValue("biosType", vjs.biosType);
 	settings.setValue("useFastBlitter", vjs.useFastBlitter);
+	settings.setValue("asyncBlitter", vjs.asyncBlitter);
+	settings.setValue("parallelBlitter", vjs.parallelBlitter);
+	settings.setValue("threadedGPU", vjs.threadedGPU);
+	settings.setValue("useGPUJIT", vjs.useGPUJIT);
+	settings.setValue("useDSPJIT", vjs.useDSPJIT);
 	settings.setValue("JagBootROM", vjs.jagBootPath);
 	settings.setValue("CDBootROM", vjs.CDBootPath);
 	settings.setValue("EEPROMs", vjs.EEPROMPath);
@@ -12,10 +12,9 @@
 #include <QtWidgets>
 #include "tom.h"
 
-#define RING_BUFFER_SIZE 32
-
 // Forward declarations
 class GLWidget;
+class EmuThread;
 class AboutWindow;
 class HelpWindow;
 class FilePickerWindow;
@@ -76,9 +75,11 @@ class MainWin: public QMainWindow
 		void ReadSettings(void);
 		void WriteSettings(void);
 		void WriteUISettings(void);
+		void UpdateEmulationState(void);
 
 //	public:
 		GLWidget * videoWidget;
+		EmuThread * emuThread;
 		AboutWindow * aboutWin;
 		HelpWindow * helpWin;
 		FilePickerWindow * filePickWin;
@@ -100,14 +101,12 @@ class MainWin: public QMainWindow
 //		bool alpineLoadSuccessful;
 		bool pauseForFileSelector;
 		bool loadAndGo;
+		bool loadingSoftware;
 		bool keyHeld[8];
 		bool fullScreen;
 		bool scannedSoftwareFolder;
 	public:
 		bool plzDontKillMyComputer;
-		uint32_t oldTimestamp;
-		uint32_t ringBufferPointer;
-		uint32_t ringBuffer[RING_BUFFER_SIZE];
 	private:
 		QPoint mainWinPosition;
 //		QSize mainWinSize;
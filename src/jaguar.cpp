@@ -59,21 +59,18 @@ void M68K_show_context(void);
 // External variables
 
 #ifdef CPU_DEBUG_MEMORY
-extern bool startMemLog;							// Set by "e" key
-extern int effect_start;
-extern int effect_start2, effect_start3, effect_start4, effect_start5, effect_start6;
+extern PER_MACHINE bool startMemLog;				// Set by "e" key
+extern PER_MACHINE int effect_start;
+extern PER_MACHINE int effect_start2, effect_start3, effect_start4, effect_start5, effect_start6;
 #endif
 
-// Really, need to include memory.h for this, but it might interfere with some stuff...
-extern uint8_t jagMemSpace[];
-
 // Internal variables
 
 uint32_t jaguar_active_memory_dumps = 0;
 
-uint32_t jaguarMainROMCRC32, jaguarROMSize, jaguarRunAddress;
-bool jaguarCartInserted = false;
-bool lowerField = false;
+PER_MACHINE uint32_t jaguarMainROMCRC32, jaguarROMSize, jaguarRunAddress;
+PER_MACHINE bool jaguarCartInserted = false;
+PER_MACHINE bool lowerField = false;
 
 #ifdef CPU_DEBUG_MEMORY
 uint8_t writeMemMax[0x400000], writeMemMin[0x400000];
@@ -81,30 +78,31 @@ uint8_t readMem[0x400000];
 uint32_t returnAddr[4000], raPtr = 0xFFFFFFFF;
 #endif
 
-uint32_t pcQueue[0x400];
-uint32_t a0Queue[0x400];
-uint32_t a1Queue[0x400];
-uint32_t a2Queue[0x400];
-uint32_t a3Queue[0x400];
-uint32_t a4Queue[0x400];
-uint32_t a5Queue[0x400];
-uint32_t a6Queue[0x400];
-uint32_t a7Queue[0x400];
-uint32_t d0Queue[0x400];
-uint32_t d1Queue[0x400];
-uint32_t d2Queue[0x400];
-uint32_t d3Queue[0x400];
-uint32_t d4Queue[0x400];
-uint32_t d5Queue[0x400];
-uint32_t d6Queue[0x400];
-uint32_t d7Queue[0x400];
-uint32_t srQueue[0x400];
-uint32_t pcQPtr = 0;
+// Register snapshots for backtraces, taken only while the instruction hook is
+// armed (the PCs are in m68kPCRing). regsQueueTag says which PC they go with.
+PER_MACHINE uint32_t a0Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t a1Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t a2Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t a3Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t a4Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t a5Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t a6Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t a7Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t d0Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t d1Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t d2Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t d3Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t d4Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t d5Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t d6Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t d7Queue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t srQueue[M68K_PC_RING_SIZE];
+PER_MACHINE uint32_t regsQueueTag[M68K_PC_RING_SIZE];
 bool startM68KTracing = false;
 
 // Breakpoint on memory access vars (exported)
-bool bpmActive = false;
-uint32_t bpmAddress1;
+PER_MACHINE bool bpmActive = false;
+PER_MACHINE uint32_t bpmAddress1;
 
 
 //
@@ -129,39 +127,42 @@ void M68KInstructionHook(void)
 	}
 #endif
 
-// For tracebacks...
-// Ideally, we'd save all the registers as well...
-	pcQueue[pcQPtr] = m68kPC;
-	a0Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A0);
-	a1Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A1);
-	a2Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A2);
-	a3Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A3);
-	a4Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A4);
-	a5Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A5);
-	a6Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A6);
-	a7Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A7);
-	d0Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D0);
-	d1Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D1);
-	d2Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D2);
-	d3Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D3);
-	d4Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D4);
-	d5Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D5);
-	d6Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D6);
-	d7Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D7);
-	srQueue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_SR);
-	pcQPtr++;
-	pcQPtr &= 0x3FF;
+// For tracebacks... The PC's already in the ring; we add the registers
+	uint32_t slot = (m68kPCRingPtr - 1) & M68K_PC_RING_MASK;
+	a0Queue[slot] = m68k_get_reg(NULL, M68K_REG_A0);
+	a1Queue[slot] = m68k_get_reg(NULL, M68K_REG_A1);
+	a2Queue[slot] = m68k_get_reg(NULL, M68K_REG_A2);
+	a3Queue[slot] = m68k_get_reg(NULL, M68K_REG_A3);
+	a4Queue[slot] = m68k_get_reg(NULL, M68K_REG_A4);
+	a5Queue[slot] = m68k_get_reg(NULL, M68K_REG_A5);
+	a6Queue[slot] = m68k_get_reg(NULL, M68K_REG_A6);
+	a7Queue[slot] = m68k_get_reg(NULL, M68K_REG_A7);
+	d0Queue[slot] = m68k_get_reg(NULL, M68K_REG_D0);
+	d1Queue[slot] = m68k_get_reg(NULL, M68K_REG_D1);
+	d2Queue[slot] = m68k_get_reg(NULL, M68K_REG_D2);
+	d3Queue[slot] = m68k_get_reg(NULL, M68K_REG_D3);
+	d4Queue[slot] = m68k_get_reg(NULL, M68K_REG_D4);
+	d5Queue[slot] = m68k_get_reg(NULL, M68K_REG_D5);
+	d6Queue[slot] = m68k_get_reg(NULL, M68K_REG_D6);
+	d7Queue[slot] = m68k_get_reg(NULL, M68K_REG_D7);
+	srQueue[slot] = m68k_get_reg(NULL, M68K_REG_SR);
+	regsQueueTag[slot] = m68kPCRingPtr;
 
 	if (m68kPC & 0x01)		// Oops! We're fetching an odd address!
 	{
 		WriteLog("M68K: Attempted to execute from an odd address!\n\nBacktrace:\n\n");
 
 		static char buffer[2048];
-		for(int i=0; i<0x400; i++)
+		for(uint32_t i=0; i<M68K_PC_RING_SIZE; i++)
 		{
-			WriteLog("[A0=%08X, A1=%08X, A2=%08X, A3=%08X, A4=%08X, A5=%08X, A6=%08X, A7=%08X, D0=%08X, D1=%08X, D2=%08X, D3=%08X, D4=%08X, D5=%08X, D6=%08X, D7=%08X, SR=%04X]\n", a0Queue[(pcQPtr + i) & 0x3FF], a1Queue[(pcQPtr + i) & 0x3FF], a2Queue[(pcQPtr + i) & 0x3FF], a3Queue[(pcQPtr + i) & 0x3FF], a4Queue[(pcQPtr + i) & 0x3FF], a5Queue[(pcQPtr + i) & 0x3FF], a6Queue[(pcQPtr + i) & 0x3FF], a7Queue[(pcQPtr + i) & 0x3FF], d0Queue[(pcQPtr + i) & 0x3FF], d1Queue[(pcQPtr + i) & 0x3FF], d2Queue[(pcQPtr + i) & 0x3FF], d3Queue[(pcQPtr + i) & 0x3FF], d4Queue[(pcQPtr + i) & 0x3FF], d5Queue[(pcQPtr + i) & 0x3FF], d6Queue[(pcQPtr + i) & 0x3FF], d7Queue[(pcQPtr + i) & 0x3FF], srQueue[(pcQPtr + i) & 0x3FF]);
-			m68k_disassemble(buffer, pcQueue[(pcQPtr + i) & 0x3FF], 0);//M68K_CPU_TYPE_68000);
-			WriteLog("\t%08X: %s\n", pcQueue[(pcQPtr + i) & 0x3FF], buffer);
+			uint32_t n = m68kPCRingPtr + i, j = n & M68K_PC_RING_MASK;
+
+			// Registers are only there if the hook was armed at the time
+			if (regsQueueTag[j] == n - M68K_PC_RING_SIZE + 1)
+				WriteLog("[A0=%08X, A1=%08X, A2=%08X, A3=%08X, A4=%08X, A5=%08X, A6=%08X, A7=%08X, D0=%08X, D1=%08X, D2=%08X, D3=%08X, D4=%08X, D5=%08X, D6=%08X, D7=%08X, SR=%04X]\n", a0Queue[j], a1Queue[j], a2Queue[j], a3Queue[j], a4Queue[j], a5Queue[j], a6Queue[j], a7Queue[j], d0Queue[j], d1Queue[j], d2Queue[j], d3Queue[j], d4Queue[j], d5Queue[j], d6Queue[j], d7Queue[j], srQueue[j]);
+
+			m68k_disassemble(buffer, m68kPCRing[j], 0);//M68K_CPU_TYPE_68000);
+			WriteLog("\t%08X: %s\n", m68kPCRing[j], buffer);
 		}
 		WriteLog("\n");
 
@@ -476,9 +477,48 @@ int irq_ack_handler(int level)
 }
 
 
-//#define USE_NEW_MMU
+//
+// Debugging hooks. Anything that only matters to a debugger (memory
+// breakpoints, memory logging, RISC opcode stats & logging, etc.) costs us on
+// every access or instruction, so the hot paths come in two flavors: the
+// instrumented one, and one with all of that compiled out. Once per frame we
+// look at what's turned on and pick; nobody has to remember to tell us.
+//
+PER_MACHINE bool jaguarDebugHooks = false;
+extern PER_MACHINE int gpu_start_log;
 
-unsigned int m68k_read_memory_8(unsigned int address)
+void JaguarUpdateDebugHooks(void)
+{
+	bool m68kHooks = false;
+
+#ifdef ALPINE_FUNCTIONS
+	m68kHooks = m68kHooks || bpmActive;
+#endif
+#ifdef CPU_DEBUG_MEMORY
+	m68kHooks = m68kHooks || startMemLog;
+#endif
+
+	// The 68K's go in its memory map, so they're only there while they're on.
+	// The DSP's lockstep counts instructions with its opcode stats.
+	MMUHook68K(m68kHooks);
+	jaguarDebugHooks = m68kHooks || vjs.hardwareTypeAlpine || startM68KTracing
+		|| gpu_start_log || vjs.lockstepDSP;
+
+	// The full instruction hook (register snapshots, tracing) only runs when
+	// somebody's debugging; otherwise the 68K just keeps a ring of PCs
+#if defined(LOG_CD_BIOS_CALLS) || defined(ABORT_ON_ILLEGAL_INSTRUCTIONS)
+	m68kHookArmed = 1;							// These need to see everything
+#else
+	m68kHookArmed = jaguarDebugHooks;
+#endif
+}
+
+
+//
+// The MMU sends every 68K access thru these while any of the 68K's hooks are
+// on (see MMUHook68K())
+//
+void M68KDebugRead(uint32_t address, uint32_t size)
 {
 #ifdef ALPINE_FUNCTIONS
 	// Check if breakpoint on memory is active, and deal with it
@@ -486,51 +526,56 @@ unsigned int m68k_read_memory_8(unsigned int address)
 		M68KDebugHalt();
 #endif
 
-	// Musashi does this automagically for you, UAE core does not :-P
-	address &= 0x00FFFFFF;
 #ifdef CPU_DEBUG_MEMORY
 	// Note that the Jaguar only has 2M of RAM, not 4!
-	if ((address >= 0x000000) && (address <= 0x1FFFFF))
+	if (startMemLog && (size == 1) && (address <= 0x1FFFFF))
+		readMem[address] = 1;
+#endif
+}
+
+
+void M68KDebugWrite(uint32_t address, uint32_t data, uint32_t size)
+{
+#ifdef ALPINE_FUNCTIONS
+	// Check if breakpoint on memory is active, and deal with it
+	if (bpmActive && address == bpmAddress1)
+		M68KDebugHalt();
+#endif
+
+#ifdef CPU_DEBUG_MEMORY
+	// Note that the Jaguar only has 2M of RAM, not 4!
+	if (startMemLog && (size <= 2) && (address <= (0x200000 - size)))
 	{
-		if (startMemLog)
-			readMem[address] = 1;
+		for(uint32_t i=0; i<size; i++)
+		{
+			uint8_t byte = data >> ((size - 1 - i) * 8);
+
+			if (byte > writeMemMax[address + i])
+				writeMemMax[address + i] = byte;
+			if (byte < writeMemMin[address + i])
+				writeMemMin[address + i] = byte;
+		}
 	}
 #endif
+}
+
+
+//
+// The 68K memory handlers. The actual decoding is done by the MMU's page
+// tables (see mmu.cpp), which also take care of syncing with the GPU thread
+// and any debugging hooks.
+//
+
+unsigned int m68k_read_memory_8(unsigned int address)
+{
+	// Musashi does this automagically for you, UAE core does not :-P
+	address &= 0x00FFFFFF;
 //WriteLog("[RM8] Addr: %08X\n", address);
 //; So, it seems that it stores the returned DWORD at $51136 and $FB074.
 /*	if (address == 0x51136 || address == 0x51138 || address == 0xFB074 || address == 0xFB076
 		|| address == 0x1AF05E)
 		WriteLog("[RM8  PC=%08X] Addr: %08X, val: %02X\n", m68k_get_reg(NULL, M68K_REG_PC), address, jaguar_mainRam[address]);//*/
-#ifndef USE_NEW_MMU
-	unsigned int retVal = 0;
-
-	// Note that the Jaguar only has 2M of RAM, not 4!
-	if ((address >= 0x000000) && (address <= 0x1FFFFF))
-		retVal = jaguarMainRAM[address];
-//	else if ((address >= 0x800000) && (address <= 0xDFFFFF))
-	else if ((address >= 0x800000) && (address <= 0xDFFEFF))
-		retVal = jaguarMainROM[address - 0x800000];
-	else if ((address >= 0xE00000) && (address <= 0xE3FFFF))
-//		retVal = jaguarBootROM[address - 0xE00000];
-//		retVal = jaguarDevBootROM1[address - 0xE00000];
-		retVal = jagMemSpace[address];
-	else if ((address >= 0xDFFF00) && (address <= 0xDFFFFF))
-		retVal = CDROMReadByte(address);
-	else if ((address >= 0xF00000) && (address <= 0xF0FFFF))
-		retVal = TOMReadByte(address, M68K);
-	else if ((address >= 0xF10000) && (address <= 0xF1FFFF))
-		retVal = JERRYReadByte(address, M68K);
-	else
-		retVal = jaguar_unknown_readbyte(address, M68K);
-
-//if (address >= 0x2800 && address <= 0x281F)
-//	WriteLog("M68K: Read byte $%02X at $%08X [PC=%08X]\n", retVal, address, m68k_get_reg(NULL, M68K_REG_PC));
-//if (address >= 0x8B5E4 && address <= 0x8B5E4 + 16)
-//	WriteLog("M68K: Read byte $%02X at $%08X [PC=%08X]\n", retVal, address, m68k_get_reg(NULL, M68K_REG_PC));
-    return retVal;
-#else
 	return MMURead8(address, M68K);
-#endif
 }
 
 
@@ -539,12 +584,6 @@ void gpu_dump_registers(void);
 
 unsigned int m68k_read_memory_16(unsigned int address)
 {
-#ifdef ALPINE_FUNCTIONS
-	// Check if breakpoint on memory is active, and deal with it
-	if (bpmActive && address == bpmAddress1)
-		M68KDebugHalt();
-#endif
-
 	// Musashi does this automagically for you, UAE core does not :-P
 	address &= 0x00FFFFFF;
 #ifdef CPU_DEBUG_MEMORY
@@ -607,61 +646,12 @@ unsigned int m68k_read_memory_16(unsigned int address)
 /*	if (address == 0x51136 || address == 0x51138 || address == 0xFB074 || address == 0xFB076
 		|| address == 0x1AF05E)
 		WriteLog("[RM16  PC=%08X] Addr: %08X, val: %04X\n", m68k_get_reg(NULL, M68K_REG_PC), address, GET16(jaguar_mainRam, address));//*/
-#ifndef USE_NEW_MMU
-    unsigned int retVal = 0;
-
-	// Note that the Jaguar only has 2M of RAM, not 4!
-	if ((address >= 0x000000) && (address <= 0x1FFFFE))
-//		retVal = (jaguar_mainRam[address] << 8) | jaguar_mainRam[address+1];
-		retVal = GET16(jaguarMainRAM, address);
-//	else if ((address >= 0x800000) && (address <= 0xDFFFFE))
-	else if ((address >= 0x800000) && (address <= 0xDFFEFE))
-	{
-		// Memory Track reading...
-		if (((TOMGetMEMCON1() & 0x0006) == (2 << 1)) && (jaguarMainROMCRC32 == 0xFDF37F47))
-		{
-			retVal = MTReadWord(address);
-		}
-		else
-			retVal = (jaguarMainROM[address - 0x800000] << 8)
-				| jaguarMainROM[address - 0x800000 + 1];
-	}
-	else if ((address >= 0xE00000) && (address <= 0xE3FFFE))
-//		retVal = (jaguarBootROM[address - 0xE00000] << 8) | jaguarBootROM[address - 0xE00000 + 1];
-//		retVal = (jaguarDevBootROM1[address - 0xE00000] << 8) | jaguarDevBootROM1[address - 0xE00000 + 1];
-		retVal = (jagMemSpace[address] << 8) | jagMemSpace[address + 1];
-	else if ((address >= 0xDFFF00) && (address <= 0xDFFFFE))
-		retVal = CDROMReadWord(address, M68K);
-	else if ((address >= 0xF00000) && (address <= 0xF0FFFE))
-		retVal = TOMReadWord(address, M68K);
-	else if ((address >= 0xF10000) && (address <= 0xF1FFFE))
-		retVal = JERRYReadWord(address, M68K);
-	else
-		retVal = jaguar_unknown_readword(address, M68K);
-
-//if (address >= 0xF1B000 && address <= 0xF1CFFF)
-//	WriteLog("M68K: Read word $%04X at $%08X [PC=%08X]\n", retVal, address, m68k_get_reg(NULL, M68K_REG_PC));
-//if (address >= 0x2800 && address <= 0x281F)
-//	WriteLog("M68K: Read word $%04X at $%08X [PC=%08X]\n", retVal, address, m68k_get_reg(NULL, M68K_REG_PC));
-//$8B3AE -> Transferred from $F1C010
-//$8B5E4 -> Only +1 read at $808AA
-//if (address >= 0x8B5E4 && address <= 0x8B5E4 + 16)
-//	WriteLog("M68K: Read word $%04X at $%08X [PC=%08X]\n", retVal, address, m68k_get_reg(NULL, M68K_REG_PC));
-    return retVal;
-#else
 	return MMURead16(address, M68K);
-#endif
 }
 
 
 unsigned int m68k_read_memory_32(unsigned int address)
 {
-#ifdef ALPINE_FUNCTIONS
-	// Check if breakpoint on memory is active, and deal with it
-	if (bpmActive && address == bpmAddress1)
-		M68KDebugHalt();
-#endif
-
 	// Musashi does this automagically for you, UAE core does not :-P
 	address &= 0x00FFFFFF;
 //; So, it seems that it stores the returned DWORD at $51136 and $FB074.
@@ -669,50 +659,15 @@ unsigned int m68k_read_memory_32(unsigned int address)
 		WriteLog("[RM32  PC=%08X] Addr: %08X, val: %08X\n", m68k_get_reg(NULL, M68K_REG_PC), address, (m68k_read_memory_16(address) << 16) | m68k_read_memory_16(address + 2));//*/
 
 //WriteLog("--> [RM32]\n");
-#ifndef USE_NEW_MMU
-	uint32_t retVal = 0;
-
-	if ((address >= 0x800000) && (address <= 0xDFFEFE))
-	{
-		// Memory Track reading...
-		if (((TOMGetMEMCON1() & 0x0006) == (2 << 1)) && (jaguarMainROMCRC32 == 0xFDF37F47))
-			retVal = MTReadLong(address);
-		else
-			retVal = GET32(jaguarMainROM, address - 0x800000);
-
-		return retVal;
-	}
-
-	return (m68k_read_memory_16(address) << 16) | m68k_read_memory_16(address + 2);
-#else
 	return MMURead32(address, M68K);
-#endif
 }
 
 
 void m68k_write_memory_8(unsigned int address, unsigned int value)
 {
-#ifdef ALPINE_FUNCTIONS
-	// Check if breakpoint on memory is active, and deal with it
-	if (bpmActive && address == bpmAddress1)
-		M68KDebugHalt();
-#endif
-
 	// Musashi does this automagically for you, UAE core does not :-P
 	address &= 0x00FFFFFF;
-#ifdef CPU_DEBUG_MEMORY
-	// Note that the Jaguar only has 2M of RAM, not 4!
-	if ((address >= 0x000000) && (address <= 0x1FFFFF))
-	{
-		if (startMemLog)
-		{
-			if (value > writeMemMax[address])
-				writeMemMax[address] = value;
-			if (value < writeMemMin[address])
-				writeMemMin[address] = value;
-		}
-	}
-#endif
+	m68kSideEffect = 1;						// Kills any idle loop in progress
 /*if (address == 0x4E00)
 	WriteLog("M68K: Writing %02X at %08X, PC=%08X\n", value, address, m68k_get_reg(NULL, M68K_REG_PC));//*/
 //if ((address >= 0x1FF020 && address <= 0x1FF03F) || (address >= 0x1FF820 && address <= 0x1FF83F))
@@ -729,54 +684,15 @@ void m68k_write_memory_8(unsigned int address, unsigned int value)
 /*if (address == 0x75A0 && value == 0xFF)
 	printf("M68K: (8) Tripwire hit...\n");//*/
 
-#ifndef USE_NEW_MMU
-	// Note that the Jaguar only has 2M of RAM, not 4!
-	if ((address >= 0x000000) && (address <= 0x1FFFFF))
-		jaguarMainRAM[address] = value;
-	else if ((address >= 0xDFFF00) && (address <= 0xDFFFFF))
-		CDROMWriteByte(address, value, M68K);
-	else if ((address >= 0xF00000) && (address <= 0xF0FFFF))
-		TOMWriteByte(address, value, M68K);
-	else if ((address >= 0xF10000) && (address <= 0xF1FFFF))
-		JERRYWriteByte(address, value, M68K);
-	else
-		jaguar_unknown_writebyte(address, value, M68K);
-#else
 	MMUWrite8(address, value, M68K);
-#endif
 }
 
 
 void m68k_write_memory_16(unsigned int address, unsigned int value)
 {
-#ifdef ALPINE_FUNCTIONS
-	// Check if breakpoint on memory is active, and deal with it
-	if (bpmActive && address == bpmAddress1)
-		M68KDebugHalt();
-#endif
-
 	// Musashi does this automagically for you, UAE core does not :-P
 	address &= 0x00FFFFFF;
-#ifdef CPU_DEBUG_MEMORY
-	// Note that the Jaguar only has 2M of RAM, not 4!
-	if ((address >= 0x000000) && (address <= 0x1FFFFE))
-	{
-		if (startMemLog)
-		{
-			uint8_t hi = value >> 8, lo = value & 0xFF;
-
-			if (hi > writeMemMax[address])
-				writeMemMax[address] = hi;
-			if (hi < writeMemMin[address])
-				writeMemMin[address] = hi;
-
-			if (lo > writeMemMax[address+1])
-				writeMemMax[address+1] = lo;
-			if (lo < writeMemMin[address+1])
-				writeMemMin[address+1] = lo;
-		}
-	}
-#endif
+	m68kSideEffect = 1;						// Kills any idle loop in progress
 /*if (address == 0x4E00)
 	WriteLog("M68K: Writing %02X at %08X, PC=%08X\n", value, address, m68k_get_reg(NULL, M68K_REG_PC));//*/
 //if ((address >= 0x1FF020 && address <= 0x1FF03F) || (address >= 0x1FF820 && address <= 0x1FF83F))
@@ -813,49 +729,12 @@ if (address == 0xF02110)
 	ShowM68KContext();
 }//*/
 
-#ifndef USE_NEW_MMU
-	// Note that the Jaguar only has 2M of RAM, not 4!
-	if ((address >= 0x000000) && (address <= 0x1FFFFE))
-	{
-/*		jaguar_mainRam[address] = value >> 8;
-		jaguar_mainRam[address + 1] = value & 0xFF;*/
-		SET16(jaguarMainRAM, address, value);
-	}
-	// Memory Track device writes....
-	else if ((address >= 0x800000) && (address <= 0x87FFFE))
-	{
-		if (((TOMGetMEMCON1() & 0x0006) == (2 << 1)) && (jaguarMainROMCRC32 == 0xFDF37F47))
-			MTWriteWord(address, value);
-	}
-	else if ((address >= 0xDFFF00) && (address <= 0xDFFFFE))
-		CDROMWriteWord(address, value, M68K);
-	else if ((address >= 0xF00000) && (address <= 0xF0FFFE))
-		TOMWriteWord(address, value, M68K);
-	else if ((address >= 0xF10000) && (address <= 0xF1FFFE))
-		JERRYWriteWord(address, value, M68K);
-	else
-	{
-		jaguar_unknown_writeword(address, value, M68K);
-#ifdef LOG_UNMAPPED_MEMORY_ACCESSES
-		WriteLog("\tA0=%08X, A1=%08X, D0=%08X, D1=%08X\n",
-			m68k_get_reg(NULL, M68K_REG_A0), m68k_get_reg(NULL, M68K_REG_A1),
-			m68k_get_reg(NULL, M68K_REG_D0), m68k_get_reg(NULL, M68K_REG_D1));
-#endif
-	}
-#else
 	MMUWrite16(address, value, M68K);
-#endif
 }
 
 
 void m68k_write_memory_32(unsigned int address, unsigned int value)
 {
-#ifdef ALPINE_FUNCTIONS
-	// Check if breakpoint on memory is active, and deal with it
-	if (bpmActive && address == bpmAddress1)
-		M68KDebugHalt();
-#endif
-
 	// Musashi does this automagically for you, UAE core does not :-P
 	address &= 0x00FFFFFF;
 /*if (address == 0x4E00)
@@ -880,12 +759,7 @@ if (address == 0xF03214 && value == 0x88E30047)
 	ShowM68KContext();
 }//*/
 
-#ifndef USE_NEW_MMU
-	m68k_write_memory_16(address, value >> 16);
-	m68k_write_memory_16(address + 2, value & 0xFFFF);
-#else
 	MMUWrite32(address, value, M68K);
-#endif
 }
 
 
@@ -1076,149 +950,50 @@ void JaguarDasm(uint32_t offset, uint32_t qt)
 
 uint8_t JaguarReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
-	uint8_t data = 0x00;
-	offset &= 0xFFFFFF;
-
-	// First 2M is mirrored in the $0 - $7FFFFF range
-	if (offset < 0x800000)
-		data = jaguarMainRAM[offset & 0x1FFFFF];
-	else if ((offset >= 0x800000) && (offset < 0xDFFF00))
-		data = jaguarMainROM[offset - 0x800000];
-	else if ((offset >= 0xDFFF00) && (offset <= 0xDFFFFF))
-		data = CDROMReadByte(offset, who);
-	else if ((offset >= 0xE00000) && (offset < 0xE40000))
-		data = jagMemSpace[offset];
-	else if ((offset >= 0xF00000) && (offset < 0xF10000))
-		data = TOMReadByte(offset, who);
-	else if ((offset >= 0xF10000) && (offset < 0xF20000))
-		data = JERRYReadByte(offset, who);
-	else
-		data = jaguar_unknown_readbyte(offset, who);
-
-	return data;
+	return MMURead8(offset, who);
 }
 
 
 uint16_t JaguarReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
-	offset &= 0xFFFFFF;
-
-	// First 2M is mirrored in the $0 - $7FFFFF range
-	if (offset < 0x800000)
-	{
-		return (jaguarMainRAM[(offset+0) & 0x1FFFFF] << 8) | jaguarMainRAM[(offset+1) & 0x1FFFFF];
-	}
-	else if ((offset >= 0x800000) && (offset < 0xDFFF00))
-	{
-		offset -= 0x800000;
-		return (jaguarMainROM[offset+0] << 8) | jaguarMainROM[offset+1];
-	}
-	else if ((offset >= 0xDFFF00) && (offset <= 0xDFFFFE))
-		return CDROMReadWord(offset, who);
-	else if ((offset >= 0xE00000) && (offset <= 0xE3FFFE))
-		return (jagMemSpace[offset + 0] << 8) | jagMemSpace[offset + 1];
-	else if ((offset >= 0xF00000) && (offset <= 0xF0FFFE))
-		return TOMReadWord(offset, who);
-	else if ((offset >= 0xF10000) && (offset <= 0xF1FFFE))
-		return JERRYReadWord(offset, who);
-
-	return jaguar_unknown_readword(offset, who);
+	return MMURead16(offset, who);
 }
 
 
 void JaguarWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 {
-  offset &= 0xFFFFFF;
-
-  // First 2M is mirrored in the $0 - $7FFFFF range
-  if (offset < 0x800000)
-    {
-      jaguarMainRAM[offset & 0x1FFFFF] = data;
-      return;
-    }
-  else if ((offset >= 0xDFFF00) && (offset <= 0xDFFFFF))
-    {
-      CDROMWriteByte(offset, data, who);
-      return;
-    }
-  else if ((offset >= 0xF00000) && (offset <= 0xF0FFFF))
-    {
-      TOMWriteByte(offset, data, who);
-      return;
-    }
-  else if ((offset >= 0xF10000) && (offset <= 0xF1FFFF))
-    {
-      JERRYWriteByte(offset, data, who);
-      return;
-    }
-	
-  jaguar_unknown_writebyte(offset, data, who);
+	MMUWrite8(offset, data, who);
 }
 
 
-uint32_t starCount;
+PER_MACHINE uint32_t starCount;
 void JaguarWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 {
-  offset &= 0xFFFFFF;
-
-  // First 2M is mirrored in the $0 - $7FFFFF range
-  if (offset <= 0x7FFFFE)
-    {
-      /*
-	GPU Table (CD BIOS)
-
-	1A 69 F0 ($0000) -> Starfield
-	1A 73 C8 ($0001) -> Final clearing blit & bitmap blit?
-	1A 79 F0 ($0002)
-	1A 88 C0 ($0003)
-	1A 8F E8 ($0004) -> "Jaguar" small color logo?
-	1A 95 20 ($0005)
-	1A 9F 08 ($0006)
-	1A A1 38 ($0007)
-	1A AB 38 ($0008)
-	1A B3 C8 ($0009)
-	1A B9 C0 ($000A)
-      */
-
-      jaguarMainRAM[(offset+0) & 0x1FFFFF] = data >> 8;
-      jaguarMainRAM[(offset+1) & 0x1FFFFF] = data & 0xFF;
-      return;
-    }
-  else if (offset >= 0xDFFF00 && offset <= 0xDFFFFE)
-    {
-      CDROMWriteWord(offset, data, who);
-      return;
-    }
-  else if (offset >= 0xF00000 && offset <= 0xF0FFFE)
-    {
-      TOMWriteWord(offset, data, who);
-      return;
-    }
-  else if (offset >= 0xF10000 && offset <= 0xF1FFFE)
-    {
-      JERRYWriteWord(offset, data, who);
-      return;
-    }
-  // Don't bomb on attempts to write to ROM
-  else if (offset >= 0x800000 && offset <= 0xEFFFFF)
-    return;
-
-  jaguar_unknown_writeword(offset, data, who);
+	MMUWrite16(offset, data, who);
 }
 
 
-// We really should re-do this so that it does *real* 32-bit access... !!! FIX !!!
 uint32_t JaguarReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
-	return (JaguarReadWord(offset, who) << 16) | JaguarReadWord(offset+2, who);
+	return MMURead32(offset, who);
+}
+
+
+uint64_t JaguarReadPhrase(uint32_t offset, uint32_t who/*=UNKNOWN*/)
+{
+	return MMURead64(offset, who);
 }
 
 
-// We really should re-do this so that it does *real* 32-bit access... !!! FIX !!!
 void JaguarWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 {
-	JaguarWriteWord(offset, data >> 16, who);
-	JaguarWriteWord(offset+2, data & 0xFFFF, who);
+	MMUWrite32(offset, data, who);
+}
+
+
+void JaguarWritePhrase(uint32_t offset, uint64_t data, uint32_t who/*=UNKNOWN*/)
+{
+	MMUWrite64(offset, data, who);
 }
 
 
@@ -1241,6 +1016,8 @@ void JaguarSetScreenPitch(uint32_t pitch)
 //
 void JaguarInit(void)
 {
+  MemoryInit();
+
   // For randomizing RAM
   srand(time(NULL));
 
@@ -1257,6 +1034,7 @@ void JaguarInit(void)
   //temp, for crappy crap that sux
   memset(jaguarMainRAM + 0x804, 0xFF, 4);
 
+  MMUInit();
   m68k_pulse_reset();							// Need to do this so UAE disasm doesn't segfault on exit
   GPUInit();
   DSPInit();
@@ -1269,8 +1047,13 @@ void JaguarInit(void)
 //New timer based code stuffola...
 void HalflineCallback(void);
 void RenderCallback(void);
+static PER_MACHINE uint32_t halflineTicks;		// Set at reset (NTSC/PAL)
+static PER_MACHINE uint16_t numHalfLines;		// Set at reset (NTSC/PAL)
+static PER_MACHINE uint32_t m68kTickRemainder;	// Odd RISC tick owed to the 68K
 void JaguarReset(void)
 {
+  BlitterSync();									// Before we go scribbling on RAM
+
   // Only problem with this approach: It wipes out RAM loaded files...!
   // Contents of local RAM are quasi-stable; we simulate this by randomizing RAM contents
   for(uint32_t i=8; i<0x200000; i+=4)
@@ -1284,9 +1067,9 @@ void JaguarReset(void)
   // Only use the system BIOS if it's available...! (it's always available now!)
   // AND only if a jaguar cartridge has been inserted.
   if (vjs.useJaguarBIOS && jaguarCartInserted && !vjs.hardwareTypeAlpine)
-    memcpy(jaguarMainRAM, jagMemSpace + 0xE00000, 8);
+    memcpy(jaguarMainRAM, jaguarBIOS, 8);	// Same layout, so OK
   else
-    SET32(jaguarMainRAM, 4, jaguarRunAddress);
+    JagMemWrite32(jaguarMainRAM, 4, jaguarRunAddress);
 
   //	WriteLog("jaguar_reset():\n");
   TOMReset();
@@ -1294,13 +1077,19 @@ void JaguarReset(void)
   GPUReset();
   DSPReset();
   CDROMReset();
+  MMUInit();										// Picks up the cart that's in now
   m68k_pulse_reset();								// Reset the 68000
   WriteLog("Jaguar: 68K reset. PC=%06X SP=%08X\n", m68k_get_reg(NULL, M68K_REG_PC), m68k_get_reg(NULL, M68K_REG_A7));
 
   lowerField = false;								// Reset the lower field flag
+  m68kTickRemainder = 0;
+
+  // Resolve the NTSC/PAL video timings once, here, instead of per halfline
+  halflineTicks = (vjs.hardwareTypeNTSC ? HALFLINE_TICKS_NTSC : HALFLINE_TICKS_PAL);
+  numHalfLines = ((vjs.hardwareTypeNTSC ? 525 : 625) * 2) / 2;
   //	SetCallbackTime(ScanlineCallback, 63.5555);
   //	SetCallbackTime(ScanlineCallback, 31.77775);
-  SetCallbackTime(HalflineCallback, (vjs.hardwareTypeNTSC ? 31.777777777 : 32.0));
+  SetCallbackTicks(HalflineCallback, halflineTicks);
 }
 
 
@@ -1351,8 +1140,11 @@ void DumpMainMemory(void)
 	if (fp == NULL)
 		return;
 
-	fwrite(jaguarMainRAM, 1, 0x200000, fp);
+	uint8_t * buffer = new uint8_t[0x200000];
+	JagMemCopyOut(buffer, 0x000000, 0x200000);
+	fwrite(buffer, 1, 0x200000, fp);
 	fclose(fp);
+	delete[] buffer;
 }
 
 
@@ -1366,24 +1158,58 @@ uint8_t * GetRamPtr(void)
 // New Jaguar execution stack
 // This executes 1 frame's worth of code.
 //
-bool frameDone;
+PER_MACHINE bool frameDone;
 void JaguarExecuteNew(void)
 {
 	frameDone = false;
+	JaguarUpdateDebugHooks();
 
 	do
 	{
-		double timeToNextEvent = GetTimeToNextEvent();
-//WriteLog("JEN: Time to next event (%u) is %f usec (%u RISC cycles)...\n", nextEvent, timeToNextEvent, USEC_TO_RISC_CYCLES(timeToNextEvent));
+		uint32_t ticksToNextEvent = (uint32_t)GetTicksToNextEvent();
+//WriteLog("JEN: Time to next event is %u RISC cycles...\n", ticksToNextEvent);
+
+		// The 68K runs at half the RISC clock; carry any odd tick over to the
+		// next slice so the two never drift apart
+		uint32_t m68kTicks = ticksToNextEvent + m68kTickRemainder;
+		m68kTickRemainder = m68kTicks & 0x01;
+
+		// If the GPU's already running, it can run its slice on its own thread
+		// alongside the 68K. Otherwise it runs after the 68K, which may well be
+		// what started it.
+#ifdef JAGUAR_MULTI_INSTANCE
+		bool gpuThreaded = false;				// GPU thread can't see our state
+#else
+		bool gpuThreaded = vjs.GPUEnabled && vjs.threadedGPU && GPUIsRunning()
+			&& !vjs.lockstepBlitter;			// Blits have to take turns
+#endif
 
-		m68k_execute(USEC_TO_M68K_CYCLES(timeToNextEvent));
+		if (gpuThreaded)
+			GPUExecThreaded(ticksToNextEvent);
 
-		if (vjs.GPUEnabled)
-			GPUExec(USEC_TO_RISC_CYCLES(timeToNextEvent));
+		m68k_execute(m68kTicks >> 1);
+
+		if (gpuThreaded)
+			GPUWaitThreaded();
+		else if (vjs.GPUEnabled)
+			GPUExec(ticksToNextEvent);
+
+		if (vjs.DSPEnabled)
+		{
+			if (vjs.lockstepDSP)
+				DSPExecLockstep(ticksToNextEvent);
+			else if (vjs.usePipelinedDSP)
+				DSPExecP2(ticksToNextEvent);
+			else
+				DSPExec(ticksToNextEvent);
+		}
 
 		HandleNextEvent();
  	}
 	while (!frameDone);
+
+	// Nobody outside of the emulation loop knows to wait for the blitter
+	BlitterSync();
 }
 
 
@@ -1408,7 +1234,7 @@ void JaguarExecuteNew(void)
 // PAL.
 //
 // Scanline times are 63.5555... μs in NTSC and 64 μs in PAL
-// Half line times are, naturally, half of this. :-P
+// Half line times are, naturally, half of this. :-P (845 & 851 RISC ticks)
 //
 void HalflineCallback(void)
 {
@@ -1420,7 +1246,7 @@ void HalflineCallback(void)
 
 	// Each # of lines is for a full frame == 1/30s (NTSC), 1/25s (PAL).
 	// So we cut the number of half-lines in a frame in half. :-P
-	uint16_t numHalfLines = ((vjs.hardwareTypeNTSC ? 525 : 625) * 2) / 2;
+	// (numHalfLines is set up in JaguarReset())
 
 	if ((vc & 0x7FF) >= numHalfLines)
 	{
@@ -1453,6 +1279,6 @@ void HalflineCallback(void)
 		frameDone = true;
 	}//*/
 
-	SetCallbackTime(HalflineCallback, (vjs.hardwareTypeNTSC ? 31.777777777 : 32.0));
+	SetCallbackTicks(HalflineCallback, halflineTicks);
 }
 
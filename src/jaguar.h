@@ -13,23 +13,29 @@ void JaguarDone(void);
 uint8_t JaguarReadByte(uint32_t offset, uint32_t who = UNKNOWN);
 uint16_t JaguarReadWord(uint32_t offset, uint32_t who = UNKNOWN);
 uint32_t JaguarReadLong(uint32_t offset, uint32_t who = UNKNOWN);
+uint64_t JaguarReadPhrase(uint32_t offset, uint32_t who = UNKNOWN);
 void JaguarWriteByte(uint32_t offset, uint8_t data, uint32_t who = UNKNOWN);
 void JaguarWriteWord(uint32_t offset, uint16_t data, uint32_t who = UNKNOWN);
 void JaguarWriteLong(uint32_t offset, uint32_t data, uint32_t who = UNKNOWN);
+void JaguarWritePhrase(uint32_t offset, uint64_t data, uint32_t who = UNKNOWN);
 
 bool JaguarInterruptHandlerIsValid(uint32_t i);
 void JaguarDasm(uint32_t offset, uint32_t qt);
 
 void JaguarExecuteNew(void);
+void JaguarUpdateDebugHooks(void);
+void M68KDebugRead(uint32_t address, uint32_t size);
+void M68KDebugWrite(uint32_t address, uint32_t data, uint32_t size);
 
 // Exports from JAGUAR.CPP
 
 extern int32_t jaguarCPUInExec;
-extern uint32_t jaguarMainROMCRC32, jaguarROMSize, jaguarRunAddress;
+extern PER_MACHINE uint32_t jaguarMainROMCRC32, jaguarROMSize, jaguarRunAddress;
 extern char * jaguarEepromsPath;
-extern bool jaguarCartInserted;
-extern bool bpmActive;
-extern uint32_t bpmAddress1;
+extern PER_MACHINE bool jaguarCartInserted;
+extern PER_MACHINE bool bpmActive;
+extern PER_MACHINE uint32_t bpmAddress1;
+extern PER_MACHINE bool jaguarDebugHooks;
 
 // Various clock rates
 
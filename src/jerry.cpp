@@ -173,7 +173,7 @@
 //Note that 44100 Hz requires samples every 22.675737 usec.
 //#define JERRY_DEBUG
 
-/*static*/ uint8_t jerry_ram_8[0x10000];
+/*static*/ PER_MACHINE uint8_t jerry_ram_8[0x10000];
 
 //#define JERRY_CONFIG	0x4002						// ??? What's this ???
 
@@ -193,22 +193,22 @@
 #define SMODE		0xA154
 
 
-uint8_t analog_x, analog_y;
+PER_MACHINE uint8_t analog_x, analog_y;
 
-static uint32_t JERRYPIT1Prescaler;
-static uint32_t JERRYPIT1Divider;
-static uint32_t JERRYPIT2Prescaler;
-static uint32_t JERRYPIT2Divider;
-static int32_t jerry_timer_1_counter;
-static int32_t jerry_timer_2_counter;
+static PER_MACHINE uint32_t JERRYPIT1Prescaler;
+static PER_MACHINE uint32_t JERRYPIT1Divider;
+static PER_MACHINE uint32_t JERRYPIT2Prescaler;
+static PER_MACHINE uint32_t JERRYPIT2Divider;
+static PER_MACHINE int32_t jerry_timer_1_counter;
+static PER_MACHINE int32_t jerry_timer_2_counter;
 
 //uint32_t JERRYI2SInterruptDivide = 8;
-int32_t JERRYI2SInterruptTimer = -1;
-uint32_t jerryI2SCycles;
-uint32_t jerryIntPending;
+PER_MACHINE int32_t JERRYI2SInterruptTimer = -1;
+PER_MACHINE uint32_t jerryI2SCycles;
+PER_MACHINE uint32_t jerryIntPending;
 
-static uint16_t jerryInterruptMask = 0;
-static uint16_t jerryPendingInterrupt = 0;
+static PER_MACHINE uint16_t jerryInterruptMask = 0;
+static PER_MACHINE uint16_t jerryPendingInterrupt = 0;
 
 // Private function prototypes
 
@@ -236,8 +236,8 @@ void JERRYResetPIT1(void)
 
 	if (JERRYPIT1Prescaler | JERRYPIT1Divider)
 	{
-		double usecs = (float)(JERRYPIT1Prescaler + 1) * (float)(JERRYPIT1Divider + 1) * RISC_CYCLE_IN_USEC;
-		SetCallbackTime(JERRYPIT1Callback, usecs, EVENT_JERRY);
+		uint64_t ticks = (uint64_t)(JERRYPIT1Prescaler + 1) * (JERRYPIT1Divider + 1);
+		SetCallbackTicks(JERRYPIT1Callback, ticks);
 	}
 }
 
@@ -248,8 +248,8 @@ void JERRYResetPIT2(void)
 
 	if (JERRYPIT1Prescaler | JERRYPIT1Divider)
 	{
-		double usecs = (float)(JERRYPIT2Prescaler + 1) * (float)(JERRYPIT2Divider + 1) * RISC_CYCLE_IN_USEC;
-		SetCallbackTime(JERRYPIT2Callback, usecs, EVENT_JERRY);
+		uint64_t ticks = (uint64_t)(JERRYPIT2Prescaler + 1) * (JERRYPIT2Divider + 1);
+		SetCallbackTicks(JERRYPIT2Callback, ticks);
 	}
 }
 
@@ -314,10 +314,7 @@ void JERRYI2SCallback(void)
 	{
 		// This does the 'IRQ enabled' checking...
 		DSPSetIRQLine(DSPIRQ_SSI, ASSERT_LINE);
-//		double usecs = (float)jerryI2SCycles * RISC_CYCLE_IN_USEC;
-//this fix is almost enough to fix timings in tripper, but not quite enough...
-		double usecs = (float)jerryI2SCycles * (vjs.hardwareTypeNTSC ? RISC_CYCLE_IN_USEC : RISC_CYCLE_PAL_IN_USEC);
-		SetCallbackTime(JERRYI2SCallback, usecs, EVENT_JERRY);
+		SetCallbackTicks(JERRYI2SCallback, jerryI2SCycles);
 	}
 	else
 	{
@@ -351,7 +348,7 @@ void JERRYI2SCallback(void)
 			DSPSetIRQLine(DSPIRQ_SSI, ASSERT_LINE);
 		}
 
-		SetCallbackTime(JERRYI2SCallback, 22.675737, EVENT_JERRY);
+		SetCallbackTicks(JERRYI2SCallback, (masterClockRate + 22050) / 44100);
 	}
 }
 
@@ -778,14 +775,12 @@ else if (offset == 0xF10020)
 
 int JERRYGetPIT1Frequency(void)
 {
-	int systemClockFrequency = (vjs.hardwareTypeNTSC ? RISC_CLOCK_RATE_NTSC : RISC_CLOCK_RATE_PAL);
-	return systemClockFrequency / ((JERRYPIT1Prescaler + 1) * (JERRYPIT1Divider + 1));
+	return masterClockRate / ((JERRYPIT1Prescaler + 1) * (JERRYPIT1Divider + 1));
 }
 
 
 int JERRYGetPIT2Frequency(void)
 {
-	int systemClockFrequency = (vjs.hardwareTypeNTSC ? RISC_CLOCK_RATE_NTSC : RISC_CLOCK_RATE_PAL);
-	return systemClockFrequency / ((JERRYPIT2Prescaler + 1) * (JERRYPIT2Divider + 1));
+	return masterClockRate / ((JERRYPIT2Prescaler + 1) * (JERRYPIT2Divider + 1));
 }
 
@@ -39,6 +39,6 @@ void JERRYI2SCallback(void);
 // External variables
 
 //extern uint32_t JERRYI2SInterruptDivide;
-extern int32_t JERRYI2SInterruptTimer;
+extern PER_MACHINE int32_t JERRYI2SInterruptTimer;
 
 #endif
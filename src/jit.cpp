@@ -0,0 +1,435 @@
+//
+// jit.cpp - Bits & pieces for the RISC recompilers
+//
+// See jit.h. Everything here just appends machine code at p; nothing checks
+// for room, so callers have to leave enough slop at the end of their buffers.
+//
+
+#include "jit.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include <string.h>
+
+
+//
+// Get a chunk of memory we can write code into & then run. Returns NULL if the
+// host won't let us have one.
+//
+uint8_t * JITAlloc(uint32_t size)
+{
+#ifdef _WIN32
+	return (uint8_t *)VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+	void * mem = mmap(NULL, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	return (mem == MAP_FAILED ? NULL : (uint8_t *)mem);
+#endif
+}
+
+
+void JITFree(uint8_t * mem, uint32_t size)
+{
+	if (mem == NULL)
+		return;
+
+#ifdef _WIN32
+	VirtualFree(mem, 0, MEM_RELEASE);
+#else
+	munmap(mem, size);
+#endif
+}
+
+#ifdef JIT_X86_64
+
+static inline void Emit32(uint8_t *& p, uint32_t data)
+{
+	memcpy(p, &data, 4);
+	p += 4;
+}
+
+
+static inline void EmitREX(uint8_t *& p, bool wide, int reg, int rm)
+{
+	uint8_t rex = 0x40 | (wide ? 0x08 : 0) | (reg & 0x08 ? 0x04 : 0) | (rm & 0x08 ? 0x01 : 0);
+
+	if (rex != 0x40)
+		*p++ = rex;
+}
+
+
+// ModR/M (& SIB & displacement) for [base + disp]
+static inline void EmitMem(uint8_t *& p, int reg, int base, int32_t disp)
+{
+	bool shortDisp = (disp >= -128 && disp <= 127);
+	*p++ = (shortDisp ? 0x40 : 0x80) | ((reg & 0x07) << 3) | (base & 0x07);
+
+	// RSP & R12 can only be a base thru a SIB byte
+	if ((base & 0x07) == RSP)
+		*p++ = 0x24;
+
+	if (shortDisp)
+		*p++ = (uint8_t)disp;
+	else
+		Emit32(p, disp);
+}
+
+
+// ModR/M for a register operand
+static inline void EmitReg(uint8_t *& p, int reg, int rm)
+{
+	*p++ = 0xC0 | ((reg & 0x07) << 3) | (rm & 0x07);
+}
+
+
+void JITPush(uint8_t *& p, int reg)
+{
+	EmitREX(p, false, 0, reg);
+	*p++ = 0x50 + (reg & 0x07);
+}
+
+
+void JITPop(uint8_t *& p, int reg)
+{
+	EmitREX(p, false, 0, reg);
+	*p++ = 0x58 + (reg & 0x07);
+}
+
+
+void JITRet(uint8_t *& p)
+{
+	*p++ = 0xC3;
+}
+
+
+// add rsp, amount
+void JITAdjustStack(uint8_t *& p, int8_t amount)
+{
+	EmitREX(p, true, 0, RSP);
+	*p++ = 0x83;
+	EmitReg(p, ALU_ADD, RSP);
+	*p++ = (uint8_t)amount;
+}
+
+
+// Goes thru RAX, since the target is likely to be more than 2 GB away
+void JITCall(uint8_t *& p, void * target)
+{
+	JITMovRegImm64(p, RAX, (uint64_t)target);
+	*p++ = 0xFF;
+	EmitReg(p, 2, RAX);
+}
+
+
+void JITMovRegImm(uint8_t *& p, int reg, uint32_t imm)
+{
+	EmitREX(p, false, 0, reg);
+	*p++ = 0xB8 + (reg & 0x07);
+	Emit32(p, imm);
+}
+
+
+void JITMovRegImm64(uint8_t *& p, int reg, uint64_t imm)
+{
+	EmitREX(p, true, 0, reg);
+	*p++ = 0xB8 + (reg & 0x07);
+	memcpy(p, &imm, 8);
+	p += 8;
+}
+
+
+void JITMovRegReg(uint8_t *& p, int dst, int src)
+{
+	EmitREX(p, false, src, dst);
+	*p++ = 0x89;
+	EmitReg(p, src, dst);
+}
+
+
+void JITLoad(uint8_t *& p, int reg, int base, int32_t disp)
+{
+	EmitREX(p, false, reg, base);
+	*p++ = 0x8B;
+	EmitMem(p, reg, base, disp);
+}
+
+
+void JITLoad64(uint8_t *& p, int reg, int base, int32_t disp)
+{
+	EmitREX(p, true, reg, base);
+	*p++ = 0x8B;
+	EmitMem(p, reg, base, disp);
+}
+
+
+void JITStore(uint8_t *& p, int base, int32_t disp, int reg)
+{
+	EmitREX(p, false, reg, base);
+	*p++ = 0x89;
+	EmitMem(p, reg, base, disp);
+}
+
+
+void JITStoreImm(uint8_t *& p, int base, int32_t disp, uint32_t imm)
+{
+	EmitREX(p, false, 0, base);
+	*p++ = 0xC7;
+	EmitMem(p, 0, base, disp);
+	Emit32(p, imm);
+}
+
+
+void JITStore64(uint8_t *& p, int base, int32_t disp, int reg)
+{
+	EmitREX(p, true, reg, base);
+	*p++ = 0x89;
+	EmitMem(p, reg, base, disp);
+}
+
+
+// Sign & zero extending loads of the low word of [base + disp]
+void JITLoadS16(uint8_t *& p, int reg, int base, int32_t disp)
+{
+	EmitREX(p, false, reg, base);
+	*p++ = 0x0F;
+	*p++ = 0xBF;
+	EmitMem(p, reg, base, disp);
+}
+
+
+void JITLoadU16(uint8_t *& p, int reg, int base, int32_t disp)
+{
+	EmitREX(p, false, reg, base);
+	*p++ = 0x0F;
+	*p++ = 0xB7;
+	EmitMem(p, reg, base, disp);
+}
+
+
+// reg = reg <op> [base + disp]
+void JITAluRegMem(uint8_t *& p, int op, int reg, int base, int32_t disp)
+{
+	EmitREX(p, false, reg, base);
+	*p++ = (op << 3) | 0x03;
+	EmitMem(p, reg, base, disp);
+}
+
+
+// [base + disp] = [base + disp] <op> reg
+void JITAluMemReg(uint8_t *& p, int op, int base, int32_t disp, int reg)
+{
+	EmitREX(p, false, reg, base);
+	*p++ = (op << 3) | 0x01;
+	EmitMem(p, reg, base, disp);
+}
+
+
+void JITAluMemImm(uint8_t *& p, int op, int base, int32_t disp, uint32_t imm)
+{
+	EmitREX(p, false, 0, base);
+
+	if ((int32_t)imm >= -128 && (int32_t)imm <= 127)
+	{
+		*p++ = 0x83;
+		EmitMem(p, op, base, disp);
+		*p++ = (uint8_t)imm;
+	}
+	else
+	{
+		*p++ = 0x81;
+		EmitMem(p, op, base, disp);
+		Emit32(p, imm);
+	}
+}
+
+
+// Same, on a byte in memory
+void JITAluMemImm8(uint8_t *& p, int op, int base, int32_t disp, uint8_t imm)
+{
+	EmitREX(p, false, 0, base);
+	*p++ = 0x80;
+	EmitMem(p, op, base, disp);
+	*p++ = imm;
+}
+
+
+// 64-bit [base + disp] = [base + disp] <op> reg
+void JITAluMemReg64(uint8_t *& p, int op, int base, int32_t disp, int reg)
+{
+	EmitREX(p, true, reg, base);
+	*p++ = (op << 3) | 0x01;
+	EmitMem(p, reg, base, disp);
+}
+
+
+void JITAluRegReg(uint8_t *& p, int op, int dst, int src)
+{
+	EmitREX(p, false, src, dst);
+	*p++ = (op << 3) | 0x01;
+	EmitReg(p, src, dst);
+}
+
+
+void JITAluRegImm(uint8_t *& p, int op, int reg, uint32_t imm)
+{
+	EmitREX(p, false, 0, reg);
+
+	if ((int32_t)imm >= -128 && (int32_t)imm <= 127)
+	{
+		*p++ = 0x83;
+		EmitReg(p, op, reg);
+		*p++ = (uint8_t)imm;
+	}
+	else
+	{
+		*p++ = 0x81;
+		EmitReg(p, op, reg);
+		Emit32(p, imm);
+	}
+}
+
+
+void JITNotReg(uint8_t *& p, int reg)
+{
+	EmitREX(p, false, 0, reg);
+	*p++ = 0xF7;
+	EmitReg(p, 2, reg);
+}
+
+
+void JITNegMem(uint8_t *& p, int base, int32_t disp)
+{
+	EmitREX(p, false, 0, base);
+	*p++ = 0xF7;
+	EmitMem(p, 3, base, disp);
+}
+
+
+// Signed multiply; only the low 32 bits of the product are kept
+void JITImulRegReg(uint8_t *& p, int dst, int src)
+{
+	EmitREX(p, false, dst, src);
+	*p++ = 0x0F;
+	*p++ = 0xAF;
+	EmitReg(p, dst, src);
+}
+
+
+// Sign extends the low 32 bits of reg to all 64 (MOVSXD)
+void JITSignExtend64(uint8_t *& p, int reg)
+{
+	EmitREX(p, true, reg, reg);
+	*p++ = 0x63;
+	EmitReg(p, reg, reg);
+}
+
+
+void JITBswap(uint8_t *& p, int reg)
+{
+	EmitREX(p, false, 0, reg);
+	*p++ = 0x0F;
+	*p++ = 0xC8 + (reg & 0x07);
+}
+
+
+// dst = src if the condition holds
+void JITCmov(uint8_t *& p, int cc, int dst, int src)
+{
+	EmitREX(p, false, dst, src);
+	*p++ = 0x0F;
+	*p++ = 0x40 + cc;
+	EmitReg(p, dst, src);
+}
+
+
+void JITShiftRegImm(uint8_t *& p, int op, int reg, uint8_t count)
+{
+	EmitREX(p, false, 0, reg);
+	*p++ = 0xC1;
+	EmitReg(p, op, reg);
+	*p++ = count;
+}
+
+
+void JITTestRegReg(uint8_t *& p, int reg1, int reg2)
+{
+	EmitREX(p, false, reg2, reg1);
+	*p++ = 0x85;
+	EmitReg(p, reg2, reg1);
+}
+
+
+void JITTestMemImm(uint8_t *& p, int base, int32_t disp, uint32_t imm)
+{
+	EmitREX(p, false, 0, base);
+	*p++ = 0xF7;
+	EmitMem(p, 0, base, disp);
+	Emit32(p, imm);
+}
+
+
+void JITShiftReg64Imm(uint8_t *& p, int op, int reg, uint8_t count)
+{
+	EmitREX(p, true, 0, reg);
+	*p++ = 0xC1;
+	EmitReg(p, op, reg);
+	*p++ = count;
+}
+
+
+// Copies bit #bit of reg into the carry
+void JITBtRegImm(uint8_t *& p, int reg, uint8_t bit)
+{
+	EmitREX(p, false, 0, reg);
+	*p++ = 0x0F;
+	*p++ = 0xBA;
+	EmitReg(p, 4, reg);
+	*p++ = bit;
+}
+
+
+// Sets the byte at [base + disp] to 1 if the condition holds, 0 if it doesn't
+void JITSetccMem(uint8_t *& p, int cc, int base, int32_t disp)
+{
+	EmitREX(p, false, 0, base);
+	*p++ = 0x0F;
+	*p++ = 0x90 + cc;
+	EmitMem(p, 0, base, disp);
+}
+
+
+//
+// Forward jumps: these return where the displacement goes, so it can be filled
+// in with JITPatch() once we know where we're going.
+//
+uint8_t * JITJcc(uint8_t *& p, int cc)
+{
+	*p++ = 0x0F;
+	*p++ = 0x80 + cc;
+	uint8_t * jump = p;
+	Emit32(p, 0);
+
+	return jump;
+}
+
+
+uint8_t * JITJmp(uint8_t *& p)
+{
+	*p++ = 0xE9;
+	uint8_t * jump = p;
+	Emit32(p, 0);
+
+	return jump;
+}
+
+
+void JITPatch(uint8_t * jump, uint8_t * target)
+{
+	int32_t disp = (int32_t)(target - (jump + 4));
+	memcpy(jump, &disp, 4);
+}
+
+#endif	// JIT_X86_64
@@ -0,0 +1,88 @@
+//
+// jit.h: Bits & pieces for the RISC recompilers
+//
+// The GPU (and DSP) can translate the code they run out of local RAM into host
+// code. This is the part that doesn't care which RISC it's working for: a
+// chunk of executable memory, and just enough of an x86-64 assembler to put
+// code into it. Operands are 32 bits wide unless the name says otherwise, and
+// memory operands are always [base + disp].
+//
+// On anything that isn't an x86-64 host, JIT_X86_64 isn't defined and the
+// recompilers turn themselves off; the interpreters are always there.
+//
+
+#ifndef __JIT_H__
+#define __JIT_H__
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JIT_X86_64
+#endif
+
+uint8_t * JITAlloc(uint32_t size);
+void JITFree(uint8_t * mem, uint32_t size);
+
+#ifdef JIT_X86_64
+
+enum { RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+// Where the first integer argument goes
+#ifdef _WIN32
+#define JIT_ARG0			RCX
+#else
+#define JIT_ARG0			RDI
+#endif
+
+// Condition codes, for Jcc & SETcc
+enum { CC_O = 0, CC_NO, CC_C, CC_NC, CC_Z, CC_NZ, CC_BE, CC_A, CC_S, CC_NS,
+	CC_P, CC_NP, CC_L, CC_GE, CC_LE, CC_G };
+
+// ALU ops & shifts, by their /digit in the 0x81 & 0xC1 groups
+enum { ALU_ADD = 0, ALU_OR = 1, ALU_AND = 4, ALU_SUB = 5, ALU_XOR = 6, ALU_CMP = 7 };
+enum { SHIFT_ROR = 1, SHIFT_SHL = 4, SHIFT_SHR = 5, SHIFT_SAR = 7 };
+
+void JITPush(uint8_t *& p, int reg);
+void JITPop(uint8_t *& p, int reg);
+void JITRet(uint8_t *& p);
+void JITAdjustStack(uint8_t *& p, int8_t amount);
+void JITCall(uint8_t *& p, void * target);
+
+void JITMovRegImm(uint8_t *& p, int reg, uint32_t imm);
+void JITMovRegImm64(uint8_t *& p, int reg, uint64_t imm);
+void JITMovRegReg(uint8_t *& p, int dst, int src);
+void JITLoad(uint8_t *& p, int reg, int base, int32_t disp);
+void JITLoad64(uint8_t *& p, int reg, int base, int32_t disp);
+void JITStore(uint8_t *& p, int base, int32_t disp, int reg);
+void JITStoreImm(uint8_t *& p, int base, int32_t disp, uint32_t imm);
+void JITStore64(uint8_t *& p, int base, int32_t disp, int reg);
+void JITLoadS16(uint8_t *& p, int reg, int base, int32_t disp);
+void JITLoadU16(uint8_t *& p, int reg, int base, int32_t disp);
+
+void JITAluRegMem(uint8_t *& p, int op, int reg, int base, int32_t disp);
+void JITAluMemReg(uint8_t *& p, int op, int base, int32_t disp, int reg);
+void JITAluMemImm(uint8_t *& p, int op, int base, int32_t disp, uint32_t imm);
+void JITAluMemImm8(uint8_t *& p, int op, int base, int32_t disp, uint8_t imm);
+void JITAluMemReg64(uint8_t *& p, int op, int base, int32_t disp, int reg);
+void JITAluRegReg(uint8_t *& p, int op, int dst, int src);
+void JITAluRegImm(uint8_t *& p, int op, int reg, uint32_t imm);
+void JITNotReg(uint8_t *& p, int reg);
+void JITNegMem(uint8_t *& p, int base, int32_t disp);
+void JITImulRegReg(uint8_t *& p, int dst, int src);
+void JITSignExtend64(uint8_t *& p, int reg);
+void JITBswap(uint8_t *& p, int reg);
+void JITCmov(uint8_t *& p, int cc, int dst, int src);
+void JITShiftRegImm(uint8_t *& p, int op, int reg, uint8_t count);
+void JITShiftReg64Imm(uint8_t *& p, int op, int reg, uint8_t count);
+void JITTestRegReg(uint8_t *& p, int reg1, int reg2);
+void JITTestMemImm(uint8_t *& p, int base, int32_t disp, uint32_t imm);
+void JITBtRegImm(uint8_t *& p, int reg, uint8_t bit);
+void JITSetccMem(uint8_t *& p, int cc, int base, int32_t disp);
+
+uint8_t * JITJcc(uint8_t *& p, int cc);
+uint8_t * JITJmp(uint8_t *& p);
+void JITPatch(uint8_t * jump, uint8_t * target);
+
+#endif	// JIT_X86_64
+
+#endif	// __JIT_H__
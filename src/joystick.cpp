@@ -22,30 +22,30 @@
 
 // Global vars
 
-static uint8_t joystick_ram[4];
-uint8_t joypad0Buttons[21];
-uint8_t joypad1Buttons[21];
-bool audioEnabled = false;
-bool joysticksEnabled = false;
-
-
-bool GUIKeyHeld = false;
-extern int start_logging;
-int gpu_start_log = 0;
-int op_start_log = 0;
-int blit_start_log = 0;
-int effect_start = 0;
-int effect_start2 = 0, effect_start3 = 0, effect_start4 = 0, effect_start5 = 0, effect_start6 = 0;
-bool interactiveMode = false;
-bool iLeft, iRight, iToggle = false;
-bool keyHeld1 = false, keyHeld2 = false, keyHeld3 = false;
-int objectPtr = 0;
-bool startMemLog = false;
+static PER_MACHINE uint8_t joystick_ram[4];
+PER_MACHINE uint8_t joypad0Buttons[21];
+PER_MACHINE uint8_t joypad1Buttons[21];
+PER_MACHINE bool audioEnabled = false;
+PER_MACHINE bool joysticksEnabled = false;
+
+
+PER_MACHINE bool GUIKeyHeld = false;
+extern PER_MACHINE int start_logging;
+PER_MACHINE int gpu_start_log = 0;
+PER_MACHINE int op_start_log = 0;
+PER_MACHINE int blit_start_log = 0;
+PER_MACHINE int effect_start = 0;
+PER_MACHINE int effect_start2 = 0, effect_start3 = 0, effect_start4 = 0, effect_start5 = 0, effect_start6 = 0;
+PER_MACHINE bool interactiveMode = false;
+PER_MACHINE bool iLeft, iRight, iToggle = false;
+PER_MACHINE bool keyHeld1 = false, keyHeld2 = false, keyHeld3 = false;
+PER_MACHINE int objectPtr = 0;
+PER_MACHINE bool startMemLog = false;
 extern bool doDSPDis, doGPUDis;
 
-bool blitterSingleStep = false;
-bool bssGo = false;
-bool bssHeld = false;
+PER_MACHINE bool blitterSingleStep = false;
+PER_MACHINE bool bssGo = false;
+PER_MACHINE bool bssHeld = false;
 
 
 void JoystickInit(void)
@@ -6,6 +6,7 @@
 #define __JOYSTICK_H__
 
 #include <stdint.h>
+#include "machine.h"
 
 enum { BUTTON_FIRST = 0, BUTTON_U = 0,
 BUTTON_D = 1,
@@ -40,10 +41,10 @@ void JoystickWriteWord(uint32_t, uint16_t);
 uint16_t JoystickReadWord(uint32_t);
 void JoystickExec(void);
 
-extern uint8_t joypad0Buttons[];
-extern uint8_t joypad1Buttons[];
-extern bool audioEnabled;
-extern bool joysticksEnabled;
+extern PER_MACHINE uint8_t joypad0Buttons[];
+extern PER_MACHINE uint8_t joypad1Buttons[];
+extern PER_MACHINE bool audioEnabled;
+extern PER_MACHINE bool joysticksEnabled;
 
 #endif	// __JOYSTICK_H__
 
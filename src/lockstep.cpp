@@ -0,0 +1,207 @@
+//
+// lockstep.cpp: Running two implementations of the same thing side by side
+//
+// See lockstep.h. This is only ever on when somebody's asked for it, so it
+// goes for simple over fast: one hash map entry per byte written.
+//
+
+#include "lockstep.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "log.h"
+#include "mmu.h"
+
+struct LockstepByte
+{
+	uint8_t original;							// What was there before the run
+	uint8_t written;							// The last thing written to it
+	uint8_t final;								// What was there after the run
+	bool memory;								// Plain memory (i.e., we can read it back)
+};
+
+typedef std::unordered_map<uint32_t, LockstepByte> LockstepJournal;
+
+struct LockstepDifference
+{
+	uint32_t address;
+	int value[2];								// -1 if it wasn't written at all
+};
+
+static PER_MACHINE LockstepJournal * journal[2];
+static PER_MACHINE int run = -1;				// Which run we're recording, if any
+static PER_MACHINE std::vector<LockstepDifference> * differences;
+
+
+//
+// Anything in here reads back what was written to it & nothing else happens
+// when it's read or written, so we can look at it & put it back
+//
+static bool IsPlainMemory(uint32_t address)
+{
+	return (address < 0x200000)									// Main RAM
+		|| (address >= 0xF00400 && address <= 0xF01FFF)			// CLUT & line buffers
+		|| (address >= 0xF03000 && address <= 0xF03FFF)			// GPU RAM
+		|| (address >= 0xF1B000 && address <= 0xF1CFFF);		// DSP RAM
+}
+
+
+static bool ByAddress(const LockstepDifference & a, const LockstepDifference & b)
+{
+	return a.address < b.address;
+}
+
+
+void LockstepStart(void)
+{
+	for(int i=0; i<2; i++)
+	{
+		if (journal[i] == NULL)
+			journal[i] = new LockstepJournal;
+
+		journal[i]->clear();
+	}
+
+	if (differences == NULL)
+		differences = new std::vector<LockstepDifference>;
+
+	differences->clear();
+
+	run = 0;
+	MMUHookBus(true);
+}
+
+
+//
+// Note what the first run left behind, then put memory back the way it was
+// for the second one
+//
+void LockstepRewind(void)
+{
+	MMUHookBus(false);
+
+	for(LockstepJournal::iterator i=journal[0]->begin(); i!=journal[0]->end(); i++)
+	{
+		if (!i->second.memory)
+			continue;
+
+		i->second.final = MMURead8(i->first);
+		MMUWrite8(i->first, i->second.original);
+	}
+
+	run = 1;
+	MMUHookBus(true);
+}
+
+
+void LockstepWrite(uint32_t address, uint8_t data, uint32_t who)
+{
+	if (run < 0)
+		return;
+
+	// Main RAM is mirrored all the way up to $7FFFFF on the bus
+	if (address < 0x800000)
+		address &= 0x1FFFFF;
+
+	LockstepJournal::iterator i = journal[run]->find(address);
+
+	if (i == journal[run]->end())
+	{
+		LockstepByte byte;
+		byte.memory = IsPlainMemory(address);
+		byte.original = (byte.memory ? MMURead8(address, who) : 0);
+		i = journal[run]->insert(std::make_pair(address, byte)).first;
+	}
+
+	i->second.written = data;
+}
+
+
+//
+// Stop recording & compare the two runs, skipping anything in the ignore range
+// (i.e., things the caller checks itself). Returns how many bytes came out
+// different.
+//
+uint32_t LockstepFinish(uint32_t ignoreStart/*= 1*/, uint32_t ignoreEnd/*= 0*/)
+{
+	MMUHookBus(false);
+	run = -1;
+
+	// Anything just one of them touched is compared against what the other
+	// one left there (or against nothing at all, if it's I/O)
+	for(int r=0; r<2; r++)
+	{
+		for(LockstepJournal::iterator i=journal[r]->begin(); i!=journal[r]->end(); i++)
+		{
+			uint32_t address = i->first;
+
+			if (address >= ignoreStart && address <= ignoreEnd)
+				continue;
+
+			LockstepJournal::iterator other = journal[r ^ 1]->find(address);
+			bool both = (other != journal[r ^ 1]->end());
+
+			if (both && r == 1)					// Already did this one
+				continue;
+
+			LockstepDifference d;
+			d.address = address;
+
+			if (i->second.memory)
+			{
+				uint8_t now = MMURead8(address);
+
+				if (r == 0)
+					d.value[0] = i->second.final, d.value[1] = now;
+				else
+					d.value[0] = i->second.original, d.value[1] = now;
+			}
+			else
+			{
+				d.value[r] = i->second.written;
+				d.value[r ^ 1] = (both ? other->second.written : -1);
+			}
+
+			if (d.value[0] != d.value[1])
+				differences->push_back(d);
+		}
+	}
+
+	std::sort(differences->begin(), differences->end(), ByAddress);
+
+	return (uint32_t)differences->size();
+}
+
+
+//
+// Log (the first few of) what LockstepFinish() found
+//
+void LockstepLogDifferences(const char * first, const char * second)
+{
+	if (differences == NULL || differences->empty())
+		return;
+
+	WriteLog("    %u byte(s) differ on the bus (%s vs. %s):\n", (uint32_t)differences->size(), first, second);
+
+	for(size_t i=0; i<differences->size() && i<16; i++)
+	{
+		const LockstepDifference & d = (*differences)[i];
+		char value[2][16];
+
+		for(int r=0; r<2; r++)
+		{
+			if (d.value[r] < 0)
+				sprintf(value[r], "--");
+			else
+				sprintf(value[r], "%02X", d.value[r]);
+		}
+
+		WriteLog("    %06X: %s vs. %s%s\n", d.address, value[0], value[1],
+			(IsPlainMemory(d.address) ? "" : " (last written)"));
+	}
+
+	if (differences->size() > 16)
+		WriteLog("    ...\n");
+}
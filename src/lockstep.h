@@ -0,0 +1,29 @@
+//
+// lockstep.h: Running two implementations of the same thing side by side
+//
+// We've got two of a few things (the pipelined & non-pipelined DSP cores, the
+// original & Midsummer blitters), and this is how we find out where they part
+// ways. Whoever's doing the comparing runs the first one, rewinds, runs the
+// second one from the same place, and asks what came out different; while it's
+// going, every write on the GPU/DSP/blitter bus is recorded a byte at a time.
+//
+// Anything that's just memory (main RAM, the CLUT & line buffers, GPU & DSP
+// RAM) gets put back by the rewind & is compared by what it ends up holding.
+// Anything else is I/O: it can't be put back, so the second run writes it all
+// over again, and it's compared by what got written to it last.
+//
+
+#ifndef __LOCKSTEP_H__
+#define __LOCKSTEP_H__
+
+#include <stdint.h>
+
+void LockstepStart(void);
+void LockstepRewind(void);
+uint32_t LockstepFinish(uint32_t ignoreStart = 1, uint32_t ignoreEnd = 0);
+void LockstepLogDifferences(const char * first, const char * second);
+
+// Called by the MMU for every byte written on the bus while we're recording
+void LockstepWrite(uint32_t address, uint8_t data, uint32_t who);
+
+#endif	// __LOCKSTEP_H__
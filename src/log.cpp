@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <stdint.h>
+#include <mutex>
 
 
 //#define MAX_LOG_SIZE		10000000				// Maximum size of log file (10 MB)
@@ -28,6 +29,7 @@
 
 static FILE * log_stream = NULL;
 static uint32_t logSize = 0;
+static std::mutex logMutex;						// Everybody's log (see machine.h)
 
 static FILE * fake_skunk_console = NULL;
 
@@ -71,6 +73,7 @@ void FakeSkunkLogByte(const unsigned char c)
 //
 void WriteLog(const char * text, ...)
 {
+	std::lock_guard<std::mutex> lock(logMutex);
 	va_list arg;
 	va_start(arg, text);
 
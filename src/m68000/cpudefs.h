@@ -56,7 +56,7 @@ struct regstruct
 	uint32_t interruptCycles;
 };
 
-extern struct regstruct regs, lastint_regs;
+extern PER_MACHINE struct regstruct regs, lastint_regs;
 
 #define m68k_dreg(r, num) ((r).regs[(num)])
 #define m68k_areg(r, num) (((r).regs + 8)[(num)])
@@ -11,15 +11,15 @@
 #include "inlines.h"
 
 
-uint16_t last_op_for_exception_3;		// Opcode of faulting instruction
-uint32_t last_addr_for_exception_3;		// PC at fault time
-uint32_t last_fault_for_exception_3;	// Address that generated the exception
+PER_MACHINE uint16_t last_op_for_exception_3;	// Opcode of faulting instruction
+PER_MACHINE uint32_t last_addr_for_exception_3;	// PC at fault time
+PER_MACHINE uint32_t last_fault_for_exception_3;	// Address that generated the exception
 
-int OpcodeFamily;						// Used by cpuemu.c...
-int BusCyclePenalty = 0;				// Used by cpuemu.c...
-int CurrentInstrCycles;
+PER_MACHINE int OpcodeFamily;			// Used by cpuemu.c...
+PER_MACHINE int BusCyclePenalty = 0;	// Used by cpuemu.c...
+PER_MACHINE int CurrentInstrCycles;
 
-struct regstruct regs;
+PER_MACHINE struct regstruct regs;
 
 
 //
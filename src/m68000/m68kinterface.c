@@ -13,6 +13,7 @@
 
 #include "m68kinterface.h"
 //#include <pthread.h>
+#include <string.h>
 #include "cpudefs.h"
 #include "inlines.h"
 #include "cpuextra.h"
@@ -55,16 +56,41 @@ STATIC_INLINE void m68ki_stack_frame_3word(uint32_t pc, uint32_t sr);
 unsigned long IllegalOpcode(uint32_t opcode);
 void BuildCPUFunctionTable(void);
 void m68k_set_irq2(unsigned int intLevel);
+void WriteLog(const char * text, ...);
 
 // Local "Global" vars
-static int32_t initialCycles;
+static PER_MACHINE int32_t initialCycles;
 cpuop_func * cpuFunctionTable[65536];
 
 // By virtue of the fact that m68k_set_irq() can be called asychronously by
 // another thread, we need something along the lines of this:
-static int checkForIRQToHandle = 0;
+static PER_MACHINE int checkForIRQToHandle = 0;
 //static pthread_mutex_t executionLock = PTHREAD_MUTEX_INITIALIZER;
-static int IRQLevelToHandle = 0;
+static PER_MACHINE int IRQLevelToHandle = 0;
+PER_MACHINE int m68kSideEffect = 0;
+
+#ifdef M68K_HOOK_FUNCTION
+PER_MACHINE int m68kHookArmed = 0;
+PER_MACHINE unsigned int m68kPCRing[M68K_PC_RING_SIZE];
+PER_MACHINE unsigned int m68kPCRingPtr = 0;
+#endif
+
+#ifdef M68K_IDLE_LOOP_DETECTION
+// A lot of software parks the 68K in a tight loop, polling VC or a flag in RAM
+// that an interrupt handler or one of the RISCs will set. If we come back
+// around to the top of a short loop with the exact same registers and nothing
+// was written in between, the next pass will be exactly the same as the last
+// one--and nothing else touches memory until our timeslice is over. So there's
+// no point in running the rest of the timeslice.
+#define IDLE_LOOP_MAX_SIZE		32			// In bytes
+#define IDLE_LOOP_REPORTS		16
+
+static PER_MACHINE uint32_t idleLoopHead;
+static PER_MACHINE uint32_t idleLoopRegs[16];
+static PER_MACHINE uint16_t idleLoopSR;
+static PER_MACHINE uint32_t idleLoopReported[IDLE_LOOP_REPORTS];
+static PER_MACHINE uint32_t numIdleLoopsReported = 0;
+#endif
 
 #if 0
 #define ADD_CYCLES(A)    m68ki_remaining_cycles += (A)
@@ -200,6 +226,9 @@ void m68k_pulse_reset(void)
 	m68ki_jump(REG_PC);
 #else
 	checkForIRQToHandle = 0;
+#ifdef M68K_IDLE_LOOP_DETECTION
+	numIdleLoopsReported = 0;
+#endif
 	regs.spcflags = 0;
 	regs.stopped = 0;
 	regs.remainingCycles = 0;
@@ -215,6 +244,45 @@ void m68k_pulse_reset(void)
 }
 
 
+#ifdef M68K_IDLE_LOOP_DETECTION
+//
+// Called when the 68K has just jumped back to the top of a short loop. Returns
+// true if it's been here before in this timeslice with the same registers and
+// without touching anything in between.
+//
+STATIC_INLINE int CheckIdleLoop(void)
+{
+	uint32_t i;
+
+	MakeSR();
+
+	if ((regs.pc == idleLoopHead) && !m68kSideEffect && (regs.sr == idleLoopSR)
+		&& (memcmp(regs.regs, idleLoopRegs, sizeof(idleLoopRegs)) == 0))
+	{
+		for(i=0; i<numIdleLoopsReported; i++)
+		{
+			if (idleLoopReported[i] == regs.pc)
+				return 1;
+		}
+
+		WriteLog("M68K: Idle loop detected at $%06X\n", regs.pc);
+
+		if (numIdleLoopsReported < IDLE_LOOP_REPORTS)
+			idleLoopReported[numIdleLoopsReported++] = regs.pc;
+
+		return 1;
+	}
+
+	idleLoopHead = regs.pc;
+	idleLoopSR = regs.sr;
+	memcpy(idleLoopRegs, regs.regs, sizeof(idleLoopRegs));
+	m68kSideEffect = 0;
+
+	return 0;
+}
+#endif
+
+
 int m68k_execute(int num_cycles)
 {
 	if (regs.stopped)
@@ -239,6 +307,11 @@ int m68k_execute(int num_cycles)
 #else
 	regs.remainingCycles = num_cycles;
 	/*int32_t*/ initialCycles = num_cycles;
+
+#ifdef M68K_IDLE_LOOP_DETECTION
+	// Anything could have changed since last time, so start over
+	idleLoopHead = 0xFFFFFFFF;
+#endif
 	
 	regs.remainingCycles -= regs.interruptCycles;
 	regs.interruptCycles = 0;
@@ -339,7 +412,13 @@ if (inRoutine)
 		}
 
 #ifdef M68K_HOOK_FUNCTION
-		M68KInstructionHook();
+		m68kPCRing[m68kPCRingPtr++ & M68K_PC_RING_MASK] = regs.pc;
+
+		if (m68kHookArmed || (regs.pc & 0x01))
+			M68KInstructionHook();
+#endif
+#ifdef M68K_IDLE_LOOP_DETECTION
+		uint32_t oldPC = regs.pc;
 #endif
 		uint32_t opcode = get_iword(0);
 //if ((opcode & 0xFFF8) == 0x31C0)
@@ -348,6 +427,13 @@ if (inRoutine)
 //}
 		int32_t cycles = (int32_t)(*cpuFunctionTable[opcode])(opcode);
 		regs.remainingCycles -= cycles;
+
+#ifdef M68K_IDLE_LOOP_DETECTION
+		// Only short backward jumps are candidates
+		if ((regs.pc <= oldPC) && ((oldPC - regs.pc) <= IDLE_LOOP_MAX_SIZE)
+			&& CheckIdleLoop())
+			regs.remainingCycles = 0;
+#endif
 //		pthread_mutex_unlock(&executionLock);
 
 //printf("Executed opcode $%04X (%i cycles)...\n", opcode, cycles);
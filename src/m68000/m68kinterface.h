@@ -11,6 +11,8 @@
 #ifndef __M68KINTERFACE_H__
 #define __M68KINTERFACE_H__
 
+#include "../machine.h"								// For PER_MACHINE
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -95,8 +97,23 @@ int irq_ack_handler(int);
 #define M68K_HOOK_FUNCTION
 #ifdef M68K_HOOK_FUNCTION
 void M68KInstructionHook(void);
+
+// The hook is only called while m68kHookArmed is set (or if the PC goes odd,
+// for the post-mortem). The rest of the time, all we keep are the last
+// M68K_PC_RING_SIZE PCs, for backtraces.
+#define M68K_PC_RING_SIZE	0x400				// Must be a power of 2
+#define M68K_PC_RING_MASK	(M68K_PC_RING_SIZE - 1)
+extern PER_MACHINE int m68kHookArmed;
+extern PER_MACHINE unsigned int m68kPCRing[M68K_PC_RING_SIZE];
+extern PER_MACHINE unsigned int m68kPCRingPtr;	// # of PCs recorded so far
 #endif
 
+// Comment this out to turn off idle loop detection in m68k_execute()
+// NB: The user's memory handlers MUST set m68kSideEffect on every write, as
+//     well as on reads that change the state of the thing being read!
+#define M68K_IDLE_LOOP_DETECTION
+extern PER_MACHINE int m68kSideEffect;
+
 // Functions to allow debugging
 void M68KDebugHalt(void);
 void M68KDebugResume(void);
@@ -34,6 +34,9 @@
 #include <stdarg.h>
 #include <stdint.h>
 
+/* The CPU's state is per machine; see ../machine.h */
+#include "../machine.h"
+
 
 #if EEXIST == ENOTEMPTY
 #define BROKEN_OS_PROBABLY_AIX
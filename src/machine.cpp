@@ -0,0 +1,157 @@
+//
+// machine.cpp - Running more than one Jaguar in the same process
+//
+// See machine.h for the big picture. A JaguarMachine is just a host thread
+// with a command queue in front of it; the thread brings its Jaguar up when it
+// starts, and takes it down again when it's told to quit.
+//
+
+#include "machine.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "event.h"
+#include "jaguar.h"
+#include "log.h"
+#include "memory.h"
+#include "settings.h"
+
+struct JaguarMachine
+{
+	std::thread * thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<std::function<void(void)> > commands;
+	bool quit;
+	VJSettings settings;						// What the machine starts up with
+};
+
+// The lookup tables (and the 68K's opcode table) are shared, and get filled in
+// by whichever machine comes up first, so machines take turns coming up
+static std::mutex initMutex;
+static std::atomic<int> numberOfMachines(0);
+
+
+static void MachineThread(JaguarMachine * machine)
+{
+	vjs = machine->settings;
+
+	{
+		std::lock_guard<std::mutex> lock(initMutex);
+		JaguarInit();
+	}
+
+	std::unique_lock<std::mutex> lock(machine->mutex);
+
+	while (true)
+	{
+		while (machine->commands.empty() && !machine->quit)
+			machine->condition.wait(lock);
+
+		// Anything still in the queue gets run before we quit
+		if (machine->commands.empty())
+			break;
+
+		std::function<void(void)> command = machine->commands.front();
+		machine->commands.pop_front();
+		lock.unlock();
+		command();
+		lock.lock();
+	}
+
+	lock.unlock();
+	JaguarDone();
+	FreeEventList();
+	MemoryDone();
+}
+
+
+//
+// Start up a new Jaguar on its own thread. It gets a copy of the caller's
+// settings (vjs), so set those up first.
+//
+JaguarMachine * JaguarMachineCreate(void)
+{
+#ifndef JAGUAR_MULTI_INSTANCE
+	// Without thread local state, they'd all be the same machine...
+	if (numberOfMachines.fetch_add(1) > 0)
+	{
+		numberOfMachines--;
+		WriteLog("MACHINE: Can't run more than one Jaguar at a time! (Build with JAGUAR_MULTI_INSTANCE for that)\n");
+		return NULL;
+	}
+#else
+	numberOfMachines++;
+#endif
+
+	JaguarMachine * machine = new JaguarMachine;
+	machine->quit = false;
+	machine->settings = vjs;
+	machine->thread = new std::thread(MachineThread, machine);
+
+	return machine;
+}
+
+
+//
+// Run whatever is left in the machine's queue, then shut it down
+//
+void JaguarMachineDestroy(JaguarMachine * machine)
+{
+	if (machine == NULL)
+		return;
+
+	machine->mutex.lock();
+	machine->quit = true;
+	machine->condition.notify_one();
+	machine->mutex.unlock();
+
+	machine->thread->join();
+	delete machine->thread;
+	delete machine;
+	numberOfMachines--;
+}
+
+
+//
+// Queue up a command to be run on the machine's thread, and return right away
+//
+void JaguarMachinePost(JaguarMachine * machine, std::function<void(void)> command)
+{
+	std::lock_guard<std::mutex> lock(machine->mutex);
+	machine->commands.push_back(command);
+	machine->condition.notify_one();
+}
+
+
+//
+// Run a command on the machine's thread, and wait for it to finish
+//
+void JaguarMachineCall(JaguarMachine * machine, std::function<void(void)> command)
+{
+	if (std::this_thread::get_id() == machine->thread->get_id())
+	{
+		command();
+		return;
+	}
+
+	std::mutex doneMutex;
+	std::condition_variable doneCondition;
+	bool done = false;
+
+	JaguarMachinePost(machine, [&]()
+	{
+		command();
+		std::lock_guard<std::mutex> lock(doneMutex);
+		done = true;
+		doneCondition.notify_one();
+	});
+
+	std::unique_lock<std::mutex> lock(doneMutex);
+
+	while (!done)
+		doneCondition.wait(lock);
+}
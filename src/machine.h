@@ -0,0 +1,46 @@
+//
+// machine.h: Running more than one Jaguar in the same process
+//
+// Normally there's exactly one Jaguar per process, and its state lives in
+// plain old globals. If you build with -DJAGUAR_MULTI_INSTANCE (i.e., put it in
+// CPPFLAGS), everything marked PER_MACHINE becomes thread local instead. Each
+// JaguarMachine owns a host thread, and that thread *is* the machine: anything
+// run on it sees that machine's RAM, CPUs, custom chips, event list & settings,
+// and nobody else's. The emulation code itself doesn't change at all, and the
+// normal build doesn't pay a thing for it.
+//
+// N.B.: In a multi-instance build, *everything* that touches the core has to
+//       go through JaguarMachineCall() or JaguarMachinePost(). The GUI doesn't
+//       do that (yet), and the GPU helper thread can't see its machine's state,
+//       so this is for headless builds (regression & soak test farms) only.
+//       Lookup tables and anything that only ever gets filled in once (BIOS
+//       images, the 68K's opcode table, etc.) stay shared.
+//
+
+#ifndef __MACHINE_H__
+#define __MACHINE_H__
+
+#ifdef JAGUAR_MULTI_INSTANCE
+#ifdef _MSC_VER
+#define PER_MACHINE			__declspec(thread)
+#else
+// Not thread_local: __thread promises the compiler there's no dynamic init, so
+// accesses from other files don't have to go through a wrapper function
+#define PER_MACHINE			__thread
+#endif
+#else
+#define PER_MACHINE
+#endif
+
+#ifdef __cplusplus
+#include <functional>
+
+struct JaguarMachine;
+
+JaguarMachine * JaguarMachineCreate(void);
+void JaguarMachineDestroy(JaguarMachine * machine);
+void JaguarMachinePost(JaguarMachine * machine, std::function<void(void)> command);
+void JaguarMachineCall(JaguarMachine * machine, std::function<void(void)> command);
+#endif
+
+#endif	// __MACHINE_H__
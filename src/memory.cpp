@@ -29,13 +29,107 @@ N.B.: Jaguar RAM is only 2 megs. ROM is 6 megs max, IO is 128K
 
 #include "memory.h"
 
-uint8_t jagMemSpace[0xF20000];					// The entire memory space of the Jaguar...!
+#include <stdlib.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+//
+// Rather than one big array for the whole address space (most of which is
+// nothing), each region gets its own allocation straight from the OS. Pages
+// that are never touched (like most of the 6M ROM window for a 1M cart) never
+// take up any real memory.
+//
+#define MAIN_RAM_SIZE		0x200000
+#define MAIN_ROM_SIZE		0x600000
+#define BIOS_SIZE			0x040000
+
+static uint8_t * AllocRegion(uint32_t size)
+{
+#ifdef _WIN32
+	void * region = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+	void * region = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+
+	if (region == MAP_FAILED)
+		region = NULL;
+#endif
+
+	// Fall back to the heap if the OS won't play ball
+	if (region == NULL)
+		region = calloc(size, 1);
+
+	return (uint8_t *)region;
+}
+
+static void FreeRegion(uint8_t * region, uint32_t size)
+{
+	if (region == NULL)
+		return;
+
+#ifdef _WIN32
+	if (VirtualFree(region, 0, MEM_RELEASE))
+		return;
+#else
+	if (munmap(region, size) == 0)
+		return;
+#endif
+
+	free(region);
+}
+
+PER_MACHINE uint8_t * jaguarMainRAM;				// $000000-$1FFFFF
+PER_MACHINE uint8_t * jaguarMainROM;				// $800000-$DFFFFF
+PER_MACHINE uint8_t * jaguarBIOS;					// $E00000-$E3FFFF
+
+static const struct { uint32_t start, size; } region[3] = {
+	{ 0x000000, MAIN_RAM_SIZE },
+	{ 0x800000, MAIN_ROM_SIZE },
+	{ 0xE00000, BIOS_SIZE }
+};
+
+
+void MemoryInit(void)
+{
+	if (jaguarMainRAM == NULL)
+	{
+		jaguarMainRAM = AllocRegion(MAIN_RAM_SIZE);
+		jaguarMainROM = AllocRegion(MAIN_ROM_SIZE);
+		jaguarBIOS    = AllocRegion(BIOS_SIZE);
+	}
+}
+
+
+void MemoryDone(void)
+{
+	FreeRegion(jaguarMainRAM, MAIN_RAM_SIZE);
+	FreeRegion(jaguarMainROM, MAIN_ROM_SIZE);
+	FreeRegion(jaguarBIOS, BIOS_SIZE);
+	jaguarMainRAM = jaguarMainROM = jaguarBIOS = NULL;
+}
+
+
+//
+// Hand the pages of the ROM window back to the OS, so a new cart starts out
+// with a clean (zeroed) slate, and only takes up as much memory as it needs
+//
+void JagMemReleaseROM(void)
+{
+#ifdef _WIN32
+	if (VirtualFree(jaguarMainROM, MAIN_ROM_SIZE, MEM_DECOMMIT)
+		&& VirtualAlloc(jaguarMainROM, MAIN_ROM_SIZE, MEM_COMMIT, PAGE_READWRITE))
+		return;
+#else
+	if (mmap(jaguarMainROM, MAIN_ROM_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANON | MAP_FIXED, -1, 0) != MAP_FAILED)
+		return;
+#endif
+
+	memset(jaguarMainROM, 0, MAIN_ROM_SIZE);
+}
 
-uint8_t * jaguarMainRAM = &jagMemSpace[0x000000];
-uint8_t * jaguarMainROM = &jagMemSpace[0x800000];
-uint8_t * cdRAM         = &jagMemSpace[0xDFFF00];
-uint8_t * gpuRAM        = &jagMemSpace[0xF03000];
-uint8_t * dspRAM        = &jagMemSpace[0xF1B000];
 
 #if 0
 union Word
@@ -113,6 +207,9 @@ unsigned long ByteSwap1 (unsigned long nLongNumber)
 }
 #endif
 
+// These all pointed into the old flat memory array, which is gone now (the real
+// registers live in TOM, JERRY, etc.)
+#if 0
 //Not sure if this is a good approach yet...
 //should be if we use proper aliasing, and htonl and friends...
 #if 1
@@ -254,13 +351,66 @@ uint32_t & d_mod     = *((uint32_t *)&jagMemSpace[0xF1A118]);
 uint32_t & d_divctrl = *((uint32_t *)&jagMemSpace[0xF1A11C]);
 uint32_t d_remain;								// Dual register with $F0211C
 uint32_t & d_machi   = *((uint32_t *)&jagMemSpace[0xF1A120]);
-uint16_t & ltxd      = *((uint16_t *)&jagMemSpace[0xF1A148]);
-uint16_t lrxd;									// Dual register with $F1A148
-uint16_t & rtxd      = *((uint16_t *)&jagMemSpace[0xF1A14C]);
-uint16_t rrxd;									// Dual register with $F1A14C
-uint8_t  & sclk      = *((uint8_t *) &jagMemSpace[0xF1A150]);
-uint8_t sstat;									// Dual register with $F1A150
-uint32_t & smode     = *((uint32_t *)&jagMemSpace[0xF1A154]);
+#endif
+
+// The I2S registers are the only ones still living here
+PER_MACHINE uint16_t ltxd;						// $F1A148
+PER_MACHINE uint16_t lrxd;						// Dual register with $F1A148
+PER_MACHINE uint16_t rtxd;						// $F1A14C
+PER_MACHINE uint16_t rrxd;						// Dual register with $F1A14C
+PER_MACHINE uint8_t sclk;						// $F1A150
+PER_MACHINE uint8_t sstat;						// Dual register with $F1A150
+PER_MACHINE uint32_t smode;						// $F1A154
+
+
+//
+// Find the region (if any) behind a guest address
+//
+static uint8_t * FindRegion(uint32_t address, uint32_t & offset)
+{
+	uint8_t * mem[3] = { jaguarMainRAM, jaguarMainROM, jaguarBIOS };
+
+	for(int i=0; i<3; i++)
+	{
+		if ((address - region[i].start) < region[i].size)
+		{
+			offset = address - region[i].start;
+			return mem[i];
+		}
+	}
+
+	return NULL;
+}
+
+
+//
+// Copy a big endian buffer (ROM image, BIOS, etc.) into guest memory, and vice
+// versa, minding the layout of main RAM & the ROMs (see memory.h). Anything
+// that falls outside of RAM & the ROMs is dropped (or read as zero).
+//
+void JagMemCopyIn(uint32_t address, const uint8_t * src, uint32_t size)
+{
+	for(uint32_t i=0; i<size; i++)
+	{
+		uint32_t offset;
+		uint8_t * mem = FindRegion(address + i, offset);
+
+		if (mem)
+			JagMemWrite8(mem, offset, src[i]);
+	}
+}
+
+
+void JagMemCopyOut(uint8_t * dst, uint32_t address, uint32_t size)
+{
+	for(uint32_t i=0; i<size; i++)
+	{
+		uint32_t offset;
+		uint8_t * mem = FindRegion(address + i, offset);
+		dst[i] = (mem ? JagMemRead8(mem, offset) : 0);
+	}
+}
+
 
 // Memory debugging identifiers
 
@@ -8,14 +8,19 @@
 #define __MEMORY_H__
 
 #include <stdint.h>
+#include <string.h>
+#include "machine.h"
 
-extern uint8_t jagMemSpace[];
+extern PER_MACHINE uint8_t * jaguarMainRAM;
+extern PER_MACHINE uint8_t * jaguarMainROM;
+extern PER_MACHINE uint8_t * jaguarBIOS;
 
-extern uint8_t * jaguarMainRAM;
-extern uint8_t * jaguarMainROM;
-extern uint8_t * gpuRAM;
-extern uint8_t * dspRAM;
+void MemoryInit(void);
+void MemoryDone(void);
+void JagMemReleaseROM(void);
 
+// These pointed into the old flat memory array, which is gone now
+#if 0
 #if 1
 extern uint32_t & butch, & dscntrl;
 extern uint16_t & ds_data;
@@ -50,9 +55,11 @@ extern uint32_t & d_flags, & d_mtxc, & d_mtxa, & d_end, & d_pc, & d_ctrl,
 	& d_mod, & d_divctrl;
 extern uint32_t d_remain;
 extern uint32_t & d_machi;
-extern uint16_t & ltxd, lrxd, & rtxd, rrxd;
-extern uint8_t & sclk, sstat;
-extern uint32_t & smode;
+#endif
+
+extern PER_MACHINE uint16_t ltxd, lrxd, rtxd, rrxd;
+extern PER_MACHINE uint8_t sclk, sstat;
+extern PER_MACHINE uint32_t smode;
 /*
 uint16_t & ltxd      = *((uint16_t *)&jagMemSpace[0xF1A148]);
 uint16_t lrxd;									// Dual register with $F1A148
@@ -74,21 +81,162 @@ extern const char * whoName[10];
 //extern int biosAvailable;
 
 // Some handy macros to help converting native endian to big endian (jaguar native)
-// & vice versa
-
-#define SET64(r, a, v) 	r[(a)] = ((v) & 0xFF00000000000000) >> 56, r[(a)+1] = ((v) & 0x00FF000000000000) >> 48, \
-						r[(a)+2] = ((v) & 0x0000FF0000000000) >> 40, r[(a)+3] = ((v) & 0x000000FF00000000) >> 32, \
-						r[(a)+4] = ((v) & 0xFF000000) >> 24, r[(a)+5] = ((v) & 0x00FF0000) >> 16, \
-						r[(a)+6] = ((v) & 0x0000FF00) >> 8, r[(a)+7] = (v) & 0x000000FF
-#define GET64(r, a)		(((uint64_t)r[(a)] << 56) | ((uint64_t)r[(a)+1] << 48) | \
-						((uint64_t)r[(a)+2] << 40) | ((uint64_t)r[(a)+3] << 32) | \
-						((uint64_t)r[(a)+4] << 24) | ((uint64_t)r[(a)+5] << 16) | \
-						((uint64_t)r[(a)+6] << 8) | (uint64_t)r[(a)+7])
-#define SET32(r, a, v)	r[(a)] = ((v) & 0xFF000000) >> 24, r[(a)+1] = ((v) & 0x00FF0000) >> 16, \
-						r[(a)+2] = ((v) & 0x0000FF00) >> 8, r[(a)+3] = (v) & 0x000000FF
-#define GET32(r, a)		((r[(a)] << 24) | (r[(a)+1] << 16) | (r[(a)+2] << 8) | r[(a)+3])
-#define SET16(r, a, v)	r[(a)] = ((v) & 0xFF00) >> 8, r[(a)+1] = (v) & 0xFF
-#define GET16(r, a)		((r[(a)] << 8) | r[(a)+1])
+// & vice versa. These compile down to a load & a bswap (or just a load, on big
+// endian hosts).
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	#define BE16(x)		(x)
+	#define BE32(x)		(x)
+	#define BE64(x)		(x)
+#else
+	#define BE16(x)		__builtin_bswap16(x)
+	#define BE32(x)		__builtin_bswap32(x)
+	#define BE64(x)		__builtin_bswap64(x)
+	#define HOST_LITTLE_ENDIAN
+#endif
+
+static inline uint16_t GetBE16(const uint8_t * p) { uint16_t v; memcpy(&v, p, 2); return BE16(v); }
+static inline uint32_t GetBE32(const uint8_t * p) { uint32_t v; memcpy(&v, p, 4); return BE32(v); }
+static inline uint64_t GetBE64(const uint8_t * p) { uint64_t v; memcpy(&v, p, 8); return BE64(v); }
+static inline void SetBE16(uint8_t * p, uint16_t v) { v = BE16(v); memcpy(p, &v, 2); }
+static inline void SetBE32(uint8_t * p, uint32_t v) { v = BE32(v); memcpy(p, &v, 4); }
+static inline void SetBE64(uint8_t * p, uint64_t v) { v = BE64(v); memcpy(p, &v, 8); }
+
+#define SET64(r, a, v)	SetBE64(&(r)[(a)], (v))
+#define GET64(r, a)		GetBE64(&(r)[(a)])
+#define SET32(r, a, v)	SetBE32(&(r)[(a)], (v))
+#define GET32(r, a)		GetBE32(&(r)[(a)])
+#define SET16(r, a, v)	SetBE16(&(r)[(a)], (v))
+#define GET16(r, a)		GetBE16(&(r)[(a)])
+
+//
+// Main RAM & the ROMs (jaguarMainRAM, etc.) are kept as host native
+// 16-bit words on little endian hosts, like most other 68K emulators do: word
+// accesses are plain loads, longs are a load & a rotate, and bytes are found by
+// flipping bit 0 of the address. Everything that touches them directly has to
+// go thru the JagMem* functions below (memcpy & friends will give you byte
+// swapped garbage). Comment this out to keep them big endian, like everything
+// else.
+//
+#ifdef HOST_LITTLE_ENDIAN
+	#define JAGMEM_NATIVE_WORDS
+#endif
+
+#ifdef JAGMEM_NATIVE_WORDS
+	#define JAGMEM_BYTE(a)	((a) ^ 1)
+#else
+	#define JAGMEM_BYTE(a)	(a)
+#endif
+
+// N.B.: mem has to be an even address in one of the regions (jaguarMainRAM, etc.)
+static inline uint8_t JagMemRead8(const uint8_t * mem, uint32_t offset)
+{
+	return mem[JAGMEM_BYTE(offset)];
+}
+
+static inline void JagMemWrite8(uint8_t * mem, uint32_t offset, uint8_t data)
+{
+	mem[JAGMEM_BYTE(offset)] = data;
+}
+
+static inline uint16_t JagMemRead16(const uint8_t * mem, uint32_t offset)
+{
+#ifdef JAGMEM_NATIVE_WORDS
+	if (offset & 0x01)
+		return (mem[offset ^ 1] << 8) | mem[(offset + 1) ^ 1];
+
+	uint16_t v;
+	memcpy(&v, mem + offset, 2);
+	return v;
+#else
+	return GetBE16(mem + offset);
+#endif
+}
+
+static inline void JagMemWrite16(uint8_t * mem, uint32_t offset, uint16_t data)
+{
+#ifdef JAGMEM_NATIVE_WORDS
+	if (offset & 0x01)
+	{
+		mem[offset ^ 1] = data >> 8;
+		mem[(offset + 1) ^ 1] = data & 0xFF;
+		return;
+	}
+
+	memcpy(mem + offset, &data, 2);
+#else
+	SetBE16(mem + offset, data);
+#endif
+}
+
+static inline uint32_t JagMemRead32(const uint8_t * mem, uint32_t offset)
+{
+#ifdef JAGMEM_NATIVE_WORDS
+	if (offset & 0x01)
+		return ((uint32_t)JagMemRead16(mem, offset) << 16) | JagMemRead16(mem, offset + 2);
+
+	uint32_t v;
+	memcpy(&v, mem + offset, 4);
+	return (v << 16) | (v >> 16);
+#else
+	return GetBE32(mem + offset);
+#endif
+}
+
+static inline void JagMemWrite32(uint8_t * mem, uint32_t offset, uint32_t data)
+{
+#ifdef JAGMEM_NATIVE_WORDS
+	if (offset & 0x01)
+	{
+		JagMemWrite16(mem, offset, data >> 16);
+		JagMemWrite16(mem, offset + 2, data & 0xFFFF);
+		return;
+	}
+
+	data = (data << 16) | (data >> 16);
+	memcpy(mem + offset, &data, 4);
+#else
+	SetBE32(mem + offset, data);
+#endif
+}
+
+static inline uint64_t JagMemRead64(const uint8_t * mem, uint32_t offset)
+{
+#ifdef JAGMEM_NATIVE_WORDS
+	if (offset & 0x01)
+		return ((uint64_t)JagMemRead32(mem, offset) << 32) | JagMemRead32(mem, offset + 4);
+
+	// Reverse the order of the words
+	uint64_t v;
+	memcpy(&v, mem + offset, 8);
+	v = (v << 32) | (v >> 32);
+	return ((v & 0x0000FFFF0000FFFFull) << 16) | ((v >> 16) & 0x0000FFFF0000FFFFull);
+#else
+	return GetBE64(mem + offset);
+#endif
+}
+
+static inline void JagMemWrite64(uint8_t * mem, uint32_t offset, uint64_t data)
+{
+#ifdef JAGMEM_NATIVE_WORDS
+	if (offset & 0x01)
+	{
+		JagMemWrite32(mem, offset, data >> 32);
+		JagMemWrite32(mem, offset + 4, data & 0xFFFFFFFF);
+		return;
+	}
+
+	data = (data << 32) | (data >> 32);
+	data = ((data & 0x0000FFFF0000FFFFull) << 16) | ((data >> 16) & 0x0000FFFF0000FFFFull);
+	memcpy(mem + offset, &data, 8);
+#else
+	SetBE64(mem + offset, data);
+#endif
+}
+
+// Block copies between (big endian) host buffers & guest memory
+void JagMemCopyIn(uint32_t address, const uint8_t * src, uint32_t size);
+void JagMemCopyOut(uint8_t * dst, uint32_t address, uint32_t size);
 
 //This doesn't seem to work on OSX. So have to figure something else out. :-(
 //byteswap.h doesn't exist on OSX.
@@ -35,11 +35,11 @@
 enum { MT_NONE, MT_PROD_ID, MT_RESET, MT_WRITE_ENABLE };
 enum { MT_IDLE, MT_PHASE1, MT_PHASE2 };
 
-uint8_t mtMem[0x20000];
-uint8_t mtCommand = MT_NONE;
-uint8_t mtState = MT_IDLE;
-bool haveMT = false;
-char mtFilename[MAX_PATH];
+PER_MACHINE uint8_t mtMem[0x20000];
+PER_MACHINE uint8_t mtCommand = MT_NONE;
+PER_MACHINE uint8_t mtState = MT_IDLE;
+PER_MACHINE bool haveMT = false;
+PER_MACHINE char mtFilename[MAX_PATH];
 
 // Private function prototypes
 void MTWriteFile(void);
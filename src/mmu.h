@@ -12,13 +12,160 @@
 //#include "types.h"
 #include "memory.h"
 
-void MMUWrite8(uint32_t address, uint8_t data, uint32_t who = UNKNOWN);
-void MMUWrite16(uint32_t address, uint16_t data, uint32_t who = UNKNOWN);
-void MMUWrite32(uint32_t address, uint32_t data, uint32_t who = UNKNOWN);
-void MMUWrite64(uint32_t address, uint64_t data, uint32_t who = UNKNOWN);
-uint8_t MMURead8(uint32_t address, uint32_t who = UNKNOWN);
-uint16_t MMURead16(uint32_t address, uint32_t who = UNKNOWN);
-uint32_t MMURead32(uint32_t address, uint32_t who = UNKNOWN);
-uint64_t MMURead64(uint32_t address, uint32_t who = UNKNOWN);
+// The 24-bit address space is cut into 64K pages. A page either points
+// straight at host memory (RAM & ROM, in the JagMem* layout; see memory.h), or
+// hands the access off to its I/O handlers. Reads & writes are split, so ROM can have a read pointer and a
+// write handler.
+
+#define MMU_PAGE_SHIFT		16
+#define MMU_PAGE_MASK		0xFFFF
+#define MMU_NUM_PAGES		0x100
+
+struct MMUPage
+{
+	uint8_t * readMem;							// Host memory for the page, or NULL
+	uint8_t * writeMem;							// "                          "
+	uint8_t (* read8)(uint32_t, uint32_t);
+	uint16_t (* read16)(uint32_t, uint32_t);
+	uint32_t (* read32)(uint32_t, uint32_t);
+	void (* write8)(uint32_t, uint8_t, uint32_t);
+	void (* write16)(uint32_t, uint16_t, uint32_t);
+};
+
+// The 68K doesn't see quite the same thing as the GPU, DSP & blitter do (main
+// RAM mirroring, Memory Track, GPU thread sync), so it gets its own map
+extern PER_MACHINE MMUPage mmuMap68K[MMU_NUM_PAGES];
+extern PER_MACHINE MMUPage mmuMapBus[MMU_NUM_PAGES];
+
+void MMUInit(void);
+void MMUHook68K(bool state);
+void MMUHookBus(bool state);
+
+// Fences keep everybody but the blitter out of the parts of main RAM that a
+// blit running on its own thread might be using (see BlitterQueue()). Anyone
+// who writes to start-end (or reads from it, if reads is set) calls wait()
+// first, and wait() has to call MMUUnfence(). start-end are bus addresses, in
+// main RAM or any of its mirrors.
+void MMUFence(uint32_t start, uint32_t end, bool reads, void (* wait)(void));
+void MMUUnfence(void);
+uint8_t * MMUBusMemory(uint32_t page, bool write);
+
+#define MMU_MAP(who)		((who) == M68K ? mmuMap68K : mmuMapBus)
+
+//
+// The fast paths are here, so they get inlined into the CPU memory handlers.
+// Accesses that straddle a page go the slow way, a piece at a time.
+//
+
+inline uint8_t MMURead8(uint32_t address, uint32_t who = UNKNOWN)
+{
+	address &= 0xFFFFFF;
+	const MMUPage & page = MMU_MAP(who)[address >> MMU_PAGE_SHIFT];
+
+	if (page.readMem)
+		return JagMemRead8(page.readMem, address & MMU_PAGE_MASK);
+
+	return page.read8(address, who);
+}
+
+inline uint16_t MMURead16(uint32_t address, uint32_t who = UNKNOWN)
+{
+	address &= 0xFFFFFF;
+	const MMUPage & page = MMU_MAP(who)[address >> MMU_PAGE_SHIFT];
+	uint32_t offset = address & MMU_PAGE_MASK;
+
+	if (page.readMem && offset < MMU_PAGE_MASK)
+		return JagMemRead16(page.readMem, offset);
+
+	if (page.readMem)
+		return (MMURead8(address, who) << 8) | MMURead8(address + 1, who);
+
+	return page.read16(address, who);
+}
+
+inline uint32_t MMURead32(uint32_t address, uint32_t who = UNKNOWN)
+{
+	address &= 0xFFFFFF;
+	const MMUPage & page = MMU_MAP(who)[address >> MMU_PAGE_SHIFT];
+	uint32_t offset = address & MMU_PAGE_MASK;
+
+	if (page.readMem && offset < (MMU_PAGE_MASK - 2))
+		return JagMemRead32(page.readMem, offset);
+
+	if (page.readMem)
+		return (MMURead16(address, who) << 16) | MMURead16(address + 2, who);
+
+	return page.read32(address, who);
+}
+
+inline uint64_t MMURead64(uint32_t address, uint32_t who = UNKNOWN)
+{
+	address &= 0xFFFFFF;
+	const MMUPage & page = MMU_MAP(who)[address >> MMU_PAGE_SHIFT];
+	uint32_t offset = address & MMU_PAGE_MASK;
+
+	if (page.readMem && offset < (MMU_PAGE_MASK - 6))
+		return JagMemRead64(page.readMem, offset);
+
+	return ((uint64_t)MMURead32(address, who) << 32) | MMURead32(address + 4, who);
+}
+
+inline void MMUWrite8(uint32_t address, uint8_t data, uint32_t who = UNKNOWN)
+{
+	address &= 0xFFFFFF;
+	const MMUPage & page = MMU_MAP(who)[address >> MMU_PAGE_SHIFT];
+
+	if (page.writeMem)
+		JagMemWrite8(page.writeMem, address & MMU_PAGE_MASK, data);
+	else
+		page.write8(address, data, who);
+}
+
+inline void MMUWrite16(uint32_t address, uint16_t data, uint32_t who = UNKNOWN)
+{
+	address &= 0xFFFFFF;
+	const MMUPage & page = MMU_MAP(who)[address >> MMU_PAGE_SHIFT];
+	uint32_t offset = address & MMU_PAGE_MASK;
+
+	if (page.writeMem && offset < MMU_PAGE_MASK)
+		JagMemWrite16(page.writeMem, offset, data);
+	else if (page.writeMem)
+	{
+		MMUWrite8(address + 0, data >> 8, who);
+		MMUWrite8(address + 1, data & 0xFF, who);
+	}
+	else
+		page.write16(address, data, who);
+}
+
+inline void MMUWrite32(uint32_t address, uint32_t data, uint32_t who = UNKNOWN)
+{
+	address &= 0xFFFFFF;
+	const MMUPage & page = MMU_MAP(who)[address >> MMU_PAGE_SHIFT];
+	uint32_t offset = address & MMU_PAGE_MASK;
+
+	if (page.writeMem && offset < (MMU_PAGE_MASK - 2))
+		JagMemWrite32(page.writeMem, offset, data);
+	else
+	{
+		MMUWrite16(address + 0, data >> 16, who);
+		MMUWrite16(address + 2, data & 0xFFFF, who);
+	}
+}
+
+inline void MMUWrite64(uint32_t address, uint64_t data, uint32_t who = UNKNOWN)
+{
+	address &= 0xFFFFFF;
+	const MMUPage & page = MMU_MAP(who)[address >> MMU_PAGE_SHIFT];
+	uint32_t offset = address & MMU_PAGE_MASK;
+
+	if (page.writeMem && offset < (MMU_PAGE_MASK - 6))
+		JagMemWrite64(page.writeMem, offset, data);
+	else
+	{
+		MMUWrite32(address + 0, data >> 32, who);
+		MMUWrite32(address + 4, data & 0xFFFFFFFF, who);
+	}
+}
 
 #endif	// __MMU_H__
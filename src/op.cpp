@@ -69,23 +69,29 @@ static uint8_t op_blend_cr[0x10000];
 // some of the regular TOM RAM...
 //#warning objectp_ram is separated from TOM RAM--need to fix that!
 //static uint8_t objectp_ram[0x40];			// This is based at $F00000
-uint8_t objectp_running = 0;
+PER_MACHINE uint8_t objectp_running = 0;
 //bool objectp_stop_reading_list;
 
 static uint8_t op_bitmap_bit_depth[8] = { 1, 2, 4, 8, 16, 24, 32, 0 };
 //static uint32_t op_bitmap_bit_size[8] =
 //	{ (uint32_t)(0.125*65536), (uint32_t)(0.25*65536), (uint32_t)(0.5*65536), (uint32_t)(1*65536),
 //	  (uint32_t)(2*65536),     (uint32_t)(1*65536),    (uint32_t)(1*65536),   (uint32_t)(1*65536) };
-static uint32_t op_pointer;
+static PER_MACHINE uint32_t op_pointer;
 
 int32_t phraseWidthToPixels[8] = { 64, 32, 16, 8, 4, 2, 0, 0 };
 
 
 //
-// Object Processor initialization
+// Fill in the blend tables. These are shared by every machine (see machine.h),
+// so only do this once.
 //
-void OPInit(void)
+static void OPFillBlendTables(void)
 {
+	static bool tablesFilled = false;
+
+	if (tablesFilled)
+		return;
+
 	// Here we calculate the saturating blend of a signed 4-bit value and an
 	// existing Cyan/Red value as well as a signed 8-bit value and an existing intensity...
 	// Note: CRY is 4 bits Cyan, 4 bits Red, 16 bits intensitY
@@ -124,6 +130,16 @@ void OPInit(void)
 		op_blend_cr[i] = (c2 << 4) | c1;
 	}
 
+	tablesFilled = true;
+}
+
+
+//
+// Object Processor initialization
+//
+void OPInit(void)
+{
+	OPFillBlendTables();
 	OPReset();
 }
 
@@ -142,8 +158,8 @@ static const char * opType[8] =
 { "(BITMAP)", "(SCALED BITMAP)", "(GPU INT)", "(BRANCH)", "(STOP)", "???", "???", "???" };
 static const char * ccType[8] =
 	{ "==", "<", ">", "(opflag set)", "(second half line)", "?", "?", "?" };
-static uint32_t object[8192];
-static uint32_t numberOfObjects;
+static PER_MACHINE uint32_t object[8192];
+static PER_MACHINE uint32_t numberOfObjects;
 //static uint32_t objectLink[8192];
 //static uint32_t numberOfLinks;
 
@@ -381,15 +397,14 @@ void OPSetCurrentObject(uint64_t object)
 uint64_t OPLoadPhrase(uint32_t offset)
 {
 	offset &= ~0x07;						// 8 byte alignment
-	return ((uint64_t)JaguarReadLong(offset, OP) << 32) | (uint64_t)JaguarReadLong(offset+4, OP);
+	return JaguarReadPhrase(offset, OP);
 }
 
 
 void OPStorePhrase(uint32_t offset, uint64_t p)
 {
 	offset &= ~0x07;						// 8 byte alignment
-	JaguarWriteLong(offset, p >> 32, OP);
-	JaguarWriteLong(offset + 4, p & 0xFFFFFFFF, OP);
+	JaguarWritePhrase(offset, p, OP);
 }
 
 
@@ -457,7 +472,7 @@ void OPProcessList(int halfline, bool render)
 //       pixels wide...
 	halfline &= 0x7FF;
 
-extern int op_start_log;
+extern PER_MACHINE int op_start_log;
 
 	op_pointer = OPGetListPointer();
 
@@ -467,9 +482,9 @@ extern int op_start_log;
 //op_done();
 
 // *** BEGIN OP PROCESSOR TESTING ONLY ***
-extern bool interactiveMode;
-extern bool iToggle;
-extern int objectPtr;
+extern PER_MACHINE bool interactiveMode;
+extern PER_MACHINE bool iToggle;
+extern PER_MACHINE int objectPtr;
 bool inhibit;
 int bitmapCounter = 0;
 // *** END OP PROCESSOR TESTING ONLY ***
@@ -553,10 +568,9 @@ WriteLog(" (GPU)\n");
 if ((p0 & 0x07) == OBJECT_TYPE_BRANCH)
 {
 WriteLog(" (BRANCH)\n");
-uint8_t * jaguarMainRam = GetRamPtr();
 WriteLog("[RAM] --> ");
 for(int k=0; k<8; k++)
-	WriteLog("%02X ", jaguarMainRam[op_pointer-8 + k]);
+	WriteLog("%02X ", JaguarReadByte(op_pointer-8 + k, OP));
 WriteLog("\n");
 }
 if ((p0 & 0x07) == OBJECT_TYPE_STOP)
@@ -1056,7 +1070,7 @@ if (depth > 5)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		// Fetch 1st phrase...
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = JaguarReadPhrase(data, OP);
 //Note that firstPix should only be honored *if* we start with the 1st phrase of the bitmap
 //i.e., we didn't clip on the margin... !!! FIX !!!
 		pixels <<= firstPix;						// Skip first N pixels (N=firstPix)...
@@ -1094,7 +1108,7 @@ if (depth > 5)
 			i = 0;
 			// Fetch next phrase...
 			data += pitch;
-			pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			pixels = JaguarReadPhrase(data, OP);
 		}
 	}
 	else if (depth == 1)							// 2 BPP
@@ -1108,7 +1122,7 @@ if (firstPix)
 		while (iwidth--)
 		{
 			// Fetch phrase...
-			uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			uint64_t pixels = JaguarReadPhrase(data, OP);
 			data += pitch;
 
 			for(int i=0; i<32; i++)
@@ -1152,7 +1166,7 @@ if (firstPix)
 		while (iwidth--)
 		{
 			// Fetch phrase...
-			uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			uint64_t pixels = JaguarReadPhrase(data, OP);
 			data += pitch;
 
 			for(int i=0; i<16; i++)
@@ -1191,7 +1205,7 @@ if (firstPix)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		// Fetch 1st phrase...
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = JaguarReadPhrase(data, OP);
 //Note that firstPix should only be honored *if* we start with the 1st phrase of the bitmap
 //i.e., we didn't clip on the margin... !!! FIX !!!
 		firstPix &= 0x30;							// Only top two bits are valid for 8 BPP
@@ -1234,7 +1248,7 @@ if (firstPix)
 			i = 0;
 			// Fetch next phrase...
 			data += pitch;
-			pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			pixels = JaguarReadPhrase(data, OP);
 		}
 	}
 	else if (depth == 4)							// 16 BPP
@@ -1247,7 +1261,7 @@ if (firstPix)
 		while (iwidth--)
 		{
 			// Fetch phrase...
-			uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			uint64_t pixels = JaguarReadPhrase(data, OP);
 			data += pitch;
 
 			for(int i=0; i<4; i++)
@@ -1295,7 +1309,7 @@ if (firstPix)
 		while (iwidth--)
 		{
 			// Fetch phrase...
-			uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			uint64_t pixels = JaguarReadPhrase(data, OP);
 			data += pitch;
 
 			for(int i=0; i<2; i++)
@@ -1481,7 +1495,7 @@ uint32_t scaledPhrasePixelsUS = phraseWidthToPixels[depth] * hscale;
 
 	if (startPos < 0)			// Case #1: Begin out, end in, L to R
 {
-extern int start_logging;
+extern PER_MACHINE int start_logging;
 if (start_logging)
 	WriteLog("OP: Scaled bitmap (%02X, %u BPP, spp=%u) start pos (%i) < 0...", hscale, op_bitmap_bit_depth[depth], scaledPhrasePixels, startPos);
 //		clippedWidth = 0 - startPos,
@@ -1507,7 +1521,7 @@ if (start_logging)
 		dataClippedWidth = phraseClippedWidth = clippedWidth / scaledPhrasePixels,
 		startPos = lbufWidth + (clippedWidth % scaledPhrasePixels);
 
-extern int op_start_log;
+extern PER_MACHINE int op_start_log;
 if (op_start_log && clippedWidth != 0)
 	WriteLog("OP: Clipped line. SP=%i, EP=%i, clip=%u, iwidth=%u, hscale=%02X\n", startPos, endPos, clippedWidth, iwidth, hscale);
 if (op_start_log && startPos == 13)
@@ -1556,7 +1570,7 @@ if (firstPix != 0)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		int pixCount = 0;
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = JaguarReadPhrase(data, OP);
 
 		while ((int32_t)iwidth > 0)
 		{
@@ -1609,7 +1623,7 @@ wide, so we could probably go back to that (as long as we make it an int16_t and
 				int phrasesToSkip = pixCount / 64, pixelShift = pixCount % 64;
 
 				data += (pitch << 3) * phrasesToSkip;
-				pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+				pixels = JaguarReadPhrase(data, OP);
 				pixels <<= 1 * pixelShift;
 				iwidth -= phrasesToSkip;
 				pixCount = pixelShift;
@@ -1625,7 +1639,7 @@ if (firstPix != 0)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		int pixCount = 0;
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = JaguarReadPhrase(data, OP);
 
 		while ((int32_t)iwidth > 0)
 		{
@@ -1673,7 +1687,7 @@ if (firstPix != 0)
 				int phrasesToSkip = pixCount / 32, pixelShift = pixCount % 32;
 
 				data += (pitch << 3) * phrasesToSkip;
-				pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+				pixels = JaguarReadPhrase(data, OP);
 				pixels <<= 2 * pixelShift;
 				iwidth -= phrasesToSkip;
 				pixCount = pixelShift;
@@ -1689,7 +1703,7 @@ if (firstPix != 0)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		int pixCount = 0;
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = JaguarReadPhrase(data, OP);
 
 		while ((int32_t)iwidth > 0)
 		{
@@ -1737,7 +1751,7 @@ if (firstPix != 0)
 				int phrasesToSkip = pixCount / 16, pixelShift = pixCount % 16;
 
 				data += (pitch << 3) * phrasesToSkip;
-				pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+				pixels = JaguarReadPhrase(data, OP);
 				pixels <<= 4 * pixelShift;
 				iwidth -= phrasesToSkip;
 				pixCount = pixelShift;
@@ -1752,7 +1766,7 @@ if (firstPix)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		int pixCount = 0;
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = JaguarReadPhrase(data, OP);
 
 		while ((int32_t)iwidth > 0)
 		{
@@ -1797,7 +1811,7 @@ if (firstPix)
 				int phrasesToSkip = pixCount / 8, pixelShift = pixCount % 8;
 
 				data += (pitch << 3) * phrasesToSkip;
-				pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+				pixels = JaguarReadPhrase(data, OP);
 				pixels <<= 8 * pixelShift;
 				iwidth -= phrasesToSkip;
 				pixCount = pixelShift;
@@ -1812,7 +1826,7 @@ if (firstPix != 0)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		int pixCount = 0;
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = JaguarReadPhrase(data, OP);
 
 		while ((int32_t)iwidth > 0)
 		{
@@ -1858,7 +1872,7 @@ if (firstPix != 0)
 				int phrasesToSkip = pixCount / 4, pixelShift = pixCount % 4;
 
 				data += (pitch << 3) * phrasesToSkip;
-				pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+				pixels = JaguarReadPhrase(data, OP);
 				pixels <<= 16 * pixelShift;
 
 				iwidth -= phrasesToSkip;
@@ -1880,7 +1894,7 @@ if (firstPix != 0)
 		while (iwidth--)
 		{
 			// Fetch phrase...
-			uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			uint64_t pixels = JaguarReadPhrase(data, OP);
 			data += pitch << 3;						// Multiply pitch * 8 (optimize: precompute this value)
 
 			for(int i=0; i<2; i++)
@@ -6,6 +6,7 @@
 #define __OBJECTP_H__
 
 #include <stdint.h>
+#include "machine.h"
 
 void OPInit(void);
 void OPReset(void);
@@ -26,6 +27,6 @@ void OPSetCurrentObject(uint64_t object);
 
 // Exported variables
 
-extern uint8_t objectp_running;
+extern PER_MACHINE uint8_t objectp_running;
 
 #endif	// __OBJECTP_H__
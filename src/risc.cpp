@@ -0,0 +1,50 @@
+//
+// risc.cpp: Tables for the RISC core that the GPU & DSP share
+//
+// See risc.h. These are shared by every machine (see machine.h), so they only
+// get built once.
+//
+
+#include "risc.h"
+
+#define ZERO_FLAG		0x0001
+#define CARRY_FLAG		0x0002
+
+const uint32_t riscConvertZero[32] =
+	{ 32,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31 };
+
+uint8_t riscBranchCondition[32 * 8];
+
+
+void RiscBuildTables(void)
+{
+	static bool tablesBuilt = false;
+
+	if (tablesBuilt)
+		return;
+
+	// Indexed by NCZ, then by condition code (bit 4 of which picks N over C)
+	for(int i=0; i<8; i++)
+	{
+		for(int j=0; j<32; j++)
+		{
+			int result = 1;
+
+			if ((j & 1) && (i & ZERO_FLAG))
+				result = 0;
+
+			if ((j & 2) && (!(i & ZERO_FLAG)))
+				result = 0;
+
+			if ((j & 4) && (i & (CARRY_FLAG << (j >> 4))))
+				result = 0;
+
+			if ((j & 8) && (!(i & (CARRY_FLAG << (j >> 4)))))
+				result = 0;
+
+			riscBranchCondition[i * 32 + j] = result;
+		}
+	}
+
+	tablesBuilt = true;
+}
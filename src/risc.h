@@ -0,0 +1,497 @@
+//
+// risc.h: The RISC core that Tom's GPU & Jerry's DSP have in common
+//
+// The GPU & DSP are the same processor with a handful of different opcodes and
+// a different view of the bus. What they share lives here: the state every
+// instruction touches (RiscState), the lookup tables, and the opcode handlers
+// (RiscCore<>). A variant hands RiscCore<> the chip specific bits:
+//
+//   static RiscState & State(void)			The chip's state
+//   static void Exec(int32_t cycles)		Runs a delay slot (GPUExec()/DSPExec())
+//   static uint16_t ReadWord(uint32_t)		The chip's view of memory
+//
+// and builds its opcode table out of RiscCore<variant>::opcode_*() and its own
+// handlers for the loads & stores (the two chips don't agree on alignment),
+// DIV, and the opcodes only it has. Everything gets resolved at compile time,
+// so there's no cost over the old copy & pasted handlers.
+//
+
+#ifndef __RISC_H__
+#define __RISC_H__
+
+#include <stdint.h>
+#include "machine.h"
+
+//
+// Everything the interpreter touches on every instruction fits in the first
+// cache line; the register banks follow on their own lines.
+//
+struct alignas(64) RiscState
+{
+	uint32_t * reg;								// Current register bank
+	uint32_t * alternateReg;					// The other one
+	uint32_t pc;
+	uint32_t control;
+	uint32_t instruction;
+	uint32_t firstParameter;					// Rm/immediate
+	uint32_t secondParameter;					// Rn
+	// Keeping the flags separate means results don't have to be masked in
+	uint8_t flagZ, flagN, flagC;
+	uint32_t flags;
+	uint64_t acc;								// 40 bits on the DSP, only 32 used on the GPU
+	uint32_t matrixControl;
+	uint32_t pointerToMatrix;
+
+	uint32_t remain;							// DIV's remainder
+	uint32_t divControl;
+	uint32_t dataOrganization;
+
+	alignas(64) uint32_t regBank0[32];
+	uint32_t regBank1[32];
+};
+
+// Shared by both chips (and every machine), filled in by RiscBuildTables()
+extern const uint32_t riscConvertZero[32];		// Turns a quick value of 0 into 32
+extern uint8_t riscBranchCondition[32 * 8];		// By condition code & NCZ
+
+void RiscBuildTables(void);
+
+#define RISC_RM				s.reg[s.firstParameter]
+#define RISC_RN				s.reg[s.secondParameter]
+#define RISC_IMM_1			s.firstParameter
+#define RISC_IMM_2			s.secondParameter
+
+template <class Variant>
+struct RiscCore
+{
+	static inline void SetZN(RiscState & s, uint32_t r)
+	{
+		s.flagZ = (r == 0);
+		s.flagN = r >> 31;
+	}
+
+	static inline void SetZNCAdd(RiscState & s, uint32_t a, uint32_t b, uint32_t r)
+	{
+		SetZN(s, r);
+		s.flagC = (b > ~a);
+	}
+
+	static inline void SetZNCSub(RiscState & s, uint32_t a, uint32_t b, uint32_t r)
+	{
+		SetZN(s, r);
+		s.flagC = (b > a);
+	}
+
+	static inline bool BranchTaken(RiscState & s)
+	{
+		return riscBranchCondition[RISC_IMM_2 + (((s.flagN << 2) | (s.flagC << 1) | s.flagZ) << 5)];
+	}
+
+	static void opcode_add(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t res = RISC_RN + RISC_RM;
+		SetZNCAdd(s, RISC_RN, RISC_RM, res);
+		RISC_RN = res;
+	}
+
+	static void opcode_addc(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t carry = s.flagC;
+		uint32_t res = RISC_RN + RISC_RM + carry;
+		SetZNCAdd(s, RISC_RN + carry, RISC_RM, res);
+		RISC_RN = res;
+	}
+
+	static void opcode_addq(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t r1 = riscConvertZero[RISC_IMM_1];
+		uint32_t res = RISC_RN + r1;
+		SetZNCAdd(s, RISC_RN, r1, res);
+		RISC_RN = res;
+	}
+
+	static void opcode_addqt(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN += riscConvertZero[RISC_IMM_1];
+	}
+
+	static void opcode_sub(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t res = RISC_RN - RISC_RM;
+		SetZNCSub(s, RISC_RN, RISC_RM, res);
+		RISC_RN = res;
+	}
+
+	static void opcode_subc(void)
+	{
+		RiscState & s = Variant::State();
+		// This is how the ALU does it--Two's complement with inverted carry
+		uint64_t res = (uint64_t)RISC_RN + (uint64_t)(RISC_RM ^ 0xFFFFFFFF) + (s.flagC ^ 1);
+		// Carry out of the result is inverted too
+		s.flagC = ((res >> 32) & 0x01) ^ 1;
+		RISC_RN = (res & 0xFFFFFFFF);
+		SetZN(s, RISC_RN);
+	}
+
+	static void opcode_subq(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t r1 = riscConvertZero[RISC_IMM_1];
+		uint32_t res = RISC_RN - r1;
+		SetZNCSub(s, RISC_RN, r1, res);
+		RISC_RN = res;
+	}
+
+	static void opcode_subqt(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN -= riscConvertZero[RISC_IMM_1];
+	}
+
+	static void opcode_neg(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t res = -RISC_RN;
+		SetZNCSub(s, 0, RISC_RN, res);
+		RISC_RN = res;
+	}
+
+	static void opcode_and(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN &= RISC_RM;
+		SetZN(s, RISC_RN);
+	}
+
+	static void opcode_or(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN |= RISC_RM;
+		SetZN(s, RISC_RN);
+	}
+
+	static void opcode_xor(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN ^= RISC_RM;
+		SetZN(s, RISC_RN);
+	}
+
+	static void opcode_not(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN = ~RISC_RN;
+		SetZN(s, RISC_RN);
+	}
+
+	static void opcode_btst(void)
+	{
+		RiscState & s = Variant::State();
+		s.flagZ = (~RISC_RN >> RISC_IMM_1) & 0x01;
+	}
+
+	static void opcode_bset(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN |= (1 << RISC_IMM_1);
+		SetZN(s, RISC_RN);
+	}
+
+	static void opcode_bclr(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN &= ~(1 << RISC_IMM_1);
+		SetZN(s, RISC_RN);
+	}
+
+	static void opcode_mult(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN = (uint32_t)(uint16_t)RISC_RM * (uint32_t)(uint16_t)RISC_RN;
+		SetZN(s, RISC_RN);
+	}
+
+	static void opcode_imult(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN = (int16_t)RISC_RN * (int16_t)RISC_RM;
+		SetZN(s, RISC_RN);
+	}
+
+	// The accumulator's sign extended all the way, so the GPU (which only has
+	// 32 bits of it) sees the same low 32 bits it always did
+	static void opcode_imultn(void)
+	{
+		RiscState & s = Variant::State();
+		int32_t res = (int16_t)RISC_RN * (int16_t)RISC_RM;
+		s.acc = (int64_t)res;
+		SetZN(s, res);
+	}
+
+	static void opcode_resmac(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN = (uint32_t)s.acc;
+	}
+
+	static void opcode_imacn(void)
+	{
+		RiscState & s = Variant::State();
+		int32_t res = (int16_t)RISC_RM * (int16_t)RISC_RN;
+		s.acc += (int64_t)res;
+	}
+
+	// ABS of $80000000 gives $80000000 back, with N & C set. (The DSP used to
+	// leave C & Z alone here; we go with what the GPU did.)
+	static void opcode_abs(void)
+	{
+		RiscState & s = Variant::State();
+		s.flagC = RISC_RN >> 31;
+
+		if (RISC_RN == 0x80000000)
+			s.flagN = 1, s.flagZ = 0;
+		else
+		{
+			if (s.flagC)
+				RISC_RN = -RISC_RN;
+
+			s.flagN = 0;
+			s.flagZ = (RISC_RN == 0);
+		}
+	}
+
+	static void opcode_sh(void)
+	{
+		RiscState & s = Variant::State();
+
+		if (RISC_RM & 0x80000000)				// Shift left
+		{
+			s.flagC = RISC_RN >> 31;
+			RISC_RN = ((int32_t)RISC_RM <= -32 ? 0 : RISC_RN << -(int32_t)RISC_RM);
+		}
+		else									// Shift right
+		{
+			s.flagC = RISC_RN & 0x01;
+			RISC_RN = (RISC_RM >= 32 ? 0 : RISC_RN >> RISC_RM);
+		}
+
+		SetZN(s, RISC_RN);
+	}
+
+	static void opcode_sha(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t res;
+
+		if ((int32_t)RISC_RM < 0)
+		{
+			res = ((int32_t)RISC_RM <= -32 ? 0 : RISC_RN << -(int32_t)RISC_RM);
+			s.flagC = RISC_RN >> 31;
+		}
+		else
+		{
+			res = ((int32_t)RISC_RM >= 32 ? (int32_t)RISC_RN >> 31 : (int32_t)RISC_RN >> (int32_t)RISC_RM);
+			s.flagC = RISC_RN & 0x01;
+		}
+
+		RISC_RN = res;
+		SetZN(s, res);
+	}
+
+	//
+	// N.B.: The quick shifts & rotates by 32 (which the hardware may or may not
+	//       do) shift by nothing, same as the x86 always did for us
+	//
+	static void opcode_shlq(void)
+	{
+		RiscState & s = Variant::State();
+		// The only one that does (32 - immediate data)
+		uint32_t res = RISC_RN << ((32 - RISC_IMM_1) & 0x1F);
+		SetZN(s, res);
+		s.flagC = RISC_RN >> 31;
+		RISC_RN = res;
+	}
+
+	static void opcode_shrq(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t res = RISC_RN >> (riscConvertZero[RISC_IMM_1] & 0x1F);
+		SetZN(s, res);
+		s.flagC = RISC_RN & 0x01;
+		RISC_RN = res;
+	}
+
+	static void opcode_sharq(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t res = (int32_t)RISC_RN >> (riscConvertZero[RISC_IMM_1] & 0x1F);
+		SetZN(s, res);
+		s.flagC = RISC_RN & 0x01;
+		RISC_RN = res;
+	}
+
+	static void opcode_ror(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t r1 = RISC_RM & 0x1F;
+		uint32_t res = (RISC_RN >> r1) | (RISC_RN << ((32 - r1) & 0x1F));
+		SetZN(s, res);
+		s.flagC = RISC_RN >> 31;
+		RISC_RN = res;
+	}
+
+	static void opcode_rorq(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t r1 = riscConvertZero[RISC_IMM_1] & 0x1F;
+		uint32_t res = (RISC_RN >> r1) | (RISC_RN << ((32 - r1) & 0x1F));
+		SetZN(s, res);
+		s.flagC = RISC_RN >> 31;
+		RISC_RN = res;
+	}
+
+	static void opcode_cmp(void)
+	{
+		RiscState & s = Variant::State();
+		SetZNCSub(s, RISC_RN, RISC_RM, RISC_RN - RISC_RM);
+	}
+
+	static void opcode_cmpq(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t r1 = (RISC_IMM_1 & 0x10 ? 0xFFFFFFF0 | RISC_IMM_1 : RISC_IMM_1);
+		SetZNCSub(s, RISC_RN, r1, RISC_RN - r1);
+	}
+
+	static void opcode_move(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN = RISC_RM;
+	}
+
+	static void opcode_moveq(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN = RISC_IMM_1;
+	}
+
+	static void opcode_moveta(void)
+	{
+		RiscState & s = Variant::State();
+		s.alternateReg[RISC_IMM_2] = RISC_RM;
+	}
+
+	static void opcode_movefa(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN = s.alternateReg[RISC_IMM_1];
+	}
+
+	static void opcode_movei(void)
+	{
+		RiscState & s = Variant::State();
+		// The 32-bit value follows in LSW / MSW order
+		RISC_RN = (uint32_t)Variant::ReadWord(s.pc) | ((uint32_t)Variant::ReadWord(s.pc + 2) << 16);
+		s.pc += 4;
+	}
+
+	static void opcode_move_pc(void)
+	{
+		RiscState & s = Variant::State();
+		RISC_RN = s.pc - 2;
+	}
+
+	static void opcode_jump(void)
+	{
+		RiscState & s = Variant::State();
+
+		if (BranchTaken(s))
+		{
+			uint32_t delayedPC = RISC_RM;
+			Variant::Exec(1);
+			s.pc = delayedPC;
+		}
+	}
+
+	static void opcode_jr(void)
+	{
+		RiscState & s = Variant::State();
+
+		if (BranchTaken(s))
+		{
+			int32_t offset = (RISC_IMM_1 & 0x10 ? 0xFFFFFFF0 | RISC_IMM_1 : RISC_IMM_1);
+			uint32_t delayedPC = s.pc + (offset * 2);
+			Variant::Exec(1);
+			s.pc = delayedPC;
+		}
+	}
+
+	static void opcode_mmult(void)
+	{
+		RiscState & s = Variant::State();
+		int count = s.matrixControl & 0x0F;		// Matrix width
+		uint32_t addr = s.pointerToMatrix;		// In local RAM
+		uint32_t step = (s.matrixControl & 0x10 ? 4 * count : 4);	// Column or row stepping
+		int64_t accum = 0;
+
+		for(int i=0; i<count; i++)
+		{
+			uint32_t a = s.alternateReg[RISC_IMM_1 + (i >> 1)];
+			int16_t b = (int16_t)Variant::ReadWord(addr + 2);
+			accum += (int16_t)(i & 0x01 ? a >> 16 : a & 0xFFFF) * b;
+			addr += step;
+		}
+
+		RISC_RN = (int32_t)accum;
+		SetZN(s, RISC_RN);
+	}
+
+	static void opcode_mtoi(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t r1 = RISC_RM;
+		RISC_RN = (((int32_t)r1 >> 8) & 0xFF800000) | (r1 & 0x007FFFFF);
+		SetZN(s, RISC_RN);
+	}
+
+	static void opcode_normi(void)
+	{
+		RiscState & s = Variant::State();
+		uint32_t r1 = RISC_RM;
+		uint32_t res = 0;
+
+		if (r1)
+		{
+			while ((r1 & 0xFFC00000) == 0)
+			{
+				r1 <<= 1;
+				res--;
+			}
+
+			while ((r1 & 0xFF800000) != 0)
+			{
+				r1 >>= 1;
+				res++;
+			}
+		}
+
+		RISC_RN = res;
+		SetZN(s, res);
+	}
+
+	static void opcode_nop(void)
+	{
+	}
+};
+
+#undef RISC_RM
+#undef RISC_RN
+#undef RISC_IMM_1
+#undef RISC_IMM_2
+
+#endif	// __RISC_H__
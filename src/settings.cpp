@@ -16,5 +16,5 @@
 
 // Global variables
 
-VJSettings vjs;
+PER_MACHINE VJSettings vjs;
 
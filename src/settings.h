@@ -17,6 +17,7 @@
 #endif
 #endif
 #include <stdint.h>
+#include "machine.h"
 
 // Settings struct
 
@@ -39,6 +40,13 @@ struct VJSettings
 	bool allowWritesToROM;
 	uint32_t biosType;
 	bool useFastBlitter;
+	bool asyncBlitter;			// Run blits on their own thread (see BlitterQueue())
+	bool parallelBlitter;		// Split big blits across threads (see BlitterParallelRows())
+	bool threadedGPU;
+	bool useGPUJIT;
+	bool useDSPJIT;
+	bool lockstepDSP;			// Run both DSP cores & compare (see lockstep.h)
+	bool lockstepBlitter;		// Run both blitters & compare
 
 	// Keybindings in order of U, D, L, R, C, B, A, Op, Pa, 0-9, #, *
 
@@ -65,6 +73,6 @@ enum { BT_K_SERIES, BT_M_SERIES, BT_STUBULATOR_1, BT_STUBULATOR_2 };
 
 // Exported variables
 
-extern VJSettings vjs;
+extern PER_MACHINE VJSettings vjs;
 
 #endif	// __SETTINGS_H__
@@ -346,18 +346,18 @@
 //(It's easier to do it here, though...)
 //#define TOM_DEBUG
 
-uint8_t tomRam8[0x4000];
-uint32_t tomWidth, tomHeight;
-uint32_t tomTimerPrescaler;
-uint32_t tomTimerDivider;
-int32_t tomTimerCounter;
-uint16_t tom_jerry_int_pending, tom_timer_int_pending, tom_object_int_pending,
+PER_MACHINE uint8_t tomRam8[0x4000];
+PER_MACHINE uint32_t tomWidth, tomHeight;
+PER_MACHINE uint32_t tomTimerPrescaler;
+PER_MACHINE uint32_t tomTimerDivider;
+PER_MACHINE int32_t tomTimerCounter;
+PER_MACHINE uint16_t tom_jerry_int_pending, tom_timer_int_pending, tom_object_int_pending,
 	tom_gpu_int_pending, tom_video_int_pending;
 
 // These are set by the "user" of the Jaguar core lib, since these are
 // OS/system dependent.
-uint32_t * screenBuffer;
-uint32_t screenPitch;
+PER_MACHINE uint32_t * screenBuffer;
+PER_MACHINE uint32_t screenPitch;
 
 static const char * videoMode_to_str[8] =
 	{ "16 BPP CRY", "24 BPP RGB", "16 BPP DIRECT", "16 BPP RGB",
@@ -565,6 +565,12 @@ uint32_t MIX16ToRGB32[0x10000];
 #warning "This is not endian-safe. !!! FIX !!!"
 void TOMFillLookupTables(void)
 {
+	// These are shared by every machine (see machine.h), so only do this once
+	static bool tablesFilled = false;
+
+	if (tablesFilled)
+		return;
+
 	// NOTE: Jaguar 16-bit (non-CRY) color is RBG 556 like so:
 	//       RRRR RBBB BBGG GGGG
 	for(uint32_t i=0; i<0x10000; i++)
@@ -586,6 +592,8 @@ void TOMFillLookupTables(void)
 		CRY16ToRGB32[i] = 0x000000FF | (r << 24) | (g << 16) | (b << 8);
 		MIX16ToRGB32[i] = (i & 0x01 ? RGB16ToRGB32[i] : CRY16ToRGB32[i]);
 	}
+
+	tablesFilled = true;
 }
 
 
@@ -1680,8 +1688,8 @@ void TOMResetPIT(void)
 
 	if (tomTimerPrescaler)
 	{
-		double usecs = (float)(tomTimerPrescaler + 1) * (float)(tomTimerDivider + 1) * RISC_CYCLE_IN_USEC;
-		SetCallbackTime(TOMPITCallback, usecs);
+		uint64_t ticks = (uint64_t)(tomTimerPrescaler + 1) * (tomTimerDivider + 1);
+		SetCallbackTicks(TOMPITCallback, ticks);
 	}
 #endif
 }
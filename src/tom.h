@@ -60,14 +60,14 @@ void TOMResetPIT(void);
 
 // Exported variables
 
-extern uint32_t tomWidth;
-extern uint32_t tomHeight;
-extern uint8_t tomRam8[];
-extern uint32_t tomTimerPrescaler;
-extern uint32_t tomTimerDivider;
-extern int32_t tomTimerCounter;
-
-extern uint32_t screenPitch;
-extern uint32_t * screenBuffer;
+extern PER_MACHINE uint32_t tomWidth;
+extern PER_MACHINE uint32_t tomHeight;
+extern PER_MACHINE uint8_t tomRam8[];
+extern PER_MACHINE uint32_t tomTimerPrescaler;
+extern PER_MACHINE uint32_t tomTimerDivider;
+extern PER_MACHINE int32_t tomTimerCounter;
+
+extern PER_MACHINE uint32_t screenPitch;
+extern PER_MACHINE uint32_t * screenBuffer;
 
 #endif	// __TOM_H__
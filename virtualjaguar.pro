@@ -79,6 +79,7 @@ HEADERS = \
 	src/gui/configdialog.h \
 	src/gui/controllertab.h \
 	src/gui/controllerwidget.h \
+	src/gui/emuthread.h \
 	src/gui/filelistmodel.h \
 	src/gui/filepicker.h \
 	src/gui/filethread.h \
@@ -103,6 +104,7 @@ SOURCES = \
 	src/gui/configdialog.cpp \
 	src/gui/controllertab.cpp \
 	src/gui/controllerwidget.cpp \
+	src/gui/emuthread.cpp \
 	src/gui/filelistmodel.cpp \
 	src/gui/filepicker.cpp \
 	src/gui/filethread.cpp \